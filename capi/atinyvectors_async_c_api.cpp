@@ -0,0 +1,89 @@
+#include "atinyvectors_c_api.h"
+#include "TaskExecutor.hpp"
+#include "service/SearchService.hpp"
+#include "service/VectorService.hpp"
+#include <cstring>
+#include <string>
+#include "nlohmann/json.hpp"
+#include "spdlog/spdlog.h"
+
+namespace {
+
+char* copyJsonString(const std::string& jsonString) {
+    char* resultCStr = (char*)malloc(jsonString.size() + 1);
+    std::strcpy(resultCStr, jsonString.c_str());
+    return resultCStr;
+}
+
+void complete(ATVCompletionCallback callback, void* userData, int status, char* resultJson) {
+    if (callback) {
+        callback(userData, status, resultJson);
+    } else {
+        atv_free_json_string(resultJson);
+    }
+}
+
+// Completes the request with ASYNC_CANCELLED if the executor goes away before it runs
+int submit(atinyvectors::TaskExecutor::Task task, ATVCompletionCallback callback, void* userData) {
+    auto cancel = [callback, userData]() {
+        complete(callback, userData, static_cast<int>(ATVErrorCode::ASYNC_CANCELLED),
+                 atv_create_error_json(ATVErrorCode::ASYNC_CANCELLED, "Async executor shut down before the request ran"));
+    };
+    if (!atinyvectors::TaskExecutor::getInstance().trySubmit(std::move(task), std::move(cancel))) {
+        spdlog::warn("Async request rejected: executor queue is full");
+        return static_cast<int>(ATVErrorCode::ASYNC_QUEUE_FULL);
+    }
+    return 0;
+}
+
+}
+
+// Async C API
+int atv_search_async(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId, const char* queryJsonStr, size_t k,
+                     ATVCompletionCallback callback, void* user_data) {
+    auto* cppManager = reinterpret_cast<atinyvectors::service::SearchServiceManager*>(manager);
+    std::string space(spaceName);
+    std::string query(queryJsonStr);
+
+    return submit([=]() {
+        int status = 0;
+        char* resultJson = nullptr;
+        try {
+            std::vector<std::pair<float, int>> results = cppManager->search(space, versionUniqueId, query, k);
+            resultJson = copyJsonString(cppManager->extractSearchResultsToJson(results).dump());
+        } catch (const nlohmann::json::exception& e) {
+            status = static_cast<int>(ATVErrorCode::JSON_PARSE_ERROR);
+            resultJson = atv_create_error_json(ATVErrorCode::JSON_PARSE_ERROR, e.what());
+        } catch (const std::exception& e) {
+            status = static_cast<int>(ATVErrorCode::UNKNOWN_ERROR);
+            resultJson = atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+        }
+        complete(callback, user_data, status, resultJson);
+    }, callback, user_data);
+}
+
+int atv_upsert_async(VectorServiceManager* manager, const char* spaceName, int versionId, const char* jsonStr,
+                     ATVCompletionCallback callback, void* user_data) {
+    auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
+    std::string space(spaceName);
+    auto payload = std::make_shared<std::string>(jsonStr);
+
+    return submit([=]() {
+        int status = 0;
+        char* resultJson = nullptr;
+        try {
+            cppManager->upsert(space, versionId, *payload);
+        } catch (const nlohmann::json::exception& e) {
+            status = static_cast<int>(ATVErrorCode::JSON_PARSE_ERROR);
+            resultJson = atv_create_error_json(ATVErrorCode::JSON_PARSE_ERROR, e.what());
+        } catch (const std::exception& e) {
+            status = static_cast<int>(ATVErrorCode::UNKNOWN_ERROR);
+            resultJson = atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+        }
+        complete(callback, user_data, status, resultJson);
+    }, callback, user_data);
+}
+
+void atv_async_shutdown() {
+    atinyvectors::TaskExecutor::shutdownInstance();
+}
@@ -2,6 +2,7 @@
 #define ATINYVECTORS_C_API_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include "ErrorCode.hpp"
 
 #ifdef __cplusplus
@@ -38,16 +39,67 @@ char* atv_version_service_get_default_version(VersionServiceManager* manager, co
 char* atv_version_service_get_lists(VersionServiceManager* manager, const char* spaceName, int start, int limit);
 void atv_version_service_delete_by_version_id(VersionServiceManager* manager, const char* spaceName, int versionId);
 
+// Column-oriented vector batch for atv_vector_service_upsert_batch. Set either
+// dense_data (count x dim, row-major) or the sparse CSR arrays, where row i spans
+// [sparse_offsets[i], sparse_offsets[i + 1]). ids may be NULL, and an id of 0
+// allocates a new one. metadata_values is metadata_key_count x count, column-major;
+// NULL entries are skipped.
+typedef struct ATVVectorBatch {
+    size_t count;
+    const int* ids;
+    const float* dense_data;
+    int dim;
+    const int64_t* sparse_offsets;
+    const int* sparse_indices;
+    const float* sparse_values;
+    size_t metadata_key_count;
+    const char* const* metadata_keys;
+    const char* const* metadata_values;
+} ATVVectorBatch;
+
 // C API for VectorServiceManager
 VectorServiceManager* atv_vector_service_manager_new();
 void atv_vector_service_manager_free(VectorServiceManager* manager);
 void atv_vector_service_upsert(VectorServiceManager* manager, const char* spaceName, int versionId, const char* jsonStr);
+// Returns NULL on success, otherwise an error JSON to release with atv_free_json_string
+char* atv_vector_service_upsert_batch(VectorServiceManager* manager, const char* spaceName, int versionId, const ATVVectorBatch* batch);
 char* atv_vector_service_get_vectors_by_version_id(VectorServiceManager* manager, const char* spaceName, int versionId, int start, int limit, const char* filter);
+char* atv_vector_service_get_vectors_by_cursor(VectorServiceManager* manager, const char* spaceName, int versionId, int afterUniqueId, int limit, const char* filter);
+// keysJson is a JSON array of metadata keys; filter may be NULL, and limit < 0 returns every value
+char* atv_vector_service_get_facets(VectorServiceManager* manager, const char* spaceName, int versionId, const char* keysJson, const char* filter, int limit);
+char* atv_vector_service_delete_by_filter(VectorServiceManager* manager, const char* spaceName, int versionId, const char* filter);
+// metadataJson is a JSON object of the keys to set on every matching vector
+char* atv_vector_service_update_metadata_by_filter(VectorServiceManager* manager, const char* spaceName, int versionId, const char* filter, const char* metadataJson);
 
 // C API for SearchServiceManager
 SearchServiceManager* atv_search_service_manager_new();
 void atv_search_service_manager_free(SearchServiceManager* manager);
 char* atv_search_service_search(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId, const char* queryJsonStr, size_t k);
+// Write up to k (distance, vector id) hits into out_distances/out_ids, which must hold
+// k entries each. Return the number of hits, or -1 on error.
+int atv_search_dense(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId,
+                     const float* query, int dim, size_t k, float* out_distances, int64_t* out_ids);
+int atv_search_sparse(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId,
+                      const int* indices, const float* values, int nnz, size_t k, float* out_distances, int64_t* out_ids);
+
+// Async C API. Work runs on an internal executor (ATV_ASYNC_THREADS workers) and the
+// callback is invoked on a worker thread with status 0 and the result JSON (NULL for
+// upserts), or with an error code and an error JSON. The callback owns result_json and
+// releases it with atv_free_json_string; a NULL callback discards it. Arguments are
+// copied, but the manager must stay alive until the callback has run.
+// Returns 0 once queued, or ASYNC_QUEUE_FULL (1004) when ATV_ASYNC_QUEUE_SIZE requests
+// are already pending; nothing is queued then and the call can be retried later.
+typedef void (*ATVCompletionCallback)(void* user_data, int status, char* result_json);
+int atv_search_async(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId, const char* queryJsonStr, size_t k,
+                     ATVCompletionCallback callback, void* user_data);
+int atv_upsert_async(VectorServiceManager* manager, const char* spaceName, int versionId, const char* jsonStr,
+                     ATVCompletionCallback callback, void* user_data);
+
+// Runs the queued async requests to completion and stops the workers. Call it before
+// exiting, while the managers are still alive, and not from a callback. Requests still
+// queued when the process exits without it complete with ASYNC_CANCELLED (1005)
+// instead of running. A later async call starts the executor again.
+void atv_async_shutdown();
 
 // C API for SnapshotServiceManager
 SnapshotServiceManager* atv_snapshot_service_manager_new();
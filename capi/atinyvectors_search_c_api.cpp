@@ -3,6 +3,7 @@
 #include <cstring>
 #include <iostream>
 #include "nlohmann/json.hpp"
+#include "spdlog/spdlog.h"
 
 // C API for SearchServiceManager
 SearchServiceManager* atv_search_service_manager_new() {
@@ -30,3 +31,31 @@ char* atv_search_service_search(SearchServiceManager* manager, const char* space
         return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
     }
 }
+
+int atv_search_dense(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId,
+                     const float* query, int dim, size_t k, float* out_distances, int64_t* out_ids) {
+    try {
+        auto* cppManager = reinterpret_cast<atinyvectors::service::SearchServiceManager*>(manager);
+        if (dim < 0) {
+            throw std::invalid_argument("dim must not be negative");
+        }
+        return static_cast<int>(cppManager->searchDense(spaceName, versionUniqueId, query, static_cast<size_t>(dim), k, out_distances, out_ids));
+    } catch (const std::exception& e) {
+        spdlog::error("atv_search_dense failed: {}", e.what());
+        return -1;
+    }
+}
+
+int atv_search_sparse(SearchServiceManager* manager, const char* spaceName, const int versionUniqueId,
+                      const int* indices, const float* values, int nnz, size_t k, float* out_distances, int64_t* out_ids) {
+    try {
+        auto* cppManager = reinterpret_cast<atinyvectors::service::SearchServiceManager*>(manager);
+        if (nnz < 0) {
+            throw std::invalid_argument("nnz must not be negative");
+        }
+        return static_cast<int>(cppManager->searchSparse(spaceName, versionUniqueId, indices, values, static_cast<size_t>(nnz), k, out_distances, out_ids));
+    } catch (const std::exception& e) {
+        spdlog::error("atv_search_sparse failed: {}", e.what());
+        return -1;
+    }
+}
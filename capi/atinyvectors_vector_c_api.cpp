@@ -24,6 +24,32 @@ void atv_vector_service_upsert(VectorServiceManager* manager, const char* spaceN
     }
 }
 
+char* atv_vector_service_upsert_batch(VectorServiceManager* manager, const char* spaceName, int versionId, const ATVVectorBatch* batch) {
+    if (batch == nullptr) {
+        return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, "batch is null");
+    }
+
+    try {
+        atinyvectors::service::VectorBatch cppBatch;
+        cppBatch.count = batch->count;
+        cppBatch.ids = batch->ids;
+        cppBatch.denseData = batch->dense_data;
+        cppBatch.dim = batch->dim;
+        cppBatch.sparseOffsets = batch->sparse_offsets;
+        cppBatch.sparseIndices = batch->sparse_indices;
+        cppBatch.sparseValues = batch->sparse_values;
+        cppBatch.metadataKeyCount = batch->metadata_key_count;
+        cppBatch.metadataKeys = batch->metadata_keys;
+        cppBatch.metadataValues = batch->metadata_values;
+
+        auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
+        cppManager->upsertBatch(spaceName, versionId, cppBatch);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+    }
+}
+
 char* atv_vector_service_get_vectors_by_version_id(VectorServiceManager* manager, const char* spaceName, int versionId, int start, int limit, const char* filter) {
     try {
         auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
@@ -40,3 +66,68 @@ char* atv_vector_service_get_vectors_by_version_id(VectorServiceManager* manager
         return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
     }
 }
+
+char* atv_vector_service_get_vectors_by_cursor(VectorServiceManager* manager, const char* spaceName, int versionId, int afterUniqueId, int limit, const char* filter) {
+    try {
+        auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
+        nlohmann::json result = cppManager->getVectorsByCursor(spaceName, versionId, afterUniqueId, limit, filter ? filter : "");
+
+        std::string jsonString = result.dump();
+        char* resultCStr = (char*)malloc(jsonString.size() + 1);
+        std::strcpy(resultCStr, jsonString.c_str());
+        return resultCStr;
+    } catch (const nlohmann::json::exception& e) {
+        return atv_create_error_json(ATVErrorCode::JSON_PARSE_ERROR, e.what());
+    } catch (const std::exception& e) {
+        return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+    }
+}
+
+char* atv_vector_service_get_facets(VectorServiceManager* manager, const char* spaceName, int versionId, const char* keysJson, const char* filter, int limit) {
+    try {
+        auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
+        std::vector<std::string> keys = nlohmann::json::parse(keysJson).get<std::vector<std::string>>();
+        nlohmann::json result = cppManager->getFacets(spaceName, versionId, keys, filter ? filter : "", limit);
+
+        std::string jsonString = result.dump();
+        char* resultCStr = (char*)malloc(jsonString.size() + 1);
+        std::strcpy(resultCStr, jsonString.c_str());
+        return resultCStr;
+    } catch (const nlohmann::json::exception& e) {
+        return atv_create_error_json(ATVErrorCode::JSON_PARSE_ERROR, e.what());
+    } catch (const std::exception& e) {
+        return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+    }
+}
+
+char* atv_vector_service_delete_by_filter(VectorServiceManager* manager, const char* spaceName, int versionId, const char* filter) {
+    try {
+        auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
+        nlohmann::json result = cppManager->deleteByFilter(spaceName, versionId, filter ? filter : "");
+
+        std::string jsonString = result.dump();
+        char* resultCStr = (char*)malloc(jsonString.size() + 1);
+        std::strcpy(resultCStr, jsonString.c_str());
+        return resultCStr;
+    } catch (const nlohmann::json::exception& e) {
+        return atv_create_error_json(ATVErrorCode::JSON_PARSE_ERROR, e.what());
+    } catch (const std::exception& e) {
+        return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+    }
+}
+
+char* atv_vector_service_update_metadata_by_filter(VectorServiceManager* manager, const char* spaceName, int versionId, const char* filter, const char* metadataJson) {
+    try {
+        auto* cppManager = reinterpret_cast<atinyvectors::service::VectorServiceManager*>(manager);
+        nlohmann::json result = cppManager->updateMetadataByFilter(spaceName, versionId, filter ? filter : "", metadataJson);
+
+        std::string jsonString = result.dump();
+        char* resultCStr = (char*)malloc(jsonString.size() + 1);
+        std::strcpy(resultCStr, jsonString.c_str());
+        return resultCStr;
+    } catch (const nlohmann::json::exception& e) {
+        return atv_create_error_json(ATVErrorCode::JSON_PARSE_ERROR, e.what());
+    } catch (const std::exception& e) {
+        return atv_create_error_json(ATVErrorCode::UNKNOWN_ERROR, e.what());
+    }
+}
@@ -0,0 +1,18 @@
+-- Text-searchable metadata keys: each space may name keys whose values are indexed
+-- by trigram, so LIKE filters with a substring pattern look the matching rows up
+-- instead of testing every row of the key
+CREATE TABLE IF NOT EXISTS MetadataTextIndex (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    spaceId INTEGER NOT NULL,
+    key TEXT NOT NULL,
+    UNIQUE(spaceId, key)
+);
+
+-- The FTS5 table VectorMetadataText and the triggers that fill it are created
+-- when a space first names text keys (VectorMetadataManager::setTextIndexedKeys),
+-- so databases that never use them don't need FTS5
+
+CREATE TRIGGER IF NOT EXISTS trg_metadata_text_index_delete AFTER DELETE ON Space
+BEGIN
+    DELETE FROM MetadataTextIndex WHERE spaceId = OLD.id;
+END;
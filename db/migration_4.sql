@@ -0,0 +1,32 @@
+-- Keyset pagination over (versionId, unique_id) and per-version live vector counts
+CREATE INDEX IF NOT EXISTS idx_vector_version_unique_id ON Vector(versionId, unique_id);
+
+CREATE TABLE IF NOT EXISTS VectorCount (
+    versionId INTEGER PRIMARY KEY,
+    liveCount INTEGER NOT NULL DEFAULT 0
+);
+
+INSERT OR REPLACE INTO VectorCount (versionId, liveCount)
+SELECT versionId, COUNT(*) FROM Vector WHERE deleted = 0 GROUP BY versionId;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_count_insert AFTER INSERT ON Vector
+WHEN NEW.deleted = 0
+BEGIN
+    INSERT INTO VectorCount (versionId, liveCount) VALUES (NEW.versionId, 1)
+    ON CONFLICT(versionId) DO UPDATE SET liveCount = liveCount + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_count_delete AFTER DELETE ON Vector
+WHEN OLD.deleted = 0
+BEGIN
+    UPDATE VectorCount SET liveCount = liveCount - 1 WHERE versionId = OLD.versionId;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_count_update AFTER UPDATE OF versionId, deleted ON Vector
+BEGIN
+    UPDATE VectorCount SET liveCount = liveCount - 1
+    WHERE OLD.deleted = 0 AND versionId = OLD.versionId;
+    INSERT INTO VectorCount (versionId, liveCount)
+    SELECT NEW.versionId, 1 WHERE NEW.deleted = 0
+    ON CONFLICT(versionId) DO UPDATE SET liveCount = liveCount + 1;
+END;
@@ -0,0 +1,5 @@
+-- Persisted high-water mark for vector unique_id allocation per version
+CREATE TABLE IF NOT EXISTS VectorSequence (
+    versionId INTEGER PRIMARY KEY,
+    nextUniqueId INTEGER NOT NULL
+);
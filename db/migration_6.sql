@@ -0,0 +1,8 @@
+-- Covering indexes for the hot lookup paths
+DROP INDEX IF EXISTS idx_vector_version_unique_id;
+CREATE INDEX IF NOT EXISTS idx_vector_version_unique_id_deleted ON Vector(versionId, unique_id, deleted);
+
+CREATE INDEX IF NOT EXISTS idx_vectorvalue_vector_id ON VectorValue(vectorId);
+CREATE INDEX IF NOT EXISTS idx_vectorvalue_vectorindex_id_vector_id ON VectorValue(vectorIndexId, vectorId);
+
+CREATE INDEX IF NOT EXISTS idx_bm25_vector_id ON BM25(vectorId);
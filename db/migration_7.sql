@@ -0,0 +1,15 @@
+-- Record index of each dense vector in the memory-mapped segment store (ATV_VECTOR_SEGMENT_STORE)
+CREATE TABLE IF NOT EXISTS VectorSegmentEntry (
+    vectorIndexId INTEGER NOT NULL,
+    vectorId INTEGER NOT NULL,
+    unique_id INTEGER NOT NULL,
+    recordIndex INTEGER NOT NULL,
+    PRIMARY KEY (vectorIndexId, vectorId)
+) WITHOUT ROWID;
+
+CREATE INDEX IF NOT EXISTS idx_vectorsegmententry_index_unique_id ON VectorSegmentEntry(vectorIndexId, unique_id);
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_segment_entry_delete AFTER DELETE ON VectorValue
+BEGIN
+    DELETE FROM VectorSegmentEntry WHERE vectorIndexId = OLD.vectorIndexId AND vectorId = OLD.vectorId;
+END;
@@ -0,0 +1,13 @@
+-- Typed metadata values: valueType records the JSON type of value, numericValue holds
+-- numbers and booleans so range filters compare numerically and can use an index
+ALTER TABLE VectorMetadata ADD COLUMN valueType INTEGER NOT NULL DEFAULT 0;
+ALTER TABLE VectorMetadata ADD COLUMN numericValue REAL;
+
+-- Existing values were stored as strings; those that read as a number get their numeric view
+UPDATE VectorMetadata SET numericValue = CAST(value AS REAL)
+WHERE value IS NOT NULL
+  AND value = trim(value, ' ' || char(9, 10, 13))
+  AND CASE WHEN json_valid(value) THEN json_type(value) IN ('integer', 'real') ELSE 0 END;
+
+CREATE INDEX IF NOT EXISTS idx_vectormetadata_versionId_key_numeric ON VectorMetadata(versionId, key, numericValue);
+CREATE INDEX IF NOT EXISTS idx_vectormetadata_vectorId_key_numeric ON VectorMetadata(vectorId, key, numericValue);
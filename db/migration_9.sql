@@ -0,0 +1,36 @@
+-- Indexed JSON paths: each space may name paths into its array and object metadata,
+-- e.g. attrs["brand"] or tags[], whose values are kept as typed rows so filters on
+-- them use an index instead of reading the JSON of every row
+CREATE TABLE IF NOT EXISTS MetadataIndexedPath (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    spaceId INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    UNIQUE(spaceId, path)
+);
+
+CREATE TABLE IF NOT EXISTS VectorMetadataPath (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    metadataId INTEGER NOT NULL,
+    vectorId INTEGER NOT NULL,
+    versionId INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    value TEXT,
+    valueType INTEGER NOT NULL DEFAULT 0,
+    numericValue REAL
+);
+
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_versionId_path_value ON VectorMetadataPath(versionId, path, value);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_vectorId_path_value ON VectorMetadataPath(vectorId, path, value);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_versionId_path_numeric ON VectorMetadataPath(versionId, path, numericValue);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_vectorId_path_numeric ON VectorMetadataPath(vectorId, path, numericValue);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_metadataId ON VectorMetadataPath(metadataId);
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_metadata_path_delete AFTER DELETE ON VectorMetadata
+BEGIN
+    DELETE FROM VectorMetadataPath WHERE metadataId = OLD.id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_metadata_indexed_path_delete AFTER DELETE ON Space
+BEGIN
+    DELETE FROM MetadataIndexedPath WHERE spaceId = OLD.id;
+END;
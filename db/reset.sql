@@ -5,9 +5,16 @@ DROP TABLE IF EXISTS Snapshot;
 DROP TABLE IF EXISTS Space;
 DROP TABLE IF EXISTS Version;
 DROP TABLE IF EXISTS Vector;
+DROP TABLE IF EXISTS VectorCount;
+DROP TABLE IF EXISTS VectorSequence;
 DROP TABLE IF EXISTS VectorValue;
+DROP TABLE IF EXISTS VectorSegmentEntry;
 DROP TABLE IF EXISTS VectorIndex;
 DROP TABLE IF EXISTS VectorMetadata;
+DROP TABLE IF EXISTS VectorMetadataPath;
+DROP TABLE IF EXISTS MetadataIndexedPath;
+DROP TABLE IF EXISTS VectorMetadataText;
+DROP TABLE IF EXISTS MetadataTextIndex;
 DROP TABLE IF EXISTS info;
 
 -- Recreate all tables and indexes
@@ -26,6 +33,8 @@ CREATE TABLE IF NOT EXISTS BM25 (
     tokens TEXT NOT NULL
 );
 
+CREATE INDEX IF NOT EXISTS idx_bm25_vector_id ON BM25(vectorId);
+
 CREATE TABLE RbacToken (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
     token TEXT NOT NULL,
@@ -86,6 +95,39 @@ CREATE TABLE Vector (
 );
 
 CREATE INDEX IF NOT EXISTS idx_vector_unique_id ON Vector(unique_id);
+CREATE INDEX IF NOT EXISTS idx_vector_version_unique_id_deleted ON Vector(versionId, unique_id, deleted);
+
+CREATE TABLE VectorCount (
+    versionId INTEGER PRIMARY KEY,
+    liveCount INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TABLE VectorSequence (
+    versionId INTEGER PRIMARY KEY,
+    nextUniqueId INTEGER NOT NULL
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_count_insert AFTER INSERT ON Vector
+WHEN NEW.deleted = 0
+BEGIN
+    INSERT INTO VectorCount (versionId, liveCount) VALUES (NEW.versionId, 1)
+    ON CONFLICT(versionId) DO UPDATE SET liveCount = liveCount + 1;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_count_delete AFTER DELETE ON Vector
+WHEN OLD.deleted = 0
+BEGIN
+    UPDATE VectorCount SET liveCount = liveCount - 1 WHERE versionId = OLD.versionId;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_count_update AFTER UPDATE OF versionId, deleted ON Vector
+BEGIN
+    UPDATE VectorCount SET liveCount = liveCount - 1
+    WHERE OLD.deleted = 0 AND versionId = OLD.versionId;
+    INSERT INTO VectorCount (versionId, liveCount)
+    SELECT NEW.versionId, 1 WHERE NEW.deleted = 0
+    ON CONFLICT(versionId) DO UPDATE SET liveCount = liveCount + 1;
+END;
 
 CREATE TABLE VectorValue (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -97,6 +139,24 @@ CREATE TABLE VectorValue (
     FOREIGN KEY(vectorIndexId) REFERENCES VectorIndex(id)
 );
 
+CREATE INDEX IF NOT EXISTS idx_vectorvalue_vector_id ON VectorValue(vectorId);
+CREATE INDEX IF NOT EXISTS idx_vectorvalue_vectorindex_id_vector_id ON VectorValue(vectorIndexId, vectorId);
+
+CREATE TABLE VectorSegmentEntry (
+    vectorIndexId INTEGER NOT NULL,
+    vectorId INTEGER NOT NULL,
+    unique_id INTEGER NOT NULL,
+    recordIndex INTEGER NOT NULL,
+    PRIMARY KEY (vectorIndexId, vectorId)
+) WITHOUT ROWID;
+
+CREATE INDEX IF NOT EXISTS idx_vectorsegmententry_index_unique_id ON VectorSegmentEntry(vectorIndexId, unique_id);
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_segment_entry_delete AFTER DELETE ON VectorValue
+BEGIN
+    DELETE FROM VectorSegmentEntry WHERE vectorIndexId = OLD.vectorIndexId AND vectorId = OLD.vectorId;
+END;
+
 CREATE TABLE VectorIndex (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
     versionId INTEGER NOT NULL,
@@ -119,8 +179,62 @@ CREATE TABLE VectorMetadata (
     vectorId INTEGER NOT NULL,
     key TEXT NOT NULL,
     value TEXT,
-    versionId INTEGER NOT NULL
+    versionId INTEGER NOT NULL,
+    valueType INTEGER NOT NULL DEFAULT 0,
+    numericValue REAL
 );
 
 CREATE INDEX IF NOT EXISTS idx_vectormetadata_versionId_key_value ON VectorMetadata(versionId, key, value);
 CREATE INDEX IF NOT EXISTS idx_vectormetadata_vectorId_key_value ON VectorMetadata(vectorId, key, value);
+CREATE INDEX IF NOT EXISTS idx_vectormetadata_versionId_key_numeric ON VectorMetadata(versionId, key, numericValue);
+CREATE INDEX IF NOT EXISTS idx_vectormetadata_vectorId_key_numeric ON VectorMetadata(vectorId, key, numericValue);
+
+CREATE TABLE MetadataIndexedPath (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    spaceId INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    UNIQUE(spaceId, path)
+);
+
+CREATE TABLE VectorMetadataPath (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    metadataId INTEGER NOT NULL,
+    vectorId INTEGER NOT NULL,
+    versionId INTEGER NOT NULL,
+    path TEXT NOT NULL,
+    value TEXT,
+    valueType INTEGER NOT NULL DEFAULT 0,
+    numericValue REAL
+);
+
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_versionId_path_value ON VectorMetadataPath(versionId, path, value);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_vectorId_path_value ON VectorMetadataPath(vectorId, path, value);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_versionId_path_numeric ON VectorMetadataPath(versionId, path, numericValue);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_vectorId_path_numeric ON VectorMetadataPath(vectorId, path, numericValue);
+CREATE INDEX IF NOT EXISTS idx_vectormetadatapath_metadataId ON VectorMetadataPath(metadataId);
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_metadata_path_delete AFTER DELETE ON VectorMetadata
+BEGIN
+    DELETE FROM VectorMetadataPath WHERE metadataId = OLD.id;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_metadata_indexed_path_delete AFTER DELETE ON Space
+BEGIN
+    DELETE FROM MetadataIndexedPath WHERE spaceId = OLD.id;
+END;
+
+CREATE TABLE MetadataTextIndex (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    spaceId INTEGER NOT NULL,
+    key TEXT NOT NULL,
+    UNIQUE(spaceId, key)
+);
+
+-- The FTS5 table VectorMetadataText and the triggers that fill it are created
+-- when a space first names text keys (VectorMetadataManager::setTextIndexedKeys),
+-- so databases that never use them don't need FTS5
+
+CREATE TRIGGER IF NOT EXISTS trg_metadata_text_index_delete AFTER DELETE ON Space
+BEGIN
+    DELETE FROM MetadataTextIndex WHERE spaceId = OLD.id;
+END;
@@ -25,6 +25,7 @@ public:
     void addDocument(long vectorId, const std::string& doc, const std::vector<std::string>& tokens);
     std::vector<std::pair<long, double>> searchWithVectorIds(const std::vector<long>& vectorIds, const std::vector<std::string>& queryTokens);
     std::string getDocByVectorId(int vectorId);
+    std::unordered_map<long, std::string> getDocsByVectorIds(const std::vector<long>& vectorIds);
 };
 
 } // namespace atinyvectors
@@ -6,6 +6,9 @@
 #include <cstdlib>
 #include <memory>
 #include <filesystem>
+#include <cctype>
+#include <initializer_list>
+#include <stdexcept>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -65,6 +68,82 @@ public:
         return jwtTokenKey_;
     }
 
+    std::string getSqliteJournalMode() const {
+        return sqliteJournalMode_;
+    }
+
+    std::string getSqliteSynchronous() const {
+        return sqliteSynchronous_;
+    }
+
+    int getSqliteCacheSize() const {
+        return sqliteCacheSize_;
+    }
+
+    long long getSqliteMmapSize() const {
+        return sqliteMmapSize_;
+    }
+
+    std::string getSqliteTempStore() const {
+        return sqliteTempStore_;
+    }
+
+    int getSqlitePageSize() const {
+        return sqlitePageSize_;
+    }
+
+    int getSqliteWalAutocheckpoint() const {
+        return sqliteWalAutocheckpoint_;
+    }
+
+    int getSqliteBusyTimeoutMs() const {
+        return sqliteBusyTimeoutMs_;
+    }
+
+    int getSqliteReadPoolSize() const {
+        return sqliteReadPoolSize_;
+    }
+
+    int getSqliteStatementCacheSize() const {
+        return sqliteStatementCacheSize_;
+    }
+
+    bool isVectorSegmentStoreEnabled() const {
+        return vectorSegmentStoreEnabled_;
+    }
+
+    int getVectorSegmentRecords() const {
+        return vectorSegmentRecords_;
+    }
+
+    int getAsyncThreads() const {
+        return asyncThreads_;
+    }
+
+    int getAsyncQueueSize() const {
+        return asyncQueueSize_;
+    }
+
+    int getFilterCacheSize() const {
+        return filterCacheSize_;
+    }
+
+    bool isMetadataBitmapIndexEnabled() const {
+        return metadataBitmapIndexEnabled_;
+    }
+
+    int getFilterExactScanMax() const {
+        return filterExactScanMax_;
+    }
+
+    double getFilterPostFilterSelectivity() const {
+        return filterPostFilterSelectivity_;
+    }
+
+    int getFilterOverFetchMax() const {
+        return filterOverFetchMax_;
+    }
+
     std::string getDefaultDenseIndexName() const {
         return DEFAULT_DENSE_INDEX_NAME;
     }
@@ -111,6 +190,34 @@ private:
     const int DEFAULT_TOKEN_EXPIRE_DAYS = 30;
     const std::string DEFAULT_JWT_TOKEN_KEY = "atinyvectors_jwt_token_key_is_really_good_and_i_hope_so_much_whatever_you_want";
 
+    // SQLite storage profile
+    const std::string DEFAULT_SQLITE_JOURNAL_MODE = "WAL";
+    const std::string DEFAULT_SQLITE_SYNCHRONOUS = "NORMAL";
+    const int DEFAULT_SQLITE_CACHE_SIZE = -65536;          // negative means KiB, i.e. 64MB
+    const long long DEFAULT_SQLITE_MMAP_SIZE = 268435456;  // 256MB
+    const std::string DEFAULT_SQLITE_TEMP_STORE = "MEMORY";
+    const int DEFAULT_SQLITE_PAGE_SIZE = 4096;
+    const int DEFAULT_SQLITE_WAL_AUTOCHECKPOINT = 1000;    // pages
+    const int DEFAULT_SQLITE_BUSY_TIMEOUT_MS = 5000;
+    const int DEFAULT_SQLITE_READ_POOL_SIZE = 8;           // read-only connections, one per thread
+    const int DEFAULT_SQLITE_STATEMENT_CACHE_SIZE = 128;   // prepared statements kept per connection
+
+    // Memory-mapped dense vector segments
+    const bool DEFAULT_VECTOR_SEGMENT_STORE = false;
+    const int DEFAULT_VECTOR_SEGMENT_RECORDS = 65536;      // records per segment file
+
+    // Executor behind the async C API
+    const int DEFAULT_ASYNC_THREADS = 4;
+    const int DEFAULT_ASYNC_QUEUE_SIZE = 1024;             // queued requests before submissions are refused
+
+    const int DEFAULT_FILTER_CACHE_SIZE = 512;             // compiled filter shapes kept by FilterManager
+    const bool DEFAULT_METADATA_BITMAP_INDEX = true;
+
+    // Filtered search plans
+    const int DEFAULT_FILTER_EXACT_SCAN_MAX = 2048;            // matching vectors scanned exactly
+    const double DEFAULT_FILTER_POSTFILTER_SELECTIVITY = 0.25; // matching share from which ANN is post-filtered
+    const int DEFAULT_FILTER_OVERFETCH_MAX = 8192;             // candidates a post-filtered search may fetch
+
     const std::string DEFAULT_DENSE_INDEX_NAME = "dense";
     const std::string DEFAULT_SPARSE_INDEX_NAME = "sparse";
 
@@ -124,6 +231,49 @@ private:
     std::string dataPath_;        // Data path
     int defaultTokenExpireDays_;  // Default token expire days
     std::string jwtTokenKey_;     // JWT token key
+    std::string sqliteJournalMode_;  // PRAGMA journal_mode
+    std::string sqliteSynchronous_;  // PRAGMA synchronous
+    int sqliteCacheSize_;            // PRAGMA cache_size
+    long long sqliteMmapSize_;       // PRAGMA mmap_size
+    std::string sqliteTempStore_;    // PRAGMA temp_store
+    int sqlitePageSize_;             // PRAGMA page_size (only effective on new databases)
+    int sqliteWalAutocheckpoint_;    // PRAGMA wal_autocheckpoint
+    int sqliteBusyTimeoutMs_;        // busy handler timeout in milliseconds
+    int sqliteReadPoolSize_;         // Maximum number of per-thread read connections (0 disables)
+    int sqliteStatementCacheSize_;   // Prepared statements cached per connection (0 disables)
+    bool vectorSegmentStoreEnabled_; // Mirror dense vectors into mmapped segment files
+    int vectorSegmentRecords_;       // Records per segment file
+    int asyncThreads_;               // Worker threads of the async executor
+    int asyncQueueSize_;             // Pending async requests before backpressure
+    int filterCacheSize_;            // Compiled filter shapes kept in the LRU (0 disables)
+    bool metadataBitmapIndexEnabled_; // Evaluate filters on in-memory metadata bitmaps
+    int filterExactScanMax_;          // Largest filtered set searched by exact distances
+    double filterPostFilterSelectivity_; // Selectivity from which unfiltered ANN is post-filtered
+    int filterOverFetchMax_;          // Candidate budget of the post-filter retries
+
+    static std::string toUpper(std::string value) {
+        for (auto& c : value) {
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+        return value;
+    }
+
+    // Pragma values are interpolated into SQL, so only accept the documented keywords.
+    static std::string pickPragmaValue(const char* envValue, const char* envName,
+                                       std::initializer_list<const char*> allowed,
+                                       const std::string& defaultValue) {
+        if (!envValue) {
+            return defaultValue;
+        }
+        std::string value = toUpper(envValue);
+        for (const char* candidate : allowed) {
+            if (value == candidate) {
+                return value;
+            }
+        }
+        spdlog::warn("Invalid value for {}. Using default value: {}", envName, defaultValue);
+        return defaultValue;
+    }
 
     Config() {
         const char* envCacheCapacity = std::getenv("ATV_HNSW_INDEX_CACHE_CAPACITY");
@@ -136,6 +286,25 @@ private:
         const char* envDataPath = std::getenv("ATV_DATA_PATH");
         const char* envTokenExpireDays = std::getenv("ATV_DEFAULT_TOKEN_EXPIRE_DAYS");
         const char* envJwtTokenKey = std::getenv("ATV_JWT_TOKEN_KEY");
+        const char* envSqliteJournalMode = std::getenv("ATV_SQLITE_JOURNAL_MODE");
+        const char* envSqliteSynchronous = std::getenv("ATV_SQLITE_SYNCHRONOUS");
+        const char* envSqliteCacheSize = std::getenv("ATV_SQLITE_CACHE_SIZE");
+        const char* envSqliteMmapSize = std::getenv("ATV_SQLITE_MMAP_SIZE");
+        const char* envSqliteTempStore = std::getenv("ATV_SQLITE_TEMP_STORE");
+        const char* envSqlitePageSize = std::getenv("ATV_SQLITE_PAGE_SIZE");
+        const char* envSqliteWalAutocheckpoint = std::getenv("ATV_SQLITE_WAL_AUTOCHECKPOINT");
+        const char* envSqliteBusyTimeout = std::getenv("ATV_SQLITE_BUSY_TIMEOUT_MS");
+        const char* envSqliteReadPoolSize = std::getenv("ATV_SQLITE_READ_POOL_SIZE");
+        const char* envSqliteStatementCacheSize = std::getenv("ATV_SQLITE_STATEMENT_CACHE_SIZE");
+        const char* envVectorSegmentStore = std::getenv("ATV_VECTOR_SEGMENT_STORE");
+        const char* envVectorSegmentRecords = std::getenv("ATV_VECTOR_SEGMENT_RECORDS");
+        const char* envAsyncThreads = std::getenv("ATV_ASYNC_THREADS");
+        const char* envAsyncQueueSize = std::getenv("ATV_ASYNC_QUEUE_SIZE");
+        const char* envFilterCacheSize = std::getenv("ATV_FILTER_CACHE_SIZE");
+        const char* envMetadataBitmapIndex = std::getenv("ATV_METADATA_BITMAP_INDEX");
+        const char* envFilterExactScanMax = std::getenv("ATV_FILTER_EXACT_SCAN_MAX");
+        const char* envFilterPostFilterSelectivity = std::getenv("ATV_FILTER_POSTFILTER_SELECTIVITY");
+        const char* envFilterOverFetchMax = std::getenv("ATV_FILTER_OVERFETCH_MAX");
 
         // Use default if environment variable is invalid
         try {
@@ -175,6 +344,164 @@ private:
 
         jwtTokenKey_ = (envJwtTokenKey) ? envJwtTokenKey : DEFAULT_JWT_TOKEN_KEY;
 
+        sqliteJournalMode_ = pickPragmaValue(envSqliteJournalMode, "ATV_SQLITE_JOURNAL_MODE",
+            {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"}, DEFAULT_SQLITE_JOURNAL_MODE);
+        sqliteSynchronous_ = pickPragmaValue(envSqliteSynchronous, "ATV_SQLITE_SYNCHRONOUS",
+            {"OFF", "NORMAL", "FULL", "EXTRA"}, DEFAULT_SQLITE_SYNCHRONOUS);
+        sqliteTempStore_ = pickPragmaValue(envSqliteTempStore, "ATV_SQLITE_TEMP_STORE",
+            {"DEFAULT", "FILE", "MEMORY"}, DEFAULT_SQLITE_TEMP_STORE);
+
+        try {
+            sqliteCacheSize_ = (envSqliteCacheSize) ? std::stoi(envSqliteCacheSize) : DEFAULT_SQLITE_CACHE_SIZE;
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_CACHE_SIZE. Using default value: {}", DEFAULT_SQLITE_CACHE_SIZE);
+            sqliteCacheSize_ = DEFAULT_SQLITE_CACHE_SIZE;
+        }
+
+        try {
+            sqliteMmapSize_ = (envSqliteMmapSize) ? std::stoll(envSqliteMmapSize) : DEFAULT_SQLITE_MMAP_SIZE;
+            if (sqliteMmapSize_ < 0) {
+                throw std::invalid_argument("negative mmap size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_MMAP_SIZE. Using default value: {}", DEFAULT_SQLITE_MMAP_SIZE);
+            sqliteMmapSize_ = DEFAULT_SQLITE_MMAP_SIZE;
+        }
+
+        try {
+            sqlitePageSize_ = (envSqlitePageSize) ? std::stoi(envSqlitePageSize) : DEFAULT_SQLITE_PAGE_SIZE;
+            // SQLite only accepts powers of two between 512 and 65536
+            if (sqlitePageSize_ < 512 || sqlitePageSize_ > 65536 || (sqlitePageSize_ & (sqlitePageSize_ - 1)) != 0) {
+                throw std::invalid_argument("invalid page size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_PAGE_SIZE. Using default value: {}", DEFAULT_SQLITE_PAGE_SIZE);
+            sqlitePageSize_ = DEFAULT_SQLITE_PAGE_SIZE;
+        }
+
+        try {
+            sqliteWalAutocheckpoint_ = (envSqliteWalAutocheckpoint) ? std::stoi(envSqliteWalAutocheckpoint) : DEFAULT_SQLITE_WAL_AUTOCHECKPOINT;
+            // 0 turns automatic checkpoints off
+            if (sqliteWalAutocheckpoint_ < 0) {
+                throw std::invalid_argument("negative wal autocheckpoint");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_WAL_AUTOCHECKPOINT. Using default value: {}", DEFAULT_SQLITE_WAL_AUTOCHECKPOINT);
+            sqliteWalAutocheckpoint_ = DEFAULT_SQLITE_WAL_AUTOCHECKPOINT;
+        }
+
+        try {
+            sqliteBusyTimeoutMs_ = (envSqliteBusyTimeout) ? std::stoi(envSqliteBusyTimeout) : DEFAULT_SQLITE_BUSY_TIMEOUT_MS;
+            if (sqliteBusyTimeoutMs_ < 0) {
+                throw std::invalid_argument("negative busy timeout");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_BUSY_TIMEOUT_MS. Using default value: {}", DEFAULT_SQLITE_BUSY_TIMEOUT_MS);
+            sqliteBusyTimeoutMs_ = DEFAULT_SQLITE_BUSY_TIMEOUT_MS;
+        }
+
+        try {
+            sqliteReadPoolSize_ = (envSqliteReadPoolSize) ? std::stoi(envSqliteReadPoolSize) : DEFAULT_SQLITE_READ_POOL_SIZE;
+            if (sqliteReadPoolSize_ < 0) {
+                throw std::invalid_argument("negative read pool size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_READ_POOL_SIZE. Using default value: {}", DEFAULT_SQLITE_READ_POOL_SIZE);
+            sqliteReadPoolSize_ = DEFAULT_SQLITE_READ_POOL_SIZE;
+        }
+
+        try {
+            sqliteStatementCacheSize_ = (envSqliteStatementCacheSize) ? std::stoi(envSqliteStatementCacheSize) : DEFAULT_SQLITE_STATEMENT_CACHE_SIZE;
+            if (sqliteStatementCacheSize_ < 0) {
+                throw std::invalid_argument("negative statement cache size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_SQLITE_STATEMENT_CACHE_SIZE. Using default value: {}", DEFAULT_SQLITE_STATEMENT_CACHE_SIZE);
+            sqliteStatementCacheSize_ = DEFAULT_SQLITE_STATEMENT_CACHE_SIZE;
+        }
+
+        vectorSegmentStoreEnabled_ = DEFAULT_VECTOR_SEGMENT_STORE;
+        if (envVectorSegmentStore) {
+            std::string value = toUpper(envVectorSegmentStore);
+            vectorSegmentStoreEnabled_ = (value == "1" || value == "TRUE" || value == "ON");
+        }
+
+        try {
+            vectorSegmentRecords_ = (envVectorSegmentRecords) ? std::stoi(envVectorSegmentRecords) : DEFAULT_VECTOR_SEGMENT_RECORDS;
+            if (vectorSegmentRecords_ <= 0) {
+                throw std::invalid_argument("non-positive segment size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_VECTOR_SEGMENT_RECORDS. Using default value: {}", DEFAULT_VECTOR_SEGMENT_RECORDS);
+            vectorSegmentRecords_ = DEFAULT_VECTOR_SEGMENT_RECORDS;
+        }
+
+        try {
+            asyncThreads_ = (envAsyncThreads) ? std::stoi(envAsyncThreads) : DEFAULT_ASYNC_THREADS;
+            if (asyncThreads_ <= 0) {
+                throw std::invalid_argument("non-positive thread count");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_ASYNC_THREADS. Using default value: {}", DEFAULT_ASYNC_THREADS);
+            asyncThreads_ = DEFAULT_ASYNC_THREADS;
+        }
+
+        try {
+            asyncQueueSize_ = (envAsyncQueueSize) ? std::stoi(envAsyncQueueSize) : DEFAULT_ASYNC_QUEUE_SIZE;
+            if (asyncQueueSize_ <= 0) {
+                throw std::invalid_argument("non-positive queue size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_ASYNC_QUEUE_SIZE. Using default value: {}", DEFAULT_ASYNC_QUEUE_SIZE);
+            asyncQueueSize_ = DEFAULT_ASYNC_QUEUE_SIZE;
+        }
+
+        try {
+            filterCacheSize_ = (envFilterCacheSize) ? std::stoi(envFilterCacheSize) : DEFAULT_FILTER_CACHE_SIZE;
+            if (filterCacheSize_ < 0) {
+                throw std::invalid_argument("negative filter cache size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_FILTER_CACHE_SIZE. Using default value: {}", DEFAULT_FILTER_CACHE_SIZE);
+            filterCacheSize_ = DEFAULT_FILTER_CACHE_SIZE;
+        }
+
+        metadataBitmapIndexEnabled_ = DEFAULT_METADATA_BITMAP_INDEX;
+        if (envMetadataBitmapIndex) {
+            std::string value = toUpper(envMetadataBitmapIndex);
+            metadataBitmapIndexEnabled_ = (value == "1" || value == "TRUE" || value == "ON");
+        }
+
+        try {
+            filterExactScanMax_ = (envFilterExactScanMax) ? std::stoi(envFilterExactScanMax) : DEFAULT_FILTER_EXACT_SCAN_MAX;
+            if (filterExactScanMax_ < 0) {
+                throw std::invalid_argument("negative exact scan size");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_FILTER_EXACT_SCAN_MAX. Using default value: {}", DEFAULT_FILTER_EXACT_SCAN_MAX);
+            filterExactScanMax_ = DEFAULT_FILTER_EXACT_SCAN_MAX;
+        }
+
+        try {
+            filterPostFilterSelectivity_ = (envFilterPostFilterSelectivity) ? std::stod(envFilterPostFilterSelectivity) : DEFAULT_FILTER_POSTFILTER_SELECTIVITY;
+            if (!(filterPostFilterSelectivity_ > 0.0 && filterPostFilterSelectivity_ <= 1.0)) {
+                throw std::invalid_argument("selectivity out of (0, 1]");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_FILTER_POSTFILTER_SELECTIVITY. Using default value: {}", DEFAULT_FILTER_POSTFILTER_SELECTIVITY);
+            filterPostFilterSelectivity_ = DEFAULT_FILTER_POSTFILTER_SELECTIVITY;
+        }
+
+        try {
+            filterOverFetchMax_ = (envFilterOverFetchMax) ? std::stoi(envFilterOverFetchMax) : DEFAULT_FILTER_OVERFETCH_MAX;
+            if (filterOverFetchMax_ <= 0) {
+                throw std::invalid_argument("non-positive over-fetch budget");
+            }
+        } catch (...) {
+            spdlog::warn("Invalid value for ATV_FILTER_OVERFETCH_MAX. Using default value: {}", DEFAULT_FILTER_OVERFETCH_MAX);
+            filterOverFetchMax_ = DEFAULT_FILTER_OVERFETCH_MAX;
+        }
+
         dbName_ = (envDbName) ? envDbName : DEFAULT_DB_NAME;
         logFile_ = (envLogFile) ? envLogFile : DEFAULT_LOG_FILE;
         logLevel_ = (envLogLevel) ? envLogLevel : DEFAULT_LOG_LEVEL;
@@ -193,6 +520,9 @@ private:
             spdlog::error("Error creating data directory {}: {}", dataPath_, e.what());
         }
 
+        spdlog::debug("Config SQLite profile - journal_mode: {}, synchronous: {}, cache_size: {}, mmap_size: {}, temp_store: {}, page_size: {}, wal_autocheckpoint: {}, busy_timeout_ms: {}, read_pool_size: {}, statement_cache_size: {}",
+                     sqliteJournalMode_, sqliteSynchronous_, sqliteCacheSize_, sqliteMmapSize_, sqliteTempStore_, sqlitePageSize_, sqliteWalAutocheckpoint_, sqliteBusyTimeoutMs_, sqliteReadPoolSize_, sqliteStatementCacheSize_);
+
         spdlog::debug("Config initialized - HNSW Cache Capacity: {}, M: {}, EF_CONSTRUCTION: {}, HNSW Max Data Size: {}, Default DB Name: {}, Log File: {}, Log Level: {}, Data Path: {}, Default Token Expire Days: {}, JWT Token Key: {}",
                      hnswIndexCacheCapacity_, m_, efConstruction_, hnswMaxDataSize_, dbName_, logFile_, logLevel_, dataPath_, defaultTokenExpireDays_, jwtTokenKey_);
 
@@ -2,10 +2,16 @@
 #define __ATINYVECTORS_DATABASE_MANAGER_HPP__
 
 #include <SQLiteCpp/SQLiteCpp.h>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include "Config.hpp"
+#include "StatementCache.hpp"
 
 namespace atinyvectors {
 
@@ -14,11 +20,39 @@ private:
     static std::unique_ptr<DatabaseManager> instance;
     static std::mutex instanceMutex;
     
+    struct ReadConnection {
+        std::unique_ptr<SQLite::Database> db;
+        std::unique_ptr<StatementCache> statements;  // destroyed before db
+    };
+
     SQLite::Database db;
+    std::unique_ptr<StatementCache> statementCache;
     std::string migrationPath;
 
+    // Read-only connections keyed by the owning thread. Only used for file
+    // databases in WAL mode, where readers do not block the single writer.
+    std::mutex readPoolMutex;
+    std::unordered_map<std::thread::id, ReadConnection> readConnections;
+    bool readPoolEnabled = false;
+    size_t readPoolSize = 0;
+
+    // Thread that last began a transaction on the writer connection
+    std::atomic<std::thread::id> writeTransactionOwner{};
+
+    // Shared by every instance, so caches also notice a database opened after closeInstance()
+    static std::atomic<uint64_t> resetGeneration;
+
+    static std::mutex preCommitHooksMutex;
+    static std::vector<std::function<bool()>> preCommitHooks;
+
     DatabaseManager(const std::string& dbFileName, const std::string& migrationDir);
 
+    void applyPragmas();
+    void applyReadPragmas(SQLite::Database& readDb);
+    static void releaseReadDatabaseOnThreadExit();
+    static int traceWriterStatement(unsigned type, void* context, void* statement, void* sql);
+    static int runPreCommitHooks(void* context);
+    StatementCache* findStatementCache(SQLite::Database& database);
     bool checkInfoTable();
     void updateDatabaseVersion(int newVersion, const std::string& projectVersion);
 
@@ -30,12 +64,52 @@ public:
         const std::string& dbFileName = atinyvectors::Config::getInstance().getDbName(),
         const std::string& migrationDir = "db");
 
+    // Closes every connection; the next getInstance() opens the database again,
+    // possibly another one. Nothing may still use the previous instance.
+    static void closeInstance();
+
+    // Runs on the committing thread right before each commit of the writer
+    // connection, for state kept outside SQLite that must be durable first.
+    // Returning false (or throwing) turns the commit into a rollback.
+    static void addPreCommitHook(std::function<bool()> hook);
+
     SQLite::Database& getDatabase();
 
+    // Returns the calling thread's read-only connection. Falls back to the writer
+    // connection for in-memory databases, non-WAL journals, when the pool is full,
+    // and for the thread that has a write transaction open, so its reads see its rows.
+    SQLite::Database& getReadDatabase();
+
+    // True when the connection is inside a write transaction, i.e. reads through it
+    // may return rows that are rolled back later
+    bool readsUncommittedRows(SQLite::Database& database);
+    void releaseReadDatabase();
+    size_t getReadConnectionCount();
+    bool isReadPoolEnabled() const { return readPoolEnabled; }
+
+    // Hands out a cached prepared statement for static SQL on the given connection
+    // (the writer or the calling thread's read connection). Unknown connections get
+    // an uncached statement.
+    CachedStatement prepare(SQLite::Database& database, const std::string& sql);
+    StatementCache& getStatementCache() { return *statementCache; }
+
     void reset();
     void migrate();
+
+    // Bumped by every reset() so in-memory state derived from table contents
+    // (e.g. id sequences) can tell that it is stale.
+    uint64_t getResetGeneration() const { return resetGeneration.load(); }
+
+    // Bumps the reset generation after the contents were replaced some other way,
+    // such as a snapshot restore
+    void markReplaced() { ++resetGeneration; }
     int getDatabaseVersion();
 
+    // Runs a WAL checkpoint. TRUNCATE also resets the WAL file to zero bytes,
+    // which is what callers copying the database file want.
+    void checkpoint(bool truncate = false);
+    std::string getJournalMode();
+
     void setMigrationPath(const std::string& path) { migrationPath = path; }
     const std::string& getMigrationPath() const { return migrationPath; }
 };
@@ -6,6 +6,8 @@ enum class ATVErrorCode {
     JSON_PARSE_ERROR = 1001,
     SQLITE_ERROR = 1002,
     MEMORY_ALLOCATION_ERROR = 1003,
+    ASYNC_QUEUE_FULL = 1004,
+    ASYNC_CANCELLED = 1005,
     UNKNOWN_ERROR = 1099,
     // Add other error codes as needed
 };
@@ -7,6 +7,7 @@
 #include <memory>
 #include "RbacToken.hpp"
 #include "SparseDataPool.hpp"
+#include "ValueType.hpp"
 
 namespace atinyvectors {
 
@@ -36,6 +37,17 @@ public:
     RbacToken getRbacToken(const std::string& token);
 
     SparseDataPool& getSparseDataPool(int vectorIndexId);
+    StoragePrecision getStoragePrecision(int vectorIndexId);
+    void clearStoragePrecision(int vectorIndexId);
+
+    // Vector unique_id sequence per version. Ids come from an in-memory range whose
+    // upper bound is persisted in VectorSequence, so the database is only touched
+    // when a range runs out. Not cleared by clean(), since version changes call it
+    // and reseeding would skip the rest of the reserved range.
+    int allocateVectorUniqueIds(int versionId, int count = 1);  // returns the first id
+    void reserveVectorUniqueIds(int versionId, int count);      // pre-reserve for a batch
+    void observeVectorUniqueId(int versionId, int uniqueId);    // explicit id was inserted
+    void resetVectorUniqueIdSequences();
 
     void clean();
     void clearSpaceNameCache();
@@ -45,6 +57,8 @@ private:
     std::mutex spaceNameCacheMutex;
     std::mutex vectorIndexCacheMutex;
     std::mutex spaceIdCacheMutex;
+    std::mutex sparseDataPoolMutex;
+    std::mutex uniqueIdSequenceMutex;
 
     std::map<std::pair<std::string, int>, int> forwardCache;
     std::map<int, std::pair<std::string, int>> reverseCache;
@@ -61,6 +75,19 @@ private:
 
     std::map<int, std::shared_ptr<SparseDataPool>> sparseDataPoolByIndexIdCache;
 
+    std::map<int, StoragePrecision> storagePrecisionCache;
+
+    // [next, reservedUntil) is free to hand out without touching the database
+    struct UniqueIdSequence {
+        int next = 1;
+        int reservedUntil = 1;
+    };
+    std::map<int, UniqueIdSequence> uniqueIdSequences;
+    uint64_t uniqueIdSequenceGeneration = 0;
+
+    UniqueIdSequence& getUniqueIdSequence(int versionId);
+    void extendUniqueIdReservation(int versionId, UniqueIdSequence& sequence, int count);
+
     int fetchFromDb(const std::string& spaceName, int versionUniqueId);
     std::pair<std::string, int> fetchByVersionIdFromDb(int versionId);
     RbacToken fetchRbacTokenFromManager(const std::string& token);
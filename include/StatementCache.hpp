@@ -0,0 +1,88 @@
+#ifndef __ATINYVECTORS_STATEMENT_CACHE_HPP__
+#define __ATINYVECTORS_STATEMENT_CACHE_HPP__
+
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atinyvectors {
+
+class StatementCache;
+
+// Statement checked out of a StatementCache. It is reset, its bindings are cleared
+// and it is handed back to the cache when the handle goes out of scope.
+class CachedStatement {
+public:
+    CachedStatement(StatementCache* owner, const std::string& sql, std::unique_ptr<SQLite::Statement> statement);
+    CachedStatement(CachedStatement&& other) noexcept;
+    CachedStatement& operator=(CachedStatement&&) = delete;
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+    ~CachedStatement();
+
+    SQLite::Statement& operator*() { return *statement; }
+    SQLite::Statement* operator->() { return statement.get(); }
+
+private:
+    StatementCache* owner;
+    std::string sql;
+    std::unique_ptr<SQLite::Statement> statement;
+};
+
+// Per-connection cache of prepared statements keyed by SQL text. Only static SQL
+// should go through it; statements built from user input (IN lists, filters) would
+// just churn the cache. The cache must be destroyed before its connection.
+class StatementCache {
+public:
+    StatementCache(SQLite::Database& db, size_t capacity);
+    ~StatementCache();
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    CachedStatement acquire(const std::string& sql);
+
+    // Drops every idle statement. Statements that are checked out are kept by their
+    // handles and return to the cache when released.
+    void clear();
+
+    size_t size();
+    size_t getHits() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return hits;
+    }
+
+    size_t getMisses() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return misses;
+    }
+
+private:
+    friend class CachedStatement;
+
+    void release(const std::string& sql, std::unique_ptr<SQLite::Statement> statement);
+    void evictIfNeeded();
+
+    struct Entry {
+        std::vector<std::unique_ptr<SQLite::Statement>> idle;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    SQLite::Database& db;
+    size_t capacity;
+    size_t idleCount = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+
+    mutable std::mutex cacheMutex;
+    std::list<std::string> lruList;  // most recently used first
+    std::unordered_map<std::string, Entry> entries;
+};
+
+}
+
+#endif
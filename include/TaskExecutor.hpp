@@ -0,0 +1,76 @@
+#ifndef __ATINYVECTORS_TASK_EXECUTOR_HPP__
+#define __ATINYVECTORS_TASK_EXECUTOR_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace atinyvectors {
+
+// Fixed pool of worker threads behind a bounded FIFO queue. trySubmit() refuses a
+// task instead of blocking when the queue is full, so callers see backpressure
+// and can retry or shed load.
+class TaskExecutor {
+public:
+    using Task = std::function<void()>;
+
+    TaskExecutor(size_t threadCount, size_t queueCapacity);
+
+    // Cancels the tasks that are still queued, then joins the workers. Queued tasks
+    // may depend on objects that are already gone when this runs at exit.
+    ~TaskExecutor();
+
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    // Shared executor of the async C API, sized by ATV_ASYNC_THREADS and ATV_ASYNC_QUEUE_SIZE
+    static TaskExecutor& getInstance();
+
+    // Shuts the shared executor down, if it was started. The next getInstance()
+    // starts a new one.
+    static void shutdownInstance();
+
+    // False when the queue is full or the executor is shutting down. `cancel`, if
+    // set, runs instead of the task when the executor is destroyed first.
+    bool trySubmit(Task task, Task cancel = nullptr);
+
+    // Stops taking tasks, runs the ones already queued and joins the workers.
+    // Must not be called from a task.
+    void shutdown();
+
+    // Blocks until the queue is empty and no task is running
+    void waitIdle();
+
+    size_t pending() const;
+    size_t getThreadCount() const { return workers.size(); }
+    size_t getQueueCapacity() const { return queueCapacity; }
+
+private:
+    struct QueuedTask {
+        Task run;
+        Task cancel;
+    };
+
+    void workerLoop();
+
+    static std::unique_ptr<TaskExecutor> instance;
+    static std::mutex instanceMutex;
+
+    size_t queueCapacity;
+    std::deque<QueuedTask> queue;
+    size_t running = 0;
+    bool stopping = false;
+
+    mutable std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::condition_variable idleCondition;
+    std::vector<std::thread> workers;
+};
+
+} // namespace atinyvectors
+
+#endif
@@ -26,6 +26,28 @@ enum class QuantizationType {
     Product
 };
 
+// Precision of dense vectors stored in VectorValue blobs. Search always runs on fp32.
+enum class StoragePrecision {
+    Float32,
+    Float16,
+    BFloat16
+};
+
+inline std::string storagePrecisionToString(StoragePrecision precision) {
+    switch (precision) {
+        case StoragePrecision::Float16: return "fp16";
+        case StoragePrecision::BFloat16: return "bf16";
+        default: return "fp32";
+    }
+}
+
+inline StoragePrecision storagePrecisionFromString(const std::string& name) {
+    if (name == "fp32") return StoragePrecision::Float32;
+    if (name == "fp16") return StoragePrecision::Float16;
+    if (name == "bf16") return StoragePrecision::BFloat16;
+    throw std::invalid_argument("Unsupported storage precision: " + name);
+}
+
 class HnswConfig {
 public:
     int M;
@@ -83,13 +105,19 @@ public:
     ScalarConfig Scalar;
     ProductConfig Product;
     QuantizationType QuantizationType;
+    StoragePrecision Storage;
 
     QuantizationConfig(const ScalarConfig& scalar = ScalarConfig(), const ProductConfig& product = ProductConfig())
-        : Scalar(scalar), Product(product), QuantizationType(QuantizationType::NoQuantization) {}
+        : Scalar(scalar), Product(product), QuantizationType(QuantizationType::NoQuantization),
+          Storage(StoragePrecision::Float32) {}
 
     nlohmann::json toJson() const {
         nlohmann::json j;
 
+        if (Storage != StoragePrecision::Float32) {
+            j["storage"] = storagePrecisionToString(Storage);
+        }
+
         switch (QuantizationType) {
             case QuantizationType::NoQuantization:
                 return j;
@@ -114,6 +142,10 @@ public:
             return config;
         }
 
+        if (j.contains("storage")) {
+            config.Storage = storagePrecisionFromString(j.at("storage").get<std::string>());
+        }
+
         if (j.contains("scalar")) {
             config.Scalar = ScalarConfig::fromJson(j.at("scalar"));
             config.QuantizationType = QuantizationType::Scalar;
@@ -8,6 +8,7 @@
 #include <memory>
 #include <iostream>
 #include <cstdint>
+#include <functional>
 #include <mutex>
 
 namespace atinyvectors {
@@ -47,8 +48,44 @@ public:
         : id(id), vectorId(vectorId), vectorIndexId(vectorIndexId), 
         type(type), size(size), multiVectorData(multiVectorData), sparseData(nullptr) {}
 
-    std::vector<uint8_t> serialize() const;
+    // Dense and sparse values are written with the given precision; multi vectors are always fp32
+    std::vector<uint8_t> serialize(StoragePrecision precision = StoragePrecision::Float32) const;
     void deserialize(const std::vector<uint8_t>& blobData);
+
+    // Decodes straight from a blob, e.g. SQLite::Column::getBlob(), reusing the
+    // capacity of denseData and the pooled sparseData.
+    void deserialize(const uint8_t* data, size_t size);
+};
+
+// Non-owning view over a serialized VectorValue blob. Nothing is copied or
+// allocated; the view is valid only as long as the blob is (for a statement row,
+// until the next step).
+class VectorValueView {
+public:
+    VectorValueView(VectorValueType type, const void* data, size_t size);
+
+    VectorValueType getType() const { return type; }
+
+    // Dense
+    size_t denseSize() const;
+    StoragePrecision getPrecision() const { return precision; }
+    // Pointer into the blob, or nullptr when the blob is fp16/bf16 or not float aligned
+    const float* denseData() const;
+    // Widens fp16/bf16 blobs to fp32
+    void copyDenseTo(float* out) const;
+
+    // Sparse: pairs are decoded in one pass, there is no random access
+    int sparseSize() const { return sparseCount; }
+    // Writes each value into out[index]; indexes outside [0, dim) are skipped
+    void scatterSparseTo(float* out, int dim) const;
+    void copySparseTo(SparseData& out) const;
+
+private:
+    VectorValueType type;
+    const uint8_t* data;
+    size_t size;
+    StoragePrecision precision;
+    int sparseCount;
 };
 
 class Vector {
@@ -74,6 +111,9 @@ private:
 
     VectorManager();
 
+    // Ids are resolved once the write transaction is open
+    size_t deleteResolvedVectors(int versionId, const std::function<std::vector<int>()>& resolveVectorIds);
+
 public:
     VectorManager(const VectorManager&) = delete;
     VectorManager& operator=(const VectorManager&) = delete;
@@ -84,6 +124,9 @@ public:
     std::vector<Vector> getAllVectors();
     std::vector<Vector> getVectorsByVersionId(int versionId, int start, int limit);
 
+    // Keyset page: up to `limit` vectors with unique_id > afterUniqueId, ordered by unique_id
+    std::vector<Vector> getVectorsByVersionIdAfter(int versionId, int afterUniqueId, int limit);
+
     std::vector<Vector> getVectorsByVectorIds(const std::vector<int>& vectorIds);
 
     int countByVersionId(int versionId);
@@ -94,6 +137,15 @@ public:
     void updateVector(const Vector& vector);
     void deleteVector(unsigned long long id);
 
+    // Deletes the vectors of the version with their values, metadata and BM25
+    // documents in one transaction, and tombstones their unique ids in the loaded
+    // indexes of the version. Ids of other versions are skipped. Returns the
+    // number of vectors deleted.
+    size_t deleteVectors(int versionId, const std::vector<int>& vectorIds);
+
+    // Same for the vectors matching the filter, matched in the delete's transaction
+    size_t deleteVectorsByFilter(int versionId, const std::string& filter);
+
     void flush();
 };
 
@@ -1,14 +1,36 @@
 #ifndef __ATINYVECTORS_VECTOR_METADATA_HPP__
 #define __ATINYVECTORS_VECTOR_METADATA_HPP__
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <iostream>
+#include <map>
 #include <vector>
 #include <mutex>
 #include <memory>
+#include <optional>
+#include <unordered_map>
 
 namespace atinyvectors {
 
+namespace filter {
+class FilterPredicate;
+struct CompiledFilter;
+struct MetadataIndexes;
+}
+
+// JSON type of a metadata value, stored in VectorMetadata.valueType
+enum class MetadataValueType {
+    String = 0,
+    Integer = 1,
+    Float = 2,
+    Boolean = 3,
+    Array = 4,
+    Object = 5,
+    Null = 6
+};
+
 class VectorMetadata {
 public:
     long id;
@@ -16,13 +38,19 @@ public:
     long vectorId;
 
     std::string key;
-    std::string value;
+    std::string value;  // strings as is, other types as their JSON text
+    MetadataValueType valueType;
 
     VectorMetadata()
-        : id(0), versionId(0), vectorId(0), key(""), value("") {}
+        : id(0), versionId(0), vectorId(0), key(""), value(""), valueType(MetadataValueType::String) {}
 
-    VectorMetadata(long id, long versionId, long vectorId, const std::string& key, const std::string& value)
-        : id(id), versionId(versionId), vectorId(vectorId), key(key), value(value) {}
+    VectorMetadata(long id, long versionId, long vectorId, const std::string& key, const std::string& value,
+                   MetadataValueType valueType = MetadataValueType::String)
+        : id(id), versionId(versionId), vectorId(vectorId), key(key), value(value), valueType(valueType) {}
+
+    // Value of the numericValue column: numbers, booleans as 1/0, and strings that
+    // read as a JSON number. Filters compare numeric literals against it.
+    std::optional<double> numericValue() const;
 };
 
 struct VectorMetadataResult {
@@ -30,6 +58,15 @@ struct VectorMetadataResult {
     std::vector<int> vectorUniqueIds;
 };
 
+// Number of vectors holding one value of a metadata key
+struct MetadataFacet {
+    std::string value;
+    int count;
+};
+
+// Facets of each requested key, most frequent value first and ties by value
+using MetadataFacets = std::map<std::string, std::vector<MetadataFacet>>;
+
 class VectorMetadataManager {
 private:
     static std::unique_ptr<VectorMetadataManager> instance;
@@ -37,6 +74,24 @@ private:
 
     VectorMetadataManager();
 
+    // Indexed paths and text keys of the space of each version, dropped when
+    // they change or the database is reset
+    std::unordered_map<long, std::shared_ptr<const filter::MetadataIndexes>> versionIndexes;
+    uint64_t indexesGeneration = 0;
+    std::mutex indexesMutex;
+
+    std::shared_ptr<const filter::MetadataIndexes> getVersionIndexes(long versionId);
+
+    // Ids are resolved once the write transaction is open
+    size_t replaceResolvedVectorMetadata(long versionId, const std::function<std::vector<int>()>& resolveVectorIds,
+                                         const std::vector<VectorMetadata>& values);
+
+    // Looks the unique ids up in the version, or in every version when it is negative
+    std::vector<std::pair<float, int>> filterVectorsSQL(
+        long versionId,
+        const std::vector<std::pair<float, int>>& inputVectors,
+        const filter::CompiledFilter& compiledFilter);
+
 public:
     VectorMetadataManager(const VectorMetadataManager&) = delete;
     VectorMetadataManager& operator=(const VectorMetadataManager&) = delete;
@@ -47,17 +102,68 @@ public:
     std::vector<VectorMetadata> getAllVectorMetadata();
     VectorMetadata getVectorMetadataById(long id);
     std::vector<VectorMetadata> getVectorMetadataByVectorId(long vectorId);
+    std::unordered_map<long, std::vector<VectorMetadata>> getVectorMetadataByVectorIds(const std::vector<long>& vectorIds);
     void updateVectorMetadata(const VectorMetadata& metadata);
     void deleteVectorMetadata(long id);
     void deleteVectorMetadataByVectorId(long vectorId);
 
+    // Gives every listed vector, all of the version, the rows of `values`, replacing its
+    // rows of the same keys, in one transaction; vectorId and versionId of `values`
+    // are ignored
+    void replaceVectorMetadata(long versionId, const std::vector<int>& vectorIds, const std::vector<VectorMetadata>& values);
+
+    // Same for the vectors matching the filter, matched in the replace's transaction;
+    // returns how many there were
+    size_t replaceVectorMetadataByFilter(long versionId, const std::string& filter, const std::vector<VectorMetadata>& values);
+
+    std::vector<std::pair<float, int>> filterVectors(
+        const std::vector<std::pair<float, int>>& inputVectors,
+        const std::string& filter);
+
+    // Same, answered by the metadata bitmap index of the version when it supports the filter
     std::vector<std::pair<float, int>> filterVectors(
+        long versionId,
         const std::vector<std::pair<float, int>>& inputVectors,
         const std::string& filter);
 
+    // Checks each candidate against `predicate`, compiled from `filter`, over the
+    // in-memory metadata of the version; SQL answers when it is null
+    std::vector<std::pair<float, int>> filterCandidates(
+        long versionId,
+        const std::vector<std::pair<float, int>>& inputVectors,
+        const std::string& filter,
+        const filter::FilterPredicate* predicate);
+
+    // JSON paths into the array and object metadata of a space, e.g. attrs["brand"]
+    // or tags[], whose values are kept as typed VectorMetadataPath rows so filters
+    // on them are index lookups. Setting them rebuilds the rows of every version
+    // of the space; malformed paths throw std::invalid_argument.
+    void setIndexedPaths(int spaceId, const std::vector<std::string>& paths);
+    std::vector<std::string> getIndexedPaths(int spaceId);
+
+    // Keys of a space whose values are indexed by trigram (VectorMetadataText), so
+    // LIKE filters with a substring pattern look matches up instead of testing
+    // every row of the key. Setting them reindexes the stored values of the keys.
+    void setTextIndexedKeys(int spaceId, const std::vector<std::string>& keys);
+    std::vector<std::string> getTextIndexedKeys(int spaceId);
+
     VectorMetadataResult queryVectors(
         long versionId, const std::string& filter, int start, int limit);
 
+    // Vector ids matching the filter with unique_id > afterUniqueId, in unique_id order
+    std::vector<int> queryVectorIdsAfter(
+        long versionId, const std::string& filter, int afterUniqueId, int limit);
+
+    // Value counts of the keys over the vectors matching the filter (every vector
+    // when it is empty), at most `limit` values per key unless limit < 0. Null
+    // values are not counted.
+    MetadataFacets facetCounts(
+        long versionId, const std::string& filter, const std::vector<std::string>& keys, int limit);
+
+    // Same over the vectors with the given unique ids, e.g. the hits of a search
+    MetadataFacets facetCounts(
+        long versionId, const std::vector<int>& uniqueIds, const std::vector<std::string>& keys, int limit);
+
 };
 
 } // namespace atinyvectors
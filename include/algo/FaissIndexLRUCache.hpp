@@ -19,6 +19,9 @@ public:
     
     std::shared_ptr<FaissIndexManager> get(int vectorIndexId);
 
+    // Cached manager, or null; neither loads an index nor touches the LRU order
+    std::shared_ptr<FaissIndexManager> peek(int vectorIndexId);
+
     std::string getCacheContents() const;
 
     void clean();
@@ -32,6 +35,7 @@ private:
     static std::unique_ptr<FaissIndexLRUCache> instance;
     static std::mutex instanceMutex;
 
+    mutable std::mutex cacheMutex_; // Guards cacheList_ and cacheMap_
     size_t capacity_; // Maximum capacity of the cache
     std::list<int> cacheList_; // List of keys representing the cache order
     std::unordered_map<int, std::pair<std::shared_ptr<FaissIndexManager>, std::list<int>::iterator>> cacheMap_; // Map to store the cache entries
@@ -1,12 +1,18 @@
 #ifndef __ATINYVECTORS_FAISS_INDEX_MANAGER_HPP__
 #define __ATINYVECTORS_FAISS_INDEX_MANAGER_HPP__
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include "faiss/Index.h"
 #include "faiss/IndexHNSW.h"
 #include "faiss/IndexFlat.h"
+#include "faiss/IndexIDMap.h"
 #include "nlohmann/json.hpp"
 #include "ValueType.hpp"
 
@@ -30,6 +36,36 @@ public:
     void addVectorData(SparseData* sparseData, int vectorId);
     std::vector<std::pair<float, int>> search(SparseData* sparseQueryVector, size_t k);
 
+    // Write up to k hits into caller buffers of k entries and return how many were
+    // found. The dense query must have `dim` floats. Scratch space is per thread, so
+    // repeated queries do not allocate here.
+    size_t search(const float* queryVector, size_t k, float* outDistances, int64_t* outLabels);
+    size_t search(const int* sparseIndices, const float* sparseValues, size_t nnz, size_t k,
+                  float* outDistances, int64_t* outLabels);
+
+    // Same as above, but only labels accepted by the selector are returned. HNSW
+    // indexes apply it while traversing the graph.
+    size_t search(const float* queryVector, size_t k, const faiss::IDSelector& selector,
+                  float* outDistances, int64_t* outLabels);
+
+    // Exact distances from the query to the given labels, best k first. Labels
+    // that are not in the index are skipped.
+    size_t searchExact(const float* queryVector, const int64_t* labels, size_t labelCount, size_t k,
+                       float* outDistances, int64_t* outLabels);
+
+    // Number of vectors in the index
+    size_t count();
+
+    // Hides the labels from every search until they are added again. Nodes
+    // can't be removed from HNSW in place, so they are tombstoned by position:
+    // the nodes of deleted labels, and the earlier node of a label that is added
+    // again, so only its latest vector can match. Indexes read from disk
+    // tombstone the nodes whose label no longer has a vector.
+    void markDeleted(const std::vector<int64_t>& labels);
+
+    // Number of tombstoned nodes
+    size_t deletedCount();
+
     void restoreVectorsToIndex(bool skipIfIndexLoaded = true);
     void saveIndex();
     void loadIndex();
@@ -41,8 +77,21 @@ private:
         VectorValueType valueType, MetricType metric, 
         const HnswConfig& hnswConfig, const QuantizationConfig& quantizationConfig);
     void setOptimizerSettings();
+    bool loadDenseVectorsFromSegments(std::vector<float>& denseVectors, std::vector<faiss::idx_t>& vectorIds);
     std::vector<float> normalizeVector(const std::vector<float>& vector);
+    void normalizeVectorInPlace(float* data, size_t size);
     void normalizeSparseVector(SparseData* sparseVector);
+    faiss::IndexIDMap* getIdMapIndex();
+    void ensureIndexLoaded();
+    const float* prepareQuery(const float* queryVector);
+    size_t searchIndex(const float* queryVector, size_t k, const faiss::SearchParameters* params,
+                       float* outDistances, int64_t* outLabels);
+    size_t searchSelected(const float* queryVector, size_t k, const faiss::IDSelector& selector,
+                          float* outDistances, int64_t* outLabels);
+    void loadTombstones();
+
+    // Requires labelOffsetsMutex
+    void trackLabelOffsets(const faiss::IndexIDMap* idMap);
 
 public:
     std::string indexFileName;
@@ -54,7 +103,24 @@ public:
 
 private:
     MetricType metricType;
-    bool indexLoaded;
+    std::atomic<bool> indexLoaded;
+
+    // Searches share the engine lock, so several of them may find an index still
+    // unloaded. Loading can also backfill segments through the writer connection,
+    // so loads of all indexes take turns.
+    static std::mutex loadMutex;
+
+    // Position of the latest node of each label in the wrapped index. Labels are
+    // only ever appended, so the map catches up with the tail of id_map and
+    // tombstones the earlier node of a label it sees again.
+    std::mutex labelOffsetsMutex;
+    const faiss::Index* labelOffsetsIndex = nullptr;
+    size_t labelOffsetsCount = 0;
+    std::unordered_map<int64_t, int64_t> labelOffsets;
+
+    // Node positions that no search may return; searches hold the lock shared
+    std::shared_mutex tombstonesMutex;
+    std::unordered_set<int64_t> tombstones;
 };
 
 };
@@ -0,0 +1,123 @@
+#ifndef __ATINYVECTORS_VECTOR_SEGMENT_STORE_HPP__
+#define __ATINYVECTORS_VECTOR_SEGMENT_STORE_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atinyvectors
+{
+namespace algo
+{
+
+// Read-only view over contiguous floats (std::span is C++20)
+struct FloatSpan {
+    const float* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return data == nullptr || size == 0; }
+    const float* begin() const { return data; }
+    const float* end() const { return data + size; }
+    float operator[](size_t i) const { return data[i]; }
+};
+
+// Append-only dense vector records for one vector index, stored with a fixed stride
+// in memory-mapped segment files. Segments are preallocated and mapped once, so a
+// FloatSpan stays valid for the lifetime of the store. SQLite keeps the record index
+// of each vector in VectorSegmentEntry; the store itself knows nothing about ids.
+class VectorSegmentStore {
+public:
+    VectorSegmentStore(const std::string& directory, int dim, size_t recordsPerSegment);
+    ~VectorSegmentStore();
+
+    VectorSegmentStore(const VectorSegmentStore&) = delete;
+    VectorSegmentStore& operator=(const VectorSegmentStore&) = delete;
+
+    // Copies `dim` floats into the next record and returns its index
+    int64_t append(const float* data);
+    FloatSpan get(int64_t recordIndex);
+
+    // Next append position. Records past it may hold data of rolled back
+    // transactions and are overwritten. Records below it are taken as durable.
+    int64_t getRecordCount() const;
+    void setRecordCount(int64_t count);
+
+    // Flushes the records appended since the last sync to disk; false on failure
+    bool sync();
+
+    int getDim() const { return dim; }
+    const std::string& getDirectory() const { return directory; }
+
+private:
+    struct Segment {
+        int fd = -1;
+        uint8_t* base = nullptr;
+        size_t length = 0;
+    };
+
+    Segment& openSegment(size_t segmentIndex);
+    std::string segmentPath(size_t segmentIndex) const;
+
+    std::string directory;
+    int dim;
+    size_t recordsPerSegment;
+    size_t recordStride;
+    int64_t recordCount = 0;
+    int64_t syncedCount = 0;
+
+    mutable std::mutex storeMutex;
+    std::vector<std::unique_ptr<Segment>> segments;
+};
+
+// Opens one VectorSegmentStore per vector index next to its FAISS index file.
+// Disabled unless ATV_VECTOR_SEGMENT_STORE is set.
+class VectorSegmentStoreManager {
+public:
+    static VectorSegmentStoreManager& getInstance();
+
+    bool isEnabled() const { return enabled; }
+
+    std::shared_ptr<VectorSegmentStore> get(int vectorIndexId);
+
+    // Writes the record and its VectorSegmentEntry row on the writer connection,
+    // so it commits or rolls back with the surrounding transaction. The record is
+    // flushed to disk before that transaction commits.
+    void appendDenseVector(int vectorIndexId, long vectorId, int uniqueId, const float* data, size_t size);
+    void appendDenseVector(int vectorIndexId, long vectorId, int uniqueId, const std::vector<float>& data) {
+        appendDenseVector(vectorIndexId, vectorId, uniqueId, data.data(), data.size());
+    }
+
+    void clean();
+
+private:
+    VectorSegmentStoreManager();
+    VectorSegmentStoreManager(const VectorSegmentStoreManager&) = delete;
+    VectorSegmentStoreManager& operator=(const VectorSegmentStoreManager&) = delete;
+
+    // Pre-commit hook of the writer connection
+    bool syncPending();
+
+    static std::unique_ptr<VectorSegmentStoreManager> instance;
+    static std::mutex instanceMutex;
+
+    bool enabled;
+    size_t recordsPerSegment;
+
+    std::mutex storesMutex;
+    std::unordered_map<int, std::shared_ptr<VectorSegmentStore>> stores;
+    uint64_t storesGeneration = 0;
+
+    // Stores with records appended since the last commit. Kept apart from
+    // storesMutex, which is held while querying the writer connection.
+    std::mutex pendingMutex;
+    std::vector<std::shared_ptr<VectorSegmentStore>> pendingSync;
+};
+
+}; // namespace algo
+}; // namespace atinyvectors
+
+#endif
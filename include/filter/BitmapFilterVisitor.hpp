@@ -0,0 +1,79 @@
+#ifndef __ATINYVECTORS_BITMAP_FILTER_VISITOR_HPP__
+#define __ATINYVECTORS_BITMAP_FILTER_VISITOR_HPP__
+
+#include "PlanBaseVisitor.h"
+#include "PlanParser.h"
+#include "filter/MetadataBitmapIndex.hpp"
+#include <string>
+
+namespace atinyvectors {
+namespace filter {
+
+// Evaluates a filter against the bitmaps of one version with the semantics of
+// the SQL built by SQLBuilderVisitor: numeric literals compare against
+// numericValue and strings against the TEXT value, NULL values never match a
+// comparison, and NOT is taken within the vectors that have metadata.
+// Conditions that only SQL can answer (arithmetic, JSON paths, ...) mark the
+// filter as unsupported.
+class BitmapFilterVisitor : public PlanBaseVisitor {
+public:
+    explicit BitmapFilterVisitor(const VersionBitmaps& bitmaps);
+
+    // False when the filter does not parse or is not supported
+    static bool evaluate(const std::string& filter, const VersionBitmaps& bitmaps, RoaringBitmap& result);
+
+    bool isSupported() const { return supported; }
+
+    // SQLite LIKE: '%' and '_' wildcards, ASCII letters compared case-insensitively
+    static bool likeMatch(const std::string& value, const std::string& pattern);
+
+    RoaringBitmap evaluateCondition(PlanParser::ExprContext* ctx);
+
+    virtual std::any visitChildren(antlr4::tree::ParseTree* node) override;
+    virtual std::any visitParens(PlanParser::ParensContext* ctx) override;
+    virtual std::any visitLike(PlanParser::LikeContext* ctx) override;
+    virtual std::any visitEquality(PlanParser::EqualityContext* ctx) override;
+    virtual std::any visitLogicalAnd(PlanParser::LogicalAndContext* ctx) override;
+    virtual std::any visitLogicalOr(PlanParser::LogicalOrContext* ctx) override;
+    virtual std::any visitRelational(PlanParser::RelationalContext* ctx) override;
+    virtual std::any visitRange(PlanParser::RangeContext* ctx) override;
+    virtual std::any visitReverseRange(PlanParser::ReverseRangeContext* ctx) override;
+    virtual std::any visitUnary(PlanParser::UnaryContext* ctx) override;
+    virtual std::any visitTerm(PlanParser::TermContext* ctx) override;
+    virtual std::any visitEmptyTerm(PlanParser::EmptyTermContext* ctx) override;
+
+private:
+    const VersionBitmaps& bitmaps;
+    bool supported;
+
+    std::any unsupported();
+
+    // Key of a condition; only plain identifiers are looked up in the index
+    bool conditionKey(PlanParser::ExprContext* ctx, std::string& key);
+
+    // Literal operand: a number compared against numericValue, or a string
+    // compared against the value column
+    struct Literal {
+        bool numeric = false;
+        double number = 0;
+        std::string text;
+    };
+    bool literal(PlanParser::ExprContext* ctx, Literal& operand);
+
+    const VersionBitmaps::KeyBitmaps* findKey(const std::string& key) const;
+
+    // Union of the bitmaps of the values (or numbers) of `key` accepted by `predicate`
+    template <typename Predicate>
+    RoaringBitmap unionValues(const std::string& key, Predicate predicate) const;
+    template <typename Predicate>
+    RoaringBitmap unionNumbers(const std::string& key, Predicate predicate) const;
+
+    // Values of `key` between the bounds; a null bound is open
+    std::any rangeCondition(const std::string& key, const Literal* lower, bool lowerInclusive,
+                            const Literal* upper, bool upperInclusive);
+};
+
+};
+};
+
+#endif
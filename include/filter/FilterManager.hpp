@@ -1,21 +1,80 @@
 #ifndef __ATINYVECTORS_FILTER_MANAGER_HPP__
 #define __ATINYVECTORS_FILTER_MANAGER_HPP__
 
+#include <SQLiteCpp/SQLiteCpp.h>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace atinyvectors {
 namespace filter {
 
+// Literal of a filter, bound to a named SQL parameter instead of being inlined
+struct FilterParameter {
+    enum class Type { Integer, Real, Text };
+
+    std::string name;
+    Type type = Type::Text;
+    long long intValue = 0;
+    double realValue = 0.0;
+    std::string textValue;
+};
+
+// SQL condition for a filter plus the values of its parameters. The SQL only
+// depends on the shape of the filter, so statements built from it can be cached.
+// Callers must bind their own parameters by name as well, since named and
+// positional parameters share one index space.
+struct CompiledFilter {
+    std::string sql;
+    std::vector<FilterParameter> parameters;
+
+    void bind(SQLite::Statement& statement) const;
+};
+
+// What a space indexes beyond the VectorMetadata columns; conditions on these
+// read the side tables instead of testing every row of the key
+struct MetadataIndexes {
+    std::vector<std::string> paths;     // canonical JSON paths, rows in VectorMetadataPath
+    std::vector<std::string> textKeys;  // keys whose values are in VectorMetadataText
+};
+
+struct ParsedFilter;
+
 class FilterManager {
 private:
     static std::unique_ptr<FilterManager> instance;
     static std::mutex instanceMutex;
 
+    // Parsed filter with placeholders; each entry names a parameter and the
+    // index of the literal token it is read from.
+    struct FilterTemplate {
+        std::string sql;
+        std::vector<std::pair<std::string, size_t>> placeholders;
+    };
+
     FilterManager();
 
-    std::string convertFilterToSQL(const std::string& filter);
+    std::string convertFilterToSQL(const std::string& filter, const MetadataIndexes& indexes);
+
+    // LRU of templates keyed by the token sequence of the filter, with literal
+    // values replaced by their type. Filters that differ only in literals share
+    // an entry and skip the parser.
+    size_t cacheCapacity;
+    std::list<std::pair<std::string, std::shared_ptr<const FilterTemplate>>> cacheList;
+    std::unordered_map<std::string, decltype(cacheList)::iterator> cacheMap;
+    size_t hits = 0;
+    size_t misses = 0;
+    mutable std::mutex cacheMutex;
+
+    // LRU of parse trees keyed by the filter text, of the same capacity. The
+    // bitmap and predicate plans carry the literals, so unlike templates they
+    // cannot be shared between filters of the same shape.
+    std::list<std::pair<std::string, std::shared_ptr<const ParsedFilter>>> parsedList;
+    std::unordered_map<std::string, decltype(parsedList)::iterator> parsedMap;
 
 public:
     FilterManager(const FilterManager&) = delete;
@@ -23,7 +82,20 @@ public:
 
     static FilterManager& getInstance();
 
-    std::string toSQL(const std::string& filter);
+    // Literals inlined into the SQL
+    std::string toSQL(const std::string& filter, const MetadataIndexes& indexes = {});
+
+    // Literals as named parameters; see CompiledFilter
+    CompiledFilter compile(const std::string& filter, const MetadataIndexes& indexes = {});
+
+    // Parse tree of the filter for the in-memory evaluators, parsed once per
+    // filter text while it stays in the cache
+    std::shared_ptr<const ParsedFilter> parse(const std::string& filter);
+
+    size_t getCacheSize() const;
+    size_t getCacheHits() const;
+    size_t getCacheMisses() const;
+    void clearCache();
 };
 
 };
@@ -0,0 +1,46 @@
+#ifndef __ATINYVECTORS_FILTER_PLANNER_HPP__
+#define __ATINYVECTORS_FILTER_PLANNER_HPP__
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace atinyvectors {
+namespace filter {
+
+// How a filtered search reaches its k hits
+enum class FilterPlan {
+    PostFilter,     // unfiltered ANN over-fetched by 1 / selectivity, then filtered
+    FilteredIndex,  // ANN that only admits the matching ids while traversing the graph
+    ExactScan,      // exact distances to every matching vector
+};
+
+const char* toString(FilterPlan plan);
+
+// Picks a plan from the number of vectors matching the filter. Post-filtering is
+// cheap while most vectors match, a filtered traversal keeps recall when few do,
+// and below a few thousand matches computing every distance beats both.
+class FilterPlanner {
+public:
+    FilterPlanner(size_t exactScanMax, double postFilterSelectivity);
+
+    // Thresholds from ATV_FILTER_EXACT_SCAN_MAX and ATV_FILTER_POSTFILTER_SELECTIVITY
+    static FilterPlanner& getInstance();
+
+    FilterPlan choose(size_t matching, size_t total, size_t k) const;
+
+    // Hits to ask the unfiltered ANN for so that about k of them match
+    static size_t postFilterFetch(size_t matching, size_t total, size_t k);
+
+private:
+    static std::unique_ptr<FilterPlanner> instance;
+    static std::mutex instanceMutex;
+
+    size_t exactScanMax;
+    double postFilterSelectivity;
+};
+
+};
+};
+
+#endif
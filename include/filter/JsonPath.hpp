@@ -0,0 +1,52 @@
+#ifndef __ATINYVECTORS_JSON_PATH_HPP__
+#define __ATINYVECTORS_JSON_PATH_HPP__
+
+#include "nlohmann/json.hpp"
+#include <string>
+#include <vector>
+
+namespace atinyvectors {
+namespace filter {
+
+// Path into an array or object metadata value as filters write it: the key
+// followed by member and index segments, e.g. attrs["brand"] or sizes[0].
+// Indexed paths may end in [] to select every element of an array.
+class JsonPath {
+public:
+    struct Segment {
+        bool isIndex = false;
+        std::string member;
+        size_t index = 0;
+    };
+
+    // Throws std::invalid_argument for malformed paths
+    static JsonPath parse(const std::string& text);
+
+    const std::string& getKey() const { return key; }
+    const std::vector<Segment>& getSegments() const { return segments; }
+    bool selectsElements() const { return elements; }
+
+    // Canonical text, as stored in VectorMetadataPath.path: attrs["brand"], tags[]
+    std::string toString() const;
+
+    // SQLite path of the segments, without the trailing []: $."brand"[0]
+    std::string toSQLitePath() const;
+
+    // The same path followed by []
+    JsonPath each() const;
+
+    // Values the path selects in `value`, the metadata value of its key. Like
+    // SQLite's json_each, [] selects the elements of an array, the members of an
+    // object, or a scalar itself.
+    std::vector<const nlohmann::json*> extract(const nlohmann::json& value) const;
+
+private:
+    std::string key;
+    std::vector<Segment> segments;
+    bool elements = false;
+};
+
+};
+};
+
+#endif
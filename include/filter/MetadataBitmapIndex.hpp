@@ -0,0 +1,178 @@
+#ifndef __ATINYVECTORS_METADATA_BITMAP_INDEX_HPP__
+#define __ATINYVECTORS_METADATA_BITMAP_INDEX_HPP__
+
+#include "filter/RoaringBitmap.hpp"
+#include "VectorMetadata.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace atinyvectors {
+namespace filter {
+
+// Inverted index of one version: for every metadata key, the unique_ids of the
+// vectors holding each value. Values are ordered like SQLite's BINARY collation
+// and numbers by numericValue, so range and LIKE conditions scan the distinct
+// values instead of the rows.
+struct VersionBitmaps {
+    struct KeyBitmaps {
+        std::map<std::string, RoaringBitmap> values;
+        std::map<double, RoaringBitmap> numbers;  // rows with a numericValue
+        RoaringBitmap nulls;  // rows whose value is NULL
+    };
+
+    std::unordered_map<std::string, KeyBitmaps> keys;
+    RoaringBitmap all;  // vectors with at least one metadata row; the domain of NOT
+};
+
+// Rows of one key stored column-wise: the value and numericValue of each row sit
+// in parallel arrays, and the rows of a vector are found by its unique id. Filters
+// test candidates against these without going through the bitmaps or SQL.
+struct KeyColumn {
+    static constexpr uint8_t HAS_VALUE = 1;
+    static constexpr uint8_t HAS_NUMBER = 2;
+
+    std::vector<std::string> values;
+    std::vector<double> numbers;
+    std::vector<uint8_t> flags;
+    std::vector<uint32_t> freeSlots;  // slots of removed rows, reused first
+    std::unordered_map<uint32_t, std::vector<uint32_t>> slotsByUniqueId;
+
+    uint32_t add(uint32_t uniqueId, const std::optional<std::string>& value, const std::optional<double>& number);
+    void remove(uint32_t uniqueId, uint32_t slot);
+    bool empty() const { return slotsByUniqueId.empty(); }
+
+    bool hasValue(uint32_t slot) const { return (flags[slot] & HAS_VALUE) != 0; }
+    bool hasNumber(uint32_t slot) const { return (flags[slot] & HAS_NUMBER) != 0; }
+    std::optional<std::string> value(uint32_t slot) const;
+    std::optional<double> number(uint32_t slot) const;
+
+    // True when one of the rows of the vector passes the test
+    template <typename Test>
+    bool anyRow(uint32_t uniqueId, const Test& test) const {
+        auto it = slotsByUniqueId.find(uniqueId);
+        if (it == slotsByUniqueId.end()) {
+            return false;
+        }
+        for (uint32_t slot : it->second) {
+            if (test(*this, slot)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+struct MetadataColumns {
+    std::unordered_map<std::string, KeyColumn> keys;
+
+    const KeyColumn* find(const std::string& key) const {
+        auto it = keys.find(key);
+        return it != keys.end() ? &it->second : nullptr;
+    }
+};
+
+class FilterPredicate;
+
+// In-memory bitmap index over VectorMetadata, built per version on first use and
+// kept in sync by VectorMetadataManager. Filters are evaluated as bitmap
+// operations; evaluate() returns false for filters it cannot answer exactly the
+// way the generated SQL would, and callers fall back to SQL for those.
+class MetadataBitmapIndex {
+public:
+    MetadataBitmapIndex(const MetadataBitmapIndex&) = delete;
+    MetadataBitmapIndex& operator=(const MetadataBitmapIndex&) = delete;
+
+    static MetadataBitmapIndex& getInstance();
+
+    bool isEnabled() const { return enabled; }
+
+    // Turns the index on or off at runtime; loaded versions are dropped either way
+    // since writes are not tracked while it is off
+    void setEnabled(bool value);
+
+    // Unique ids of the vectors of the version matching the filter
+    bool evaluate(long versionId, const std::string& filter, RoaringBitmap& result);
+
+    // Sets matched[i] to whether uniqueIds[i] passes the compiled filter
+    bool evaluate(long versionId, const FilterPredicate& predicate, const uint32_t* uniqueIds, size_t count, uint8_t* matched);
+
+    // Value counts of the keys over the vectors matching the filter, or every
+    // vector when it is empty; see VectorMetadataManager::facetCounts
+    bool facets(long versionId, const std::string& filter, const std::vector<std::string>& keys,
+                int limit, MetadataFacets& result);
+
+    // Same over the unique ids of `domain`
+    bool facets(long versionId, const RoaringBitmap& domain, const std::vector<std::string>& keys,
+                int limit, MetadataFacets& result);
+
+    // Vector.id of each unique id, in the same order; unknown ids are skipped
+    std::vector<int> toVectorIds(long versionId, const std::vector<uint32_t>& uniqueIds);
+
+    // Called after the corresponding write committed. Versions that are not
+    // loaded are skipped, since they are read from the database on first use.
+    void onMetadataAdded(const VectorMetadata& metadata);
+    void onMetadataUpdated(const VectorMetadata& metadata);
+    void onMetadataDeleted(long metadataId);
+    void onVectorMetadataDeleted(long vectorId);
+    void onVectorMetadataDeleted(const std::vector<long>& vectorIds);
+
+    void clean();
+
+private:
+    MetadataBitmapIndex();
+
+    // Value and number of the row live in the column of its key
+    struct Entry {
+        long vectorId;
+        uint32_t uniqueId;
+        std::string key;
+        uint32_t slot = 0;
+    };
+
+    struct VersionIndex {
+        VersionBitmaps bitmaps;
+        MetadataColumns columns;
+        std::unordered_map<long, Entry> entries;                    // by VectorMetadata.id
+        std::unordered_map<long, std::vector<long>> entryIdsByVectorId;
+        std::unordered_map<uint32_t, long> vectorIdByUniqueId;
+    };
+
+    static std::unique_ptr<MetadataBitmapIndex> instance;
+    static std::mutex instanceMutex;
+
+    std::atomic<bool> enabled;
+
+    std::shared_mutex indexMutex;
+    std::unordered_map<long, std::unique_ptr<VersionIndex>> versions;
+    uint64_t versionsGeneration = 0;
+
+    // Both require indexMutex held exclusively. loadVersion returns null when the
+    // calling thread reads inside a write transaction, whose rows may be rolled back.
+    void checkGeneration();
+    VersionIndex* loadVersion(long versionId);
+
+    // Loads the version if needed and returns it with `lock` held shared, or null
+    // when it cannot be loaded now and the caller should fall back to SQL
+    VersionIndex* acquireVersion(long versionId, std::shared_lock<std::shared_mutex>& lock);
+
+    // Counts each value bitmap of the keys against `domain`, or takes its size when null
+    static void countFacets(const VersionBitmaps& bitmaps, const RoaringBitmap* domain,
+                            const std::vector<std::string>& keys, int limit, MetadataFacets& result);
+
+    static void addEntry(VersionIndex& index, long metadataId, Entry entry,
+                         const std::optional<std::string>& value, const std::optional<double>& number);
+    static void removeEntry(VersionIndex& index, long metadataId);
+};
+
+};
+};
+
+#endif
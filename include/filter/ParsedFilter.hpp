@@ -0,0 +1,48 @@
+#ifndef __ATINYVECTORS_PARSED_FILTER_HPP__
+#define __ATINYVECTORS_PARSED_FILTER_HPP__
+
+#include "antlr4-runtime.h"
+#include "PlanLexer.h"
+#include "PlanParser.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace atinyvectors {
+namespace filter {
+
+class FilterPredicate;
+
+// Parse tree of a filter together with the ANTLR objects that own it, shared
+// through FilterManager::parse. The tree is only read once built, so visitors on
+// several threads can walk it at the same time. Plans that only depend on the
+// filter text are kept here as well, so later calls skip compiling them.
+struct ParsedFilter {
+    explicit ParsedFilter(const std::string& filter);
+
+    ParsedFilter(const ParsedFilter&) = delete;
+    ParsedFilter& operator=(const ParsedFilter&) = delete;
+
+    // Null when the filter has syntax errors
+    PlanParser::ExprContext* tree = nullptr;
+
+    // Set once BitmapFilterVisitor found a condition the bitmap index cannot answer
+    mutable std::atomic<bool> bitmapUnsupported{false};
+
+    // Built by PredicateBuilderVisitor::compile on first use; null when unsupported
+    mutable std::once_flag predicateOnce;
+    mutable std::shared_ptr<const FilterPredicate> predicate;
+
+private:
+    antlr4::ANTLRInputStream input;
+    PlanLexer lexer;
+    antlr4::CommonTokenStream tokens;
+    PlanParser parser;
+};
+
+};
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef __ATINYVECTORS_PREDICATE_BUILDER_VISITOR_HPP__
+#define __ATINYVECTORS_PREDICATE_BUILDER_VISITOR_HPP__
+
+#include "PlanBaseVisitor.h"
+#include "PlanParser.h"
+#include "filter/MetadataBitmapIndex.hpp"
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace atinyvectors {
+namespace filter {
+
+// Metadata of one version a compiled filter is evaluated against
+struct MetadataView {
+    const VersionBitmaps& bitmaps;
+    const MetadataColumns& columns;
+};
+
+// Filter compiled into a tree of closures over MetadataColumns. Each node
+// evaluates a whole batch of candidates, and the right side of AND / OR only
+// sees the candidates the left side left undecided.
+class FilterPredicate {
+public:
+    using Node = std::function<void(const MetadataView& view, const uint32_t* uniqueIds, size_t count, uint8_t* matched)>;
+
+    explicit FilterPredicate(Node root) : root(std::move(root)) {}
+
+    // Sets matched[i] to whether uniqueIds[i] passes the filter
+    void evaluate(const VersionBitmaps& bitmaps, const MetadataColumns& columns,
+                  const uint32_t* uniqueIds, size_t count, uint8_t* matched) const;
+
+private:
+    Node root;
+};
+
+// Compiles filters into FilterPredicates with the semantics of the SQL built by
+// SQLBuilderVisitor. Arithmetic on literals is folded the way SQLite computes
+// it, and both columns of a row are at hand, so mixed ranges and NOT IN lists
+// need no SQL either. Conditions on JSON paths, arithmetic on keys and the like
+// make the filter unsupported.
+class PredicateBuilderVisitor : public PlanBaseVisitor {
+public:
+    // Null when the filter does not parse or is not supported
+    static std::shared_ptr<const FilterPredicate> compile(const std::string& filter);
+
+    bool isSupported() const { return supported; }
+
+    FilterPredicate::Node compileCondition(PlanParser::ExprContext* ctx);
+
+    virtual std::any visitChildren(antlr4::tree::ParseTree* node) override;
+    virtual std::any visitParens(PlanParser::ParensContext* ctx) override;
+    virtual std::any visitLike(PlanParser::LikeContext* ctx) override;
+    virtual std::any visitEquality(PlanParser::EqualityContext* ctx) override;
+    virtual std::any visitLogicalAnd(PlanParser::LogicalAndContext* ctx) override;
+    virtual std::any visitLogicalOr(PlanParser::LogicalOrContext* ctx) override;
+    virtual std::any visitRelational(PlanParser::RelationalContext* ctx) override;
+    virtual std::any visitRange(PlanParser::RangeContext* ctx) override;
+    virtual std::any visitReverseRange(PlanParser::ReverseRangeContext* ctx) override;
+    virtual std::any visitUnary(PlanParser::UnaryContext* ctx) override;
+    virtual std::any visitTerm(PlanParser::TermContext* ctx) override;
+    virtual std::any visitEmptyTerm(PlanParser::EmptyTermContext* ctx) override;
+
+private:
+    bool supported = true;
+
+    // Test of one row of a key, given its column and slot
+    using RowTest = std::function<bool(const KeyColumn& column, uint32_t slot)>;
+
+    // Operand of a condition: a number compared against numericValue, or a
+    // string compared against the value column
+    struct Constant {
+        bool numeric = false;
+        double number = 0;
+        std::string text;
+    };
+
+    // SQLite value of a folded numeric expression
+    struct Number {
+        bool integer = true;
+        long long intValue = 0;
+        double realValue = 0;
+    };
+
+    std::any unsupported();
+
+    bool conditionKey(PlanParser::ExprContext* ctx, std::string& key);
+    bool constant(PlanParser::ExprContext* ctx, Constant& value);
+    bool fold(PlanParser::ExprContext* ctx, Number& number);
+
+    static RowTest compare(size_t op, const Constant& operand);
+    static FilterPredicate::Node keyCondition(const std::string& key, RowTest test);
+    std::any rangeCondition(const std::string& key, PlanParser::ExprContext* lower, bool lowerInclusive,
+                            PlanParser::ExprContext* upper, bool upperInclusive);
+};
+
+};
+};
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef __ATINYVECTORS_ROARING_BITMAP_HPP__
+#define __ATINYVECTORS_ROARING_BITMAP_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace atinyvectors {
+namespace filter {
+
+// Compressed set of 32-bit ids in the Roaring layout: ids are grouped by their
+// high 16 bits, and each group is a sorted array while sparse and a 65536-bit
+// bitset once it holds more than ARRAY_MAX_SIZE ids.
+class RoaringBitmap {
+public:
+    static constexpr size_t ARRAY_MAX_SIZE = 4096;
+
+    RoaringBitmap() = default;
+
+    static RoaringBitmap of(const std::vector<uint32_t>& values);
+
+    void add(uint32_t value);
+    void remove(uint32_t value);
+    bool contains(uint32_t value) const;
+
+    size_t cardinality() const;
+
+    // Size of the intersection with `other`, without building it
+    size_t intersectionCardinality(const RoaringBitmap& other) const;
+    bool empty() const { return containers.empty(); }
+    void clear() { containers.clear(); }
+
+    RoaringBitmap& operator|=(const RoaringBitmap& other);
+    RoaringBitmap& operator&=(const RoaringBitmap& other);
+    RoaringBitmap& operator-=(const RoaringBitmap& other);
+
+    friend RoaringBitmap operator|(RoaringBitmap lhs, const RoaringBitmap& rhs) { return lhs |= rhs; }
+    friend RoaringBitmap operator&(RoaringBitmap lhs, const RoaringBitmap& rhs) { return lhs &= rhs; }
+    friend RoaringBitmap operator-(RoaringBitmap lhs, const RoaringBitmap& rhs) { return lhs -= rhs; }
+
+    bool operator==(const RoaringBitmap& other) const;
+    bool operator!=(const RoaringBitmap& other) const { return !(*this == other); }
+
+    // All ids in ascending order
+    std::vector<uint32_t> toVector() const;
+
+    // Up to `limit` ids that are >= minValue, in ascending order
+    std::vector<uint32_t> valuesFrom(uint32_t minValue, size_t limit) const;
+
+    // Id at `offset` followed by up to `limit - 1` more, in ascending order
+    std::vector<uint32_t> page(size_t offset, size_t limit) const;
+
+private:
+    static constexpr size_t BITSET_WORDS = 65536 / 64;
+
+    struct Container {
+        std::vector<uint16_t> array;  // sorted low bits, used while bits is empty
+        std::vector<uint64_t> bits;   // BITSET_WORDS words once the container is dense
+        uint32_t cardinality = 0;
+
+        bool isBitset() const { return !bits.empty(); }
+        bool contains(uint16_t low) const;
+        void toBitset();
+        void toArray();
+        void normalize();  // picks the layout that matches the cardinality
+
+        template <typename Fn>
+        bool forEach(uint16_t fromLow, Fn&& fn) const;  // stops when fn returns false
+    };
+
+    std::vector<std::pair<uint16_t, Container>> containers;  // sorted by high bits
+
+    Container* findContainer(uint16_t high);
+    const Container* findContainer(uint16_t high) const;
+
+    static Container unite(const Container& a, const Container& b);
+    static Container intersect(const Container& a, const Container& b);
+    static uint32_t intersectCount(const Container& a, const Container& b);
+    static Container subtract(const Container& a, const Container& b);
+};
+
+};
+};
+
+#endif
@@ -3,8 +3,11 @@
 
 #include "PlanBaseVisitor.h"
 #include "PlanParser.h"
+#include "filter/FilterManager.hpp"
+#include "filter/JsonPath.hpp"
 #include <string>
 #include <stack>
+#include <unordered_set>
 #include <algorithm>
 #include <sstream>
 
@@ -13,10 +16,28 @@ namespace filter {
 
 class SQLBuilderVisitor : public PlanBaseVisitor {
 public:
-    SQLBuilderVisitor();
+    // With `parameterize`, literals become named parameters (see getPlaceholders).
+    // Conditions on the JSON paths of `indexes` read their VectorMetadataPath rows;
+    // other paths are read out of the JSON value of their key. LIKE on its text
+    // keys looks the pattern up in VectorMetadataText.
+    explicit SQLBuilderVisitor(bool parameterize = false, const MetadataIndexes& indexes = {});
 
     std::string getSQL() const;
 
+    // Parameter name and literal token index for each placeholder in the SQL
+    const std::vector<std::pair<std::string, size_t>>& getPlaceholders() const { return placeholders; }
+
+    // Value of a literal token as SQLite would read it inline. False for literals
+    // that are kept inline (hex floats, binary constants, out of range numbers).
+    static bool toParameter(size_t tokenType, const std::string& text, FilterParameter& parameter);
+
+    // Numeric expressions compare against numericValue, everything else against value
+    static bool isNumeric(PlanParser::ExprContext* ctx);
+
+    // True when the LIKE pattern has three characters in a row that are not
+    // wildcards, the least the trigram index can look up
+    static bool hasTrigram(const std::string& pattern);
+
     virtual std::any visitInteger(PlanParser::IntegerContext* ctx) override;
     virtual std::any visitFloating(PlanParser::FloatingContext* ctx) override;
     virtual std::any visitBoolean(PlanParser::BooleanContext* ctx) override;
@@ -28,23 +49,72 @@ public:
     virtual std::any visitLogicalAnd(PlanParser::LogicalAndContext* ctx) override;
     virtual std::any visitLogicalOr(PlanParser::LogicalOrContext* ctx) override;
     virtual std::any visitRelational(PlanParser::RelationalContext* ctx) override;
+    virtual std::any visitRange(PlanParser::RangeContext* ctx) override;
+    virtual std::any visitReverseRange(PlanParser::ReverseRangeContext* ctx) override;
     virtual std::any visitUnary(PlanParser::UnaryContext* ctx) override;
     virtual std::any visitMulDivMod(PlanParser::MulDivModContext* ctx) override;
     virtual std::any visitIdentifier(PlanParser::IdentifierContext* ctx) override;
     virtual std::any visitJSONIdentifier(PlanParser::JSONIdentifierContext* ctx) override;
     virtual std::any visitTerm(PlanParser::TermContext* ctx) override;
     virtual std::any visitEmptyTerm(PlanParser::EmptyTermContext* ctx) override;
+    virtual std::any visitJSONContains(PlanParser::JSONContainsContext* ctx) override;
+    virtual std::any visitJSONContainsAll(PlanParser::JSONContainsAllContext* ctx) override;
+    virtual std::any visitJSONContainsAny(PlanParser::JSONContainsAnyContext* ctx) override;
+    virtual std::any visitArrayLength(PlanParser::ArrayLengthContext* ctx) override;
 
 private:
     std::string sql_expression;
 
     int conditionCount;
 
-    std::string handleKeyValueCondition(const std::string& key, const std::string& condition);
+    bool parameterize;
+    std::vector<std::pair<std::string, size_t>> placeholders;
+
+    std::unordered_set<std::string> indexedPaths;
+    std::unordered_set<std::string> textKeys;
+
+    // Rows the next key-value condition tests: the rows of a key, the rows of an
+    // indexed JSON path, the value at a JSON path inside the rows of its key, or
+    // the elements there (json_each)
+    struct ConditionTarget {
+        enum class Kind { Key, IndexedPath, JsonValue, JsonElements };
+        Kind kind = Kind::Key;
+        std::string key;
+        std::string path;
+    };
+    ConditionTarget target;
+
+    std::string literal(antlr4::Token* token, const std::string& inlined);
+
+    // Points the next condition at an identifier or JSON path (or at its
+    // elements); false for other expressions
+    bool setTarget(antlr4::ParserRuleContext* ctx, bool elements = false);
+    bool setTarget(const std::string& text, bool json, bool elements);
+
+    // EXISTS over the rows of the target; `predicate` refers to the row through column()
+    std::string handleKeyValueCondition(const std::string& predicate);
+
+    // Column of the row the next key-value condition tests
+    std::string column(const std::string& name) const;
+
+    std::string valueColumn(PlanParser::ExprContext* ctx) const;
+
+    // Vectors whose value of the target key matches the LIKE pattern, looked up in
+    // VectorMetadataText once instead of testing the rows of each vector
+    std::string textIndexCondition(const std::string& pattern);
+
+    std::string rangeCondition(PlanParser::ExprContext* lower, antlr4::Token* lowerOp,
+                               PlanParser::ExprContext* upper, antlr4::Token* upperOp);
+
+    // Matches a value against a list of literals, numbers on numericValue and strings on value
+    std::string inCondition(const std::string& op, bool notIn, const std::vector<PlanParser::ExprContext*>& values);
+
+    // Literals of an array argument such as json_contains_all(tags, ['a', 'b'])
+    std::vector<PlanParser::ExprContext*> arrayElements(PlanParser::ExprContext* ctx, const std::string& function);
 
     bool isIdentifier(antlr4::ParserRuleContext* ctx);
     std::string getIdentifier(antlr4::ParserRuleContext* ctx);
-    std::string quoteString(const std::string& str);
+    static std::string quoteString(const std::string& str);
     std::string generateValueCondition(const std::string& op, PlanParser::ExprContext* ctx);
 
     std::string extractIdentifier(const std::string& expr);
@@ -0,0 +1,35 @@
+#ifndef __ATINYVECTORS_ENGINE_LOCK_HPP__
+#define __ATINYVECTORS_ENGINE_LOCK_HPP__
+
+#include <mutex>
+#include <shared_mutex>
+
+namespace atinyvectors {
+namespace service {
+
+// Orders service calls that write vectors against searches. Searches hold it
+// shared and run concurrently; upserts, filter deletes/updates and snapshot
+// restores hold it exclusively, since the writer connection and the in-memory
+// indexes are not safe for concurrent writes. Taken inside the services, so sync
+// and async callers share it.
+class EngineLock {
+public:
+    static std::shared_lock<std::shared_mutex> shared() {
+        return std::shared_lock<std::shared_mutex>(mutex());
+    }
+
+    static std::unique_lock<std::shared_mutex> exclusive() {
+        return std::unique_lock<std::shared_mutex>(mutex());
+    }
+
+private:
+    static std::shared_mutex& mutex() {
+        static std::shared_mutex instance;
+        return instance;
+    }
+};
+
+} // namespace service
+} // namespace atinyvectors
+
+#endif // __ATINYVECTORS_ENGINE_LOCK_HPP__
@@ -1,8 +1,11 @@
 #ifndef __ATINYVECTORS_SEARCH_SERVICE_HPP__
 #define __ATINYVECTORS_SEARCH_SERVICE_HPP__
 
+#include <cstdint>
+#include <functional>
 #include <vector>
 #include <string>
+#include "algo/FaissIndexManager.hpp"
 #include "nlohmann/json.hpp"
 
 namespace atinyvectors {
@@ -13,12 +16,42 @@ public:
     // Method to perform a search based on a JSON query and return the top k results with version's Unique ID
     std::vector<std::pair<float, int>> search(const std::string& spaceName, int versionUniqueId, const std::string& queryJsonStr, size_t k);
 
+    // Search without JSON: hits are written into caller buffers of k entries and the
+    // number found is returned. Labels are vector unique ids. Filters need the JSON search.
+    size_t searchDense(const std::string& spaceName, int versionUniqueId, const float* queryVector, size_t dim,
+                       size_t k, float* outDistances, int64_t* outLabels);
+    size_t searchSparse(const std::string& spaceName, int versionUniqueId, const int* indices, const float* values,
+                        size_t nnz, size_t k, float* outDistances, int64_t* outLabels);
+
     // Extracts search results to JSON format
     nlohmann::json extractSearchResultsToJson(const std::vector<std::pair<float, int>>& searchResults);
 
+    // Value counts of the keys over the hits of a search, in the format of
+    // VectorServiceManager::getFacets
+    nlohmann::json getFacets(const std::string& spaceName, int versionUniqueId,
+                             const std::vector<std::pair<float, int>>& searchResults,
+                             const std::vector<std::string>& keys, int limit = -1);
+
 private:
     // Helper function to find the appropriate vector index by space name and version Unique ID
     int findVectorIndexBySpaceNameAndVersionUniqueId(const std::string& spaceName, int& outVersionUniqueId);
+
+    // Filtered search, planned from the number of vectors matching the filter
+    std::vector<std::pair<float, int>> searchFiltered(algo::FaissIndexManager& indexManager, int versionId,
+                                                      const std::vector<float>& queryVector, size_t k,
+                                                      const std::string& filter);
+
+    // Keeps the candidates accepted by a filter, in their order
+    using CandidateFilter = std::function<std::vector<std::pair<float, int>>(const std::vector<std::pair<float, int>>&)>;
+
+    // Unfiltered ANN filtered afterwards: the search is retried with twice the
+    // candidates until k of them pass, the whole index was searched, or
+    // ATV_FILTER_OVERFETCH_MAX candidates were fetched. Candidates already seen
+    // keep their verdict, so each is filtered once. `complete` is false when the
+    // budget ran out first.
+    std::vector<std::pair<float, int>> searchOverFetch(algo::FaissIndexManager& indexManager,
+                                                       const std::vector<float>& queryVector, size_t k, size_t fetch,
+                                                       const CandidateFilter& filter, bool& complete);
 };
 
 } // namespace service
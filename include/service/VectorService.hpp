@@ -1,6 +1,7 @@
 #ifndef __ATINYVECTORS_VECTOR_SERVICE_HPP__
 #define __ATINYVECTORS_VECTOR_SERVICE_HPP__
 
+#include <cstdint>
 #include <string>
 #include "nlohmann/json.hpp"
 #include "Version.hpp"
@@ -12,12 +13,52 @@ using namespace nlohmann;
 namespace atinyvectors {
 namespace service {
 
+// Column-oriented batch for upsertBatch. Buffers are borrowed for the duration of
+// the call. Set either the dense matrix or the sparse CSR arrays.
+struct VectorBatch {
+    size_t count = 0;
+    const int* ids = nullptr;                  // optional; null or 0 allocates an id
+
+    const float* denseData = nullptr;          // count x dim, row-major
+    int dim = 0;
+
+    const int64_t* sparseOffsets = nullptr;    // count + 1 entries; row i is [offsets[i], offsets[i + 1])
+    const int* sparseIndices = nullptr;
+    const float* sparseValues = nullptr;
+
+    size_t metadataKeyCount = 0;
+    const char* const* metadataKeys = nullptr;
+    const char* const* metadataValues = nullptr;  // metadataKeyCount x count, column-major; null skips
+};
+
 class VectorServiceManager {
 public:
     void upsert(const std::string& spaceName, int versionUniqueId, const std::string& jsonStr); 
+
+    // Same effect as upsert with "vectors" entries, without going through JSON
+    void upsertBatch(const std::string& spaceName, int versionUniqueId, const VectorBatch& batch);
     json getVectorsByVersionId(const std::string& spaceName, int versionUniqueId, int start, int limit, const std::string& filter = "");
 
+    // Resumes after the last unique_id of the previous page (0 for the first page).
+    // "next_cursor" in the result is null once the listing is exhausted.
+    json getVectorsByCursor(const std::string& spaceName, int versionUniqueId, int afterUniqueId, int limit, const std::string& filter = "");
+
+    // {"facets": {key: [{"value", "count"}, ...]}} over the vectors matching the filter,
+    // most frequent values first and at most `limit` per key unless limit < 0
+    json getFacets(const std::string& spaceName, int versionUniqueId, const std::vector<std::string>& keys,
+                   const std::string& filter = "", int limit = -1);
+
+    // Deletes every vector matching the filter in one transaction and returns
+    // {"deleted_count": n}. The filter must not be empty.
+    json deleteByFilter(const std::string& spaceName, int versionUniqueId, const std::string& filter);
+
+    // Sets the keys of the JSON object `metadataJsonStr` on every vector matching
+    // the filter, replacing their previous values, and returns {"updated_count": n}
+    json updateMetadataByFilter(const std::string& spaceName, int versionUniqueId, const std::string& filter,
+                                const std::string& metadataJsonStr);
+
 private:
+    json buildVectorsJson(const std::vector<Vector>& vectors);
     void processSimpleVectors(const json& vectorsJson, int versionId, int defaultIndexId);
     void processDefaultDenseData(const json& parsedJson, int versionId, int defaultIndexId);
     void processVectors(const json& parsedJson, int versionId, int defaultIndexId);
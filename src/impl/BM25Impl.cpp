@@ -35,7 +35,8 @@ BM25Manager& BM25Manager::getInstance() {
 }
 
 void BM25Manager::addDocument(long vectorId, const std::string& doc, const std::vector<std::string>& tokens) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
 
     std::string tokensSerialized;
     for (const auto& token : tokens) {
@@ -48,19 +49,19 @@ void BM25Manager::addDocument(long vectorId, const std::string& doc, const std::
     spdlog::debug("Adding document: vectorId={}, doc={}, tokens={}", vectorId, doc, tokensSerialized);
 
     SQLite::Transaction transaction(db);
-    SQLite::Statement insertQuery(db, "INSERT INTO BM25 (vectorId, doc, docLength, tokens) VALUES (?, ?, ?, ?)");
-    insertQuery.bind(1, vectorId);
-    insertQuery.bind(2, doc);
-    insertQuery.bind(3, static_cast<int>(tokens.size()));
-    insertQuery.bind(4, tokensSerialized);
-    insertQuery.exec();
+    auto insertQuery = dbManager.prepare(db, "INSERT INTO BM25 (vectorId, doc, docLength, tokens) VALUES (?, ?, ?, ?)");
+    insertQuery->bind(1, vectorId);
+    insertQuery->bind(2, doc);
+    insertQuery->bind(3, static_cast<int>(tokens.size()));
+    insertQuery->bind(4, tokensSerialized);
+    insertQuery->exec();
     transaction.commit();
 }
 
 std::vector<std::pair<long, double>> BM25Manager::searchWithVectorIds(
     const std::vector<long>& vectorIds,
     const std::vector<std::string>& queryTokens) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
 
     // Prepare IN query for vectorIds
     std::ostringstream idListStream;
@@ -159,16 +160,45 @@ std::vector<std::pair<long, double>> BM25Manager::searchWithVectorIds(
 }
 
 std::string BM25Manager::getDocByVectorId(int vectorId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT doc FROM BM25 WHERE vectorId = ?");
-    query.bind(1, vectorId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT doc FROM BM25 WHERE vectorId = ?");
+    query->bind(1, vectorId);
 
-    if (query.executeStep()) {
-        return query.getColumn(0).getString();
+    if (query->executeStep()) {
+        return query->getColumn(0).getString();
     } else {
         return "";
     }
 }
 
+std::unordered_map<long, std::string> BM25Manager::getDocsByVectorIds(const std::vector<long>& vectorIds) {
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
+    std::unordered_map<long, std::string> docs;
+
+    const size_t maxParams = 500;
+    for (size_t offset = 0; offset < vectorIds.size(); offset += maxParams) {
+        size_t chunkSize = std::min(maxParams, vectorIds.size() - offset);
+
+        std::ostringstream ss;
+        ss << "SELECT vectorId, doc FROM BM25 WHERE vectorId IN (";
+        for (size_t i = 0; i < chunkSize; ++i) {
+            ss << (i == 0 ? "?" : ",?");
+        }
+        ss << ") ORDER BY vectorId, id";
+
+        SQLite::Statement query(db, ss.str());
+        for (size_t i = 0; i < chunkSize; ++i) {
+            query.bind(static_cast<int>(i + 1), static_cast<int64_t>(vectorIds[offset + i]));
+        }
+
+        while (query.executeStep()) {
+            // Keep the first document per vector, matching getDocByVectorId
+            docs.emplace(query.getColumn(0).getInt64(), query.getColumn(1).getString());
+        }
+    }
+
+    return docs;
+}
 
 } // namespace atinyvectors
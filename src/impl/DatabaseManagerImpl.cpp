@@ -1,9 +1,11 @@
 #include "DatabaseManager.hpp"
 #include <SQLiteCpp/Backup.h>
 #include <sqlite3.h>
+#include <cctype>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 using namespace atinyvectors;
 
@@ -11,10 +13,207 @@ namespace atinyvectors {
 
 std::unique_ptr<DatabaseManager> DatabaseManager::instance;
 std::mutex DatabaseManager::instanceMutex;
+std::atomic<uint64_t> DatabaseManager::resetGeneration{0};
+std::mutex DatabaseManager::preCommitHooksMutex;
+std::vector<std::function<bool()>> DatabaseManager::preCommitHooks;
 
 DatabaseManager::DatabaseManager(const std::string& dbFileName, const std::string& migrationDir)
-    : db(dbFileName, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE), migrationPath(migrationDir) {
-    migrate();   
+    : db(dbFileName, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE),
+      statementCache(std::make_unique<StatementCache>(db, Config::getInstance().getSqliteStatementCacheSize())),
+      migrationPath(migrationDir) {
+    applyPragmas();
+    migrate();
+
+    sqlite3_trace_v2(db.getHandle(), SQLITE_TRACE_STMT, &DatabaseManager::traceWriterStatement, this);
+    sqlite3_commit_hook(db.getHandle(), &DatabaseManager::runPreCommitHooks, nullptr);
+
+    auto& config = Config::getInstance();
+    readPoolSize = static_cast<size_t>(config.getSqliteReadPoolSize());
+    readPoolEnabled = dbFileName != ":memory:" && readPoolSize > 0 && getJournalMode() == "wal";
+    spdlog::info("SQLite read connection pool: {} (size={})", readPoolEnabled ? "enabled" : "disabled", readPoolSize);
+}
+
+void DatabaseManager::applyPragmas() {
+    auto& config = Config::getInstance();
+
+    db.setBusyTimeout(config.getSqliteBusyTimeoutMs());
+
+    // page_size must be set before the first table is created; on an existing
+    // database SQLite silently keeps the original page size.
+    db.exec("PRAGMA page_size = " + std::to_string(config.getSqlitePageSize()) + ";");
+
+    // journal_mode returns the mode actually in effect (":memory:" databases stay in MEMORY)
+    std::string journalMode = db.execAndGet("PRAGMA journal_mode = " + config.getSqliteJournalMode() + ";").getString();
+
+    db.exec("PRAGMA synchronous = " + config.getSqliteSynchronous() + ";");
+    db.exec("PRAGMA cache_size = " + std::to_string(config.getSqliteCacheSize()) + ";");
+    db.exec("PRAGMA mmap_size = " + std::to_string(config.getSqliteMmapSize()) + ";");
+    db.exec("PRAGMA temp_store = " + config.getSqliteTempStore() + ";");
+    db.exec("PRAGMA wal_autocheckpoint = " + std::to_string(config.getSqliteWalAutocheckpoint()) + ";");
+
+    spdlog::info("Applied SQLite pragmas: journal_mode={}, synchronous={}, cache_size={}, mmap_size={}, temp_store={}, page_size={}, wal_autocheckpoint={}",
+                 journalMode, config.getSqliteSynchronous(), config.getSqliteCacheSize(), config.getSqliteMmapSize(),
+                 config.getSqliteTempStore(), config.getSqlitePageSize(), config.getSqliteWalAutocheckpoint());
+}
+
+void DatabaseManager::applyReadPragmas(SQLite::Database& readDb) {
+    auto& config = Config::getInstance();
+
+    readDb.setBusyTimeout(config.getSqliteBusyTimeoutMs());
+    readDb.exec("PRAGMA cache_size = " + std::to_string(config.getSqliteCacheSize()) + ";");
+    readDb.exec("PRAGMA mmap_size = " + std::to_string(config.getSqliteMmapSize()) + ";");
+    readDb.exec("PRAGMA temp_store = " + config.getSqliteTempStore() + ";");
+}
+
+SQLite::Database& DatabaseManager::getReadDatabase() {
+    if (!readPoolEnabled) {
+        return db;
+    }
+
+    // A read connection cannot see the rows of an open write transaction, so the
+    // thread that opened it keeps reading through the writer. Other threads read
+    // the last committed state from their own connection.
+    if (!sqlite3_get_autocommit(db.getHandle()) && writeTransactionOwner.load() == std::this_thread::get_id()) {
+        return db;
+    }
+
+    // Releases this thread's connection when the thread goes away so the slot can be reused
+    struct ThreadExitGuard {
+        ~ThreadExitGuard() { DatabaseManager::releaseReadDatabaseOnThreadExit(); }
+    };
+    thread_local ThreadExitGuard threadExitGuard;
+    (void)threadExitGuard;
+
+    const auto threadId = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(readPoolMutex);
+
+    auto it = readConnections.find(threadId);
+    if (it != readConnections.end()) {
+        return *it->second.db;
+    }
+
+    if (readConnections.size() >= readPoolSize) {
+        spdlog::debug("Read connection pool is full ({}). Using writer connection.", readPoolSize);
+        return db;
+    }
+
+    try {
+        auto readDb = std::make_unique<SQLite::Database>(db.getFilename(), SQLite::OPEN_READONLY | SQLite::OPEN_NOMUTEX);
+        applyReadPragmas(*readDb);
+
+        auto& conn = readConnections[threadId];
+        conn.statements = std::make_unique<StatementCache>(*readDb, Config::getInstance().getSqliteStatementCacheSize());
+        conn.db = std::move(readDb);
+        spdlog::debug("Opened read connection {} of {}", readConnections.size(), readPoolSize);
+        return *conn.db;
+    } catch (const SQLite::Exception& e) {
+        spdlog::warn("Failed to open read connection: {}. Using writer connection.", e.what());
+        return db;
+    }
+}
+
+void DatabaseManager::releaseReadDatabase() {
+    std::lock_guard<std::mutex> lock(readPoolMutex);
+    readConnections.erase(std::this_thread::get_id());
+}
+
+void DatabaseManager::releaseReadDatabaseOnThreadExit() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (instance) {
+        instance->releaseReadDatabase();
+    }
+}
+
+// Runs on the thread stepping the statement; BEGIN and SAVEPOINT (which opens a
+// transaction outside of one) make that thread the owner of the write transaction
+int DatabaseManager::traceWriterStatement(unsigned type, void* context, void* statement, void* /*sql*/) {
+    if (type != SQLITE_TRACE_STMT) {
+        return 0;
+    }
+
+    const char* text = sqlite3_sql(static_cast<sqlite3_stmt*>(statement));
+    if (text == nullptr) {
+        return 0;
+    }
+    while (std::isspace(static_cast<unsigned char>(*text))) {
+        ++text;
+    }
+    if (sqlite3_strnicmp(text, "BEGIN", 5) == 0 || sqlite3_strnicmp(text, "SAVEPOINT", 9) == 0) {
+        static_cast<DatabaseManager*>(context)->writeTransactionOwner.store(std::this_thread::get_id());
+    }
+    return 0;
+}
+
+void DatabaseManager::addPreCommitHook(std::function<bool()> hook) {
+    std::lock_guard<std::mutex> lock(preCommitHooksMutex);
+    preCommitHooks.push_back(std::move(hook));
+}
+
+// A non-zero return makes SQLite roll the transaction back instead of committing
+int DatabaseManager::runPreCommitHooks(void* /*context*/) {
+    std::lock_guard<std::mutex> lock(preCommitHooksMutex);
+    for (const auto& hook : preCommitHooks) {
+        try {
+            if (!hook()) {
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            spdlog::error("Pre-commit hook failed: {}", e.what());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+bool DatabaseManager::readsUncommittedRows(SQLite::Database& database) {
+    return !sqlite3_get_autocommit(database.getHandle()) && &database == &db;
+}
+
+StatementCache* DatabaseManager::findStatementCache(SQLite::Database& database) {
+    if (&database == &db) {
+        return statementCache.get();
+    }
+
+    std::lock_guard<std::mutex> lock(readPoolMutex);
+    auto it = readConnections.find(std::this_thread::get_id());
+    if (it != readConnections.end() && it->second.db.get() == &database) {
+        return it->second.statements.get();
+    }
+    return nullptr;
+}
+
+CachedStatement DatabaseManager::prepare(SQLite::Database& database, const std::string& sql) {
+    StatementCache* cache = findStatementCache(database);
+    if (cache) {
+        return cache->acquire(sql);
+    }
+    return CachedStatement(nullptr, sql, std::make_unique<SQLite::Statement>(database, sql));
+}
+
+size_t DatabaseManager::getReadConnectionCount() {
+    std::lock_guard<std::mutex> lock(readPoolMutex);
+    return readConnections.size();
+}
+
+std::string DatabaseManager::getJournalMode() {
+    return db.execAndGet("PRAGMA journal_mode;").getString();
+}
+
+void DatabaseManager::checkpoint(bool truncate) {
+    if (getJournalMode() != "wal") {
+        return;
+    }
+
+    SQLite::Statement query(db, truncate ? "PRAGMA wal_checkpoint(TRUNCATE);" : "PRAGMA wal_checkpoint(PASSIVE);");
+    if (query.executeStep()) {
+        int busy = query.getColumn(0).getInt();
+        int logFrames = query.getColumn(1).getInt();
+        int checkpointedFrames = query.getColumn(2).getInt();
+        spdlog::debug("WAL checkpoint: busy={}, log_frames={}, checkpointed_frames={}", busy, logFrames, checkpointedFrames);
+        if (busy != 0) {
+            spdlog::warn("WAL checkpoint could not complete because readers or writers are active.");
+        }
+    }
 }
 
 DatabaseManager& DatabaseManager::getInstance(const std::string& dbFileName, const std::string& migrationDir) {
@@ -32,6 +231,15 @@ DatabaseManager& DatabaseManager::getInstance(const std::string& dbFileName, con
     return *instance;
 }
 
+void DatabaseManager::closeInstance() {
+    std::unique_ptr<DatabaseManager> closing;
+    {
+        std::lock_guard<std::mutex> lock(instanceMutex);
+        closing = std::move(instance);
+    }
+    ++resetGeneration;
+}
+
 SQLite::Database& DatabaseManager::getDatabase() {
     return db;
 }
@@ -78,6 +286,7 @@ void DatabaseManager::updateDatabaseVersion(int newVersion, const std::string& p
 
 void DatabaseManager::migrate() {
     spdlog::info("Starting database migration...");
+    statementCache->clear();
     SQLite::Transaction transaction(db);
     try {
         int currentDbVersion = 0;
@@ -160,6 +369,8 @@ void DatabaseManager::migrate() {
 
 void DatabaseManager::reset() {
     spdlog::info("Resetting database...");
+    statementCache->clear();
+    ++resetGeneration;
     SQLite::Transaction transaction(db);
     try {
         executeSqlFile(db, migrationPath + "/reset.sql");
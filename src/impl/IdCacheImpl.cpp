@@ -2,8 +2,17 @@
 #include "DatabaseManager.hpp"
 #include "spdlog/spdlog.h"
 
+#include <algorithm>
+
 namespace atinyvectors {
 
+namespace {
+
+// Ids reserved per VectorSequence write
+const int UNIQUE_ID_BLOCK_SIZE = 1024;
+
+}
+
 std::unique_ptr<IdCache> IdCache::instance = nullptr;
 std::mutex IdCache::instanceMutex;
 
@@ -26,19 +35,21 @@ int IdCache::getVersionId(const std::string& spaceName, int versionUniqueId) {
     }
 
     auto key = std::make_pair(spaceName, versionUniqueId);
-    auto it = forwardCache.find(key);
-
-    if (it != forwardCache.end()) {
-        return it->second;
-    } else {
+    {
         std::lock_guard<std::mutex> lock(cacheMutex);
-        int versionId = fetchFromDb(spaceName, versionUniqueId);
+        auto it = forwardCache.find(key);
+        if (it != forwardCache.end()) {
+            return it->second;
+        }
+    }
 
-        forwardCache[key] = versionId;
-        reverseCache[versionId] = key;
+    int versionId = fetchFromDb(spaceName, versionUniqueId);
 
-        return versionId;
-    }
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    forwardCache[key] = versionId;
+    reverseCache[versionId] = key;
+
+    return versionId;
 }
 
 int IdCache::getDefaultVersionId(const std::string& spaceName) {
@@ -46,31 +57,32 @@ int IdCache::getDefaultVersionId(const std::string& spaceName) {
 }
 
 int IdCache::getDefaultUniqueVersionId(const std::string& spaceName) {
-    int outVersionUniqueId = 0;
-
-    auto cacheIt = spaceNameCache.find(spaceName);
-    if (cacheIt != spaceNameCache.end()) {
-        outVersionUniqueId = cacheIt->second;
-    } else {
+    {
         std::lock_guard<std::mutex> lock(spaceNameCacheMutex);
+        auto cacheIt = spaceNameCache.find(spaceName);
+        if (cacheIt != spaceNameCache.end()) {
+            return cacheIt->second;
+        }
+    }
 
-        auto& db = atinyvectors::DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = atinyvectors::DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
 
-        SQLite::Statement defaultVersionQuery(db,
-            "SELECT v.unique_id FROM Space s "
-            "JOIN Version v ON s.id = v.spaceId "
-            "WHERE s.name = ? AND v.is_default = 1");
-        defaultVersionQuery.bind(1, spaceName);
+    auto defaultVersionQuery = dbManager.prepare(db, "SELECT v.unique_id FROM Space s "
+        "JOIN Version v ON s.id = v.spaceId "
+        "WHERE s.name = ? AND v.is_default = 1");
+    defaultVersionQuery->bind(1, spaceName);
 
-        if (defaultVersionQuery.executeStep()) {
-            outVersionUniqueId = defaultVersionQuery.getColumn(0).getInt();
-            spaceNameCache[spaceName] = outVersionUniqueId;
-        } else {
-            spdlog::error("No default version found for space: {}", spaceName);
-            throw std::runtime_error("No default version found in the database.");
-        }
+    if (!defaultVersionQuery->executeStep()) {
+        spdlog::error("No default version found for space: {}", spaceName);
+        throw std::runtime_error("No default version found in the database.");
     }
 
+    int outVersionUniqueId = defaultVersionQuery->getColumn(0).getInt();
+
+    std::lock_guard<std::mutex> lock(spaceNameCacheMutex);
+    spaceNameCache[spaceName] = outVersionUniqueId;
+
     return outVersionUniqueId;
 }
 
@@ -80,68 +92,114 @@ int IdCache::getVectorIndexId(const std::string& spaceName, int versionUniqueId)
     }
 
     auto key = std::make_pair(spaceName, versionUniqueId);
-    auto it = vectorIndexReverseCache.find(key);
-
-    if (it != vectorIndexReverseCache.end()) {
-        return it->second;
-    } else {
+    {
         std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+        auto it = vectorIndexReverseCache.find(key);
+        if (it != vectorIndexReverseCache.end()) {
+            return it->second;
+        }
+    }
 
-        int versionId = getVersionId(spaceName, versionUniqueId);
+    int versionId = getVersionId(spaceName, versionUniqueId);
 
-        auto& db = DatabaseManager::getInstance().getDatabase();
-        SQLite::Statement queryDefaultIndex(db, "SELECT id FROM VectorIndex WHERE versionId = ? AND is_default = 1");
-        queryDefaultIndex.bind(1, versionId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto queryDefaultIndex = dbManager.prepare(db, "SELECT id FROM VectorIndex WHERE versionId = ? AND is_default = 1");
+    queryDefaultIndex->bind(1, versionId);
 
-        if (queryDefaultIndex.executeStep()) {
-            int vectorIndexId = queryDefaultIndex.getColumn(0).getInt();
+    if (!queryDefaultIndex->executeStep()) {
+        spdlog::error("No default vectorIndex found in the database for spaceName: {}, versionUniqueId: {}", spaceName, versionUniqueId);
+        throw std::runtime_error("No default vectorIndex found in the database.");
+    }
 
-            vectorIndexForwardCache[vectorIndexId] = key;
-            vectorIndexReverseCache[key] = vectorIndexId;
+    int vectorIndexId = queryDefaultIndex->getColumn(0).getInt();
 
-            return vectorIndexId;
-        } else {
-            spdlog::error("No default vectorIndex found in the database for spaceName: {}, versionUniqueId: {}", spaceName, versionUniqueId);
-            throw std::runtime_error("No default vectorIndex found in the database.");
+    std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+    vectorIndexForwardCache[vectorIndexId] = key;
+    vectorIndexReverseCache[key] = vectorIndexId;
+
+    return vectorIndexId;
+}
+
+std::pair<std::string, int> IdCache::getSpaceNameAndVersionUniqueId(int versionId) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = reverseCache.find(versionId);
+        if (it != reverseCache.end()) {
+            return it->second;
         }
     }
+
+    auto result = fetchByVersionIdFromDb(versionId);
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    forwardCache[result] = versionId;
+    reverseCache[versionId] = result;
+
+    return result;
 }
 
-std::pair<std::string, int> IdCache::getSpaceNameAndVersionUniqueId(int versionId) {
-    auto it = reverseCache.find(versionId);
+std::pair<std::string, int> IdCache::getSpaceNameAndVersionUniqueIdByVectorIndexId(int vectorIndexId) {
+    {
+        std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+        auto it = vectorIndexForwardCache.find(vectorIndexId);
+        if (it != vectorIndexForwardCache.end()) {
+            return it->second;
+        }
+    }
 
-    if (it != reverseCache.end()) {
-        return it->second;
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT versionId FROM VectorIndex WHERE id = ?");
+    query->bind(1, vectorIndexId);
+
+    int versionId = -1;
+    if (query->executeStep()) {
+        versionId = query->getColumn(0).getInt();
     } else {
-        return fetchByVersionIdFromDb(versionId);
+        spdlog::error("VectorIndex with id {} not found in the database.", vectorIndexId);
+        throw std::runtime_error("VectorIndex not found in the database.");
     }
+
+    std::pair<std::string, int> result = getSpaceNameAndVersionUniqueId(versionId);
+
+    std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+    vectorIndexForwardCache[vectorIndexId] = result;
+    vectorIndexReverseCache[result] = vectorIndexId;
+
+    return result;
 }
 
-std::pair<std::string, int> IdCache::getSpaceNameAndVersionUniqueIdByVectorIndexId(int vectorIndexId) {
-    auto it = vectorIndexForwardCache.find(vectorIndexId);
-    if (it != vectorIndexForwardCache.end()) {
-        return it->second;
-    } else {
+StoragePrecision IdCache::getStoragePrecision(int vectorIndexId) {
+    {
         std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+        auto it = storagePrecisionCache.find(vectorIndexId);
+        if (it != storagePrecisionCache.end()) {
+            return it->second;
+        }
+    }
 
-        auto& db = DatabaseManager::getInstance().getDatabase();
-        SQLite::Statement query(db, "SELECT versionId FROM VectorIndex WHERE id = ?");
-        query.bind(1, vectorIndexId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT quantizationConfigJson FROM VectorIndex WHERE id = ?");
+    query->bind(1, vectorIndexId);
 
-        int versionId = -1;
-        if (query.executeStep()) {
-            versionId = query.getColumn(0).getInt();
-        } else {
-            spdlog::error("VectorIndex with id {} not found in the database.", vectorIndexId);
-            throw std::runtime_error("VectorIndex not found in the database.");
+    StoragePrecision precision = StoragePrecision::Float32;
+    if (query->executeStep()) {
+        std::string configJson = query->getColumn(0).getString();
+        if (!configJson.empty()) {
+            precision = QuantizationConfig::fromJson(nlohmann::json::parse(configJson)).Storage;
         }
+    }
 
-        std::pair<std::string, int> result = getSpaceNameAndVersionUniqueId(versionId);
-        vectorIndexForwardCache[vectorIndexId] = result;
-        vectorIndexReverseCache[result] = vectorIndexId;
+    std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+    storagePrecisionCache[vectorIndexId] = precision;
+    return precision;
+}
 
-        return result;
-    }
+void IdCache::clearStoragePrecision(int vectorIndexId) {
+    std::lock_guard<std::mutex> lock(vectorIndexCacheMutex);
+    storagePrecisionCache.erase(vectorIndexId);
 }
 
 void IdCache::clean() {
@@ -149,6 +207,7 @@ void IdCache::clean() {
     std::lock_guard<std::mutex> lock2(spaceNameCacheMutex);
     std::lock_guard<std::mutex> lock3(vectorIndexCacheMutex);
     std::lock_guard<std::mutex> lock4(spaceIdCacheMutex);
+    std::lock_guard<std::mutex> lock5(sparseDataPoolMutex);
 
     spdlog::debug("Clearing all caches.");
 
@@ -158,13 +217,14 @@ void IdCache::clean() {
     vectorIndexCache.clear();
     vectorIndexForwardCache.clear();
     vectorIndexReverseCache.clear();
+    storagePrecisionCache.clear();
     rbacTokenCache.clear();
     sparseDataPoolByIndexIdCache.clear();
     spaceIdCache.clear();
 }
 
 void IdCache::clearSpaceNameCache() {
-    std::lock_guard<std::mutex> lock(cacheMutex);
+    std::lock_guard<std::mutex> lock(spaceNameCacheMutex);
     std::lock_guard<std::mutex> lock2(spaceIdCacheMutex);
 
     spdlog::debug("Clearing spaceName cache.");
@@ -174,21 +234,17 @@ void IdCache::clearSpaceNameCache() {
 }
 
 int IdCache::fetchFromDb(const std::string& spaceName, int versionUniqueId) {
-    auto& db = atinyvectors::DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = atinyvectors::DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
 
-    SQLite::Statement query(db, "SELECT V.id FROM Version V "
+    auto query = dbManager.prepare(db, "SELECT V.id FROM Version V "
                                 "JOIN Space S ON V.spaceId = S.id "
                                 "WHERE S.name = ? AND V.unique_id = ?");
-    query.bind(1, spaceName);
-    query.bind(2, versionUniqueId);
-
-    if (query.executeStep()) {
-        int versionId = query.getColumn(0).getInt();
-
-        forwardCache[std::make_pair(spaceName, versionUniqueId)] = versionId;
-        reverseCache[versionId] = std::make_pair(spaceName, versionUniqueId);
+    query->bind(1, spaceName);
+    query->bind(2, versionUniqueId);
 
-        return versionId;
+    if (query->executeStep()) {
+        return query->getColumn(0).getInt();
     } else {
         spdlog::error("No matching data found in the database for spaceName: {}, versionUniqueId: {}", spaceName, versionUniqueId);
         throw std::runtime_error("No matching data found in the database.");
@@ -196,20 +252,17 @@ int IdCache::fetchFromDb(const std::string& spaceName, int versionUniqueId) {
 }
 
 std::pair<std::string, int> IdCache::fetchByVersionIdFromDb(int versionId) {
-    auto& db = atinyvectors::DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = atinyvectors::DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
 
-    SQLite::Statement query(db, "SELECT S.name, V.unique_id FROM Version V "
+    auto query = dbManager.prepare(db, "SELECT S.name, V.unique_id FROM Version V "
                                 "JOIN Space S ON V.spaceId = S.id "
                                 "WHERE V.id = ?");
-    query.bind(1, versionId);
-
-    if (query.executeStep()) {
-        std::string spaceName = query.getColumn(0).getString();
-        int versionUniqueId = query.getColumn(1).getInt();
-
-        forwardCache[std::make_pair(spaceName, versionUniqueId)] = versionId;
-        reverseCache[versionId] = std::make_pair(spaceName, versionUniqueId);
+    query->bind(1, versionId);
 
+    if (query->executeStep()) {
+        std::string spaceName = query->getColumn(0).getString();
+        int versionUniqueId = query->getColumn(1).getInt();
         return std::make_pair(spaceName, versionUniqueId);
     } else {
         spdlog::error("No matching data found in the database for versionId: {}", versionId);
@@ -248,6 +301,7 @@ RbacToken IdCache::fetchRbacTokenFromManager(const std::string& token) {
 }
 
 SparseDataPool& IdCache::getSparseDataPool(int vectorIndexId) {
+    std::lock_guard<std::mutex> lock(sparseDataPoolMutex);
     auto it = sparseDataPoolByIndexIdCache.find(vectorIndexId);
 
     if (it != sparseDataPoolByIndexIdCache.end()) {
@@ -288,12 +342,13 @@ int IdCache::getSpaceId(const std::string& spaceName) {
 
 int IdCache::fetchSpaceIdFromDb(const std::string& spaceName) {
     try {
-        auto& db = DatabaseManager::getInstance().getDatabase();
-        SQLite::Statement query(db, "SELECT id FROM Space WHERE name = ? LIMIT 1");
-        query.bind(1, spaceName);
+        auto& dbManager = DatabaseManager::getInstance();
+        auto& db = dbManager.getReadDatabase();
+        auto query = dbManager.prepare(db, "SELECT id FROM Space WHERE name = ? LIMIT 1");
+        query->bind(1, spaceName);
 
-        if (query.executeStep()) {
-            int spaceId = query.getColumn(0).getInt();
+        if (query->executeStep()) {
+            int spaceId = query->getColumn(0).getInt();
             spdlog::debug("Fetched spaceId from DB: {} = {}", spaceName, spaceId);
             return spaceId;
         } else {
@@ -306,4 +361,94 @@ int IdCache::fetchSpaceIdFromDb(const std::string& spaceName) {
     }
 }
 
+int IdCache::allocateVectorUniqueIds(int versionId, int count) {
+    std::lock_guard<std::mutex> lock(uniqueIdSequenceMutex);
+    UniqueIdSequence& sequence = getUniqueIdSequence(versionId);
+
+    if (sequence.next + count > sequence.reservedUntil) {
+        extendUniqueIdReservation(versionId, sequence, count);
+    }
+
+    int first = sequence.next;
+    sequence.next += count;
+    return first;
+}
+
+void IdCache::reserveVectorUniqueIds(int versionId, int count) {
+    std::lock_guard<std::mutex> lock(uniqueIdSequenceMutex);
+    UniqueIdSequence& sequence = getUniqueIdSequence(versionId);
+
+    if (sequence.next + count > sequence.reservedUntil) {
+        extendUniqueIdReservation(versionId, sequence, count);
+    }
+}
+
+void IdCache::resetVectorUniqueIdSequences() {
+    std::lock_guard<std::mutex> lock(uniqueIdSequenceMutex);
+    uniqueIdSequences.clear();
+}
+
+void IdCache::observeVectorUniqueId(int versionId, int uniqueId) {
+    std::lock_guard<std::mutex> lock(uniqueIdSequenceMutex);
+    UniqueIdSequence& sequence = getUniqueIdSequence(versionId);
+
+    // Only the in-memory cursor moves; a restart reseeds from MAX(unique_id)
+    if (uniqueId >= sequence.next) {
+        sequence.next = uniqueId + 1;
+    }
+}
+
+IdCache::UniqueIdSequence& IdCache::getUniqueIdSequence(int versionId) {
+    auto& dbManager = DatabaseManager::getInstance();
+    if (uniqueIdSequenceGeneration != dbManager.getResetGeneration()) {
+        uniqueIdSequences.clear();
+        uniqueIdSequenceGeneration = dbManager.getResetGeneration();
+    }
+
+    auto it = uniqueIdSequences.find(versionId);
+    if (it != uniqueIdSequences.end()) {
+        return it->second;
+    }
+
+    // Seed once per version. Uses the writer so rows of an open transaction count.
+    auto& db = dbManager.getDatabase();
+
+    int persistedNext = 1;
+    auto sequenceQuery = dbManager.prepare(db, "SELECT nextUniqueId FROM VectorSequence WHERE versionId = ?");
+    sequenceQuery->bind(1, versionId);
+    if (sequenceQuery->executeStep()) {
+        persistedNext = sequenceQuery->getColumn(0).getInt();
+    }
+
+    auto maxQuery = dbManager.prepare(db, "SELECT IFNULL(MAX(unique_id), 0) + 1 FROM Vector WHERE versionId = ?");
+    maxQuery->bind(1, versionId);
+    maxQuery->executeStep();
+    int usedNext = maxQuery->getColumn(0).getInt();
+
+    UniqueIdSequence sequence;
+    sequence.next = std::max(persistedNext, usedNext);
+    sequence.reservedUntil = sequence.next;
+
+    spdlog::debug("Seeded unique_id sequence for versionId={} at {}", versionId, sequence.next);
+    return uniqueIdSequences.emplace(versionId, sequence).first->second;
+}
+
+void IdCache::extendUniqueIdReservation(int versionId, UniqueIdSequence& sequence, int count) {
+    // Never move the bound backwards: if the transaction that persisted the previous
+    // bound rolled back, ids below it may still have been handed out in memory.
+    int newReservedUntil = std::max(sequence.reservedUntil, sequence.next) + std::max(count, UNIQUE_ID_BLOCK_SIZE);
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db,
+        "INSERT INTO VectorSequence (versionId, nextUniqueId) VALUES (?, ?) "
+        "ON CONFLICT(versionId) DO UPDATE SET nextUniqueId = MAX(nextUniqueId, excluded.nextUniqueId)");
+    query->bind(1, versionId);
+    query->bind(2, newReservedUntil);
+    query->exec();
+
+    sequence.reservedUntil = newReservedUntil;
+    spdlog::debug("Reserved unique_ids for versionId={} up to {}", versionId, newReservedUntil);
+}
+
 }  // namespace atinyvectors
@@ -1,4 +1,6 @@
 #include "algo/FaissIndexLRUCache.hpp"
+#include "algo/VectorSegmentStore.hpp"
+#include "filter/MetadataBitmapIndex.hpp"
 #include "Snapshot.hpp"
 #include "DatabaseManager.hpp"
 #include "IdCache.hpp"
@@ -100,7 +102,11 @@ void zipDirectoryAndDatabase(const std::string& directoryPath, const std::string
 }
 
 void backupDatabase(const std::string& backupFileName) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+
+    // Fold the WAL into the main file so the snapshot does not carry a long log
+    dbManager.checkpoint(true);
 
     // Open a destination database file for backup
     SQLite::Database destDB(backupFileName, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
@@ -276,7 +282,10 @@ int SnapshotManager::createSnapshot(const std::vector<std::pair<std::string, int
 void SnapshotManager::restoreSnapshot(const std::string& zipFileName, const std::string& targetDirectory) {
     // clean memory caches
     IdCache::getInstance().clean();
+    IdCache::getInstance().resetVectorUniqueIdSequences();
     FaissIndexLRUCache::getInstance().clean();
+    VectorSegmentStoreManager::getInstance().clean();
+    filter::MetadataBitmapIndex::getInstance().clean();
 
     // Create the target directory if it does not exist
     if (!fs::exists(targetDirectory)) {
@@ -317,6 +326,11 @@ void SnapshotManager::restoreSnapshot(const std::string& zipFileName, const std:
             }
             spdlog::info("File-based database restored successfully from file: {}", zipFileName);
         }
+
+        // Caches that follow the reset generation, like the metadata indexes of
+        // each version, were built from the replaced contents
+        dbManager.markReplaced();
+        dbManager.checkpoint(true);
     } catch (const std::exception& e) {
         spdlog::error("Error occurred during database restoration: {}", e.what());
         throw;
@@ -1,4 +1,6 @@
 #include "algo/FaissIndexLRUCache.hpp"
+#include "algo/VectorSegmentStore.hpp"
+#include "filter/MetadataBitmapIndex.hpp"
 #include "Space.hpp"
 #include "DatabaseManager.hpp"
 #include "IdCache.hpp"
@@ -53,10 +55,10 @@ std::vector<Space> executeSpaceSelectQuery(const std::string& queryStr) {
 // Helper function to retrieve all version IDs associated with a space
 std::vector<int> getVersionIdsBySpaceId(SQLite::Database& db, int spaceId) {
     std::vector<int> versionIds;
-    SQLite::Statement query(db, "SELECT id FROM Version WHERE spaceId = ?");
-    query.bind(1, spaceId);
-    while (query.executeStep()) {
-        versionIds.push_back(query.getColumn(0).getInt());
+    auto query = DatabaseManager::getInstance().prepare(db, "SELECT id FROM Version WHERE spaceId = ?");
+    query->bind(1, spaceId);
+    while (query->executeStep()) {
+        versionIds.push_back(query->getColumn(0).getInt());
     }
     return versionIds;
 }
@@ -164,14 +166,15 @@ SpaceManager& SpaceManager::getInstance() {
 }
 
 int SpaceManager::addSpace(Space& space) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
 
     space.created_time_utc = getCurrentTimeUTC();
     space.updated_time_utc = getCurrentTimeUTC();
 
-    SQLite::Statement query(db, "INSERT INTO Space (name, description, created_time_utc, updated_time_utc) VALUES (?, ?, ?, ?)");
-    bindSpaceParameters(query, space);
-    query.exec();
+    auto query = dbManager.prepare(db, "INSERT INTO Space (name, description, created_time_utc, updated_time_utc) VALUES (?, ?, ?, ?)");
+    bindSpaceParameters(*query, space);
+    query->exec();
 
     int insertedId = static_cast<int>(db.getLastInsertRowid());
     space.id = insertedId;
@@ -184,24 +187,26 @@ std::vector<Space> SpaceManager::getAllSpaces() {
 }
 
 Space SpaceManager::getSpaceById(int id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, name, description, created_time_utc, updated_time_utc FROM Space WHERE id = ?");
-    query.bind(1, id);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, name, description, created_time_utc, updated_time_utc FROM Space WHERE id = ?");
+    query->bind(1, id);
 
-    if (query.executeStep()) {
-        return createSpaceFromQuery(query);
+    if (query->executeStep()) {
+        return createSpaceFromQuery(*query);
     }
 
     throw std::runtime_error("Space not found");
 }
 
 Space SpaceManager::getSpaceByName(const std::string& name) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, name, description, created_time_utc, updated_time_utc FROM Space WHERE name = ?");
-    query.bind(1, name);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, name, description, created_time_utc, updated_time_utc FROM Space WHERE name = ?");
+    query->bind(1, name);
 
-    if (query.executeStep()) {
-        return createSpaceFromQuery(query);
+    if (query->executeStep()) {
+        return createSpaceFromQuery(*query);
     }
 
     throw std::runtime_error("Space with name '" + name + "' not found");
@@ -210,17 +215,19 @@ Space SpaceManager::getSpaceByName(const std::string& name) {
 void SpaceManager::updateSpace(Space& space) {
     space.updated_time_utc = getCurrentTimeUTC();
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "UPDATE Space SET name = ?, description = ?, created_time_utc = ?, updated_time_utc = ? WHERE id = ?");
-    bindSpaceParameters(query, space);
-    query.bind(5, space.id);
-    query.exec();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "UPDATE Space SET name = ?, description = ?, created_time_utc = ?, updated_time_utc = ? WHERE id = ?");
+    bindSpaceParameters(*query, space);
+    query->bind(5, space.id);
+    query->exec();
 }
 
 void SpaceManager::deleteSpace(int spaceId) {
     spdlog::info("deleteSpace: Deleting space with ID {}", spaceId);
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     auto space = getSpaceById(spaceId);
     auto spaceName = space.name;
 
@@ -360,9 +367,9 @@ void SpaceManager::deleteSpace(int spaceId) {
 
         // 9. Finally, delete the Space
         spdlog::info("deleteSpace: Deleting the Space with ID {}.", spaceId);
-        SQLite::Statement deleteSpaceQuery(db, "DELETE FROM Space WHERE id = ?;");
-        deleteSpaceQuery.bind(1, spaceId);
-        deleteSpaceQuery.exec();
+        auto deleteSpaceQuery = dbManager.prepare(db, "DELETE FROM Space WHERE id = ?;");
+        deleteSpaceQuery->bind(1, spaceId);
+        deleteSpaceQuery->exec();
 
         // Commit transaction
         spdlog::info("deleteSpace: Committing transaction.");
@@ -371,6 +378,8 @@ void SpaceManager::deleteSpace(int spaceId) {
         spdlog::info("deleteSpace: Cleaning caches.");
         IdCache::getInstance().clean();
         FaissIndexLRUCache::getInstance().clean();
+        VectorSegmentStoreManager::getInstance().clean();
+        filter::MetadataBitmapIndex::getInstance().clean();
         spdlog::info("deleteSpace: Successfully deleted space with ID {}.", spaceId);
     } catch (const std::exception& e) {
         spdlog::error("deleteSpace: Error occurred while deleting space with ID {}: {}", spaceId, e.what());
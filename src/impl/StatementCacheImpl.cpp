@@ -0,0 +1,101 @@
+#include "StatementCache.hpp"
+#include "spdlog/spdlog.h"
+
+namespace atinyvectors {
+
+CachedStatement::CachedStatement(StatementCache* owner, const std::string& sql, std::unique_ptr<SQLite::Statement> statement)
+    : owner(owner), sql(sql), statement(std::move(statement)) {
+}
+
+CachedStatement::CachedStatement(CachedStatement&& other) noexcept
+    : owner(other.owner), sql(std::move(other.sql)), statement(std::move(other.statement)) {
+    other.owner = nullptr;
+}
+
+CachedStatement::~CachedStatement() {
+    if (!statement || !owner) {
+        return;
+    }
+
+    // reset() ends the statement's read transaction so WAL readers see new commits
+    statement->tryReset();
+    try {
+        statement->clearBindings();
+    } catch (const std::exception& e) {
+        spdlog::warn("Dropping cached statement after clearBindings failed: {}", e.what());
+        return;
+    }
+
+    owner->release(sql, std::move(statement));
+}
+
+StatementCache::StatementCache(SQLite::Database& db, size_t capacity)
+    : db(db), capacity(capacity) {
+}
+
+StatementCache::~StatementCache() {
+    clear();
+}
+
+CachedStatement StatementCache::acquire(const std::string& sql) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = entries.find(sql);
+        if (it != entries.end()) {
+            lruList.splice(lruList.begin(), lruList, it->second.lruIt);
+            if (!it->second.idle.empty()) {
+                auto statement = std::move(it->second.idle.back());
+                it->second.idle.pop_back();
+                --idleCount;
+                ++hits;
+                return CachedStatement(this, sql, std::move(statement));
+            }
+        }
+        ++misses;
+    }
+
+    // Prepare outside the lock; a statement already checked out (e.g. the same
+    // query in a nested call) simply gets a second prepared copy.
+    auto statement = std::make_unique<SQLite::Statement>(db, sql);
+    if (capacity == 0) {
+        return CachedStatement(nullptr, sql, std::move(statement));
+    }
+    return CachedStatement(this, sql, std::move(statement));
+}
+
+void StatementCache::release(const std::string& sql, std::unique_ptr<SQLite::Statement> statement) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto it = entries.find(sql);
+    if (it == entries.end()) {
+        lruList.push_front(sql);
+        it = entries.emplace(sql, Entry{{}, lruList.begin()}).first;
+    }
+    it->second.idle.push_back(std::move(statement));
+    ++idleCount;
+
+    evictIfNeeded();
+}
+
+void StatementCache::evictIfNeeded() {
+    while (idleCount > capacity && !lruList.empty()) {
+        auto it = entries.find(lruList.back());
+        idleCount -= it->second.idle.size();
+        entries.erase(it);
+        lruList.pop_back();
+    }
+}
+
+void StatementCache::clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    entries.clear();
+    lruList.clear();
+    idleCount = 0;
+}
+
+size_t StatementCache::size() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return idleCount;
+}
+
+}
@@ -0,0 +1,143 @@
+#include "TaskExecutor.hpp"
+#include "Config.hpp"
+#include "spdlog/spdlog.h"
+
+#include <stdexcept>
+
+namespace atinyvectors {
+
+std::unique_ptr<TaskExecutor> TaskExecutor::instance;
+std::mutex TaskExecutor::instanceMutex;
+
+TaskExecutor::TaskExecutor(size_t threadCount, size_t queueCapacity)
+    : queueCapacity(queueCapacity) {
+    if (threadCount == 0 || queueCapacity == 0) {
+        throw std::invalid_argument("TaskExecutor requires at least one thread and a positive queue capacity");
+    }
+
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&TaskExecutor::workerLoop, this);
+    }
+}
+
+TaskExecutor::~TaskExecutor() {
+    std::deque<QueuedTask> dropped;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        dropped.swap(queue);
+    }
+    queueCondition.notify_all();
+
+    if (!dropped.empty()) {
+        spdlog::warn("Async executor destroyed with {} queued tasks; cancelling them", dropped.size());
+    }
+    for (auto& task : dropped) {
+        if (!task.cancel) {
+            continue;
+        }
+        try {
+            task.cancel();
+        } catch (const std::exception& e) {
+            spdlog::error("Cancelling async task failed: {}", e.what());
+        } catch (...) {
+            spdlog::error("Cancelling async task failed with an unknown exception");
+        }
+    }
+
+    shutdown();
+}
+
+void TaskExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void TaskExecutor::shutdownInstance() {
+    std::unique_ptr<TaskExecutor> executor;
+    {
+        std::lock_guard<std::mutex> lock(instanceMutex);
+        executor = std::move(instance);
+    }
+    if (executor) {
+        executor->shutdown();
+    }
+}
+
+TaskExecutor& TaskExecutor::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        const Config& config = Config::getInstance();
+        instance.reset(new TaskExecutor(static_cast<size_t>(config.getAsyncThreads()),
+                                        static_cast<size_t>(config.getAsyncQueueSize())));
+        spdlog::debug("Async executor started with {} threads and queue size {}",
+                      config.getAsyncThreads(), config.getAsyncQueueSize());
+    }
+    return *instance;
+}
+
+bool TaskExecutor::trySubmit(Task task, Task cancel) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping || queue.size() >= queueCapacity) {
+            return false;
+        }
+        queue.push_back({std::move(task), std::move(cancel)});
+    }
+    queueCondition.notify_one();
+    return true;
+}
+
+void TaskExecutor::waitIdle() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    idleCondition.wait(lock, [this]() { return queue.empty() && running == 0; });
+}
+
+size_t TaskExecutor::pending() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return queue.size();
+}
+
+void TaskExecutor::workerLoop() {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;  // stopping and drained
+            }
+            task = std::move(queue.front().run);
+            queue.pop_front();
+            ++running;
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            spdlog::error("Async task failed: {}", e.what());
+        } catch (...) {
+            spdlog::error("Async task failed with an unknown exception");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            --running;
+            if (queue.empty() && running == 0) {
+                idleCondition.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace atinyvectors
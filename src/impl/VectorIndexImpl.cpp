@@ -1,5 +1,6 @@
 #include "VectorIndex.hpp"
 #include "DatabaseManager.hpp"
+#include "IdCache.hpp"
 #include "utils/Utils.hpp"
 
 using namespace atinyvectors::utils;
@@ -60,22 +61,23 @@ VectorIndexManager& VectorIndexManager::getInstance() {
 }
 
 int VectorIndexManager::addVectorIndex(VectorIndex& vectorIndex) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
         
     if (vectorIndex.is_default) {
-        SQLite::Statement updateQuery(db, "UPDATE VectorIndex SET is_default = 0 WHERE versionId = ?");
-        updateQuery.bind(1, vectorIndex.versionId);
-        updateQuery.exec();
+        auto updateQuery = dbManager.prepare(db, "UPDATE VectorIndex SET is_default = 0 WHERE versionId = ?");
+        updateQuery->bind(1, vectorIndex.versionId);
+        updateQuery->exec();
     }
 
     vectorIndex.create_date_utc = getCurrentTimeUTC();
     vectorIndex.updated_time_utc = getCurrentTimeUTC();
 
-    SQLite::Statement insertQuery(db, "INSERT INTO VectorIndex (versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
-    bindVectorIndexParameters(insertQuery, vectorIndex);
-    insertQuery.exec();
+    auto insertQuery = dbManager.prepare(db, "INSERT INTO VectorIndex (versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    bindVectorIndexParameters(*insertQuery, vectorIndex);
+    insertQuery->exec();
 
     int insertedId = static_cast<int>(db.getLastInsertRowid());
     vectorIndex.id = insertedId;
@@ -86,86 +88,95 @@ int VectorIndexManager::addVectorIndex(VectorIndex& vectorIndex) {
 }
 
 std::vector<VectorIndex> VectorIndexManager::getAllVectorIndices() {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default FROM VectorIndex");
-    return executeSelectQuery(query);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default FROM VectorIndex");
+    return executeSelectQuery(*query);
 }
 
 VectorIndex VectorIndexManager::getVectorIndexById(int id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default FROM VectorIndex WHERE id = ?");
-    query.bind(1, id);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default FROM VectorIndex WHERE id = ?");
+    query->bind(1, id);
 
-    if (query.executeStep()) {
-        return createVectorIndexFromQuery(query);
+    if (query->executeStep()) {
+        return createVectorIndexFromQuery(*query);
     }
 
     throw std::runtime_error("VectorIndex not found");
 }
 
 std::vector<VectorIndex> VectorIndexManager::getVectorIndicesByVersionId(int versionId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default FROM VectorIndex WHERE versionId = ?");
-    query.bind(1, versionId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, versionId, vectorValueType, name, metricType, dimension, hnswConfigJson, quantizationConfigJson, create_date_utc, updated_time_utc, is_default FROM VectorIndex WHERE versionId = ?");
+    query->bind(1, versionId);
 
-    return executeSelectQuery(query);
+    return executeSelectQuery(*query);
 }
 
 void VectorIndexManager::updateVectorIndex(VectorIndex& vectorIndex) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     vectorIndex.updated_time_utc = getCurrentTimeUTC();
 
     SQLite::Transaction transaction(db);
     
     if (vectorIndex.is_default) {
-        SQLite::Statement updateQuery(db, "UPDATE VectorIndex SET is_default = 0 WHERE versionId = ? AND id != ?");
-        updateQuery.bind(1, vectorIndex.versionId);
-        updateQuery.bind(2, vectorIndex.id);
-        updateQuery.exec();
+        auto updateQuery = dbManager.prepare(db, "UPDATE VectorIndex SET is_default = 0 WHERE versionId = ? AND id != ?");
+        updateQuery->bind(1, vectorIndex.versionId);
+        updateQuery->bind(2, vectorIndex.id);
+        updateQuery->exec();
     }
 
-    SQLite::Statement query(db, "UPDATE VectorIndex SET versionId = ?, vectorValueType = ?, name = ?, metricType = ?, dimension = ?, hnswConfigJson = ?, quantizationConfigJson = ?, create_date_utc = ?, updated_time_utc = ?, is_default = ? WHERE id = ?");
-    bindVectorIndexParameters(query, vectorIndex);
-    query.bind(11, vectorIndex.id);
-    query.exec();
+    auto query = dbManager.prepare(db, "UPDATE VectorIndex SET versionId = ?, vectorValueType = ?, name = ?, metricType = ?, dimension = ?, hnswConfigJson = ?, quantizationConfigJson = ?, create_date_utc = ?, updated_time_utc = ?, is_default = ? WHERE id = ?");
+    bindVectorIndexParameters(*query, vectorIndex);
+    query->bind(11, vectorIndex.id);
+    query->exec();
     
     transaction.commit();
+
+    IdCache::getInstance().clearStoragePrecision(vectorIndex.id);
 }
 
 void VectorIndexManager::deleteVectorIndex(int id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
 
-    SQLite::Statement checkQuery(db, "SELECT versionId, is_default FROM VectorIndex WHERE id = ?");
-    checkQuery.bind(1, id);
+    auto checkQuery = dbManager.prepare(db, "SELECT versionId, is_default FROM VectorIndex WHERE id = ?");
+    checkQuery->bind(1, id);
     
     int versionId = -1;
     bool isDefault = false;
 
-    if (checkQuery.executeStep()) {
-        versionId = checkQuery.getColumn(0).getInt();
-        isDefault = checkQuery.getColumn(1).getInt() == 1;
+    if (checkQuery->executeStep()) {
+        versionId = checkQuery->getColumn(0).getInt();
+        isDefault = checkQuery->getColumn(1).getInt() == 1;
     }
 
-    SQLite::Statement deleteQuery(db, "DELETE FROM VectorIndex WHERE id = ?");
-    deleteQuery.bind(1, id);
-    deleteQuery.exec();
+    auto deleteQuery = dbManager.prepare(db, "DELETE FROM VectorIndex WHERE id = ?");
+    deleteQuery->bind(1, id);
+    deleteQuery->exec();
 
     if (isDefault) {
-        SQLite::Statement findRecentQuery(db, "SELECT id FROM VectorIndex WHERE versionId = ? ORDER BY create_date_utc DESC LIMIT 1");
-        findRecentQuery.bind(1, versionId);
+        auto findRecentQuery = dbManager.prepare(db, "SELECT id FROM VectorIndex WHERE versionId = ? ORDER BY create_date_utc DESC LIMIT 1");
+        findRecentQuery->bind(1, versionId);
         
-        if (findRecentQuery.executeStep()) {
-            int recentId = findRecentQuery.getColumn(0).getInt();
-            SQLite::Statement setDefaultQuery(db, "UPDATE VectorIndex SET is_default = 1 WHERE id = ?");
-            setDefaultQuery.bind(1, recentId);
-            setDefaultQuery.exec();
+        if (findRecentQuery->executeStep()) {
+            int recentId = findRecentQuery->getColumn(0).getInt();
+            auto setDefaultQuery = dbManager.prepare(db, "UPDATE VectorIndex SET is_default = 1 WHERE id = ?");
+            setDefaultQuery->bind(1, recentId);
+            setDefaultQuery->exec();
         }
     }
 
     transaction.commit();
+
+    IdCache::getInstance().clearStoragePrecision(id);
 }
 
 } // namespace atinyvectors
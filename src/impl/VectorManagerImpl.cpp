@@ -2,11 +2,17 @@
 #include <sstream>
 #include <cstring>
 #include <unordered_set>
+#include <algorithm>
+#include <iterator>
 
 #include "Vector.hpp"
 #include "VectorIndex.hpp"
+#include "VectorMetadata.hpp"
 #include "DatabaseManager.hpp"
+#include "IdCache.hpp"
 #include "algo/FaissIndexLRUCache.hpp"
+#include "algo/VectorSegmentStore.hpp"
+#include "filter/MetadataBitmapIndex.hpp"
 #include <SQLiteCpp/SQLiteCpp.h>
 #include "spdlog/spdlog.h"
 #include "Config.hpp"
@@ -14,6 +20,53 @@
 using namespace atinyvectors;
 using namespace atinyvectors::algo;
 
+namespace {
+
+// Vectors joined with their values; rows for one vector are adjacent because
+// every loader orders by V.id (or unique_id, then V.id) before VV.id.
+const std::string VECTOR_WITH_VALUES_COLUMNS =
+    "V.id, V.versionId, V.unique_id, V.type, V.deleted, VV.id, VV.vectorId, VV.vectorIndexId, VV.type, VV.data";
+
+// Upper bound on host parameters per IN list; SQLite builds before 3.32 allow 999
+const size_t MAX_IN_LIST_PARAMS = 500;
+
+std::vector<Vector> loadVectorsWithValues(SQLite::Statement& query) {
+    std::vector<Vector> vectors;
+
+    while (query.executeStep()) {
+        long vectorId = query.getColumn(0).getInt64();
+        if (vectors.empty() || vectors.back().id != vectorId) {
+            Vector vector;
+            vector.id = vectorId;
+            vector.versionId = query.getColumn(1).getInt();
+            vector.unique_id = query.getColumn(2).getInt();
+            vector.type = static_cast<VectorValueType>(query.getColumn(3).getInt());
+            vector.deleted = query.getColumn(4).getInt() != 0;
+            vectors.push_back(std::move(vector));
+        }
+
+        // LEFT JOIN: a vector without values yields a single row of NULLs
+        if (query.getColumn(5).isNull()) {
+            continue;
+        }
+
+        VectorValue value;
+        value.id = query.getColumn(5).getInt();
+        value.vectorId = query.getColumn(6).getInt64();
+        value.vectorIndexId = query.getColumn(7).getInt();
+        value.type = static_cast<VectorValueType>(query.getColumn(8).getInt());
+
+        SQLite::Column blob = query.getColumn(9);
+        value.deserialize(static_cast<const uint8_t*>(blob.getBlob()), static_cast<size_t>(blob.getBytes()));
+
+        vectors.back().values.push_back(std::move(value));
+    }
+
+    return vectors;
+}
+
+} // anonymous namespace
+
 std::unique_ptr<VectorManager> VectorManager::instance;
 std::mutex VectorManager::instanceMutex;
 
@@ -30,59 +83,59 @@ VectorManager& VectorManager::getInstance() {
 }
 
 int VectorManager::addVector(Vector& vector, bool autoflush) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     spdlog::debug("Starting transaction for adding/updating vector with UniqueID: {}, VersionID: {}", vector.unique_id, vector.versionId);
     SQLite::Transaction transaction(db);
 
     try {
         if (vector.unique_id > 0) {
             spdlog::debug("Checking if vector with UniqueID: {} and VersionID: {} already exists", vector.unique_id, vector.versionId);
-            SQLite::Statement checkQuery(db, "SELECT id FROM Vector WHERE versionId = ? AND unique_id = ?");
-            checkQuery.bind(1, vector.versionId);
-            checkQuery.bind(2, vector.unique_id);
+            auto checkQuery = dbManager.prepare(db, "SELECT id FROM Vector WHERE versionId = ? AND unique_id = ?");
+            checkQuery->bind(1, vector.versionId);
+            checkQuery->bind(2, vector.unique_id);
 
-            if (checkQuery.executeStep()) {
-                vector.id = checkQuery.getColumn(0).getInt64();
+            if (checkQuery->executeStep()) {
+                vector.id = checkQuery->getColumn(0).getInt64();
                 spdlog::debug("Vector with UniqueID {} exists. Updating vector ID: {}", vector.unique_id, vector.id);
 
-                SQLite::Statement updateQuery(db, "UPDATE Vector SET versionId = ?, unique_id = ?, type = ?, deleted = ? WHERE id = ?");
-                updateQuery.bind(1, vector.versionId);
-                updateQuery.bind(2, vector.unique_id);
-                updateQuery.bind(3, static_cast<int>(vector.type));
-                updateQuery.bind(4, vector.deleted ? 1 : 0);
-                updateQuery.bind(5, static_cast<int>(vector.id));
-                updateQuery.exec();
-
-                SQLite::Statement deleteValueQuery(db, "DELETE FROM VectorValue WHERE vectorId = ?");
-                deleteValueQuery.bind(1, static_cast<int>(vector.id));
-                deleteValueQuery.exec();
+                auto updateQuery = dbManager.prepare(db, "UPDATE Vector SET versionId = ?, unique_id = ?, type = ?, deleted = ? WHERE id = ?");
+                updateQuery->bind(1, vector.versionId);
+                updateQuery->bind(2, vector.unique_id);
+                updateQuery->bind(3, static_cast<int>(vector.type));
+                updateQuery->bind(4, vector.deleted ? 1 : 0);
+                updateQuery->bind(5, static_cast<int>(vector.id));
+                updateQuery->exec();
+
+                auto deleteValueQuery = dbManager.prepare(db, "DELETE FROM VectorValue WHERE vectorId = ?");
+                deleteValueQuery->bind(1, static_cast<int>(vector.id));
+                deleteValueQuery->exec();
             } else {
                 spdlog::debug("Vector with UniqueID {} does not exist. Inserting new vector.", vector.unique_id);
 
-                SQLite::Statement query(db, "INSERT INTO Vector (versionId, unique_id, type, deleted) VALUES (?, ?, ?, ?)");
-                query.bind(1, vector.versionId);
-                query.bind(2, vector.unique_id);
-                query.bind(3, static_cast<int>(vector.type));
-                query.bind(4, vector.deleted ? 1 : 0);
-                query.exec();
+                auto query = dbManager.prepare(db, "INSERT INTO Vector (versionId, unique_id, type, deleted) VALUES (?, ?, ?, ?)");
+                query->bind(1, vector.versionId);
+                query->bind(2, vector.unique_id);
+                query->bind(3, static_cast<int>(vector.type));
+                query->bind(4, vector.deleted ? 1 : 0);
+                query->exec();
 
                 vector.id = static_cast<int>(db.getLastInsertRowid());
                 spdlog::debug("Inserted new vector with auto-assigned ID: {}", vector.id);
+
+                IdCache::getInstance().observeVectorUniqueId(vector.versionId, vector.unique_id);
             }
         } else {
             spdlog::debug("Inserting new vector without UniqueID for VersionID: {}", vector.versionId);
 
-            SQLite::Statement maxUniqueIdQuery(db, "SELECT IFNULL(MAX(unique_id), 0) + 1 FROM Vector WHERE versionId = ?");
-            maxUniqueIdQuery.bind(1, vector.versionId);
-            maxUniqueIdQuery.executeStep();
-            vector.unique_id = maxUniqueIdQuery.getColumn(0).getInt();
+            vector.unique_id = IdCache::getInstance().allocateVectorUniqueIds(vector.versionId);
 
-            SQLite::Statement query(db, "INSERT INTO Vector (versionId, unique_id, type, deleted) VALUES (?, ?, ?, ?)");
-            query.bind(1, vector.versionId);
-            query.bind(2, vector.unique_id);
-            query.bind(3, static_cast<int>(vector.type));
-            query.bind(4, vector.deleted ? 1 : 0);
-            query.exec();
+            auto query = dbManager.prepare(db, "INSERT INTO Vector (versionId, unique_id, type, deleted) VALUES (?, ?, ?, ?)");
+            query->bind(1, vector.versionId);
+            query->bind(2, vector.unique_id);
+            query->bind(3, static_cast<int>(vector.type));
+            query->bind(4, vector.deleted ? 1 : 0);
+            query->exec();
 
             vector.id = static_cast<int>(db.getLastInsertRowid());
             spdlog::debug("Inserted new vector with auto-assigned ID: {}", vector.id);
@@ -101,17 +154,21 @@ int VectorManager::addVector(Vector& vector, bool autoflush) {
 
             spdlog::debug("Inserting VectorValue for vector ID: {}, vectorIndexId: {}", vector.id, value.vectorIndexId);
 
-            SQLite::Statement valueQuery(db, "INSERT INTO VectorValue (vectorId, vectorIndexId, type, data) VALUES (?, ?, ?, ?)");
-            valueQuery.bind(1, vector.id);
-            valueQuery.bind(2, value.vectorIndexId);
-            valueQuery.bind(3, static_cast<int>(value.type));
-            std::vector<uint8_t> serializedData = value.serialize();
-            valueQuery.bind(4, serializedData.data(), static_cast<int>(serializedData.size()));
-            valueQuery.exec();
+            auto valueQuery = dbManager.prepare(db, "INSERT INTO VectorValue (vectorId, vectorIndexId, type, data) VALUES (?, ?, ?, ?)");
+            valueQuery->bind(1, vector.id);
+            valueQuery->bind(2, value.vectorIndexId);
+            valueQuery->bind(3, static_cast<int>(value.type));
+            std::vector<uint8_t> serializedData = value.serialize(IdCache::getInstance().getStoragePrecision(value.vectorIndexId));
+            valueQuery->bind(4, serializedData.data(), static_cast<int>(serializedData.size()));
+            valueQuery->exec();
 
             value.id = static_cast<int>(db.getLastInsertRowid());
             spdlog::debug("Inserted VectorValue with ID: {} for vector ID: {}", value.id, vector.id);
 
+            if (value.type == VectorValueType::Dense && VectorSegmentStoreManager::getInstance().isEnabled()) {
+                VectorSegmentStoreManager::getInstance().appendDenseVector(value.vectorIndexId, vector.id, vector.unique_id, value.denseData);
+            }
+
             // Process based on vector type
             if (value.type == VectorValueType::Dense || value.type == VectorValueType::Sparse || value.type == VectorValueType::MultiVector) {
                 spdlog::debug("Processing HNSW index update for vector ID: {}", vector.id);
@@ -163,270 +220,256 @@ void VectorManager::flush() {
 }
 
 std::vector<Vector> VectorManager::getAllVectors() {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, versionId, unique_id, type, deleted FROM Vector");
-    
-    std::vector<Vector> vectors;
-    while (query.executeStep()) {
-        Vector vector;
-        vector.id = query.getColumn(0).getInt64();
-        vector.versionId = query.getColumn(1).getInt();
-        vector.unique_id = query.getColumn(2).getInt();
-        vector.type = static_cast<VectorValueType>(query.getColumn(3).getInt());
-        vector.deleted = query.getColumn(4).getInt() != 0;
-
-        SQLite::Statement valueQuery(db, "SELECT id, vectorId, vectorIndexId, type, data FROM VectorValue WHERE vectorId = ?");
-        valueQuery.bind(1, vector.id);
-        
-        while (valueQuery.executeStep()) {
-            VectorValue value;
-            value.id = valueQuery.getColumn(0).getInt();
-            value.vectorId = valueQuery.getColumn(1).getInt64();
-            value.vectorIndexId = valueQuery.getColumn(2).getInt();
-            value.type = static_cast<VectorValueType>(valueQuery.getColumn(3).getInt());
-            std::vector<uint8_t> blobData;
-            blobData.assign(static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()), 
-                            static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()) + valueQuery.getColumn(4).getBytes());
-            value.deserialize(blobData);
-            vector.values.push_back(value);
-        }
-
-        vectors.push_back(vector);
-    }
-
-    return vectors;
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db,
+        "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM Vector V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id "
+        "ORDER BY V.id, VV.id");
+
+    return loadVectorsWithValues(*query);
 }
 
 Vector VectorManager::getVectorById(unsigned long long id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE id = ?");
-    query.bind(1, static_cast<int>(id));
-
-    if (query.executeStep()) {
-        Vector vector;
-        vector.id = query.getColumn(0).getInt64();
-        vector.versionId = query.getColumn(1).getInt();
-        vector.unique_id = query.getColumn(2).getInt();
-        vector.type = static_cast<VectorValueType>(query.getColumn(3).getInt());
-        vector.deleted = query.getColumn(4).getInt() != 0;
-
-        // Retrieve associated VectorValues
-        SQLite::Statement valueQuery(db, "SELECT id, vectorId, vectorIndexId, type, data FROM VectorValue WHERE vectorId = ?");
-        valueQuery.bind(1, vector.id);
-        
-        while (valueQuery.executeStep()) {
-            VectorValue value;
-            value.id = valueQuery.getColumn(0).getInt();
-            value.vectorId = valueQuery.getColumn(1).getInt64();
-            value.vectorIndexId = valueQuery.getColumn(2).getInt();
-            value.type = static_cast<VectorValueType>(valueQuery.getColumn(3).getInt());
-
-            std::vector<uint8_t> blobData;
-            blobData.assign(static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()), 
-                            static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()) + valueQuery.getColumn(4).getBytes());
-
-            // Deserialize the data into VectorValue
-            value.deserialize(blobData);
-            vector.values.push_back(value);
-        }
-
-        return vector;
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db,
+        "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM Vector V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id "
+        "WHERE V.id = ? ORDER BY VV.id");
+    query->bind(1, static_cast<int>(id));
+
+    auto vectors = loadVectorsWithValues(*query);
+    if (!vectors.empty()) {
+        return std::move(vectors.front());
     }
 
     throw std::runtime_error("Vector not found");
 }
 
 Vector VectorManager::getVectorByUniqueId(int versionId, int unique_id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE versionId = ? AND unique_id = ?");
-    query.bind(1, versionId);
-    query.bind(2, unique_id);
-
-    if (query.executeStep()) {
-        Vector vector;
-        vector.id = query.getColumn(0).getInt64();
-        vector.versionId = query.getColumn(1).getInt();
-        vector.unique_id = query.getColumn(2).getInt();
-        vector.type = static_cast<VectorValueType>(query.getColumn(3).getInt());
-        vector.deleted = query.getColumn(4).getInt() != 0;
-
-        // Fetch associated VectorValues
-        SQLite::Statement valueQuery(db, "SELECT id, vectorId, vectorIndexId, type, data FROM VectorValue WHERE vectorId = ?");
-        valueQuery.bind(1, vector.id);
-
-        while (valueQuery.executeStep()) {
-            VectorValue value;
-            value.id = valueQuery.getColumn(0).getInt();
-            value.vectorId = valueQuery.getColumn(1).getInt64();
-            value.vectorIndexId = valueQuery.getColumn(2).getInt();
-            value.type = static_cast<VectorValueType>(valueQuery.getColumn(3).getInt());
-            std::vector<uint8_t> blobData;
-            blobData.assign(static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()), 
-                            static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()) + valueQuery.getColumn(4).getBytes());
-
-            value.deserialize(blobData);
-            vector.values.push_back(value);
-        }
-
-        return vector;
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db,
+        "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM Vector V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id "
+        "WHERE V.versionId = ? AND V.unique_id = ? ORDER BY V.id, VV.id");
+    query->bind(1, versionId);
+    query->bind(2, unique_id);
+
+    auto vectors = loadVectorsWithValues(*query);
+    if (!vectors.empty()) {
+        return std::move(vectors.front());
     }
 
     throw std::runtime_error("Vector not found with the specified versionId and unique_id.");
 }
 
 std::vector<Vector> VectorManager::getVectorsByVersionId(int versionId, int start, int limit) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    
-    // Modified SQL query with LIMIT and OFFSET
-    SQLite::Statement query(db, "SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE versionId = ? LIMIT ? OFFSET ?");
-    query.bind(1, versionId);
-    query.bind(2, limit);  // Limit the number of rows returned
-    query.bind(3, start);  // Offset from where to start fetching rows
-    
-    std::vector<Vector> vectors;
-    spdlog::debug("Fetching vectors for versionId: {} with start: {}, limit: {}", versionId, start, limit);
-
-    while (query.executeStep()) {
-        Vector vector;
-        vector.id = query.getColumn(0).getInt64();
-        vector.versionId = query.getColumn(1).getInt();
-        vector.unique_id = query.getColumn(2).getInt();
-        vector.type = static_cast<VectorValueType>(query.getColumn(3).getInt());
-        vector.deleted = query.getColumn(4).getInt() != 0;
-
-        // Retrieve associated VectorValues
-        SQLite::Statement valueQuery(db, "SELECT id, vectorId, vectorIndexId, type, data FROM VectorValue WHERE vectorId = ?");
-        valueQuery.bind(1, vector.id);
-
-        while (valueQuery.executeStep()) {
-            VectorValue value;
-            value.id = valueQuery.getColumn(0).getInt();
-            value.vectorId = valueQuery.getColumn(1).getInt64();
-            value.vectorIndexId = valueQuery.getColumn(2).getInt();
-            value.type = static_cast<VectorValueType>(valueQuery.getColumn(3).getInt());
-
-            std::vector<uint8_t> blobData;
-            blobData.assign(static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()),
-                            static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()) + valueQuery.getColumn(4).getBytes());
-
-            // Deserialize the data into VectorValue
-            value.deserialize(blobData);
-            vector.values.push_back(value);
-        }
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+
+    // Page over Vector first so LIMIT/OFFSET count vectors, not value rows. Ordering
+    // by unique_id walks the (versionId, unique_id) index instead of sorting the version.
+    auto query = dbManager.prepare(db,
+        "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM "
+        "(SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE versionId = ? ORDER BY unique_id LIMIT ? OFFSET ?) V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id "
+        "ORDER BY V.unique_id, V.id, VV.id");
+    query->bind(1, versionId);
+    query->bind(2, limit);  // Limit the number of rows returned
+    query->bind(3, start);  // Offset from where to start fetching rows
 
-        vectors.push_back(vector);
-    }
+    spdlog::debug("Fetching vectors for versionId: {} with start: {}, limit: {}", versionId, start, limit);
+    auto vectors = loadVectorsWithValues(*query);
 
     spdlog::debug("Finished fetching vectors for versionId: {}. Total vectors fetched: {}", versionId, vectors.size());
     return vectors;
 }
 
+std::vector<Vector> VectorManager::getVectorsByVersionIdAfter(int versionId, int afterUniqueId, int limit) {
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+
+    // Seeks on the (versionId, unique_id) index instead of scanning past skipped rows
+    auto query = dbManager.prepare(db,
+        "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM "
+        "(SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE versionId = ? AND unique_id > ? ORDER BY unique_id LIMIT ?) V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id "
+        "ORDER BY V.unique_id, V.id, VV.id");
+    query->bind(1, versionId);
+    query->bind(2, afterUniqueId);
+    query->bind(3, limit);
+
+    spdlog::debug("Fetching vectors for versionId: {} after unique_id: {}, limit: {}", versionId, afterUniqueId, limit);
+    return loadVectorsWithValues(*query);
+}
+
 void VectorManager::updateVector(const Vector& vector) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     SQLite::Transaction transaction(db);
-    SQLite::Statement query(db, "UPDATE Vector SET versionId = ?, type = ?, deleted = ? WHERE id = ?");
-    query.bind(1, vector.versionId);
-    query.bind(2, static_cast<int>(vector.type));
-    query.bind(3, vector.deleted ? 1 : 0);
-    query.bind(4, static_cast<int>(vector.id));
-    query.exec();
+    auto query = dbManager.prepare(db, "UPDATE Vector SET versionId = ?, type = ?, deleted = ? WHERE id = ?");
+    query->bind(1, vector.versionId);
+    query->bind(2, static_cast<int>(vector.type));
+    query->bind(3, vector.deleted ? 1 : 0);
+    query->bind(4, static_cast<int>(vector.id));
+    query->exec();
 
-    SQLite::Statement deleteValueQuery(db, "DELETE FROM VectorValue WHERE vectorId = ?");
-    deleteValueQuery.bind(1, static_cast<int>(vector.id));
-    deleteValueQuery.exec();
+    auto deleteValueQuery = dbManager.prepare(db, "DELETE FROM VectorValue WHERE vectorId = ?");
+    deleteValueQuery->bind(1, static_cast<int>(vector.id));
+    deleteValueQuery->exec();
 
     for (auto& value : vector.values) {
-        SQLite::Statement valueQuery(db, "INSERT INTO VectorValue (vectorId, vectorIndexId, type, data) VALUES (?, ?, ?, ?)");
-        valueQuery.bind(1, vector.id);
-        valueQuery.bind(2, value.vectorIndexId);
-        valueQuery.bind(3, static_cast<int>(value.type));
-        std::vector<uint8_t> serializedData = value.serialize();
-        valueQuery.bind(4, serializedData.data(), static_cast<int>(serializedData.size()));
-        valueQuery.exec();
+        auto valueQuery = dbManager.prepare(db, "INSERT INTO VectorValue (vectorId, vectorIndexId, type, data) VALUES (?, ?, ?, ?)");
+        valueQuery->bind(1, vector.id);
+        valueQuery->bind(2, value.vectorIndexId);
+        valueQuery->bind(3, static_cast<int>(value.type));
+        std::vector<uint8_t> serializedData = value.serialize(IdCache::getInstance().getStoragePrecision(value.vectorIndexId));
+        valueQuery->bind(4, serializedData.data(), static_cast<int>(serializedData.size()));
+        valueQuery->exec();
+
+        if (value.type == VectorValueType::Dense && VectorSegmentStoreManager::getInstance().isEnabled()) {
+            VectorSegmentStoreManager::getInstance().appendDenseVector(value.vectorIndexId, vector.id, vector.unique_id, value.denseData);
+        }
     }
 
     transaction.commit();
 }
 
 void VectorManager::deleteVector(unsigned long long id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     SQLite::Transaction transaction(db);
-    SQLite::Statement query(db, "DELETE FROM Vector WHERE id = ?");
-    query.bind(1, static_cast<int>(id));
-    query.exec();
+    auto query = dbManager.prepare(db, "DELETE FROM Vector WHERE id = ?");
+    query->bind(1, static_cast<int>(id));
+    query->exec();
 
-    SQLite::Statement deleteValueQuery(db, "DELETE FROM VectorValue WHERE vectorId = ?");
-    deleteValueQuery.bind(1, static_cast<int>(id));
-    deleteValueQuery.exec();
+    auto deleteValueQuery = dbManager.prepare(db, "DELETE FROM VectorValue WHERE vectorId = ?");
+    deleteValueQuery->bind(1, static_cast<int>(id));
+    deleteValueQuery->exec();
 
     transaction.commit();
+
+    // Its metadata rows stay behind, but without a unique_id they no longer match a filter
+    filter::MetadataBitmapIndex::getInstance().onVectorMetadataDeleted(static_cast<long>(id));
 }
 
-int VectorManager::countByVersionId(int versionId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT COUNT(*) FROM Vector WHERE versionId = ? AND deleted = 0");
-    query.bind(1, versionId);
-
-    if (query.executeStep()) {
-        int count = query.getColumn(0).getInt();
-        spdlog::debug("Counted {} vectors for versionId: {}", count, versionId);
-        return count;
-    }
+size_t VectorManager::deleteVectors(int versionId, const std::vector<int>& vectorIds) {
+    return deleteResolvedVectors(versionId, [&]() { return vectorIds; });
+}
 
-    spdlog::error("Failed to count vectors for versionId: {}", versionId);
-    throw std::runtime_error("Failed to count vectors for the specified versionId.");
+size_t VectorManager::deleteVectorsByFilter(int versionId, const std::string& filter) {
+    return deleteResolvedVectors(versionId, [&]() {
+        return VectorMetadataManager::getInstance().queryVectorIdsAfter(versionId, filter, -1, -1);
+    });
 }
 
-std::vector<Vector> VectorManager::getVectorsByVectorIds(const std::vector<int>& vectorIds) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    std::vector<Vector> vectors;
+size_t VectorManager::deleteResolvedVectors(int versionId, const std::function<std::vector<int>()>& resolveVectorIds) {
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+
+    std::vector<long> deletedIds;
+    std::vector<int64_t> deletedUniqueIds;
+
+    // IMMEDIATE takes the write lock up front, so nothing commits between matching
+    // the vectors and deleting them; reads inside the transaction use the writer
+    SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+    const std::vector<int> vectorIds = resolveVectorIds();
+    for (size_t offset = 0; offset < vectorIds.size(); offset += MAX_IN_LIST_PARAMS) {
+        size_t chunkSize = std::min(MAX_IN_LIST_PARAMS, vectorIds.size() - offset);
+
+        std::stringstream ss;
+        ss << "SELECT id FROM Vector WHERE versionId = ? AND id IN (";
+        for (size_t i = 0; i < chunkSize; ++i) {
+            ss << (i == 0 ? "?" : ",?");
+        }
+        ss << ")";
+        std::string chunkVectors = ss.str();
+
+        auto bindChunk = [&](SQLite::Statement& statement) {
+            statement.bind(1, versionId);
+            for (size_t i = 0; i < chunkSize; ++i) {
+                statement.bind(static_cast<int>(i + 2), vectorIds[offset + i]);
+            }
+        };
+
+        SQLite::Statement selectQuery(db, "SELECT id, unique_id FROM Vector WHERE id IN (" + chunkVectors + ")");
+        bindChunk(selectQuery);
+        while (selectQuery.executeStep()) {
+            deletedIds.push_back(selectQuery.getColumn(0).getInt64());
+            deletedUniqueIds.push_back(selectQuery.getColumn(1).getInt64());
+        }
+
+        // Dependent rows first, while the subquery still finds their vectors;
+        // triggers drop the path, text and segment rows along with them
+        for (const char* table : {"VectorMetadata", "BM25", "VectorValue"}) {
+            SQLite::Statement deleteQuery(db, std::string("DELETE FROM ") + table + " WHERE vectorId IN (" + chunkVectors + ")");
+            bindChunk(deleteQuery);
+            deleteQuery.exec();
+        }
+        SQLite::Statement deleteQuery(db, "DELETE FROM Vector WHERE id IN (" + chunkVectors + ")");
+        bindChunk(deleteQuery);
+        deleteQuery.exec();
+    }
+    transaction.commit();
 
-    if (vectorIds.empty()) {
-        return vectors;
+    if (deletedIds.empty()) {
+        return 0;
     }
 
-    std::stringstream ss;
-    ss << "SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE id IN (";
-    for (size_t i = 0; i < vectorIds.size(); ++i) {
-        ss << "?";
-        if (i < vectorIds.size() - 1) {
-            ss << ",";
+    filter::MetadataBitmapIndex::getInstance().onVectorMetadataDeleted(deletedIds);
+
+    // Indexes that are not loaded are rebuilt, or tombstoned, from the database
+    for (const auto& vectorIndex : VectorIndexManager::getInstance().getVectorIndicesByVersionId(versionId)) {
+        auto indexManager = FaissIndexLRUCache::getInstance().peek(vectorIndex.id);
+        if (indexManager) {
+            indexManager->markDeleted(deletedUniqueIds);
         }
     }
-    ss << ")";
 
-    SQLite::Statement query(db, ss.str());
-    for (size_t i = 0; i < vectorIds.size(); ++i) {
-        query.bind(static_cast<int>(i + 1), vectorIds[i]);
+    spdlog::info("Deleted {} vectors of versionId: {}", deletedIds.size(), versionId);
+    return deletedIds.size();
+}
+
+int VectorManager::countByVersionId(int versionId) {
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    // Maintained by the trg_vector_count_* triggers; a version without vectors has no row
+    auto query = dbManager.prepare(db, "SELECT liveCount FROM VectorCount WHERE versionId = ?");
+    query->bind(1, versionId);
+
+    int count = 0;
+    if (query->executeStep()) {
+        count = query->getColumn(0).getInt();
     }
 
-    while (query.executeStep()) {
-        Vector vector;
-        vector.id = query.getColumn(0).getInt64();
-        vector.versionId = query.getColumn(1).getInt();
-        vector.unique_id = query.getColumn(2).getInt();
-        vector.type = static_cast<VectorValueType>(query.getColumn(3).getInt());
-        vector.deleted = query.getColumn(4).getInt() != 0;
-
-        SQLite::Statement valueQuery(db, "SELECT id, vectorId, vectorIndexId, type, data FROM VectorValue WHERE vectorId = ?");
-        valueQuery.bind(1, vector.id);
-
-        while (valueQuery.executeStep()) {
-            VectorValue value;
-            value.id = valueQuery.getColumn(0).getInt();
-            value.vectorId = valueQuery.getColumn(1).getInt64();
-            value.vectorIndexId = valueQuery.getColumn(2).getInt();
-            value.type = static_cast<VectorValueType>(valueQuery.getColumn(3).getInt());
-
-            std::vector<uint8_t> blobData;
-            blobData.assign(static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()),
-                            static_cast<const uint8_t*>(valueQuery.getColumn(4).getBlob()) + valueQuery.getColumn(4).getBytes());
-
-            value.deserialize(blobData);
-            vector.values.push_back(value);
+    spdlog::debug("Counted {} vectors for versionId: {}", count, versionId);
+    return count;
+}
+
+std::vector<Vector> VectorManager::getVectorsByVectorIds(const std::vector<int>& vectorIds) {
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
+    std::vector<Vector> vectors;
+
+    for (size_t offset = 0; offset < vectorIds.size(); offset += MAX_IN_LIST_PARAMS) {
+        size_t chunkSize = std::min(MAX_IN_LIST_PARAMS, vectorIds.size() - offset);
+
+        std::stringstream ss;
+        ss << "SELECT " << VECTOR_WITH_VALUES_COLUMNS << " FROM Vector V "
+           << "LEFT JOIN VectorValue VV ON VV.vectorId = V.id WHERE V.id IN (";
+        for (size_t i = 0; i < chunkSize; ++i) {
+            ss << (i == 0 ? "?" : ",?");
+        }
+        ss << ") ORDER BY V.id, VV.id";
+
+        SQLite::Statement query(db, ss.str());
+        for (size_t i = 0; i < chunkSize; ++i) {
+            query.bind(static_cast<int>(i + 1), vectorIds[offset + i]);
         }
 
-        vectors.push_back(vector);
+        auto chunk = loadVectorsWithValues(query);
+        vectors.insert(vectors.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
     }
 
     return vectors;
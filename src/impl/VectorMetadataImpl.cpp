@@ -1,22 +1,117 @@
 #include <unordered_set>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
 
 #include "VectorMetadata.hpp"
 #include "DatabaseManager.hpp"
 #include "filter/FilterManager.hpp"
+#include "filter/JsonPath.hpp"
+#include "filter/MetadataBitmapIndex.hpp"
+#include "filter/PredicateBuilderVisitor.hpp"
 #include "spdlog/spdlog.h"
+#include "nlohmann/json.hpp"
 
 using namespace atinyvectors::filter;
 
 namespace atinyvectors {
 
 namespace {
-    
+
+// Same grammar as a JSON number, so "007", " 1" or "1e" stay strings
+bool isJsonNumber(const std::string& text) {
+    size_t i = 0;
+    auto digits = [&]() {
+        size_t start = i;
+        while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+            ++i;
+        }
+        return i > start;
+    };
+
+    if (i < text.size() && text[i] == '-') {
+        ++i;
+    }
+    if (i < text.size() && text[i] == '0') {
+        ++i;
+    } else if (!digits()) {
+        return false;
+    }
+    if (i < text.size() && text[i] == '.') {
+        ++i;
+        if (!digits()) {
+            return false;
+        }
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        ++i;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+            ++i;
+        }
+        if (!digits()) {
+            return false;
+        }
+    }
+    return i == text.size();
+}
+
+// rowid is VectorMetadata.id. A row is in the table while its key is a text key
+// of its space, so the triggers look the space up only for keys some space indexes.
+const char* const TEXT_INDEX_SCHEMA = R"(
+CREATE VIRTUAL TABLE IF NOT EXISTS VectorMetadataText USING fts5(value, tokenize = 'trigram');
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_metadata_text_insert AFTER INSERT ON VectorMetadata
+WHEN NEW.value IS NOT NULL AND NEW.key IN (SELECT key FROM MetadataTextIndex)
+BEGIN
+    INSERT INTO VectorMetadataText (rowid, value)
+    SELECT NEW.id, NEW.value
+    WHERE EXISTS (SELECT 1 FROM MetadataTextIndex T JOIN Version V ON V.spaceId = T.spaceId
+                  WHERE V.id = NEW.versionId AND T.key = NEW.key);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_metadata_text_update AFTER UPDATE OF key, value, versionId ON VectorMetadata
+WHEN OLD.key IN (SELECT key FROM MetadataTextIndex) OR NEW.key IN (SELECT key FROM MetadataTextIndex)
+BEGIN
+    DELETE FROM VectorMetadataText WHERE rowid = OLD.id;
+    INSERT INTO VectorMetadataText (rowid, value)
+    SELECT NEW.id, NEW.value
+    WHERE NEW.value IS NOT NULL
+      AND EXISTS (SELECT 1 FROM MetadataTextIndex T JOIN Version V ON V.spaceId = T.spaceId
+                  WHERE V.id = NEW.versionId AND T.key = NEW.key);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_vector_metadata_text_delete AFTER DELETE ON VectorMetadata
+WHEN OLD.key IN (SELECT key FROM MetadataTextIndex)
+BEGIN
+    DELETE FROM VectorMetadataText WHERE rowid = OLD.id;
+END;
+)";
+
+bool hasTextIndexTable(SQLite::Database& db) {
+    auto query = DatabaseManager::getInstance().prepare(db,
+        "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'VectorMetadataText'");
+    return query->executeStep();
+}
+
 void bindVectorMetadataParameters(SQLite::Statement& query, const VectorMetadata& metadata) {
     query.bind(1, metadata.vectorId);
     query.bind(2, metadata.key);
-    query.bind(3, metadata.value);
+    if (metadata.valueType == MetadataValueType::Null) {
+        query.bind(3);
+    } else {
+        query.bind(3, metadata.value);
+    }
     query.bind(4, metadata.versionId);
+    query.bind(5, static_cast<int>(metadata.valueType));
+
+    std::optional<double> numericValue = metadata.numericValue();
+    if (numericValue) {
+        query.bind(6, *numericValue);
+    } else {
+        query.bind(6);
+    }
 }
 
 VectorMetadata createVectorMetadataFromQuery(SQLite::Statement& query) {
@@ -25,10 +120,96 @@ VectorMetadata createVectorMetadataFromQuery(SQLite::Statement& query) {
         query.getColumn(4).getInt64(),   // versionId
         query.getColumn(1).getInt64(),  // vectorId
         query.getColumn(2).getString(), // key
-        query.getColumn(3).getString() // value
+        query.getColumn(3).getString(), // value
+        static_cast<MetadataValueType>(query.getColumn(5).getInt()) // valueType
     );
 }
 
+// Binds value, valueType and numericValue of a VectorMetadataPath row from
+// `first` on, typed like the VectorMetadata column of a top-level value except
+// that strings never get a numeric view; SQLite's json_type does not give one
+void bindJsonPathValue(SQLite::Statement& query, int first, const nlohmann::json& value) {
+    MetadataValueType valueType = MetadataValueType::String;
+    std::optional<double> numericValue;
+    switch (value.type()) {
+    case nlohmann::json::value_t::string:
+        query.bind(first, value.get<std::string>());
+        break;
+    case nlohmann::json::value_t::null:
+        query.bind(first);
+        valueType = MetadataValueType::Null;
+        break;
+    case nlohmann::json::value_t::boolean:
+        query.bind(first, value.dump());
+        valueType = MetadataValueType::Boolean;
+        numericValue = value.get<bool>() ? 1.0 : 0.0;
+        break;
+    case nlohmann::json::value_t::number_integer:
+    case nlohmann::json::value_t::number_unsigned:
+    case nlohmann::json::value_t::number_float:
+        query.bind(first, value.dump());
+        valueType = value.is_number_float() ? MetadataValueType::Float : MetadataValueType::Integer;
+        if (std::isfinite(value.get<double>())) {
+            numericValue = value.get<double>();
+        }
+        break;
+    default:
+        query.bind(first, value.dump());
+        valueType = value.is_array() ? MetadataValueType::Array : MetadataValueType::Object;
+        break;
+    }
+
+    query.bind(first + 1, static_cast<int>(valueType));
+    if (numericValue) {
+        query.bind(first + 2, *numericValue);
+    } else {
+        query.bind(first + 2);
+    }
+}
+
+// Adds the VectorMetadataPath rows of an array or object value: one for each
+// value an indexed path of its key selects
+void insertMetadataPathRows(const VectorMetadata& metadata, const std::vector<std::string>& indexedPaths) {
+    if (metadata.valueType != MetadataValueType::Array && metadata.valueType != MetadataValueType::Object) {
+        return;
+    }
+
+    std::vector<JsonPath> paths;
+    for (const auto& text : indexedPaths) {
+        JsonPath path = JsonPath::parse(text);
+        if (path.getKey() == metadata.key) {
+            paths.push_back(std::move(path));
+        }
+    }
+    if (paths.empty()) {
+        return;
+    }
+
+    nlohmann::json value = nlohmann::json::parse(metadata.value, nullptr, false);
+    if (value.is_discarded()) {
+        spdlog::warn("Metadata {} of vector {} is not valid JSON; its indexed paths are skipped.", metadata.key, metadata.vectorId);
+        return;
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto insertQuery = dbManager.prepare(db,
+        "INSERT INTO VectorMetadataPath (metadataId, vectorId, versionId, path, value, valueType, numericValue) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?)");
+    for (const auto& path : paths) {
+        std::string name = path.toString();
+        for (const nlohmann::json* selected : path.extract(value)) {
+            insertQuery->bind(1, static_cast<int64_t>(metadata.id));
+            insertQuery->bind(2, static_cast<int64_t>(metadata.vectorId));
+            insertQuery->bind(3, static_cast<int64_t>(metadata.versionId));
+            insertQuery->bind(4, name);
+            bindJsonPathValue(*insertQuery, 5, *selected);
+            insertQuery->exec();
+            insertQuery->reset();
+        }
+    }
+}
+
 std::vector<VectorMetadata> executeSelectQuery(SQLite::Statement& query) {
     std::vector<VectorMetadata> metadataList;
     while (query.executeStep()) {
@@ -37,8 +218,59 @@ std::vector<VectorMetadata> executeSelectQuery(SQLite::Statement& query) {
     return metadataList;
 }
 
+// Counts of (key, value) pairs of VectorMetadata F over the vectors selected by
+// `domainSQL`, which reads the :versionId parameter; each key is listed even
+// when none of the vectors hold it
+MetadataFacets queryFacets(SQLite::Database& db, long versionId, const std::vector<std::string>& keys, int limit,
+                           const std::string& domainSQL, const std::function<void(SQLite::Statement&)>& bindDomain) {
+    MetadataFacets facets;
+    for (const auto& key : keys) {
+        facets[key];
+    }
+    if (keys.empty()) {
+        return facets;
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto query = dbManager.prepare(db,
+        "SELECT F.key, F.value, COUNT(DISTINCT F.vectorId) FROM VectorMetadata F "
+        "WHERE F.versionId = :versionId AND F.value IS NOT NULL "
+        "AND F.key IN (SELECT value FROM json_each(:keys)) " + domainSQL + " "
+        "GROUP BY F.key, F.value ORDER BY F.key, 3 DESC, F.value");
+    query->bind(":versionId", static_cast<int64_t>(versionId));
+    query->bind(":keys", nlohmann::json(keys).dump());
+    bindDomain(*query);
+
+    while (query->executeStep()) {
+        auto& values = facets[query->getColumn(0).getString()];
+        if (limit < 0 || static_cast<int>(values.size()) < limit) {
+            values.push_back({query->getColumn(1).getString(), query->getColumn(2).getInt()});
+        }
+    }
+    return facets;
+}
+
 } // anonymous namespace
 
+std::optional<double> VectorMetadata::numericValue() const {
+    switch (valueType) {
+    case MetadataValueType::Boolean:
+        return value == "true" ? 1.0 : 0.0;
+    case MetadataValueType::String:
+    case MetadataValueType::Integer:
+    case MetadataValueType::Float:
+        if (isJsonNumber(value)) {
+            double number = std::strtod(value.c_str(), nullptr);
+            if (std::isfinite(number)) {
+                return number;
+            }
+        }
+        return std::nullopt;
+    default:
+        return std::nullopt;
+    }
+}
+
 std::unique_ptr<VectorMetadataManager> VectorMetadataManager::instance;
 std::mutex VectorMetadataManager::instanceMutex;
 
@@ -54,90 +286,401 @@ VectorMetadataManager& VectorMetadataManager::getInstance() {
 }
 
 long VectorMetadataManager::addVectorMetadata(VectorMetadata& metadata) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
-    SQLite::Statement insertQuery(db, "INSERT INTO VectorMetadata (vectorId, key, value, versionId) VALUES (?, ?, ?, ?)");
-    bindVectorMetadataParameters(insertQuery, metadata);
-    insertQuery.exec();
+    auto insertQuery = dbManager.prepare(db, "INSERT INTO VectorMetadata (vectorId, key, value, versionId, valueType, numericValue) VALUES (?, ?, ?, ?, ?, ?)");
+    bindVectorMetadataParameters(*insertQuery, metadata);
+    insertQuery->exec();
 
     long insertedId = static_cast<long>(db.getLastInsertRowid());
     metadata.id = insertedId;
+    insertMetadataPathRows(metadata, getVersionIndexes(metadata.versionId)->paths);
 
     transaction.commit();
+    MetadataBitmapIndex::getInstance().onMetadataAdded(metadata);
 
     return insertedId;
 }
 
 std::vector<VectorMetadata> VectorMetadataManager::getAllVectorMetadata() {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, vectorId, key, value, versionId FROM VectorMetadata");
-    return executeSelectQuery(query);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, vectorId, key, value, versionId, valueType FROM VectorMetadata");
+    return executeSelectQuery(*query);
 }
 
 VectorMetadata VectorMetadataManager::getVectorMetadataById(long id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, vectorId, key, value, versionId FROM VectorMetadata WHERE id = ?");
-    query.bind(1, id);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, vectorId, key, value, versionId, valueType FROM VectorMetadata WHERE id = ?");
+    query->bind(1, id);
 
-    if (query.executeStep()) {
-        return createVectorMetadataFromQuery(query);
+    if (query->executeStep()) {
+        return createVectorMetadataFromQuery(*query);
     }
 
     throw std::runtime_error("VectorMetadata not found");
 }
 
 std::vector<VectorMetadata> VectorMetadataManager::getVectorMetadataByVectorId(long vectorId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, vectorId, key, value, versionId FROM VectorMetadata WHERE vectorId = ?");
-    query.bind(1, vectorId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, vectorId, key, value, versionId, valueType FROM VectorMetadata WHERE vectorId = ?");
+    query->bind(1, vectorId);
 
-    return executeSelectQuery(query);
+    return executeSelectQuery(*query);
+}
+
+std::unordered_map<long, std::vector<VectorMetadata>> VectorMetadataManager::getVectorMetadataByVectorIds(const std::vector<long>& vectorIds) {
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
+    std::unordered_map<long, std::vector<VectorMetadata>> metadataByVectorId;
+
+    const size_t maxParams = 500;
+    for (size_t offset = 0; offset < vectorIds.size(); offset += maxParams) {
+        size_t chunkSize = std::min(maxParams, vectorIds.size() - offset);
+
+        std::stringstream ss;
+        ss << "SELECT id, vectorId, key, value, versionId, valueType FROM VectorMetadata WHERE vectorId IN (";
+        for (size_t i = 0; i < chunkSize; ++i) {
+            ss << (i == 0 ? "?" : ",?");
+        }
+        ss << ") ORDER BY vectorId, id";
+
+        SQLite::Statement query(db, ss.str());
+        for (size_t i = 0; i < chunkSize; ++i) {
+            query.bind(static_cast<int>(i + 1), static_cast<int64_t>(vectorIds[offset + i]));
+        }
+
+        while (query.executeStep()) {
+            VectorMetadata metadata = createVectorMetadataFromQuery(query);
+            metadataByVectorId[metadata.vectorId].push_back(std::move(metadata));
+        }
+    }
+
+    return metadataByVectorId;
 }
 
 void VectorMetadataManager::updateVectorMetadata(const VectorMetadata& metadata) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
     
-    SQLite::Statement query(db, "UPDATE VectorMetadata SET vectorId = ?, key = ?, value = ?, versionId = ? WHERE id = ?");
-    bindVectorMetadataParameters(query, metadata);
-    query.bind(5, metadata.id);
-    query.exec();
+    auto query = dbManager.prepare(db, "UPDATE VectorMetadata SET vectorId = ?, key = ?, value = ?, versionId = ?, valueType = ?, numericValue = ? WHERE id = ?");
+    bindVectorMetadataParameters(*query, metadata);
+    query->bind(7, metadata.id);
+    query->exec();
+
+    auto deletePathsQuery = dbManager.prepare(db, "DELETE FROM VectorMetadataPath WHERE metadataId = ?");
+    deletePathsQuery->bind(1, metadata.id);
+    deletePathsQuery->exec();
+    insertMetadataPathRows(metadata, getVersionIndexes(metadata.versionId)->paths);
     
     transaction.commit();
+    MetadataBitmapIndex::getInstance().onMetadataUpdated(metadata);
 }
 
 void VectorMetadataManager::deleteVectorMetadata(long id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
     
-    SQLite::Statement query(db, "DELETE FROM VectorMetadata WHERE id = ?");
-    query.bind(1, id);
-    query.exec();
+    auto query = dbManager.prepare(db, "DELETE FROM VectorMetadata WHERE id = ?");
+    query->bind(1, id);
+    query->exec();
 
     transaction.commit();
+    MetadataBitmapIndex::getInstance().onMetadataDeleted(id);
 }
 
 void VectorMetadataManager::deleteVectorMetadataByVectorId(long vectorId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
     
-    SQLite::Statement query(db, "DELETE FROM VectorMetadata WHERE vectorId = ?");
-    query.bind(1, vectorId);
-    query.exec();
+    auto query = dbManager.prepare(db, "DELETE FROM VectorMetadata WHERE vectorId = ?");
+    query->bind(1, vectorId);
+    query->exec();
+
+    transaction.commit();
+    MetadataBitmapIndex::getInstance().onVectorMetadataDeleted(vectorId);
+}
+
+void VectorMetadataManager::replaceVectorMetadata(long versionId, const std::vector<int>& vectorIds,
+                                                  const std::vector<VectorMetadata>& values) {
+    if (vectorIds.empty()) {
+        return;
+    }
+    replaceResolvedVectorMetadata(versionId, [&]() { return vectorIds; }, values);
+}
+
+size_t VectorMetadataManager::replaceVectorMetadataByFilter(long versionId, const std::string& filter,
+                                                            const std::vector<VectorMetadata>& values) {
+    return replaceResolvedVectorMetadata(versionId, [&]() {
+        return queryVectorIdsAfter(versionId, filter, -1, -1);
+    }, values);
+}
+
+size_t VectorMetadataManager::replaceResolvedVectorMetadata(long versionId,
+                                                            const std::function<std::vector<int>()>& resolveVectorIds,
+                                                            const std::vector<VectorMetadata>& values) {
+    if (values.empty()) {
+        return 0;
+    }
+
+    std::vector<std::string> keys;
+    for (const auto& value : values) {
+        if (std::find(keys.begin(), keys.end(), value.key) == keys.end()) {
+            keys.push_back(value.key);
+        }
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    std::shared_ptr<const MetadataIndexes> indexes = getVersionIndexes(versionId);
+
+    // IMMEDIATE takes the write lock up front, so nothing commits between matching
+    // the vectors and replacing their rows; reads inside the transaction use the writer
+    SQLite::Transaction transaction(db, SQLite::TransactionBehavior::IMMEDIATE);
+    const std::vector<int> vectorIds = resolveVectorIds();
+    if (vectorIds.empty()) {
+        return 0;
+    }
+
+    std::vector<long> removedIds;
+    std::vector<VectorMetadata> added;
+    added.reserve(vectorIds.size() * values.size());
+
+    auto selectQuery = dbManager.prepare(db, "SELECT id FROM VectorMetadata WHERE vectorId = ? AND versionId = ? AND key = ?");
+    auto deleteQuery = dbManager.prepare(db, "DELETE FROM VectorMetadata WHERE vectorId = ? AND versionId = ? AND key = ?");
+    auto insertQuery = dbManager.prepare(db, "INSERT INTO VectorMetadata (vectorId, key, value, versionId, valueType, numericValue) VALUES (?, ?, ?, ?, ?, ?)");
+    for (int vectorId : vectorIds) {
+        for (const auto& key : keys) {
+            selectQuery->bind(1, vectorId);
+            selectQuery->bind(2, static_cast<int64_t>(versionId));
+            selectQuery->bind(3, key);
+            while (selectQuery->executeStep()) {
+                removedIds.push_back(selectQuery->getColumn(0).getInt64());
+            }
+            selectQuery->reset();
+
+            deleteQuery->bind(1, vectorId);
+            deleteQuery->bind(2, static_cast<int64_t>(versionId));
+            deleteQuery->bind(3, key);
+            deleteQuery->exec();
+            deleteQuery->reset();
+        }
+
+        for (const auto& value : values) {
+            VectorMetadata metadata = value;
+            metadata.vectorId = vectorId;
+            metadata.versionId = versionId;
+            bindVectorMetadataParameters(*insertQuery, metadata);
+            insertQuery->exec();
+            insertQuery->reset();
+
+            metadata.id = static_cast<long>(db.getLastInsertRowid());
+            insertMetadataPathRows(metadata, indexes->paths);
+            added.push_back(std::move(metadata));
+        }
+    }
+    transaction.commit();
+
+    auto& bitmapIndex = MetadataBitmapIndex::getInstance();
+    for (long id : removedIds) {
+        bitmapIndex.onMetadataDeleted(id);
+    }
+    for (const auto& metadata : added) {
+        bitmapIndex.onMetadataAdded(metadata);
+    }
+    spdlog::info("Replaced {} metadata keys on {} vectors of versionId: {}", keys.size(), vectorIds.size(), versionId);
+    return vectorIds.size();
+}
+
+std::shared_ptr<const MetadataIndexes> VectorMetadataManager::getVersionIndexes(long versionId) {
+    std::lock_guard<std::mutex> lock(indexesMutex);
+    auto& dbManager = DatabaseManager::getInstance();
+    if (indexesGeneration != dbManager.getResetGeneration()) {
+        versionIndexes.clear();
+        indexesGeneration = dbManager.getResetGeneration();
+    }
+
+    auto it = versionIndexes.find(versionId);
+    if (it != versionIndexes.end()) {
+        return it->second;
+    }
+
+    auto& db = dbManager.getReadDatabase();
+    auto indexes = std::make_shared<MetadataIndexes>();
+    auto pathsQuery = dbManager.prepare(db,
+        "SELECT P.path FROM MetadataIndexedPath P JOIN Version V ON V.spaceId = P.spaceId WHERE V.id = ? ORDER BY P.path");
+    pathsQuery->bind(1, static_cast<int64_t>(versionId));
+    while (pathsQuery->executeStep()) {
+        indexes->paths.push_back(pathsQuery->getColumn(0).getString());
+    }
+
+    auto keysQuery = dbManager.prepare(db,
+        "SELECT T.key FROM MetadataTextIndex T JOIN Version V ON V.spaceId = T.spaceId WHERE V.id = ? ORDER BY T.key");
+    keysQuery->bind(1, static_cast<int64_t>(versionId));
+    while (keysQuery->executeStep()) {
+        indexes->textKeys.push_back(keysQuery->getColumn(0).getString());
+    }
+
+    versionIndexes[versionId] = indexes;
+    return indexes;
+}
+
+std::vector<std::string> VectorMetadataManager::getIndexedPaths(int spaceId) {
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT path FROM MetadataIndexedPath WHERE spaceId = ? ORDER BY path");
+    query->bind(1, spaceId);
+
+    std::vector<std::string> paths;
+    while (query->executeStep()) {
+        paths.push_back(query->getColumn(0).getString());
+    }
+    return paths;
+}
+
+void VectorMetadataManager::setIndexedPaths(int spaceId, const std::vector<std::string>& paths) {
+    // Stored in canonical form, the form filters are matched against
+    std::vector<std::string> canonicalPaths;
+    for (const auto& text : paths) {
+        canonicalPaths.push_back(JsonPath::parse(text).toString());
+    }
+    std::sort(canonicalPaths.begin(), canonicalPaths.end());
+    canonicalPaths.erase(std::unique(canonicalPaths.begin(), canonicalPaths.end()), canonicalPaths.end());
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+
+    SQLite::Transaction transaction(db);
+
+    auto deleteQuery = dbManager.prepare(db, "DELETE FROM MetadataIndexedPath WHERE spaceId = ?");
+    deleteQuery->bind(1, spaceId);
+    deleteQuery->exec();
+
+    auto insertQuery = dbManager.prepare(db, "INSERT INTO MetadataIndexedPath (spaceId, path) VALUES (?, ?)");
+    for (const auto& path : canonicalPaths) {
+        insertQuery->bind(1, spaceId);
+        insertQuery->bind(2, path);
+        insertQuery->exec();
+        insertQuery->reset();
+    }
+
+    // Rebuild the rows of every version of the space
+    auto deletePathsQuery = dbManager.prepare(db,
+        "DELETE FROM VectorMetadataPath WHERE versionId IN (SELECT id FROM Version WHERE spaceId = ?)");
+    deletePathsQuery->bind(1, spaceId);
+    deletePathsQuery->exec();
+
+    if (!canonicalPaths.empty()) {
+        auto rowsQuery = dbManager.prepare(db,
+            "SELECT id, vectorId, key, value, versionId, valueType FROM VectorMetadata "
+            "WHERE versionId IN (SELECT id FROM Version WHERE spaceId = ?) AND valueType IN (?, ?)");
+        rowsQuery->bind(1, spaceId);
+        rowsQuery->bind(2, static_cast<int>(MetadataValueType::Array));
+        rowsQuery->bind(3, static_cast<int>(MetadataValueType::Object));
+        for (const auto& metadata : executeSelectQuery(*rowsQuery)) {
+            insertMetadataPathRows(metadata, canonicalPaths);
+        }
+    }
 
     transaction.commit();
+
+    std::lock_guard<std::mutex> lock(indexesMutex);
+    versionIndexes.clear();
+    spdlog::info("Space {} indexes {} metadata paths.", spaceId, canonicalPaths.size());
+}
+
+std::vector<std::string> VectorMetadataManager::getTextIndexedKeys(int spaceId) {
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+    auto query = dbManager.prepare(db, "SELECT key FROM MetadataTextIndex WHERE spaceId = ? ORDER BY key");
+    query->bind(1, spaceId);
+
+    std::vector<std::string> keys;
+    while (query->executeStep()) {
+        keys.push_back(query->getColumn(0).getString());
+    }
+    return keys;
+}
+
+void VectorMetadataManager::setTextIndexedKeys(int spaceId, const std::vector<std::string>& keys) {
+    for (const auto& key : keys) {
+        if (key.empty()) {
+            throw std::invalid_argument("Text indexed metadata keys cannot be empty.");
+        }
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+
+    SQLite::Transaction transaction(db);
+
+    auto deleteQuery = dbManager.prepare(db, "DELETE FROM MetadataTextIndex WHERE spaceId = ?");
+    deleteQuery->bind(1, spaceId);
+    deleteQuery->exec();
+
+    auto insertQuery = dbManager.prepare(db, "INSERT OR IGNORE INTO MetadataTextIndex (spaceId, key) VALUES (?, ?)");
+    for (const auto& key : keys) {
+        insertQuery->bind(1, spaceId);
+        insertQuery->bind(2, key);
+        insertQuery->exec();
+        insertQuery->reset();
+    }
+
+    if (!hasTextIndexTable(db)) {
+        if (keys.empty()) {
+            transaction.commit();
+            return;
+        }
+        try {
+            db.exec(TEXT_INDEX_SCHEMA);
+        } catch (const SQLite::Exception& e) {
+            throw std::runtime_error(std::string("Text indexes need SQLite 3.34 or later with FTS5: ") + e.what());
+        }
+    }
+
+    // Triggers keep the index current from here on; reindex what is stored
+    auto deleteTextQuery = dbManager.prepare(db,
+        "DELETE FROM VectorMetadataText WHERE rowid IN (SELECT id FROM VectorMetadata "
+        "WHERE versionId IN (SELECT id FROM Version WHERE spaceId = ?))");
+    deleteTextQuery->bind(1, spaceId);
+    deleteTextQuery->exec();
+
+    auto insertTextQuery = dbManager.prepare(db,
+        "INSERT INTO VectorMetadataText (rowid, value) SELECT id, value FROM VectorMetadata "
+        "WHERE versionId IN (SELECT id FROM Version WHERE spaceId = ?) AND value IS NOT NULL "
+        "AND key IN (SELECT key FROM MetadataTextIndex WHERE spaceId = ?)");
+    insertTextQuery->bind(1, spaceId);
+    insertTextQuery->bind(2, spaceId);
+    insertTextQuery->exec();
+
+    transaction.commit();
+
+    std::lock_guard<std::mutex> lock(indexesMutex);
+    versionIndexes.clear();
+    spdlog::info("Space {} indexes the text of {} metadata keys.", spaceId, keys.size());
 }
 
 std::vector<std::pair<float, int>> VectorMetadataManager::filterVectors(
     const std::vector<std::pair<float, int>>& inputVectors,
     const std::string& filter) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    return filterVectorsSQL(-1, inputVectors, FilterManager::getInstance().compile(filter));
+}
+
+std::vector<std::pair<float, int>> VectorMetadataManager::filterVectorsSQL(
+    long versionId,
+    const std::vector<std::pair<float, int>>& inputVectors,
+    const CompiledFilter& compiledFilter) {
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
     std::vector<std::pair<float, int>> filteredVectors;
-    std::string sqlFilter = FilterManager::getInstance().toSQL(filter);
 
     std::stringstream uniqueIdListStream;
     uniqueIdListStream << "(";
@@ -150,8 +693,15 @@ std::vector<std::pair<float, int>> VectorMetadataManager::filterVectors(
     uniqueIdListStream << ")";
     std::string uniqueIdList = uniqueIdListStream.str();
 
+    // unique_id is only unique within a version
     std::string idQueryStr = "SELECT V.id, V.unique_id FROM Vector V WHERE V.unique_id IN " + uniqueIdList;
+    if (versionId >= 0) {
+        idQueryStr += " AND V.versionId = ?";
+    }
     SQLite::Statement idQuery(db, idQueryStr);
+    if (versionId >= 0) {
+        idQuery.bind(1, static_cast<int64_t>(versionId));
+    }
 
     std::unordered_map<long, long> uniqueIdToRealId;
     while (idQuery.executeStep()) {
@@ -171,8 +721,9 @@ std::vector<std::pair<float, int>> VectorMetadataManager::filterVectors(
     idListStream << ")";
     std::string idList = idListStream.str();
 
-    std::string filterQueryStr = "SELECT VectorMetadata.vectorId FROM VectorMetadata WHERE VectorMetadata.vectorId IN " + idList + " AND " + sqlFilter;
+    std::string filterQueryStr = "SELECT VectorMetadata.vectorId FROM VectorMetadata WHERE VectorMetadata.vectorId IN " + idList + " AND " + compiledFilter.sql;
     SQLite::Statement filterQuery(db, filterQueryStr);
+    compiledFilter.bind(filterQuery);
 
     std::unordered_set<long> validRealIds;
     while (filterQuery.executeStep()) {
@@ -190,34 +741,186 @@ std::vector<std::pair<float, int>> VectorMetadataManager::filterVectors(
     return filteredVectors;
 }
 
+std::vector<std::pair<float, int>> VectorMetadataManager::filterVectors(
+    long versionId,
+    const std::vector<std::pair<float, int>>& inputVectors,
+    const std::string& filter) {
+    auto& bitmapIndex = MetadataBitmapIndex::getInstance();
+    RoaringBitmap matched;
+    if (!bitmapIndex.evaluate(versionId, filter, matched)) {
+        std::shared_ptr<const FilterPredicate> predicate;
+        if (bitmapIndex.isEnabled()) {
+            predicate = PredicateBuilderVisitor::compile(filter);
+        }
+        return filterCandidates(versionId, inputVectors, filter, predicate.get());
+    }
+
+    std::vector<std::pair<float, int>> filteredVectors;
+    for (const auto& vec : inputVectors) {
+        if (vec.second >= 0 && matched.contains(static_cast<uint32_t>(vec.second))) {
+            filteredVectors.push_back(vec);
+        }
+    }
+    return filteredVectors;
+}
+
+std::vector<std::pair<float, int>> VectorMetadataManager::filterCandidates(
+    long versionId,
+    const std::vector<std::pair<float, int>>& inputVectors,
+    const std::string& filter,
+    const FilterPredicate* predicate) {
+    // Without a predicate SQL answers, reading the paths the version's space indexes
+    CompiledFilter compiledFilter;
+    if (predicate == nullptr) {
+        compiledFilter = FilterManager::getInstance().compile(filter, *getVersionIndexes(versionId));
+        return filterVectorsSQL(versionId, inputVectors, compiledFilter);
+    }
+
+    std::vector<std::pair<float, int>> candidates;
+    std::vector<uint32_t> uniqueIds;
+    for (const auto& vec : inputVectors) {
+        if (vec.second >= 0) {
+            candidates.push_back(vec);
+            uniqueIds.push_back(static_cast<uint32_t>(vec.second));
+        }
+    }
+
+    std::vector<uint8_t> matched(uniqueIds.size());
+    if (!MetadataBitmapIndex::getInstance().evaluate(versionId, *predicate, uniqueIds.data(), uniqueIds.size(), matched.data())) {
+        compiledFilter = FilterManager::getInstance().compile(filter, *getVersionIndexes(versionId));
+        return filterVectorsSQL(versionId, inputVectors, compiledFilter);
+    }
+
+    std::vector<std::pair<float, int>> filteredVectors;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (matched[i]) {
+            filteredVectors.push_back(candidates[i]);
+        }
+    }
+    return filteredVectors;
+}
+
 VectorMetadataResult VectorMetadataManager::queryVectors(
     long versionId, const std::string& filter, int start, int limit) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
     VectorMetadataResult result;
-    std::string sqlFilter = FilterManager::getInstance().toSQL(filter);
 
-    // Query to get the total count of vectors matching the filter and versionId
-    std::string countQueryStr = "SELECT COUNT(*) FROM VectorMetadata WHERE versionId = ? AND " + sqlFilter;
-    SQLite::Statement countQuery(db, countQueryStr);
-    countQuery.bind(1, versionId);
-    if (countQuery.executeStep()) {
-        result.totalCount = countQuery.getColumn(0).getInt();
+    // The bitmap index answers with one entry per vector, in unique_id order
+    RoaringBitmap matched;
+    auto& bitmapIndex = MetadataBitmapIndex::getInstance();
+    if (bitmapIndex.evaluate(versionId, filter, matched)) {
+        result.totalCount = static_cast<int>(matched.cardinality());
+        size_t pageLimit = limit < 0 ? matched.cardinality() : static_cast<size_t>(limit);
+        result.vectorUniqueIds = bitmapIndex.toVectorIds(versionId, matched.page(start < 0 ? 0 : start, pageLimit));
+        return result;
     }
 
-    // Query to get the filtered vectors with pagination and versionId
-    std::string queryStr = "SELECT vectorId FROM VectorMetadata WHERE versionId = ? AND " + sqlFilter + 
-                           " LIMIT ? OFFSET ?";
-    SQLite::Statement query(db, queryStr);
-    query.bind(1, versionId);
-    query.bind(2, limit);
-    query.bind(3, start);
+    // Literals are bound, so the SQL only varies with the shape of the filter and
+    // the statements can be cached
+    CompiledFilter compiledFilter = FilterManager::getInstance().compile(filter, *getVersionIndexes(versionId));
+
+    // Count and page over distinct vectors in unique_id order, the same answer the
+    // bitmap index gives, even when several metadata rows of a vector match
+    std::string countQueryStr = "SELECT COUNT(DISTINCT vectorId) FROM VectorMetadata WHERE versionId = :versionId AND " + compiledFilter.sql;
+    auto countQuery = dbManager.prepare(db, countQueryStr);
+    countQuery->bind(":versionId", versionId);
+    compiledFilter.bind(*countQuery);
+    if (countQuery->executeStep()) {
+        result.totalCount = countQuery->getColumn(0).getInt();
+    }
 
-    while (query.executeStep()) {
-        int vectorId = query.getColumn(0).getInt();
+    std::string queryStr = "SELECT V.id FROM Vector V WHERE V.versionId = :versionId "
+                           "AND EXISTS (SELECT 1 FROM VectorMetadata WHERE VectorMetadata.vectorId = V.id AND " + compiledFilter.sql + ") "
+                           "ORDER BY V.unique_id LIMIT :limit OFFSET :start";
+    auto query = dbManager.prepare(db, queryStr);
+    query->bind(":versionId", versionId);
+    query->bind(":limit", limit);
+    query->bind(":start", start);
+    compiledFilter.bind(*query);
+
+    while (query->executeStep()) {
+        int vectorId = query->getColumn(0).getInt();
         result.vectorUniqueIds.emplace_back(vectorId);
     }
 
     return result;
 }
 
+std::vector<int> VectorMetadataManager::queryVectorIdsAfter(
+    long versionId, const std::string& filter, int afterUniqueId, int limit) {
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+
+    RoaringBitmap matched;
+    auto& bitmapIndex = MetadataBitmapIndex::getInstance();
+    if (bitmapIndex.evaluate(versionId, filter, matched)) {
+        uint32_t minUniqueId = afterUniqueId < 0 ? 0 : static_cast<uint32_t>(afterUniqueId) + 1;
+        size_t pageLimit = limit < 0 ? matched.cardinality() : static_cast<size_t>(limit);
+        return bitmapIndex.toVectorIds(versionId, matched.valuesFrom(minUniqueId, pageLimit));
+    }
+
+    CompiledFilter compiledFilter = FilterManager::getInstance().compile(filter, *getVersionIndexes(versionId));
+
+    // Walk Vector in keyset order and probe metadata per candidate, so a page
+    // stops as soon as `limit` matches are found
+    std::string queryStr = "SELECT V.id FROM Vector V WHERE V.versionId = :versionId AND V.unique_id > :afterUniqueId "
+                           "AND EXISTS (SELECT 1 FROM VectorMetadata WHERE VectorMetadata.vectorId = V.id AND " + compiledFilter.sql + ") "
+                           "ORDER BY V.unique_id LIMIT :limit";
+    auto query = dbManager.prepare(db, queryStr);
+    query->bind(":versionId", versionId);
+    query->bind(":afterUniqueId", afterUniqueId);
+    query->bind(":limit", limit);
+    compiledFilter.bind(*query);
+
+    std::vector<int> vectorIds;
+    while (query->executeStep()) {
+        vectorIds.emplace_back(query->getColumn(0).getInt());
+    }
+
+    return vectorIds;
+}
+
+MetadataFacets VectorMetadataManager::facetCounts(
+    long versionId, const std::string& filter, const std::vector<std::string>& keys, int limit) {
+    // Counted as bitmap intersections when the index of the version answers the filter
+    MetadataFacets facets;
+    if (MetadataBitmapIndex::getInstance().facets(versionId, filter, keys, limit, facets)) {
+        return facets;
+    }
+
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
+    if (filter.empty()) {
+        return queryFacets(db, versionId, keys, limit, "", [](SQLite::Statement&) {});
+    }
+
+    CompiledFilter compiledFilter = FilterManager::getInstance().compile(filter, *getVersionIndexes(versionId));
+    std::string domainSQL = "AND F.vectorId IN (SELECT vectorId FROM VectorMetadata "
+                            "WHERE versionId = :versionId AND " + compiledFilter.sql + ")";
+    return queryFacets(db, versionId, keys, limit, domainSQL, [&](SQLite::Statement& query) {
+        compiledFilter.bind(query);
+    });
+}
+
+MetadataFacets VectorMetadataManager::facetCounts(
+    long versionId, const std::vector<int>& uniqueIds, const std::vector<std::string>& keys, int limit) {
+    MetadataFacets facets;
+    RoaringBitmap domain;
+    for (int uniqueId : uniqueIds) {
+        if (uniqueId >= 0) {
+            domain.add(static_cast<uint32_t>(uniqueId));
+        }
+    }
+    if (MetadataBitmapIndex::getInstance().facets(versionId, domain, keys, limit, facets)) {
+        return facets;
+    }
+
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
+    std::string domainSQL = "AND F.vectorId IN (SELECT id FROM Vector WHERE versionId = :versionId "
+                            "AND unique_id IN (SELECT value FROM json_each(:uniqueIds)))";
+    return queryFacets(db, versionId, keys, limit, domainSQL, [&](SQLite::Statement& query) {
+        query.bind(":uniqueIds", nlohmann::json(domain.toVector()).dump());
+    });
+}
+
 } // namespace atinyvectors
@@ -1,7 +1,13 @@
 // VectorValueImpl.cpp
 #include "Vector.hpp"
 #include "IdCache.hpp"
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
 
 using namespace atinyvectors;
 
@@ -25,25 +31,374 @@ std::vector<uint8_t> serializeFloatVector(const std::vector<float>& data) {
     return serializedData;
 }
 
-std::vector<float> deserializeFloatVector(const std::vector<uint8_t>& blobData, size_t& offset, size_t count) {
-    std::vector<float> data(count);
-    memcpy(data.data(), blobData.data() + offset, count * sizeof(float));
+void deserializeFloatVector(std::vector<float>& out, const uint8_t* data, size_t& offset, size_t count) {
+    out.resize(count);
+    memcpy(out.data(), data + offset, count * sizeof(float));
     offset += count * sizeof(float);
-    return data;
 }
 
-std::vector<uint8_t> VectorValue::serialize() const {
+// fp32 dense blobs are raw floats. Reduced precision blobs start with a tag whose
+// bits are a signaling NaN, which no JSON input or float arithmetic can produce,
+// followed by 16-bit components.
+const uint32_t DENSE_PRECISION_TAG = 0x7FA55600;
+const uint32_t DENSE_PRECISION_TAG_MASK = 0xFFFFFF00;
+
+StoragePrecision readDensePrecision(const uint8_t* data, size_t size) {
+    if (size < sizeof(uint32_t)) {
+        return StoragePrecision::Float32;
+    }
+    uint32_t tag;
+    memcpy(&tag, data, sizeof(tag));
+    if ((tag & DENSE_PRECISION_TAG_MASK) != DENSE_PRECISION_TAG) {
+        return StoragePrecision::Float32;
+    }
+
+    auto precision = static_cast<StoragePrecision>(tag & ~DENSE_PRECISION_TAG_MASK);
+    if (precision != StoragePrecision::Float16 && precision != StoragePrecision::BFloat16) {
+        throw std::runtime_error("Unknown dense vector blob precision");
+    }
+    return precision;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t magnitude = bits & 0x7FFFFFFF;
+
+    if (magnitude >= 0x7F800000) {
+        // Inf stays Inf; NaN becomes quiet and keeps the top of its payload, like F16C
+        uint32_t nan = magnitude > 0x7F800000 ? (0x0200 | ((magnitude >> 13) & 0x3FF)) : 0;
+        return static_cast<uint16_t>(sign | 0x7C00 | nan);
+    }
+    if (magnitude >= 0x477FF000) {
+        // Rounds to a value above the largest half
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+    if (magnitude < 0x38800000) {
+        // Subnormal half (or zero): shift the implicit-one mantissa into place, round to nearest even
+        if (magnitude < 0x33000000) {
+            return static_cast<uint16_t>(sign);
+        }
+        uint32_t exponent = magnitude >> 23;
+        uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+        uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (remainder > midpoint || (remainder == midpoint && (half & 1))) {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    // Normal: rebias the exponent and round the mantissa to nearest even
+    uint32_t half = ((magnitude - 0x38000000) + 0x0FFF + ((magnitude >> 13) & 1)) >> 13;
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa != 0 ? 0x400000 : 0) | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa != 0) {
+        // Subnormal half becomes a normal float
+        exponent = 113;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    } else {
+        bits = sign;
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void floatsToHalf(const float* in, uint16_t* out, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = floatToHalf(in[i]);
+    }
+}
+
+void halfToFloats(const uint8_t* in, float* out, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * sizeof(uint16_t)));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(packed));
+    }
+#endif
+    for (; i < count; ++i) {
+        uint16_t value;
+        memcpy(&value, in + i * sizeof(uint16_t), sizeof(value));
+        out[i] = halfToFloat(value);
+    }
+}
+
+// bfloat16 is the upper half of a float; plain integer loops that the compiler vectorizes
+void floatsToBFloat16(const float* in, uint16_t* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t bits;
+        memcpy(&bits, in + i, sizeof(bits));
+        bool isNan = (bits & 0x7FFFFFFF) > 0x7F800000;
+        uint32_t rounded = (bits + 0x7FFF + ((bits >> 16) & 1)) >> 16;
+        out[i] = static_cast<uint16_t>(isNan ? ((bits >> 16) | 0x0040) : rounded);
+    }
+}
+
+void bfloat16ToFloats(const uint8_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t value;
+        memcpy(&value, in + i * sizeof(uint16_t), sizeof(value));
+        uint32_t bits = static_cast<uint32_t>(value) << 16;
+        memcpy(out + i, &bits, sizeof(bits));
+    }
+}
+
+std::vector<uint8_t> serializeDenseVector(const std::vector<float>& data, StoragePrecision precision) {
+    if (precision == StoragePrecision::Float32) {
+        return serializeFloatVector(data);
+    }
+
+    std::vector<uint8_t> serializedData(sizeof(uint32_t) + data.size() * sizeof(uint16_t));
+    uint32_t tag = DENSE_PRECISION_TAG | static_cast<uint32_t>(precision);
+    memcpy(serializedData.data(), &tag, sizeof(tag));
+
+    std::vector<uint16_t> packed(data.size());
+    if (precision == StoragePrecision::Float16) {
+        floatsToHalf(data.data(), packed.data(), data.size());
+    } else {
+        floatsToBFloat16(data.data(), packed.data(), data.size());
+    }
+    memcpy(serializedData.data() + sizeof(uint32_t), packed.data(), packed.size() * sizeof(uint16_t));
+    return serializedData;
+}
+
+size_t denseComponentCount(size_t size, StoragePrecision precision) {
+    if (precision == StoragePrecision::Float32) {
+        return size / sizeof(float);
+    }
+    return (size - sizeof(uint32_t)) / sizeof(uint16_t);
+}
+
+void decodeDenseVector(const uint8_t* data, size_t size, StoragePrecision precision, float* out) {
+    size_t count = denseComponentCount(size, precision);
+    if (count == 0) {
+        return;
+    }
+
+    if (precision == StoragePrecision::Float16) {
+        halfToFloats(data + sizeof(uint32_t), out, count);
+    } else if (precision == StoragePrecision::BFloat16) {
+        bfloat16ToFloats(data + sizeof(uint32_t), out, count);
+    } else {
+        memcpy(out, data, count * sizeof(float));
+    }
+}
+
+// Legacy sparse blobs are an int pair count followed by (int index, float value) pairs.
+// Current blobs start with a tag that is negative as an int, so it never reads as
+// a legacy count:
+//   tag (format version, value precision) | varint count | varint index bytes |
+//   varint index deltas, ascending | values (fp32, fp16 or bf16)
+const size_t SPARSE_PAIR_SIZE = sizeof(int) + sizeof(float);
+const uint32_t SPARSE_FORMAT_TAG = 0xA5530000;
+const uint32_t SPARSE_FORMAT_TAG_MASK = 0xFFFF0000;
+const uint32_t SPARSE_FORMAT_VERSION = 1;
+
+void writeVarint(std::vector<uint8_t>& buffer, uint32_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t readVarint(const uint8_t* data, size_t end, size_t& offset) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (offset >= end) {
+            break;
+        }
+        uint8_t byte = data[offset++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Corrupted sparse vector blob");
+}
+
+size_t sparseValueSize(StoragePrecision precision) {
+    return precision == StoragePrecision::Float32 ? sizeof(float) : sizeof(uint16_t);
+}
+
+struct SparseBlobLayout {
+    bool legacy = true;
+    int count = 0;
+    StoragePrecision precision = StoragePrecision::Float32;
+    size_t indexOffset = 0;
+    size_t indexEnd = 0;
+    size_t valueOffset = 0;
+};
+
+SparseBlobLayout readSparseLayout(const uint8_t* data, size_t size) {
+    SparseBlobLayout layout;
+    if (size < sizeof(uint32_t)) {
+        return layout;
+    }
+
+    size_t offset = 0;
+    uint32_t tag = deserializeInteger<uint32_t>(data, offset);
+    if ((tag & SPARSE_FORMAT_TAG_MASK) != SPARSE_FORMAT_TAG) {
+        int pairCount = static_cast<int>(tag);
+        if (pairCount < 0 || static_cast<size_t>(pairCount) > (size - offset) / SPARSE_PAIR_SIZE) {
+            throw std::runtime_error("Corrupted sparse vector blob");
+        }
+        layout.count = pairCount;
+        layout.indexOffset = offset;
+        return layout;
+    }
+
+    if ((tag & 0xFF) != SPARSE_FORMAT_VERSION) {
+        throw std::runtime_error("Unsupported sparse vector blob version " + std::to_string(tag & 0xFF));
+    }
+    layout.legacy = false;
+    layout.precision = static_cast<StoragePrecision>((tag >> 8) & 0xFF);
+    if (layout.precision != StoragePrecision::Float32 && layout.precision != StoragePrecision::Float16 &&
+        layout.precision != StoragePrecision::BFloat16) {
+        throw std::runtime_error("Unknown sparse vector blob precision");
+    }
+
+    uint32_t count = readVarint(data, size, offset);
+    uint32_t indexBytes = readVarint(data, size, offset);
+    if (indexBytes > size - offset || count > indexBytes ||
+        count > (size - offset - indexBytes) / sparseValueSize(layout.precision)) {
+        throw std::runtime_error("Corrupted sparse vector blob");
+    }
+
+    layout.count = static_cast<int>(count);
+    layout.indexOffset = offset;
+    layout.indexEnd = offset + indexBytes;
+    layout.valueOffset = layout.indexEnd;
+    return layout;
+}
+
+// Calls visit(index, value) for every pair, in stored order
+template <typename Visitor>
+void decodeSparse(const uint8_t* data, const SparseBlobLayout& layout, Visitor&& visit) {
+    size_t indexOffset = layout.indexOffset;
+
+    if (layout.legacy) {
+        for (int i = 0; i < layout.count; ++i) {
+            int index = deserializeInteger<int>(data, indexOffset);
+            float value = deserializeInteger<float>(data, indexOffset);
+            visit(index, value);
+        }
+        return;
+    }
+
+    const uint8_t* values = data + layout.valueOffset;
+    uint32_t index = 0;
+    for (int i = 0; i < layout.count; ++i) {
+        index += readVarint(data, layout.indexEnd, indexOffset);
+
+        float value;
+        if (layout.precision == StoragePrecision::Float32) {
+            memcpy(&value, values + i * sizeof(float), sizeof(float));
+        } else {
+            uint16_t packed;
+            memcpy(&packed, values + i * sizeof(uint16_t), sizeof(uint16_t));
+            if (layout.precision == StoragePrecision::Float16) {
+                value = halfToFloat(packed);
+            } else {
+                uint32_t bits = static_cast<uint32_t>(packed) << 16;
+                memcpy(&value, &bits, sizeof(bits));
+            }
+        }
+        visit(static_cast<int>(index), value);
+    }
+}
+
+std::vector<uint8_t> serializeSparseVector(const SparseData& sparse, StoragePrecision precision) {
+    std::vector<uint8_t> blobData;
+
+    bool hasNegativeIndex = std::any_of(sparse.begin(), sparse.end(),
+                                        [](const std::pair<int, float>& pair) { return pair.first < 0; });
+    if (hasNegativeIndex) {
+        // Deltas need non-negative indexes; keep such vectors in the legacy layout
+        serializeInteger(blobData, static_cast<int>(sparse.size()));
+        for (const auto& pair : sparse) {
+            serializeInteger(blobData, pair.first);
+            serializeInteger(blobData, pair.second);
+        }
+        return blobData;
+    }
+
+    SparseData sorted(sparse);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const std::pair<int, float>& a, const std::pair<int, float>& b) { return a.first < b.first; });
+
+    std::vector<uint8_t> indexBytes;
+    indexBytes.reserve(sorted.size() * 2);
+    uint32_t previous = 0;
+    for (const auto& pair : sorted) {
+        uint32_t index = static_cast<uint32_t>(pair.first);
+        writeVarint(indexBytes, index - previous);
+        previous = index;
+    }
+
+    std::vector<float> values(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        values[i] = sorted[i].second;
+    }
+
+    serializeInteger(blobData, SPARSE_FORMAT_TAG | (static_cast<uint32_t>(precision) << 8) | SPARSE_FORMAT_VERSION);
+    writeVarint(blobData, static_cast<uint32_t>(sorted.size()));
+    writeVarint(blobData, static_cast<uint32_t>(indexBytes.size()));
+    blobData.insert(blobData.end(), indexBytes.begin(), indexBytes.end());
+
+    size_t valueOffset = blobData.size();
+    blobData.resize(valueOffset + values.size() * sparseValueSize(precision));
+    if (precision == StoragePrecision::Float32) {
+        memcpy(blobData.data() + valueOffset, values.data(), values.size() * sizeof(float));
+    } else {
+        std::vector<uint16_t> packed(values.size());
+        if (precision == StoragePrecision::Float16) {
+            floatsToHalf(values.data(), packed.data(), values.size());
+        } else {
+            floatsToBFloat16(values.data(), packed.data(), values.size());
+        }
+        memcpy(blobData.data() + valueOffset, packed.data(), packed.size() * sizeof(uint16_t));
+    }
+    return blobData;
+}
+
+std::vector<uint8_t> VectorValue::serialize(StoragePrecision precision) const {
     std::vector<uint8_t> blobData;
     
     if (type == VectorValueType::Dense) {
-        blobData = serializeFloatVector(denseData);
+        blobData = serializeDenseVector(denseData, precision);
     } else if (type == VectorValueType::Sparse) {
-        serializeInteger(blobData, static_cast<int>(sparseData->size()));
-        for (const auto& pair : *sparseData) {
-            serializeInteger(blobData, pair.first);
-            const uint8_t* floatData = reinterpret_cast<const uint8_t*>(&pair.second);
-            blobData.insert(blobData.end(), floatData, floatData + sizeof(float));
-        }
+        blobData = serializeSparseVector(*sparseData, precision);
     } else if (type == VectorValueType::MultiVector) {
         serializeInteger(blobData, size);
         for (const auto& vec : multiVectorData) {
@@ -56,31 +411,85 @@ std::vector<uint8_t> VectorValue::serialize() const {
 }
 
 void VectorValue::deserialize(const std::vector<uint8_t>& blobData) {
+    deserialize(blobData.data(), blobData.size());
+}
+
+void VectorValue::deserialize(const uint8_t* data, size_t blobSize) {
     size_t offset = 0;
 
     if (type == VectorValueType::Dense) {
-        denseData = deserializeFloatVector(blobData, offset, blobData.size() / sizeof(float));
+        StoragePrecision precision = readDensePrecision(data, blobSize);
+        denseData.resize(denseComponentCount(blobSize, precision));
+        decodeDenseVector(data, blobSize, precision, denseData.data());
     } else if (type == VectorValueType::Sparse) {
+        SparseBlobLayout layout = readSparseLayout(data, blobSize);
         if (sparseData == nullptr) {
             sparseData = IdCache::getInstance().getSparseDataPool(vectorIndexId).allocate();
         }
-        
-        int pairCount = deserializeInteger<int>(blobData.data(), offset);
-        sparseData->resize(pairCount);
-        for (int i = 0; i < pairCount; ++i) {
-            int index = deserializeInteger<int>(blobData.data(), offset);
-            float value;
-            memcpy(&value, blobData.data() + offset, sizeof(float));
-            offset += sizeof(float);
-            (*sparseData)[i] = std::make_pair(index, value);
-        }
+
+        sparseData->clear();
+        sparseData->reserve(layout.count);
+        decodeSparse(data, layout, [this](int index, float value) {
+            sparseData->emplace_back(index, value);
+        });
     } else if (type == VectorValueType::MultiVector) {
-        size = deserializeInteger<int>(blobData.data(), offset);
-        size_t totalFloats = (blobData.size() - offset) / sizeof(float);
-        size_t vectorSize = totalFloats / size;
-        multiVectorData.resize(size, std::vector<float>(vectorSize));
+        if (blobSize < sizeof(int)) {
+            size = 0;
+            multiVectorData.clear();
+            return;
+        }
+        size = deserializeInteger<int>(data, offset);
+        if (size <= 0) {
+            size = 0;
+            multiVectorData.clear();
+            return;
+        }
+        size_t vectorSize = (blobSize - offset) / sizeof(float) / size;
+        multiVectorData.resize(size);
         for (int i = 0; i < size; ++i) {
-            multiVectorData[i] = deserializeFloatVector(blobData, offset, vectorSize);
+            deserializeFloatVector(multiVectorData[i], data, offset, vectorSize);
         }
     }
 }
+
+VectorValueView::VectorValueView(VectorValueType type, const void* data, size_t size)
+    : type(type), data(static_cast<const uint8_t*>(data)), size(data ? size : 0),
+      precision(StoragePrecision::Float32), sparseCount(0) {
+    if (type == VectorValueType::Dense) {
+        precision = readDensePrecision(this->data, this->size);
+    } else if (type == VectorValueType::Sparse) {
+        sparseCount = readSparseLayout(this->data, this->size).count;
+    }
+}
+
+size_t VectorValueView::denseSize() const {
+    return denseComponentCount(size, precision);
+}
+
+const float* VectorValueView::denseData() const {
+    // SQLite hands out 8-byte aligned blobs, but the view may wrap any buffer
+    if (precision != StoragePrecision::Float32 || reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<const float*>(data);
+}
+
+void VectorValueView::copyDenseTo(float* out) const {
+    decodeDenseVector(data, size, precision, out);
+}
+
+void VectorValueView::scatterSparseTo(float* out, int dim) const {
+    decodeSparse(data, readSparseLayout(data, size), [out, dim](int index, float value) {
+        if (index >= 0 && index < dim) {
+            out[index] = value;
+        }
+    });
+}
+
+void VectorValueView::copySparseTo(SparseData& out) const {
+    out.clear();
+    out.reserve(sparseCount);
+    decodeSparse(data, readSparseLayout(data, size), [&out](int index, float value) {
+        out.emplace_back(index, value);
+    });
+}
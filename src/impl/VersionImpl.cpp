@@ -68,15 +68,16 @@ VersionManager& VersionManager::getInstance() {
 int VersionManager::addVersion(Version& version) {
     IdCache::getInstance().clean();
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
     
     // Set unique_id to the maximum value by spaceId + 1
-    SQLite::Statement maxUniqueIdQuery(db, "SELECT IFNULL(MAX(unique_id), 0) + 1 FROM Version WHERE spaceId = ?");
-    maxUniqueIdQuery.bind(1, version.spaceId);
-    if (maxUniqueIdQuery.executeStep()) {
-        version.unique_id = maxUniqueIdQuery.getColumn(0).getInt();
+    auto maxUniqueIdQuery = dbManager.prepare(db, "SELECT IFNULL(MAX(unique_id), 0) + 1 FROM Version WHERE spaceId = ?");
+    maxUniqueIdQuery->bind(1, version.spaceId);
+    if (maxUniqueIdQuery->executeStep()) {
+        version.unique_id = maxUniqueIdQuery->getColumn(0).getInt();
     } else {
         version.unique_id = 1; // default value
     }
@@ -84,11 +85,11 @@ int VersionManager::addVersion(Version& version) {
     spdlog::debug("Calculated unique_id: {}", version.unique_id);
 
     // Check if a default version exists for the given spaceId
-    SQLite::Statement checkDefaultQuery(db, "SELECT COUNT(*) FROM Version WHERE spaceId = ? AND is_default = 1");
-    checkDefaultQuery.bind(1, version.spaceId);
+    auto checkDefaultQuery = dbManager.prepare(db, "SELECT COUNT(*) FROM Version WHERE spaceId = ? AND is_default = 1");
+    checkDefaultQuery->bind(1, version.spaceId);
     int defaultCount = 0;
-    if (checkDefaultQuery.executeStep()) {
-        defaultCount = checkDefaultQuery.getColumn(0).getInt();
+    if (checkDefaultQuery->executeStep()) {
+        defaultCount = checkDefaultQuery->getColumn(0).getInt();
     }
 
     if (defaultCount == 0) {
@@ -97,9 +98,9 @@ int VersionManager::addVersion(Version& version) {
         spdlog::debug("No default version found for spaceId: {}. Setting is_default to true.", version.spaceId);
     } else if (version.is_default) {
         // If a default version already exists and the new version is set as default, update the existing default version
-        SQLite::Statement updateQuery(db, "UPDATE Version SET is_default = 0 WHERE spaceId = ?");
-        updateQuery.bind(1, version.spaceId);
-        updateQuery.exec();
+        auto updateQuery = dbManager.prepare(db, "UPDATE Version SET is_default = 0 WHERE spaceId = ?");
+        updateQuery->bind(1, version.spaceId);
+        updateQuery->exec();
         spdlog::debug("Updated existing default versions for spaceId: {} to is_default = false.", version.spaceId);
     }
 
@@ -111,9 +112,9 @@ int VersionManager::addVersion(Version& version) {
                  version.spaceId, version.unique_id, version.name, version.description, version.tag, version.created_time_utc, version.updated_time_utc, version.is_default);
 
     // Insert version
-    SQLite::Statement insertQuery(db, "INSERT INTO Version (spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
-    bindVersionParameters(insertQuery, version);
-    insertQuery.exec();
+    auto insertQuery = dbManager.prepare(db, "INSERT INTO Version (spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default) VALUES (?, ?, ?, ?, ?, ?, ?, ?)");
+    bindVersionParameters(*insertQuery, version);
+    insertQuery->exec();
 
     version.id = static_cast<int>(db.getLastInsertRowid());
     spdlog::debug("Inserted new version with auto-assigned ID: {}", version.id);
@@ -128,59 +129,64 @@ std::vector<Version> VersionManager::getAllVersions() {
 }
 
 Version VersionManager::getVersionById(int id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE id = ?");
-    query.bind(1, id);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE id = ?");
+    query->bind(1, id);
 
-    if (query.executeStep()) {
-        return createVersionFromQuery(query);
+    if (query->executeStep()) {
+        return createVersionFromQuery(*query);
     }
 
     throw std::runtime_error("Version not found");
 }
 
 Version VersionManager::getVersionByUniqueId(int spaceId, int unique_id) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE spaceId = ? AND unique_id = ?");
-    query.bind(1, spaceId);
-    query.bind(2, unique_id);
-
-    if (query.executeStep()) {
-        return createVersionFromQuery(query);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE spaceId = ? AND unique_id = ?");
+    query->bind(1, spaceId);
+    query->bind(2, unique_id);
+
+    if (query->executeStep()) {
+        return createVersionFromQuery(*query);
     }
 
     throw std::runtime_error("Version not found with the specified spaceId and unique_id.");
 }
 
 std::vector<Version> VersionManager::getVersionsBySpaceId(int spaceId, int start, int limit) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE spaceId = ? ORDER BY id DESC LIMIT ? OFFSET ?");
-    query.bind(1, spaceId);
-    query.bind(2, limit);
-    query.bind(3, start);
-
-    return executeSelectQuery(query);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE spaceId = ? ORDER BY id DESC LIMIT ? OFFSET ?");
+    query->bind(1, spaceId);
+    query->bind(2, limit);
+    query->bind(3, start);
+
+    return executeSelectQuery(*query);
 }
 
 Version VersionManager::getDefaultVersion(int spaceId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE spaceId = ? AND is_default = 1");
-    query.bind(1, spaceId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT id, spaceId, unique_id, name, description, tag, created_time_utc, updated_time_utc, is_default FROM Version WHERE spaceId = ? AND is_default = 1");
+    query->bind(1, spaceId);
 
-    if (query.executeStep()) {
-        return createVersionFromQuery(query);
+    if (query->executeStep()) {
+        return createVersionFromQuery(*query);
     }
 
     throw std::runtime_error("Default version not found for the specified space.");
 }
 
 int VersionManager::getTotalCountBySpaceId(int spaceId) {
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT COUNT(*) FROM Version WHERE spaceId = ?");
-    query.bind(1, spaceId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT COUNT(*) FROM Version WHERE spaceId = ?");
+    query->bind(1, spaceId);
 
-    if (query.executeStep()) {
-        return query.getColumn(0).getInt();
+    if (query->executeStep()) {
+        return query->getColumn(0).getInt();
     }
 
     throw std::runtime_error("Failed to get total count for the specified spaceId.");
@@ -189,15 +195,16 @@ int VersionManager::getTotalCountBySpaceId(int spaceId) {
 void VersionManager::updateVersion(const Version& version) {
     IdCache::getInstance().clean();
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
     SQLite::Transaction transaction(db);
     
     if (version.is_default) {
-        SQLite::Statement updateQuery(db, "UPDATE Version SET is_default = 0 WHERE spaceId = ? AND id != ?");
-        updateQuery.bind(1, version.spaceId);
-        updateQuery.bind(2, version.id);
-        updateQuery.exec();
+        auto updateQuery = dbManager.prepare(db, "UPDATE Version SET is_default = 0 WHERE spaceId = ? AND id != ?");
+        updateQuery->bind(1, version.spaceId);
+        updateQuery->bind(2, version.id);
+        updateQuery->exec();
     }
 
     long currentTime = getCurrentTimeUTC();
@@ -205,15 +212,15 @@ void VersionManager::updateVersion(const Version& version) {
     Version updatedVersion = version;
     updatedVersion.updated_time_utc = currentTime;
 
-    SQLite::Statement query(db, "UPDATE Version SET name = ?, description = ?, tag = ?, created_time_utc = ?, updated_time_utc = ?, is_default = ? WHERE id = ?");
-    query.bind(1, updatedVersion.name);
-    query.bind(2, updatedVersion.description);
-    query.bind(3, updatedVersion.tag);
-    query.bind(4, updatedVersion.created_time_utc);
-    query.bind(5, updatedVersion.updated_time_utc);
-    query.bind(6, updatedVersion.is_default ? 1 : 0);
-    query.bind(7, updatedVersion.id);
-    query.exec();
+    auto query = dbManager.prepare(db, "UPDATE Version SET name = ?, description = ?, tag = ?, created_time_utc = ?, updated_time_utc = ?, is_default = ? WHERE id = ?");
+    query->bind(1, updatedVersion.name);
+    query->bind(2, updatedVersion.description);
+    query->bind(3, updatedVersion.tag);
+    query->bind(4, updatedVersion.created_time_utc);
+    query->bind(5, updatedVersion.updated_time_utc);
+    query->bind(6, updatedVersion.is_default ? 1 : 0);
+    query->bind(7, updatedVersion.id);
+    query->exec();
     
     transaction.commit();
 }
@@ -221,34 +228,35 @@ void VersionManager::updateVersion(const Version& version) {
 void VersionManager::deleteVersion(int id) {
     IdCache::getInstance().clean();
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
 
     SQLite::Transaction transaction(db);
     
-    SQLite::Statement checkQuery(db, "SELECT spaceId, is_default FROM Version WHERE id = ?");
-    checkQuery.bind(1, id);
+    auto checkQuery = dbManager.prepare(db, "SELECT spaceId, is_default FROM Version WHERE id = ?");
+    checkQuery->bind(1, id);
     
     int spaceId = -1;
     bool isDefault = false;
     
-    if (checkQuery.executeStep()) {
-        spaceId = checkQuery.getColumn(0).getInt();
-        isDefault = checkQuery.getColumn(1).getInt() == 1;
+    if (checkQuery->executeStep()) {
+        spaceId = checkQuery->getColumn(0).getInt();
+        isDefault = checkQuery->getColumn(1).getInt() == 1;
     }
 
-    SQLite::Statement deleteQuery(db, "DELETE FROM Version WHERE id = ?");
-    deleteQuery.bind(1, id);
-    deleteQuery.exec();
+    auto deleteQuery = dbManager.prepare(db, "DELETE FROM Version WHERE id = ?");
+    deleteQuery->bind(1, id);
+    deleteQuery->exec();
     
     if (isDefault) {
-        SQLite::Statement findRecentQuery(db, "SELECT id FROM Version WHERE spaceId = ? ORDER BY created_time_utc DESC LIMIT 1");
-        findRecentQuery.bind(1, spaceId);
+        auto findRecentQuery = dbManager.prepare(db, "SELECT id FROM Version WHERE spaceId = ? ORDER BY created_time_utc DESC LIMIT 1");
+        findRecentQuery->bind(1, spaceId);
         
-        if (findRecentQuery.executeStep()) {
-            int recentId = findRecentQuery.getColumn(0).getInt();
-            SQLite::Statement setDefaultQuery(db, "UPDATE Version SET is_default = 1 WHERE id = ?");
-            setDefaultQuery.bind(1, recentId);
-            setDefaultQuery.exec();
+        if (findRecentQuery->executeStep()) {
+            int recentId = findRecentQuery->getColumn(0).getInt();
+            auto setDefaultQuery = dbManager.prepare(db, "UPDATE Version SET is_default = 1 WHERE id = ?");
+            setDefaultQuery->bind(1, recentId);
+            setDefaultQuery->exec();
         }
     }
 
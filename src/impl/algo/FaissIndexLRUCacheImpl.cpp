@@ -30,8 +30,15 @@ FaissIndexLRUCache& FaissIndexLRUCache::getInstance() {
     return *instance;
 }
 
+std::shared_ptr<FaissIndexManager> FaissIndexLRUCache::peek(int vectorIndexId) {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    auto it = cacheMap_.find(vectorIndexId);
+    return it != cacheMap_.end() ? it->second.first : nullptr;
+}
+
 std::shared_ptr<FaissIndexManager> FaissIndexLRUCache::get(int vectorIndexId) {
     spdlog::debug("Fetching HnswIndexManager for vectorIndexId: {}", vectorIndexId);
+    std::lock_guard<std::mutex> lock(cacheMutex_);
     auto it = cacheMap_.find(vectorIndexId);
 
     if (it != cacheMap_.end()) {
@@ -53,9 +60,10 @@ std::shared_ptr<FaissIndexManager> FaissIndexLRUCache::get(int vectorIndexId) {
         spdlog::debug("Cache full. Removed least recently used entry for vectorIndexId: {}", lruKey);
     }
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
-    SQLite::Statement query(db, "SELECT metricType, dimension, vectorValueType, hnswConfigJson, quantizationConfigJson FROM VectorIndex WHERE id = ?");
-    query.bind(1, vectorIndexId);
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT metricType, dimension, vectorValueType, hnswConfigJson, quantizationConfigJson FROM VectorIndex WHERE id = ?");
+    query->bind(1, vectorIndexId);
 
     MetricType metric = MetricType::L2;  // Default metric
     VectorValueType vectorValueType = VectorValueType::Dense;
@@ -63,12 +71,12 @@ std::shared_ptr<FaissIndexManager> FaissIndexLRUCache::get(int vectorIndexId) {
     std::string hnswConfigJson;
     std::string quantizationConfigJson;
 
-    if (query.executeStep()) {
-        int metricType = query.getColumn(0).getInt();
-        dim = query.getColumn(1).getInt();
-        vectorValueType = static_cast<VectorValueType>(query.getColumn(2).getInt());
-        hnswConfigJson = query.getColumn(3).getString();
-        quantizationConfigJson = query.getColumn(4).getString();
+    if (query->executeStep()) {
+        int metricType = query->getColumn(0).getInt();
+        dim = query->getColumn(1).getInt();
+        vectorValueType = static_cast<VectorValueType>(query->getColumn(2).getInt());
+        hnswConfigJson = query->getColumn(3).getString();
+        quantizationConfigJson = query->getColumn(4).getString();
 
         metric = static_cast<MetricType>(metricType);
         spdlog::debug("Using {} metric for vectorIndexId: {}", metricType, vectorIndexId);
@@ -121,7 +129,7 @@ std::shared_ptr<FaissIndexManager> FaissIndexLRUCache::get(int vectorIndexId) {
 
 // Function to clear the cache
 void FaissIndexLRUCache::clean() {
-    std::lock_guard<std::mutex> lock(instanceMutex);
+    std::lock_guard<std::mutex> lock(cacheMutex_);
     cacheList_.clear();
     cacheMap_.clear();
     spdlog::debug("Cache has been cleaned.");
@@ -129,6 +137,7 @@ void FaissIndexLRUCache::clean() {
 
 // Function to return the current state of the cache for debugging purposes
 std::string FaissIndexLRUCache::getCacheContents() const {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
     std::string contents;
     for (const auto& key : cacheList_) {
         contents += std::to_string(key) + " ";
@@ -1,7 +1,9 @@
+#include <algorithm>
 #include <fstream>
 #include <cmath>
 
 #include "algo/FaissIndexManager.hpp"
+#include "algo/VectorSegmentStore.hpp"
 #include "Config.hpp"
 #include "IdCache.hpp"
 #include "Vector.hpp"
@@ -10,12 +12,36 @@
 #include "spdlog/spdlog.h"
 #include "faiss/index_io.h"
 #include "faiss/IndexIDMap.h"
+#include "faiss/impl/IDSelector.h"
+#include "faiss/utils/distances.h"
 
 namespace atinyvectors
 {
 namespace algo
 {
 
+std::mutex FaissIndexManager::loadMutex;
+
+namespace {
+
+// Tests node positions of the wrapped index: rejects tombstoned nodes, then hands
+// the label of the node to the selector of the search if any
+struct LiveIDSelector : faiss::IDSelector {
+    const std::unordered_set<int64_t>& tombstones;
+    const std::vector<faiss::idx_t>& labels;
+    const faiss::IDSelector* selector;
+
+    LiveIDSelector(const std::unordered_set<int64_t>& tombstones, const std::vector<faiss::idx_t>& labels,
+                   const faiss::IDSelector* selector)
+        : tombstones(tombstones), labels(labels), selector(selector) {}
+
+    bool is_member(faiss::idx_t offset) const override {
+        return tombstones.count(offset) == 0 && (selector == nullptr || selector->is_member(labels[offset]));
+    }
+};
+
+}
+
 FaissIndexManager::FaissIndexManager(
     const std::string& indexFileName, 
     int vectorIndexId, int dim, int maxElements, 
@@ -141,6 +167,21 @@ std::vector<float> FaissIndexManager::normalizeVector(const std::vector<float>&
     return normalized;
 }
 
+void FaissIndexManager::normalizeVectorInPlace(float* data, size_t size) {
+    float norm = 0.0f;
+    for (size_t i = 0; i < size; ++i) {
+        norm += data[i] * data[i];
+    }
+    norm = std::sqrt(norm);
+    if (norm == 0.0f) {
+        return;
+    }
+
+    for (size_t i = 0; i < size; ++i) {
+        data[i] /= norm;
+    }
+}
+
 void FaissIndexManager::normalizeSparseVector(SparseData* sparseVector) {
     if (sparseVector == nullptr || sparseVector->empty()) {
         return;
@@ -167,76 +208,93 @@ void FaissIndexManager::restoreVectorsToIndex(bool skipIfIndexLoaded) {
 
     spdlog::debug("Starting restoreVectorsToIndex for vectorIndexId: {}", vectorIndexId);
 
+    // Rebuilt from the live vectors only
+    {
+        std::lock_guard<std::mutex> offsetsLock(labelOffsetsMutex);
+        labelOffsetsIndex = nullptr;
+        std::unique_lock<std::shared_mutex> lock(tombstonesMutex);
+        tombstones.clear();
+    }
+
     // Initialize index settings
     setOptimizerSettings();
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
     
-    SQLite::Statement query(db, 
-        "SELECT V.unique_id, VV.type, VV.data "
-        "FROM VectorValue VV "
-        "JOIN Vector V ON VV.vectorId = V.id "
-        "WHERE VV.vectorIndexId = ? AND V.deleted = 0");
-    query.bind(1, vectorIndexId);
-
     std::vector<float> denseVectors;
     std::vector<faiss::idx_t> vectorIds;
     std::vector<std::vector<float>> sparseVectors; // Handle sparse vectors separately if needed
 
-    while (query.executeStep()) {
-        int unique_id = query.getColumn(0).getInt();
-        int typeValue = query.getColumn(1).getInt();
-        const void* blobDataPtr = query.getColumn(2).getBlob();
-        int blobSize = query.getColumn(2).getBytes();
+    // Read straight from the mmapped segments when they cover every value of this
+    // index; otherwise decode the blobs and backfill the segments on the way.
+    bool loadedFromSegments = loadDenseVectorsFromSegments(denseVectors, vectorIds);
+    auto& segmentStores = VectorSegmentStoreManager::getInstance();
+    bool backfillSegments = !loadedFromSegments && segmentStores.isEnabled() && valueType == VectorValueType::Dense;
+
+    std::unique_ptr<SQLite::Transaction> backfillTransaction;
+    if (backfillSegments && sqlite3_get_autocommit(db.getHandle())) {
+        backfillTransaction = std::make_unique<SQLite::Transaction>(db);
+    }
 
-        std::vector<uint8_t> blobData(reinterpret_cast<const uint8_t*>(blobDataPtr), 
-                                     reinterpret_cast<const uint8_t*>(blobDataPtr) + blobSize);
+    auto query = dbManager.prepare(db, "SELECT V.unique_id, VV.type, VV.data, V.id "
+        "FROM VectorValue VV "
+        "JOIN Vector V ON VV.vectorId = V.id "
+        "WHERE VV.vectorIndexId = ? AND V.deleted = 0");
+    query->bind(1, vectorIndexId);
 
-        VectorValue vectorValue;
-        vectorValue.type = static_cast<VectorValueType>(typeValue);
-        vectorValue.vectorIndexId = vectorIndexId;
-        vectorValue.deserialize(blobData);
+    while (!loadedFromSegments && query->executeStep()) {
+        int unique_id = query->getColumn(0).getInt();
+        int typeValue = query->getColumn(1).getInt();
+        SQLite::Column blob = query->getColumn(2);
 
-        if (vectorValue.type == VectorValueType::Dense) {
-            std::vector<float> vector = vectorValue.denseData;
-            if (metricType == MetricType::Cosine) {
-                vector = normalizeVector(vector);
-            }
+        // Decode from the blob straight into the batch, without an intermediate VectorValue
+        VectorValueView view(static_cast<VectorValueType>(typeValue), blob.getBlob(), static_cast<size_t>(blob.getBytes()));
 
-            if (vector.size() != this->dim) {
-                spdlog::debug("Vector size desn't match with dim: {}", static_cast<int>(vector.size()));
+        if (view.getType() == VectorValueType::Dense) {
+            if (view.denseSize() != static_cast<size_t>(this->dim)) {
+                spdlog::debug("Vector size desn't match with dim: {}", static_cast<int>(view.denseSize()));
                 continue;
             }
 
-            denseVectors.insert(denseVectors.end(), vector.begin(), vector.end());
-            vectorIds.push_back(unique_id);
-        } 
-        else if (vectorValue.type == VectorValueType::Sparse) {
-            SparseData* sparseVectorPtr = vectorValue.sparseData;
-            if (!sparseVectorPtr) {
-                spdlog::warn("Sparse vector is null for vectorId: {}", unique_id);
-                continue;
+            size_t offset = denseVectors.size();
+            denseVectors.resize(offset + dim);
+            float* vector = denseVectors.data() + offset;
+            view.copyDenseTo(vector);
+
+            if (backfillSegments) {
+                segmentStores.appendDenseVector(vectorIndexId, query->getColumn(3).getInt64(), unique_id, vector, dim);
             }
+
             if (metricType == MetricType::Cosine) {
-                normalizeSparseVector(sparseVectorPtr);
+                normalizeVectorInPlace(vector, dim);
             }
 
-            // Convert SparseData to dense vector
-            std::vector<float> denseVector(dim, 0.0f);
-            for (const auto& [idx, val] : *sparseVectorPtr) {
-                if (idx >= 0 && idx < dim) {
-                    denseVector[idx] = val;
-                }
+            vectorIds.push_back(unique_id);
+        } 
+        else if (view.getType() == VectorValueType::Sparse) {
+            // Scatter into a zeroed dense row, then normalize the row: same result
+            // as normalizing the sparse pairs when indexes are unique and in range
+            size_t offset = denseVectors.size();
+            denseVectors.resize(offset + dim, 0.0f);
+            float* denseVector = denseVectors.data() + offset;
+            view.scatterSparseTo(denseVector, dim);
+
+            if (metricType == MetricType::Cosine) {
+                normalizeVectorInPlace(denseVector, dim);
             }
 
-            denseVectors.insert(denseVectors.end(), denseVector.begin(), denseVector.end());
             vectorIds.push_back(unique_id);
         } 
         else {
-            spdlog::debug("Unsupported VectorValueType: {}", static_cast<int>(vectorValue.type));
+            spdlog::debug("Unsupported VectorValueType: {}", static_cast<int>(view.getType()));
         }
     }
 
+    if (backfillTransaction) {
+        backfillTransaction->commit();
+    }
+
     if (!denseVectors.empty()) {
         faiss::IndexIDMap* idMapIndex = dynamic_cast<faiss::IndexIDMap*>(index.get());
         if (!idMapIndex) {
@@ -261,19 +319,74 @@ void FaissIndexManager::restoreVectorsToIndex(bool skipIfIndexLoaded) {
     saveIndex();
 }
 
+bool FaissIndexManager::loadDenseVectorsFromSegments(std::vector<float>& denseVectors, std::vector<faiss::idx_t>& vectorIds) {
+    auto& segmentStores = VectorSegmentStoreManager::getInstance();
+    if (!segmentStores.isEnabled() || valueType != VectorValueType::Dense) {
+        return false;
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+
+    auto countQuery = dbManager.prepare(db,
+        "SELECT (SELECT COUNT(*) FROM VectorValue WHERE vectorIndexId = ?), "
+        "(SELECT COUNT(*) FROM VectorSegmentEntry WHERE vectorIndexId = ?)");
+    countQuery->bind(1, vectorIndexId);
+    countQuery->bind(2, vectorIndexId);
+    if (!countQuery->executeStep() || countQuery->getColumn(0).getInt64() != countQuery->getColumn(1).getInt64()) {
+        spdlog::debug("Vector segments for vectorIndexId: {} are incomplete, reading VectorValue", vectorIndexId);
+        return false;
+    }
+
+    auto store = segmentStores.get(vectorIndexId);
+    if (store->getDim() != dim) {
+        return false;
+    }
+
+    auto query = dbManager.prepare(db, "SELECT V.unique_id, E.recordIndex "
+        "FROM VectorSegmentEntry E "
+        "JOIN Vector V ON E.vectorId = V.id "
+        "WHERE E.vectorIndexId = ? AND V.deleted = 0");
+    query->bind(1, vectorIndexId);
+
+    while (query->executeStep()) {
+        FloatSpan record = store->get(query->getColumn(1).getInt64());
+        if (record.empty()) {
+            // The record count comes from this table, so this only trips if the store
+            // lost records it had; start over from the blobs. Records are flushed before
+            // their entry commits, so a crash does not leave entries over unwritten data.
+            spdlog::warn("Vector segment record missing for vectorIndexId: {}, reading VectorValue", vectorIndexId);
+            denseVectors.clear();
+            vectorIds.clear();
+            return false;
+        }
+
+        size_t offset = denseVectors.size();
+        denseVectors.insert(denseVectors.end(), record.begin(), record.end());
+        if (metricType == MetricType::Cosine) {
+            normalizeVectorInPlace(denseVectors.data() + offset, record.size);
+        }
+        vectorIds.push_back(query->getColumn(0).getInt());
+    }
+
+    spdlog::debug("Loaded {} dense vectors from segments for vectorIndexId: {}", vectorIds.size(), vectorIndexId);
+    return true;
+}
+
 void FaissIndexManager::setOptimizerSettings() {
     spdlog::debug("Setting optimizer settings for vectorIndexId: {}", vectorIndexId);
 
-    auto& db = DatabaseManager::getInstance().getDatabase();
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
 
-    SQLite::Statement query(db, "SELECT hnswConfigJson, quantizationConfigJson, metricType, vectorValueType FROM VectorIndex WHERE id = ?");
-    query.bind(1, vectorIndexId);
+    auto query = dbManager.prepare(db, "SELECT hnswConfigJson, quantizationConfigJson, metricType, vectorValueType FROM VectorIndex WHERE id = ?");
+    query->bind(1, vectorIndexId);
 
-    if (query.executeStep()) {
-        const std::string& hnswConfigJson = query.getColumn(0).getString();
-        const std::string& quantizationConfigJson = query.getColumn(1).getString();
-        int metricTypeValue = query.getColumn(2).getInt();
-        int vectorValueTypeValue = query.getColumn(3).getInt();
+    if (query->executeStep()) {
+        const std::string& hnswConfigJson = query->getColumn(0).getString();
+        const std::string& quantizationConfigJson = query->getColumn(1).getString();
+        int metricTypeValue = query->getColumn(2).getInt();
+        int vectorValueTypeValue = query->getColumn(3).getInt();
 
         nlohmann::json hnswConfigJsonParsed;
 
@@ -321,10 +434,20 @@ bool FaissIndexManager::indexNeedsUpdate() {
     return !indexLoaded;
 }
 
-void FaissIndexManager::addVectorData(const std::vector<float>& vectorData, int vectorId) {
+void FaissIndexManager::ensureIndexLoaded() {
+    // indexLoaded is set once the index is in place, so it is checked first
+    if (!indexNeedsUpdate() && index) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(loadMutex);
     if (!index || indexNeedsUpdate()) {
         loadIndex();
     }
+}
+
+void FaissIndexManager::addVectorData(const std::vector<float>& vectorData, int vectorId) {
+    ensureIndexLoaded();
 
     if (index->d != this->dim) {
         spdlog::error("Dimension mismatch: Index d = {}, FaissIndexManager dim = {}", index->d, this->dim);
@@ -347,13 +470,16 @@ void FaissIndexManager::addVectorData(const std::vector<float>& vectorData, int
     faiss::idx_t xids = vectorId;
 
     idMapIndex->add_with_ids(1, x, &xids);
+    {
+        // The node added earlier for the same label, if any, is tombstoned here
+        std::lock_guard<std::mutex> lock(labelOffsetsMutex);
+        trackLabelOffsets(idMapIndex);
+    }
     spdlog::debug("ntotal: {}", idMapIndex->ntotal);
 }
 
 void FaissIndexManager::addVectorData(SparseData* vectorData, int vectorId) {
-    if (!index || indexNeedsUpdate()) {
-        loadIndex();
-    }
+    ensureIndexLoaded();
 
     if (metricType == MetricType::Cosine) {
         normalizeSparseVector(vectorData);
@@ -391,6 +517,9 @@ void FaissIndexManager::loadIndex() {
         index.reset(loadedIndex);
         spdlog::debug("FAISS index successfully loaded from file: {} / count={}", 
             indexFileName, index->ntotal);
+
+        // The file may predate deletions
+        loadTombstones();
     } else {
         spdlog::warn("FAISS index file not found. Creating a new index.");
         
@@ -426,51 +555,270 @@ void FaissIndexManager::saveIndex() {
 }
 
 std::vector<std::pair<float, int>> FaissIndexManager::search(const std::vector<float>& queryVector, size_t k) {
-    if (!index || indexNeedsUpdate()) {
-        loadIndex();
+    if (queryVector.size() < static_cast<size_t>(dim)) {
+        // FAISS reads `dim` floats; pad short queries as before instead of reading past the end
+        std::vector<float> padded(queryVector);
+        padded.resize(dim, 0.0f);
+        return search(padded, k);
     }
 
-    std::vector<float> vector = queryVector;
-    if (metricType == MetricType::Cosine) {
-        vector = normalizeVector(queryVector);
+    std::vector<int64_t> labels(k);
+    std::vector<float> distances(k);
+    size_t found = search(queryVector.data(), k, distances.data(), labels.data());
+
+    std::vector<std::pair<float, int>> results;
+    results.reserve(found);
+    for (size_t i = 0; i < found; ++i) {
+        // labels are the external vector unique ids
+        results.emplace_back(distances[i], static_cast<int>(labels[i]));
     }
 
-    // FAISS expects queries as a 2D array (nq x dim)
-    const float* x = vector.data();
-    faiss::idx_t nq = 1;
-    faiss::idx_t knn = k;
+    return results;
+}
 
-    std::vector<faiss::idx_t> indices(knn);
-    std::vector<float> distances(knn);
+faiss::IndexIDMap* FaissIndexManager::getIdMapIndex() {
+    ensureIndexLoaded();
 
     faiss::IndexIDMap* idMapIndex = dynamic_cast<faiss::IndexIDMap*>(index.get());
     if (!idMapIndex) {
         spdlog::error("Index is not of type IndexIDMap");
         throw std::runtime_error("Incorrect index type");
     }
+    return idMapIndex;
+}
 
-    idMapIndex->search(nq, x, knn, distances.data(), indices.data());
+const float* FaissIndexManager::prepareQuery(const float* queryVector) {
+    if (metricType != MetricType::Cosine) {
+        return queryVector;
+    }
 
-    std::vector<std::pair<float, int>> results;
-    results.reserve(k);
-    for (size_t i = 0; i < knn; ++i) {
-        faiss::idx_t faissId = indices[i];
-        if (faissId < 0) {
+    thread_local std::vector<float> normalized;
+    normalized.assign(queryVector, queryVector + dim);
+    normalizeVectorInPlace(normalized.data(), normalized.size());
+    return normalized.data();
+}
+
+size_t FaissIndexManager::count() {
+    return static_cast<size_t>(getIdMapIndex()->ntotal);
+}
+
+void FaissIndexManager::markDeleted(const std::vector<int64_t>& labels) {
+    faiss::IndexIDMap* idMap = getIdMapIndex();
+
+    std::lock_guard<std::mutex> offsetsLock(labelOffsetsMutex);
+    trackLabelOffsets(idMap);
+
+    std::unique_lock<std::shared_mutex> lock(tombstonesMutex);
+    for (int64_t label : labels) {
+        auto it = labelOffsets.find(label);
+        if (it != labelOffsets.end()) {
+            tombstones.insert(it->second);
+        }
+    }
+    spdlog::debug("Tombstoned {} labels in vectorIndexId: {} ({} nodes in total)", labels.size(), vectorIndexId, tombstones.size());
+}
+
+void FaissIndexManager::trackLabelOffsets(const faiss::IndexIDMap* idMap) {
+    if (labelOffsetsIndex != idMap || labelOffsetsCount > idMap->id_map.size()) {
+        labelOffsets.clear();
+        labelOffsetsCount = 0;
+        labelOffsetsIndex = idMap;
+    }
+
+    for (; labelOffsetsCount < idMap->id_map.size(); ++labelOffsetsCount) {
+        int64_t offset = static_cast<int64_t>(labelOffsetsCount);
+        auto [it, inserted] = labelOffsets.try_emplace(idMap->id_map[labelOffsetsCount], offset);
+        if (!inserted) {
+            // A label added again: only its latest node may match
+            std::unique_lock<std::shared_mutex> lock(tombstonesMutex);
+            tombstones.insert(it->second);
+            it->second = offset;
+        }
+    }
+}
+
+size_t FaissIndexManager::deletedCount() {
+    std::shared_lock<std::shared_mutex> lock(tombstonesMutex);
+    return tombstones.size();
+}
+
+void FaissIndexManager::loadTombstones() {
+    faiss::IndexIDMap* idMap = dynamic_cast<faiss::IndexIDMap*>(index.get());
+    std::unordered_set<int64_t> deleted;
+    if (idMap && !idMap->id_map.empty()) {
+        auto& dbManager = DatabaseManager::getInstance();
+        auto& db = dbManager.getDatabase();
+        auto query = dbManager.prepare(db, "SELECT V.unique_id FROM VectorValue VV "
+            "JOIN Vector V ON VV.vectorId = V.id "
+            "WHERE VV.vectorIndexId = ? AND V.deleted = 0");
+        query->bind(1, vectorIndexId);
+
+        std::unordered_set<int64_t> live;
+        while (query->executeStep()) {
+            live.insert(query->getColumn(0).getInt64());
+        }
+        for (size_t offset = 0; offset < idMap->id_map.size(); ++offset) {
+            if (live.count(idMap->id_map[offset]) == 0) {
+                deleted.insert(static_cast<int64_t>(offset));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> offsetsLock(labelOffsetsMutex);
+    {
+        std::unique_lock<std::shared_mutex> lock(tombstonesMutex);
+        tombstones = std::move(deleted);
+    }
+
+    // The file may also hold several nodes of a label that was upserted again
+    labelOffsetsIndex = nullptr;
+    if (idMap) {
+        trackLabelOffsets(idMap);
+    }
+
+    std::shared_lock<std::shared_mutex> lock(tombstonesMutex);
+    if (!tombstones.empty()) {
+        spdlog::debug("Tombstoned {} nodes without a live vector in vectorIndexId: {}", tombstones.size(), vectorIndexId);
+    }
+}
+
+size_t FaissIndexManager::search(const float* queryVector, size_t k, float* outDistances, int64_t* outLabels) {
+    getIdMapIndex();  // loads the index, and its tombstones, before locking them
+
+    std::shared_lock<std::shared_mutex> lock(tombstonesMutex);
+    if (tombstones.empty()) {
+        return searchIndex(queryVector, k, nullptr, outDistances, outLabels);
+    }
+    LiveIDSelector live(tombstones, getIdMapIndex()->id_map, nullptr);
+    return searchSelected(queryVector, k, live, outDistances, outLabels);
+}
+
+size_t FaissIndexManager::search(const float* queryVector, size_t k, const faiss::IDSelector& selector,
+                                 float* outDistances, int64_t* outLabels) {
+    getIdMapIndex();
+
+    // Also wraps the selector when nothing is tombstoned, to hand it labels
+    std::shared_lock<std::shared_mutex> lock(tombstonesMutex);
+    LiveIDSelector live(tombstones, getIdMapIndex()->id_map, &selector);
+    return searchSelected(queryVector, k, live, outDistances, outLabels);
+}
+
+size_t FaissIndexManager::searchSelected(const float* queryVector, size_t k, const faiss::IDSelector& selector,
+                                         float* outDistances, int64_t* outLabels) {
+    faiss::IndexIDMap* idMap = getIdMapIndex();
+
+    // The selector tests node positions of the wrapped index (see searchIndex)
+    faiss::IndexHNSW* hnswIndex = dynamic_cast<faiss::IndexHNSW*>(idMap->index);
+    if (hnswIndex) {
+        faiss::SearchParametersHNSW params;
+        params.sel = const_cast<faiss::IDSelector*>(&selector);
+        params.efSearch = std::max(hnswIndex->hnsw.efSearch, static_cast<int>(k));
+        return searchIndex(queryVector, k, &params, outDistances, outLabels);
+    }
+
+    faiss::SearchParameters params;
+    params.sel = const_cast<faiss::IDSelector*>(&selector);
+    return searchIndex(queryVector, k, &params, outDistances, outLabels);
+}
+
+size_t FaissIndexManager::searchIndex(const float* queryVector, size_t k, const faiss::SearchParameters* params,
+                                      float* outDistances, int64_t* outLabels) {
+    faiss::IndexIDMap* idMap = getIdMapIndex();
+    if (k == 0) {
+        return 0;
+    }
+
+    const float* x = prepareQuery(queryVector);
+
+    // The wrapped index is searched directly, so selectors see node positions and
+    // tombstones can tell nodes of the same label apart. FAISS expects queries as a
+    // 2D array (nq x dim).
+    static_assert(sizeof(faiss::idx_t) == sizeof(int64_t), "faiss::idx_t must be 64-bit");
+    idMap->index->search(1, x, static_cast<faiss::idx_t>(k), outDistances, reinterpret_cast<faiss::idx_t*>(outLabels), params);
+
+    // Missing hits are -1; move the found ones to the front as labels
+    size_t found = 0;
+    for (size_t i = 0; i < k; ++i) {
+        if (outLabels[i] < 0) {
             continue;
         }
-        // faissId is your external vectorId
-        int originalId = static_cast<int>(faissId);
-        results.emplace_back(distances[i], originalId);
+        outDistances[found] = outDistances[i];
+        outLabels[found] = idMap->id_map[outLabels[i]];
+        ++found;
     }
+    return found;
+}
 
-    return results;
+size_t FaissIndexManager::searchExact(const float* queryVector, const int64_t* labels, size_t labelCount, size_t k,
+                                      float* outDistances, int64_t* outLabels) {
+    faiss::IndexIDMap* idMap = getIdMapIndex();
+    if (k == 0) {
+        return 0;
+    }
+
+    thread_local std::vector<std::pair<int64_t, int64_t>> targets;  // label, offset
+    targets.clear();
+    {
+        std::lock_guard<std::mutex> lock(labelOffsetsMutex);
+        trackLabelOffsets(idMap);
+
+        std::shared_lock<std::shared_mutex> tombstonesLock(tombstonesMutex);
+        for (size_t i = 0; i < labelCount; ++i) {
+            auto it = labelOffsets.find(labels[i]);
+            if (it != labelOffsets.end() && tombstones.count(it->second) == 0) {
+                targets.emplace_back(labels[i], it->second);
+            }
+        }
+    }
+
+    const float* x = prepareQuery(queryVector);
+    bool similarity = idMap->metric_type == faiss::METRIC_INNER_PRODUCT;
+
+    // Distances as the index reports them: squared L2, or the inner product
+    thread_local std::vector<float> stored;
+    thread_local std::vector<std::pair<float, int64_t>> hits;
+    stored.resize(dim);
+    hits.clear();
+    hits.reserve(targets.size());
+    for (const auto& [label, offset] : targets) {
+        idMap->index->reconstruct(offset, stored.data());
+        float distance = similarity ? faiss::fvec_inner_product(x, stored.data(), dim)
+                                    : faiss::fvec_L2sqr(x, stored.data(), dim);
+        hits.emplace_back(distance, label);
+    }
+
+    size_t found = std::min(k, hits.size());
+    std::partial_sort(hits.begin(), hits.begin() + found, hits.end(),
+        [similarity](const std::pair<float, int64_t>& a, const std::pair<float, int64_t>& b) {
+            if (a.first != b.first) {
+                return similarity ? a.first > b.first : a.first < b.first;
+            }
+            return a.second < b.second;
+        });
+    for (size_t i = 0; i < found; ++i) {
+        outDistances[i] = hits[i].first;
+        outLabels[i] = hits[i].second;
+    }
+    return found;
 }
 
-std::vector<std::pair<float, int>> FaissIndexManager::search(SparseData* sparseQueryVector, size_t k) {
-    if (!index || indexNeedsUpdate()) {
-        loadIndex();
+size_t FaissIndexManager::search(const int* sparseIndices, const float* sparseValues, size_t nnz, size_t k,
+                                 float* outDistances, int64_t* outLabels) {
+    thread_local std::vector<float> denseVector;
+    denseVector.assign(dim, 0.0f);
+    for (size_t i = 0; i < nnz; ++i) {
+        int idx = sparseIndices[i];
+        if (idx >= 0 && idx < dim) {
+            denseVector[idx] = sparseValues[i];
+        }
     }
 
+    return search(denseVector.data(), k, outDistances, outLabels);
+}
+
+std::vector<std::pair<float, int>> FaissIndexManager::search(SparseData* sparseQueryVector, size_t k) {
+    ensureIndexLoaded();
+
     if (metricType == MetricType::Cosine) {
         normalizeSparseVector(sparseQueryVector);
     }
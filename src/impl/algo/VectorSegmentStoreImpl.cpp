@@ -0,0 +1,295 @@
+#include "algo/VectorSegmentStore.hpp"
+#include "Config.hpp"
+#include "DatabaseManager.hpp"
+#include "IdCache.hpp"
+#include "VectorIndex.hpp"
+#include "utils/Utils.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace atinyvectors
+{
+namespace algo
+{
+
+namespace {
+
+const char SEGMENT_MAGIC[8] = {'A', 'T', 'V', 'S', 'E', 'G', '0', '1'};
+
+// Records start at a 64-byte boundary so they stay aligned for SIMD loads
+struct SegmentHeader {
+    char magic[8];
+    uint32_t dim;
+    uint32_t reserved;
+    uint64_t recordsPerSegment;
+    uint8_t padding[40];
+};
+static_assert(sizeof(SegmentHeader) == 64, "segment header must be 64 bytes");
+
+bool readHeader(const std::string& path, SegmentHeader& header) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t bytesRead = ::pread(fd, &header, sizeof(header), 0);
+    ::close(fd);
+    return bytesRead == static_cast<ssize_t>(sizeof(header)) &&
+           std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) == 0;
+}
+
+}
+
+VectorSegmentStore::VectorSegmentStore(const std::string& directory, int dim, size_t recordsPerSegment)
+    : directory(directory), dim(dim), recordsPerSegment(recordsPerSegment),
+      recordStride(static_cast<size_t>(dim) * sizeof(float)) {
+    if (dim <= 0 || recordsPerSegment == 0) {
+        throw std::invalid_argument("VectorSegmentStore requires a positive dimension and segment size");
+    }
+
+    std::filesystem::create_directories(directory);
+
+    // Existing stores keep the layout they were created with
+    SegmentHeader header;
+    if (readHeader(segmentPath(0), header)) {
+        if (header.dim != static_cast<uint32_t>(dim)) {
+            throw std::runtime_error("Vector segment dimension mismatch in " + directory);
+        }
+        this->recordsPerSegment = static_cast<size_t>(header.recordsPerSegment);
+    }
+}
+
+VectorSegmentStore::~VectorSegmentStore() {
+    for (auto& segment : segments) {
+        if (!segment) {
+            continue;
+        }
+        if (segment->base) {
+            ::munmap(segment->base, segment->length);
+        }
+        if (segment->fd >= 0) {
+            ::close(segment->fd);
+        }
+    }
+}
+
+std::string VectorSegmentStore::segmentPath(size_t segmentIndex) const {
+    return directory + "/segment_" + std::to_string(segmentIndex) + ".vseg";
+}
+
+VectorSegmentStore::Segment& VectorSegmentStore::openSegment(size_t segmentIndex) {
+    if (segmentIndex < segments.size() && segments[segmentIndex]) {
+        return *segments[segmentIndex];
+    }
+    if (segmentIndex >= segments.size()) {
+        segments.resize(segmentIndex + 1);
+    }
+
+    std::string path = segmentPath(segmentIndex);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open vector segment: " + path);
+    }
+
+    // Preallocate the whole segment (sparse on disk) so it is mapped exactly once
+    // and spans handed out earlier never move.
+    size_t length = sizeof(SegmentHeader) + recordsPerSegment * recordStride;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < length) {
+        if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to size vector segment: " + path);
+        }
+    }
+
+    void* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Failed to map vector segment: " + path);
+    }
+
+    auto segment = std::make_unique<Segment>();
+    segment->fd = fd;
+    segment->base = static_cast<uint8_t*>(base);
+    segment->length = length;
+
+    auto* header = reinterpret_cast<SegmentHeader*>(segment->base);
+    if (std::memcmp(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        std::memset(header, 0, sizeof(SegmentHeader));
+        std::memcpy(header->magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+        header->dim = static_cast<uint32_t>(dim);
+        header->recordsPerSegment = recordsPerSegment;
+    }
+
+    segments[segmentIndex] = std::move(segment);
+    spdlog::debug("Mapped vector segment {} ({} bytes)", path, length);
+    return *segments[segmentIndex];
+}
+
+int64_t VectorSegmentStore::append(const float* data) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    int64_t recordIndex = recordCount;
+    Segment& segment = openSegment(static_cast<size_t>(recordIndex) / recordsPerSegment);
+    size_t offset = sizeof(SegmentHeader) + (static_cast<size_t>(recordIndex) % recordsPerSegment) * recordStride;
+    std::memcpy(segment.base + offset, data, recordStride);
+
+    ++recordCount;
+    return recordIndex;
+}
+
+FloatSpan VectorSegmentStore::get(int64_t recordIndex) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    if (recordIndex < 0 || recordIndex >= recordCount) {
+        return FloatSpan();
+    }
+
+    Segment& segment = openSegment(static_cast<size_t>(recordIndex) / recordsPerSegment);
+    size_t offset = sizeof(SegmentHeader) + (static_cast<size_t>(recordIndex) % recordsPerSegment) * recordStride;
+    return FloatSpan{reinterpret_cast<const float*>(segment.base + offset), static_cast<size_t>(dim)};
+}
+
+int64_t VectorSegmentStore::getRecordCount() const {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return recordCount;
+}
+
+void VectorSegmentStore::setRecordCount(int64_t count) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    recordCount = count;
+    syncedCount = count;
+}
+
+bool VectorSegmentStore::sync() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+
+    // Only the pages of the new records; a segment's first record shares its
+    // page with the header, so a new header is flushed along with it
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    int64_t first = syncedCount;
+    while (first < recordCount) {
+        size_t segmentIndex = static_cast<size_t>(first) / recordsPerSegment;
+        int64_t segmentEnd = static_cast<int64_t>((segmentIndex + 1) * recordsPerSegment);
+        int64_t last = std::min(recordCount, segmentEnd);
+
+        Segment& segment = openSegment(segmentIndex);
+        size_t begin = sizeof(SegmentHeader) + (static_cast<size_t>(first) % recordsPerSegment) * recordStride;
+        size_t end = begin + static_cast<size_t>(last - first) * recordStride;
+        begin -= begin % pageSize;
+        if (::msync(segment.base + begin, end - begin, MS_SYNC) != 0) {
+            spdlog::error("Failed to sync vector segment {} of {}", segmentIndex, directory);
+            return false;
+        }
+        first = last;
+    }
+
+    syncedCount = recordCount;
+    return true;
+}
+
+std::unique_ptr<VectorSegmentStoreManager> VectorSegmentStoreManager::instance;
+std::mutex VectorSegmentStoreManager::instanceMutex;
+
+VectorSegmentStoreManager::VectorSegmentStoreManager()
+    : enabled(Config::getInstance().isVectorSegmentStoreEnabled()),
+      recordsPerSegment(static_cast<size_t>(Config::getInstance().getVectorSegmentRecords())) {
+    // A committed VectorSegmentEntry must never point at a record that is still
+    // only in the page cache; after a crash it would read back as zeros
+    if (enabled) {
+        DatabaseManager::addPreCommitHook([this]() { return syncPending(); });
+    }
+}
+
+VectorSegmentStoreManager& VectorSegmentStoreManager::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance.reset(new VectorSegmentStoreManager());
+    }
+    return *instance;
+}
+
+std::shared_ptr<VectorSegmentStore> VectorSegmentStoreManager::get(int vectorIndexId) {
+    std::lock_guard<std::mutex> lock(storesMutex);
+
+    // Record indexes live in the database; after a reset they no longer match
+    auto& dbManager = DatabaseManager::getInstance();
+    if (storesGeneration != dbManager.getResetGeneration()) {
+        stores.clear();
+        storesGeneration = dbManager.getResetGeneration();
+    }
+
+    auto it = stores.find(vectorIndexId);
+    if (it != stores.end()) {
+        return it->second;
+    }
+
+    VectorIndex vectorIndex = VectorIndexManager::getInstance().getVectorIndexById(vectorIndexId);
+    auto spaceNameAndVersion = IdCache::getInstance().getSpaceNameAndVersionUniqueIdByVectorIndexId(vectorIndexId);
+    std::string directory = utils::getDataPathByVersionUniqueId(spaceNameAndVersion.first, spaceNameAndVersion.second) +
+                            "/index/segments_" + std::to_string(vectorIndexId);
+
+    auto store = std::make_shared<VectorSegmentStore>(directory, vectorIndex.dimension, recordsPerSegment);
+
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "SELECT IFNULL(MAX(recordIndex), -1) + 1 FROM VectorSegmentEntry WHERE vectorIndexId = ?");
+    query->bind(1, vectorIndexId);
+    if (query->executeStep()) {
+        store->setRecordCount(query->getColumn(0).getInt64());
+    }
+
+    spdlog::debug("Opened vector segment store for vectorIndexId={} with {} records", vectorIndexId, store->getRecordCount());
+    stores[vectorIndexId] = store;
+    return store;
+}
+
+void VectorSegmentStoreManager::appendDenseVector(int vectorIndexId, long vectorId, int uniqueId, const float* data, size_t size) {
+    auto store = get(vectorIndexId);
+    if (size != static_cast<size_t>(store->getDim())) {
+        spdlog::debug("Skipping segment record for vectorId={}: size {} does not match dim {}", vectorId, size, store->getDim());
+        return;
+    }
+
+    int64_t recordIndex = store->append(data);
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (std::find(pendingSync.begin(), pendingSync.end(), store) == pendingSync.end()) {
+            pendingSync.push_back(store);
+        }
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getDatabase();
+    auto query = dbManager.prepare(db, "INSERT OR REPLACE INTO VectorSegmentEntry (vectorIndexId, vectorId, unique_id, recordIndex) VALUES (?, ?, ?, ?)");
+    query->bind(1, vectorIndexId);
+    query->bind(2, static_cast<int64_t>(vectorId));
+    query->bind(3, uniqueId);
+    query->bind(4, recordIndex);
+    query->exec();
+}
+
+bool VectorSegmentStoreManager::syncPending() {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    for (auto it = pendingSync.begin(); it != pendingSync.end(); it = pendingSync.erase(it)) {
+        if (!(*it)->sync()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void VectorSegmentStoreManager::clean() {
+    std::lock_guard<std::mutex> lock(storesMutex);
+    stores.clear();
+    spdlog::debug("Vector segment stores have been closed.");
+}
+
+}; // namespace algo
+}; // namespace atinyvectors
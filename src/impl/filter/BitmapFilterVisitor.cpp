@@ -0,0 +1,396 @@
+#include "filter/BitmapFilterVisitor.hpp"
+#include "filter/FilterManager.hpp"
+#include "filter/ParsedFilter.hpp"
+#include "filter/SQLBuilderVisitor.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
+namespace atinyvectors
+{
+namespace filter
+{
+
+BitmapFilterVisitor::BitmapFilterVisitor(const VersionBitmaps& bitmaps) : bitmaps(bitmaps), supported(true) {
+}
+
+bool BitmapFilterVisitor::evaluate(const std::string& filter, const VersionBitmaps& bitmaps, RoaringBitmap& result) {
+    // Support only depends on the filter, so an unsupported one is not walked again
+    std::shared_ptr<const ParsedFilter> parsed = FilterManager::getInstance().parse(filter);
+    if (parsed->tree == nullptr || parsed->bitmapUnsupported) {
+        return false;
+    }
+
+    BitmapFilterVisitor visitor(bitmaps);
+    RoaringBitmap matched = visitor.evaluateCondition(parsed->tree);
+    if (!visitor.isSupported()) {
+        spdlog::debug("Filter is not supported by the bitmap index: {}", filter);
+        parsed->bitmapUnsupported = true;
+        return false;
+    }
+
+    result = std::move(matched);
+    return true;
+}
+
+RoaringBitmap BitmapFilterVisitor::evaluateCondition(PlanParser::ExprContext* ctx) {
+    if (!supported || ctx == nullptr) {
+        supported = false;
+        return RoaringBitmap();
+    }
+
+    std::any result = visit(ctx);
+    if (auto* bitmap = std::any_cast<RoaringBitmap>(&result)) {
+        return std::move(*bitmap);
+    }
+    supported = false;
+    return RoaringBitmap();
+}
+
+std::any BitmapFilterVisitor::unsupported() {
+    supported = false;
+    return std::any();
+}
+
+std::any BitmapFilterVisitor::visitChildren(antlr4::tree::ParseTree* node) {
+    // Every rule without an override, so partial results never leak upwards
+    return unsupported();
+}
+
+bool BitmapFilterVisitor::conditionKey(PlanParser::ExprContext* ctx, std::string& key) {
+    if (auto idCtx = dynamic_cast<PlanParser::IdentifierContext*>(ctx)) {
+        key = idCtx->getText();
+        return true;
+    }
+    return false;
+}
+
+bool BitmapFilterVisitor::literal(PlanParser::ExprContext* ctx, Literal& operand) {
+    FilterParameter parameter;
+
+    if (dynamic_cast<PlanParser::StringContext*>(ctx) != nullptr) {
+        antlr4::Token* token = ctx->getStart();
+        if (!SQLBuilderVisitor::toParameter(token->getType(), token->getText(), parameter)) {
+            return false;
+        }
+        operand.numeric = false;
+        operand.text = parameter.textValue;
+        return true;
+    }
+
+    if (dynamic_cast<PlanParser::BooleanContext*>(ctx) != nullptr) {
+        std::string value = ctx->getText();
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        if (value != "true" && value != "false") {
+            return false;
+        }
+        operand.numeric = true;
+        operand.number = (value == "true") ? 1.0 : 0.0;
+        return true;
+    }
+
+    // Negative numbers arrive as a unary minus on the constant
+    double sign = 1.0;
+    if (auto unaryCtx = dynamic_cast<PlanParser::UnaryContext*>(ctx)) {
+        if (unaryCtx->op->getType() != PlanParser::SUB && unaryCtx->op->getType() != PlanParser::ADD) {
+            return false;
+        }
+        sign = unaryCtx->op->getType() == PlanParser::SUB ? -1.0 : 1.0;
+        ctx = unaryCtx->expr();
+    }
+
+    if (dynamic_cast<PlanParser::IntegerContext*>(ctx) == nullptr &&
+        dynamic_cast<PlanParser::FloatingContext*>(ctx) == nullptr) {
+        return false;
+    }
+    antlr4::Token* token = ctx->getStart();
+    if (!SQLBuilderVisitor::toParameter(token->getType(), token->getText(), parameter)) {
+        return false;
+    }
+    if (parameter.type == FilterParameter::Type::Integer) {
+        // SQLite compares large integers with REAL exactly; doubles only hold 53 bits
+        if (parameter.intValue > (1LL << 53) || parameter.intValue < -(1LL << 53)) {
+            return false;
+        }
+        operand.number = sign * static_cast<double>(parameter.intValue);
+    } else {
+        operand.number = sign * parameter.realValue;
+    }
+    operand.numeric = true;
+    return true;
+}
+
+const VersionBitmaps::KeyBitmaps* BitmapFilterVisitor::findKey(const std::string& key) const {
+    auto it = bitmaps.keys.find(key);
+    return it != bitmaps.keys.end() ? &it->second : nullptr;
+}
+
+template <typename Predicate>
+RoaringBitmap BitmapFilterVisitor::unionValues(const std::string& key, Predicate predicate) const {
+    RoaringBitmap result;
+    if (const auto* keyBitmaps = findKey(key)) {
+        for (const auto& [value, bitmap] : keyBitmaps->values) {
+            if (predicate(value)) {
+                result |= bitmap;
+            }
+        }
+    }
+    return result;
+}
+
+template <typename Predicate>
+RoaringBitmap BitmapFilterVisitor::unionNumbers(const std::string& key, Predicate predicate) const {
+    RoaringBitmap result;
+    if (const auto* keyBitmaps = findKey(key)) {
+        for (const auto& [number, bitmap] : keyBitmaps->numbers) {
+            if (predicate(number)) {
+                result |= bitmap;
+            }
+        }
+    }
+    return result;
+}
+
+namespace {
+
+// Union of the bitmaps of an ordered map between two optional bounds
+template <typename Map>
+RoaringBitmap unionRange(const Map& map, const typename Map::key_type* lower, bool lowerInclusive,
+                         const typename Map::key_type* upper, bool upperInclusive) {
+    RoaringBitmap result;
+    if (lower != nullptr && upper != nullptr &&
+        (*upper < *lower || (!(*lower < *upper) && !(lowerInclusive && upperInclusive)))) {
+        return result;  // empty range; the bounds below would cross
+    }
+
+    auto first = map.begin();
+    auto last = map.end();
+    if (lower != nullptr) {
+        first = lowerInclusive ? map.lower_bound(*lower) : map.upper_bound(*lower);
+    }
+    if (upper != nullptr) {
+        last = upperInclusive ? map.upper_bound(*upper) : map.lower_bound(*upper);
+    }
+
+    for (auto it = first; it != last; ++it) {
+        result |= it->second;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+std::any BitmapFilterVisitor::rangeCondition(const std::string& key, const Literal* lower, bool lowerInclusive,
+                                             const Literal* upper, bool upperInclusive) {
+    // Both bounds compare against the same column; mixed bounds are left to SQL
+    bool numeric = lower != nullptr ? lower->numeric : upper->numeric;
+    if ((lower != nullptr && lower->numeric != numeric) || (upper != nullptr && upper->numeric != numeric)) {
+        return unsupported();
+    }
+
+    const auto* keyBitmaps = findKey(key);
+    if (keyBitmaps == nullptr) {
+        return std::any(RoaringBitmap());
+    }
+    if (numeric) {
+        return std::any(unionRange(keyBitmaps->numbers,
+                                   lower != nullptr ? &lower->number : nullptr, lowerInclusive,
+                                   upper != nullptr ? &upper->number : nullptr, upperInclusive));
+    }
+    // Values are ordered by byte, as the BINARY collation compares TEXT
+    return std::any(unionRange(keyBitmaps->values,
+                               lower != nullptr ? &lower->text : nullptr, lowerInclusive,
+                               upper != nullptr ? &upper->text : nullptr, upperInclusive));
+}
+
+bool BitmapFilterVisitor::likeMatch(const std::string& value, const std::string& pattern) {
+    // SQLite LIKE: '%' matches any sequence, '_' one UTF-8 character, ASCII letters
+    // compare case-insensitively
+    auto charLength = [](const std::string& s, size_t pos) {
+        size_t length = 1;
+        while (pos + length < s.size() && (static_cast<unsigned char>(s[pos + length]) & 0xC0) == 0x80) {
+            ++length;
+        }
+        return length;
+    };
+    auto fold = [](char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    };
+
+    size_t v = 0;
+    size_t p = 0;
+    size_t starPattern = std::string::npos;
+    size_t starValue = 0;
+    while (v < value.size()) {
+        if (p < pattern.size() && pattern[p] == '%') {
+            starPattern = ++p;
+            starValue = v;
+        } else if (p < pattern.size() && pattern[p] == '_') {
+            v += charLength(value, v);
+            ++p;
+        } else if (p < pattern.size() && fold(pattern[p]) == fold(value[v])) {
+            ++v;
+            ++p;
+        } else if (starPattern != std::string::npos) {
+            starValue += charLength(value, starValue);
+            v = starValue;
+            p = starPattern;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+std::any BitmapFilterVisitor::visitParens(PlanParser::ParensContext* ctx) {
+    RoaringBitmap result = evaluateCondition(ctx->expr());
+    return supported ? std::any(std::move(result)) : std::any();
+}
+
+std::any BitmapFilterVisitor::visitLike(PlanParser::LikeContext* ctx) {
+    std::string key;
+    FilterParameter pattern;
+    antlr4::Token* token = ctx->StringLiteral()->getSymbol();
+    if (!conditionKey(ctx->expr(), key) ||
+        !SQLBuilderVisitor::toParameter(token->getType(), token->getText(), pattern)) {
+        return unsupported();
+    }
+
+    return std::any(unionValues(key, [&](const std::string& value) {
+        return likeMatch(value, pattern.textValue);
+    }));
+}
+
+std::any BitmapFilterVisitor::visitEquality(PlanParser::EqualityContext* ctx) {
+    std::string key;
+    Literal operand;
+    if (!conditionKey(ctx->expr(0), key) || !literal(ctx->expr(1), operand)) {
+        return unsupported();
+    }
+
+    if (ctx->op->getType() == PlanParser::EQ) {
+        return rangeCondition(key, &operand, true, &operand, true);
+    }
+
+    if (operand.numeric) {
+        return std::any(unionNumbers(key, [&](double number) { return number != operand.number; }));
+    }
+    return std::any(unionValues(key, [&](const std::string& value) { return value != operand.text; }));
+}
+
+std::any BitmapFilterVisitor::visitLogicalAnd(PlanParser::LogicalAndContext* ctx) {
+    RoaringBitmap left = evaluateCondition(ctx->expr(0));
+    RoaringBitmap right = evaluateCondition(ctx->expr(1));
+    return supported ? std::any(left &= right) : std::any();
+}
+
+std::any BitmapFilterVisitor::visitLogicalOr(PlanParser::LogicalOrContext* ctx) {
+    RoaringBitmap left = evaluateCondition(ctx->expr(0));
+    RoaringBitmap right = evaluateCondition(ctx->expr(1));
+    return supported ? std::any(left |= right) : std::any();
+}
+
+std::any BitmapFilterVisitor::visitRelational(PlanParser::RelationalContext* ctx) {
+    std::string key;
+    Literal operand;
+    if (!conditionKey(ctx->expr(0), key) || !literal(ctx->expr(1), operand)) {
+        return unsupported();
+    }
+
+    switch (ctx->op->getType()) {
+    case PlanParser::LT: return rangeCondition(key, nullptr, false, &operand, false);
+    case PlanParser::LE: return rangeCondition(key, nullptr, false, &operand, true);
+    case PlanParser::GT: return rangeCondition(key, &operand, false, nullptr, false);
+    case PlanParser::GE: return rangeCondition(key, &operand, true, nullptr, false);
+    default: return unsupported();
+    }
+}
+
+std::any BitmapFilterVisitor::visitRange(PlanParser::RangeContext* ctx) {
+    // lower < key < upper
+    Literal lower;
+    Literal upper;
+    if (ctx->Identifier() == nullptr || !literal(ctx->expr(0), lower) || !literal(ctx->expr(1), upper)) {
+        return unsupported();
+    }
+    return rangeCondition(ctx->Identifier()->getText(), &lower, ctx->op1->getType() == PlanParser::LE,
+                          &upper, ctx->op2->getType() == PlanParser::LE);
+}
+
+std::any BitmapFilterVisitor::visitReverseRange(PlanParser::ReverseRangeContext* ctx) {
+    // upper > key > lower
+    Literal upper;
+    Literal lower;
+    if (ctx->Identifier() == nullptr || !literal(ctx->expr(0), upper) || !literal(ctx->expr(1), lower)) {
+        return unsupported();
+    }
+    return rangeCondition(ctx->Identifier()->getText(), &lower, ctx->op2->getType() == PlanParser::GE,
+                          &upper, ctx->op1->getType() == PlanParser::GE);
+}
+
+std::any BitmapFilterVisitor::visitUnary(PlanParser::UnaryContext* ctx) {
+    if (ctx->op->getType() != PlanParser::NOT) {
+        return unsupported();
+    }
+
+    RoaringBitmap operand = evaluateCondition(ctx->expr());
+    return supported ? std::any(bitmaps.all - operand) : std::any();
+}
+
+std::any BitmapFilterVisitor::visitTerm(PlanParser::TermContext* ctx) {
+    std::string key;
+    if (!conditionKey(ctx->expr(0), key)) {
+        return unsupported();
+    }
+
+    std::set<double> numbers;
+    std::unordered_set<std::string> texts;
+    for (size_t i = 1; i < ctx->expr().size(); ++i) {
+        Literal operand;
+        if (!literal(ctx->expr(i), operand)) {
+            return unsupported();
+        }
+        if (operand.numeric) {
+            numbers.insert(operand.number);
+        } else {
+            texts.insert(operand.text);
+        }
+    }
+
+    if (ctx->op->getType() == PlanParser::NIN) {
+        // Mixed lists test both columns of the same row, which bitmaps cannot tell apart
+        if (!numbers.empty() && !texts.empty()) {
+            return unsupported();
+        }
+        if (!numbers.empty()) {
+            return std::any(unionNumbers(key, [&](double number) { return numbers.count(number) == 0; }));
+        }
+        return std::any(unionValues(key, [&](const std::string& value) { return texts.count(value) == 0; }));
+    }
+
+    RoaringBitmap result = unionNumbers(key, [&](double number) { return numbers.count(number) > 0; });
+    result |= unionValues(key, [&](const std::string& value) { return texts.count(value) > 0; });
+    return std::any(std::move(result));
+}
+
+std::any BitmapFilterVisitor::visitEmptyTerm(PlanParser::EmptyTermContext* ctx) {
+    std::string key;
+    if (!conditionKey(ctx->expr(), key)) {
+        return unsupported();
+    }
+
+    // Same as the SQL: IN () tests for a value, NOT IN () for a NULL value
+    if (ctx->op->getType() == PlanParser::NIN) {
+        const auto* keyBitmaps = findKey(key);
+        return std::any(keyBitmaps != nullptr ? keyBitmaps->nulls : RoaringBitmap());
+    }
+    return std::any(unionValues(key, [](const std::string&) { return true; }));
+}
+
+}; // namespace filter
+}; // namespace atinyvectors
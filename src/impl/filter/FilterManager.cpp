@@ -1,18 +1,52 @@
 #include "filter/FilterManager.hpp"
+#include "filter/ParsedFilter.hpp"
 #include "filter/SQLBuilderVisitor.hpp"
+#include "Config.hpp"
 #include "antlr4-runtime.h"
 #include "PlanLexer.h"
 #include "PlanParser.h"
+#include "spdlog/spdlog.h"
 #include <iostream>
+#include <unordered_set>
 
 using namespace atinyvectors::filter;
 
 std::unique_ptr<FilterManager> FilterManager::instance = nullptr;
 std::mutex FilterManager::instanceMutex;
 
-FilterManager::FilterManager() = default;
+void CompiledFilter::bind(SQLite::Statement& statement) const {
+    for (const auto& parameter : parameters) {
+        switch (parameter.type) {
+        case FilterParameter::Type::Integer:
+            statement.bind(parameter.name.c_str(), static_cast<int64_t>(parameter.intValue));
+            break;
+        case FilterParameter::Type::Real:
+            statement.bind(parameter.name.c_str(), parameter.realValue);
+            break;
+        case FilterParameter::Type::Text:
+            statement.bind(parameter.name.c_str(), parameter.textValue);
+            break;
+        }
+    }
+}
+
+ParsedFilter::ParsedFilter(const std::string& filter)
+    : input(filter), lexer(&input), tokens(&lexer), parser(&tokens) {
+    // Invalid filters are reported by the SQL path the callers fall back to
+    lexer.removeErrorListeners();
+    parser.removeErrorListeners();
+
+    PlanParser::ExprContext* parsed = parser.expr();
+    if (lexer.getNumberOfSyntaxErrors() == 0 && parser.getNumberOfSyntaxErrors() == 0) {
+        tree = parsed;
+    }
+}
 
-std::string FilterManager::convertFilterToSQL(const std::string& filter) {
+FilterManager::FilterManager()
+    : cacheCapacity(static_cast<size_t>(atinyvectors::Config::getInstance().getFilterCacheSize())) {
+}
+
+std::string FilterManager::convertFilterToSQL(const std::string& filter, const MetadataIndexes& indexes) {
     antlr4::ANTLRInputStream input(filter);
     PlanLexer lexer(&input);
     antlr4::CommonTokenStream tokens(&lexer);
@@ -20,7 +54,7 @@ std::string FilterManager::convertFilterToSQL(const std::string& filter) {
 
     PlanParser::ExprContext* tree = parser.expr();
 
-    SQLBuilderVisitor visitor;
+    SQLBuilderVisitor visitor(false, indexes);
     std::any result = visitor.visit(tree);
 
     if (result.has_value()) {
@@ -42,6 +76,153 @@ FilterManager& FilterManager::getInstance() {
     return *instance;
 }
 
-std::string FilterManager::toSQL(const std::string& filter) {
-    return convertFilterToSQL(filter);
+std::string FilterManager::toSQL(const std::string& filter, const MetadataIndexes& indexes) {
+    return convertFilterToSQL(filter, indexes);
+}
+
+CompiledFilter FilterManager::compile(const std::string& filter, const MetadataIndexes& indexes) {
+    antlr4::ANTLRInputStream input(filter);
+    PlanLexer lexer(&input);
+    antlr4::CommonTokenStream tokens(&lexer);
+    tokens.fill();
+
+    // Whitespace is skipped by the lexer, so the key is also whitespace-normalized
+    std::string shapeKey;
+    FilterParameter scratch;
+    const std::vector<antlr4::Token*> allTokens = tokens.getTokens();
+    for (size_t i = 0; i + 1 < allTokens.size(); ++i) {  // fill() ends the stream with EOF
+        antlr4::Token* token = allTokens[i];
+        if (SQLBuilderVisitor::toParameter(token->getType(), token->getText(), scratch)) {
+            shapeKey += "?" + std::to_string(token->getType());
+            // Only LIKE patterns with a trigram can use the text index
+            if (i > 0 && allTokens[i - 1]->getType() == PlanParser::LIKE &&
+                SQLBuilderVisitor::hasTrigram(scratch.textValue)) {
+                shapeKey += "t";
+            }
+        } else {
+            shapeKey += token->getText();
+        }
+        shapeKey += ' ';
+    }
+    // The same filter reads other tables when its space indexes other metadata
+    for (const auto& path : indexes.paths) {
+        shapeKey += "#" + path;
+    }
+    for (const auto& key : indexes.textKeys) {
+        shapeKey += "~" + key;
+    }
+
+    std::shared_ptr<const FilterTemplate> filterTemplate;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = cacheMap.find(shapeKey);
+        if (it != cacheMap.end()) {
+            cacheList.splice(cacheList.begin(), cacheList, it->second);
+            filterTemplate = it->second->second;
+            ++hits;
+        } else {
+            ++misses;
+        }
+    }
+
+    if (!filterTemplate) {
+        PlanParser parser(&tokens);
+        PlanParser::ExprContext* tree = parser.expr();
+
+        SQLBuilderVisitor visitor(true, indexes);
+        std::any result = visitor.visit(tree);
+
+        auto compiled = std::make_shared<FilterTemplate>();
+        try {
+            compiled->sql = result.has_value() ? std::any_cast<std::string>(result) : "";
+        } catch (const std::bad_any_cast& e) {
+            spdlog::error("Error casting filter SQL to string: {}", e.what());
+        }
+        compiled->placeholders = visitor.getPlaceholders();
+        filterTemplate = compiled;
+
+        // Filters with syntax errors are not cached, so they are reported every time
+        if (parser.getNumberOfSyntaxErrors() == 0 && !compiled->sql.empty() && cacheCapacity > 0) {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            if (cacheMap.find(shapeKey) == cacheMap.end()) {
+                cacheList.emplace_front(shapeKey, filterTemplate);
+                cacheMap[shapeKey] = cacheList.begin();
+                if (cacheList.size() > cacheCapacity) {
+                    cacheMap.erase(cacheList.back().first);
+                    cacheList.pop_back();
+                }
+            }
+        }
+    }
+
+    // Read this filter's literals from its own tokens
+    CompiledFilter compiledFilter;
+    compiledFilter.sql = filterTemplate->sql;
+    std::unordered_set<std::string> boundNames;
+    for (const auto& [name, tokenIndex] : filterTemplate->placeholders) {
+        if (!boundNames.insert(name).second) {
+            continue;
+        }
+        antlr4::Token* token = tokens.get(tokenIndex);
+        FilterParameter parameter;
+        if (!SQLBuilderVisitor::toParameter(token->getType(), token->getText(), parameter)) {
+            throw std::runtime_error("Filter literal does not match its cached shape: " + token->getText());
+        }
+        parameter.name = name;
+        compiledFilter.parameters.push_back(std::move(parameter));
+    }
+
+    spdlog::debug("Compiled filter: {} -> {} ({} parameters)", filter, compiledFilter.sql, compiledFilter.parameters.size());
+    return compiledFilter;
+}
+
+std::shared_ptr<const ParsedFilter> FilterManager::parse(const std::string& filter) {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = parsedMap.find(filter);
+        if (it != parsedMap.end()) {
+            parsedList.splice(parsedList.begin(), parsedList, it->second);
+            return it->second->second;
+        }
+    }
+
+    auto parsed = std::make_shared<const ParsedFilter>(filter);
+    if (cacheCapacity > 0) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = parsedMap.find(filter);
+        if (it != parsedMap.end()) {
+            // Another thread parsed it first; share its plans
+            return it->second->second;
+        }
+        parsedList.emplace_front(filter, parsed);
+        parsedMap[filter] = parsedList.begin();
+        if (parsedList.size() > cacheCapacity) {
+            parsedMap.erase(parsedList.back().first);
+            parsedList.pop_back();
+        }
+    }
+    return parsed;
+}
+
+size_t FilterManager::getCacheSize() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cacheList.size();
+}
+
+size_t FilterManager::getCacheHits() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return hits;
+}
+
+size_t FilterManager::getCacheMisses() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return misses;
+}
+
+void FilterManager::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheList.clear();
+    cacheMap.clear();
+    parsedList.clear();
+    parsedMap.clear();
 }
@@ -0,0 +1,61 @@
+#include "filter/FilterPlanner.hpp"
+#include "Config.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace atinyvectors {
+namespace filter {
+
+std::unique_ptr<FilterPlanner> FilterPlanner::instance;
+std::mutex FilterPlanner::instanceMutex;
+
+const char* toString(FilterPlan plan) {
+    switch (plan) {
+        case FilterPlan::PostFilter:
+            return "post-filter";
+        case FilterPlan::FilteredIndex:
+            return "filtered-index";
+        case FilterPlan::ExactScan:
+            return "exact-scan";
+    }
+    return "unknown";
+}
+
+FilterPlanner::FilterPlanner(size_t exactScanMax, double postFilterSelectivity)
+    : exactScanMax(exactScanMax), postFilterSelectivity(postFilterSelectivity) {
+}
+
+FilterPlanner& FilterPlanner::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        auto& config = Config::getInstance();
+        instance.reset(new FilterPlanner(static_cast<size_t>(config.getFilterExactScanMax()),
+                                         config.getFilterPostFilterSelectivity()));
+    }
+    return *instance;
+}
+
+FilterPlan FilterPlanner::choose(size_t matching, size_t total, size_t k) const {
+    // k or fewer matches are all returned anyway; no traversal can do better
+    if (matching <= std::max(exactScanMax, k)) {
+        return FilterPlan::ExactScan;
+    }
+
+    double selectivity = total > 0 ? static_cast<double>(matching) / static_cast<double>(total) : 1.0;
+    if (selectivity >= postFilterSelectivity) {
+        return FilterPlan::PostFilter;
+    }
+    return FilterPlan::FilteredIndex;
+}
+
+size_t FilterPlanner::postFilterFetch(size_t matching, size_t total, size_t k) {
+    if (matching == 0 || matching >= total) {
+        return std::min(k, total);
+    }
+    double fetch = std::ceil(static_cast<double>(k) * static_cast<double>(total) / static_cast<double>(matching));
+    return std::min(total, static_cast<size_t>(fetch));
+}
+
+};
+};
@@ -0,0 +1,125 @@
+#include "filter/JsonPath.hpp"
+
+#include <stdexcept>
+
+namespace atinyvectors {
+namespace filter {
+
+JsonPath JsonPath::parse(const std::string& text) {
+    auto invalid = [&text](const std::string& reason) {
+        return std::invalid_argument("Invalid JSON path '" + text + "': " + reason);
+    };
+
+    JsonPath path;
+    size_t pos = text.find('[');
+    path.key = text.substr(0, pos);
+    if (path.key.empty()) {
+        throw invalid("missing key");
+    }
+
+    while (pos < text.size()) {
+        if (path.elements) {
+            throw invalid("[] must be the last segment");
+        }
+        if (text[pos] != '[') {
+            throw invalid("expected '['");
+        }
+        ++pos;
+
+        if (pos < text.size() && text[pos] == ']') {
+            path.elements = true;
+            ++pos;
+            continue;
+        }
+
+        Segment segment;
+        if (pos < text.size() && (text[pos] == '"' || text[pos] == '\'')) {
+            size_t end = text.find(text[pos], pos + 1);
+            if (end == std::string::npos) {
+                throw invalid("unterminated member name");
+            }
+            segment.member = text.substr(pos + 1, end - pos - 1);
+            // SQLite paths have no escapes for quoted labels
+            if (segment.member.find_first_of("\"\\") != std::string::npos) {
+                throw invalid("member names cannot contain '\"' or '\\'");
+            }
+            pos = end + 1;
+        } else {
+            size_t end = pos;
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                ++end;
+            }
+            if (end == pos || end - pos > 9) {
+                throw invalid("expected a member name or an array index");
+            }
+            segment.isIndex = true;
+            segment.index = std::stoul(text.substr(pos, end - pos));
+            pos = end;
+        }
+
+        if (pos >= text.size() || text[pos] != ']') {
+            throw invalid("expected ']'");
+        }
+        ++pos;
+        path.segments.push_back(std::move(segment));
+    }
+    return path;
+}
+
+std::string JsonPath::toString() const {
+    std::string text = key;
+    for (const auto& segment : segments) {
+        text += segment.isIndex ? "[" + std::to_string(segment.index) + "]" : "[\"" + segment.member + "\"]";
+    }
+    if (elements) {
+        text += "[]";
+    }
+    return text;
+}
+
+std::string JsonPath::toSQLitePath() const {
+    std::string text = "$";
+    for (const auto& segment : segments) {
+        text += segment.isIndex ? "[" + std::to_string(segment.index) + "]" : ".\"" + segment.member + "\"";
+    }
+    return text;
+}
+
+JsonPath JsonPath::each() const {
+    JsonPath path = *this;
+    path.elements = true;
+    return path;
+}
+
+std::vector<const nlohmann::json*> JsonPath::extract(const nlohmann::json& value) const {
+    const nlohmann::json* node = &value;
+    for (const auto& segment : segments) {
+        if (segment.isIndex) {
+            if (!node->is_array() || segment.index >= node->size()) {
+                return {};
+            }
+            node = &(*node)[segment.index];
+        } else {
+            if (!node->is_object()) {
+                return {};
+            }
+            auto it = node->find(segment.member);
+            if (it == node->end()) {
+                return {};
+            }
+            node = &*it;
+        }
+    }
+
+    if (!elements || !node->is_structured()) {
+        return {node};
+    }
+    std::vector<const nlohmann::json*> values;
+    for (const auto& element : *node) {
+        values.push_back(&element);
+    }
+    return values;
+}
+
+};
+};
@@ -0,0 +1,453 @@
+#include "filter/MetadataBitmapIndex.hpp"
+#include "filter/BitmapFilterVisitor.hpp"
+#include "filter/PredicateBuilderVisitor.hpp"
+#include "DatabaseManager.hpp"
+#include "Config.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+
+namespace atinyvectors {
+namespace filter {
+
+uint32_t KeyColumn::add(uint32_t uniqueId, const std::optional<std::string>& value, const std::optional<double>& number) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(flags.size());
+        values.emplace_back();
+        numbers.push_back(0);
+        flags.push_back(0);
+    }
+
+    values[slot] = value.value_or(std::string());
+    numbers[slot] = number.value_or(0);
+    flags[slot] = (value ? HAS_VALUE : 0) | (number ? HAS_NUMBER : 0);
+    slotsByUniqueId[uniqueId].push_back(slot);
+    return slot;
+}
+
+void KeyColumn::remove(uint32_t uniqueId, uint32_t slot) {
+    auto it = slotsByUniqueId.find(uniqueId);
+    if (it == slotsByUniqueId.end()) {
+        return;
+    }
+    auto& slots = it->second;
+    auto slotIt = std::find(slots.begin(), slots.end(), slot);
+    if (slotIt == slots.end()) {
+        return;
+    }
+    slots.erase(slotIt);
+    if (slots.empty()) {
+        slotsByUniqueId.erase(it);
+    }
+
+    values[slot].clear();
+    values[slot].shrink_to_fit();
+    flags[slot] = 0;
+    freeSlots.push_back(slot);
+}
+
+std::optional<std::string> KeyColumn::value(uint32_t slot) const {
+    return hasValue(slot) ? std::optional<std::string>(values[slot]) : std::nullopt;
+}
+
+std::optional<double> KeyColumn::number(uint32_t slot) const {
+    return hasNumber(slot) ? std::optional<double>(numbers[slot]) : std::nullopt;
+}
+
+std::unique_ptr<MetadataBitmapIndex> MetadataBitmapIndex::instance;
+std::mutex MetadataBitmapIndex::instanceMutex;
+
+MetadataBitmapIndex::MetadataBitmapIndex()
+    : enabled(Config::getInstance().isMetadataBitmapIndexEnabled()) {
+}
+
+MetadataBitmapIndex& MetadataBitmapIndex::getInstance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!instance) {
+        instance.reset(new MetadataBitmapIndex());
+    }
+    return *instance;
+}
+
+void MetadataBitmapIndex::checkGeneration() {
+    // Rows are read from the database; after a reset they no longer match
+    auto& dbManager = DatabaseManager::getInstance();
+    if (versionsGeneration != dbManager.getResetGeneration()) {
+        versions.clear();
+        versionsGeneration = dbManager.getResetGeneration();
+    }
+}
+
+MetadataBitmapIndex::VersionIndex* MetadataBitmapIndex::loadVersion(long versionId) {
+    auto it = versions.find(versionId);
+    if (it != versions.end()) {
+        return it->second.get();
+    }
+
+    auto& dbManager = DatabaseManager::getInstance();
+    auto& db = dbManager.getReadDatabase();
+
+    // Rows of an open write transaction would stay in the index if it rolled back
+    if (dbManager.readsUncommittedRows(db)) {
+        return nullptr;
+    }
+
+    // Rows whose vector no longer exists have no unique_id and are left out
+    auto query = dbManager.prepare(db,
+        "SELECT M.id, M.vectorId, V.unique_id, M.key, M.value, M.numericValue FROM VectorMetadata M "
+        "JOIN Vector V ON V.id = M.vectorId WHERE M.versionId = ?");
+    query->bind(1, static_cast<int64_t>(versionId));
+
+    auto index = std::make_unique<VersionIndex>();
+    while (query->executeStep()) {
+        Entry entry;
+        entry.vectorId = query->getColumn(1).getInt64();
+        entry.uniqueId = static_cast<uint32_t>(query->getColumn(2).getInt64());
+        entry.key = query->getColumn(3).getString();
+        std::optional<std::string> value;
+        std::optional<double> number;
+        if (!query->getColumn(4).isNull()) {
+            value = query->getColumn(4).getString();
+        }
+        if (!query->getColumn(5).isNull()) {
+            number = query->getColumn(5).getDouble();
+        }
+        addEntry(*index, query->getColumn(0).getInt64(), std::move(entry), value, number);
+    }
+
+    spdlog::debug("Loaded metadata bitmap index for versionId {}: {} rows, {} keys, {} vectors",
+                  versionId, index->entries.size(), index->bitmaps.keys.size(), index->bitmaps.all.cardinality());
+
+    VersionIndex* loaded = index.get();
+    versions[versionId] = std::move(index);
+    return loaded;
+}
+
+void MetadataBitmapIndex::addEntry(VersionIndex& index, long metadataId, Entry entry,
+                                   const std::optional<std::string>& value, const std::optional<double>& number) {
+    if (index.entries.count(metadataId) > 0) {
+        return;  // already read while loading the version
+    }
+
+    auto& keyBitmaps = index.bitmaps.keys[entry.key];
+    if (value) {
+        keyBitmaps.values[*value].add(entry.uniqueId);
+    } else {
+        keyBitmaps.nulls.add(entry.uniqueId);
+    }
+    if (number) {
+        keyBitmaps.numbers[*number].add(entry.uniqueId);
+    }
+    index.bitmaps.all.add(entry.uniqueId);
+    entry.slot = index.columns.keys[entry.key].add(entry.uniqueId, value, number);
+    index.entryIdsByVectorId[entry.vectorId].push_back(metadataId);
+    index.vectorIdByUniqueId[entry.uniqueId] = entry.vectorId;
+    index.entries.emplace(metadataId, std::move(entry));
+}
+
+void MetadataBitmapIndex::removeEntry(VersionIndex& index, long metadataId) {
+    auto it = index.entries.find(metadataId);
+    if (it == index.entries.end()) {
+        return;
+    }
+    Entry entry = std::move(it->second);
+    index.entries.erase(it);
+
+    auto& siblings = index.entryIdsByVectorId[entry.vectorId];
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), metadataId), siblings.end());
+
+    // Siblings with the same key share the column
+    KeyColumn& column = index.columns.keys.at(entry.key);
+    std::optional<std::string> value = column.value(entry.slot);
+    std::optional<double> number = column.number(entry.slot);
+    column.remove(entry.uniqueId, entry.slot);
+
+    // A vector may hold the same pair in several rows; keep its bit while one is left
+    auto heldBySibling = [&](auto read, const auto& field) {
+        return std::any_of(siblings.begin(), siblings.end(), [&](long siblingId) {
+            const Entry& sibling = index.entries.at(siblingId);
+            return sibling.key == entry.key && (column.*read)(sibling.slot) == field;
+        });
+    };
+    bool valueHeld = heldBySibling(&KeyColumn::value, value);
+    bool numberHeld = !number || heldBySibling(&KeyColumn::number, number);
+    if (column.empty()) {
+        index.columns.keys.erase(entry.key);
+    }
+
+    auto keyIt = index.bitmaps.keys.find(entry.key);
+    if (keyIt != index.bitmaps.keys.end()) {
+        auto& keyBitmaps = keyIt->second;
+        if (!valueHeld && value) {
+            auto valueIt = keyBitmaps.values.find(*value);
+            if (valueIt != keyBitmaps.values.end()) {
+                valueIt->second.remove(entry.uniqueId);
+                if (valueIt->second.empty()) {
+                    keyBitmaps.values.erase(valueIt);
+                }
+            }
+        } else if (!valueHeld) {
+            keyBitmaps.nulls.remove(entry.uniqueId);
+        }
+        if (!numberHeld) {
+            auto numberIt = keyBitmaps.numbers.find(*number);
+            if (numberIt != keyBitmaps.numbers.end()) {
+                numberIt->second.remove(entry.uniqueId);
+                if (numberIt->second.empty()) {
+                    keyBitmaps.numbers.erase(numberIt);
+                }
+            }
+        }
+        if (keyBitmaps.values.empty() && keyBitmaps.nulls.empty()) {
+            index.bitmaps.keys.erase(keyIt);
+        }
+    }
+
+    if (siblings.empty()) {
+        index.entryIdsByVectorId.erase(entry.vectorId);
+        index.bitmaps.all.remove(entry.uniqueId);
+        index.vectorIdByUniqueId.erase(entry.uniqueId);
+    }
+}
+
+bool MetadataBitmapIndex::evaluate(long versionId, const std::string& filter, RoaringBitmap& result) {
+    if (!enabled) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock;
+    VersionIndex* index = acquireVersion(versionId, lock);
+    if (!index) {
+        return false;
+    }
+    return BitmapFilterVisitor::evaluate(filter, index->bitmaps, result);
+}
+
+bool MetadataBitmapIndex::evaluate(long versionId, const FilterPredicate& predicate,
+                                   const uint32_t* uniqueIds, size_t count, uint8_t* matched) {
+    if (!enabled) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock;
+    VersionIndex* index = acquireVersion(versionId, lock);
+    if (!index) {
+        return false;
+    }
+    predicate.evaluate(index->bitmaps, index->columns, uniqueIds, count, matched);
+    return true;
+}
+
+bool MetadataBitmapIndex::facets(long versionId, const std::string& filter, const std::vector<std::string>& keys,
+                                 int limit, MetadataFacets& result) {
+    if (!enabled) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock;
+    VersionIndex* index = acquireVersion(versionId, lock);
+    if (!index) {
+        return false;
+    }
+    if (filter.empty()) {
+        countFacets(index->bitmaps, nullptr, keys, limit, result);
+        return true;
+    }
+
+    RoaringBitmap matched;
+    if (!BitmapFilterVisitor::evaluate(filter, index->bitmaps, matched)) {
+        return false;
+    }
+    countFacets(index->bitmaps, &matched, keys, limit, result);
+    return true;
+}
+
+bool MetadataBitmapIndex::facets(long versionId, const RoaringBitmap& domain, const std::vector<std::string>& keys,
+                                 int limit, MetadataFacets& result) {
+    if (!enabled) {
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock;
+    VersionIndex* index = acquireVersion(versionId, lock);
+    if (!index) {
+        return false;
+    }
+    countFacets(index->bitmaps, &domain, keys, limit, result);
+    return true;
+}
+
+void MetadataBitmapIndex::countFacets(const VersionBitmaps& bitmaps, const RoaringBitmap* domain,
+                                      const std::vector<std::string>& keys, int limit, MetadataFacets& result) {
+    for (const auto& key : keys) {
+        auto& facets = result[key];
+        auto keyIt = bitmaps.keys.find(key);
+        if (keyIt == bitmaps.keys.end()) {
+            continue;
+        }
+
+        // Values are only copied for the counts that are kept
+        std::vector<std::pair<size_t, const std::string*>> counts;
+        for (const auto& [value, vectors] : keyIt->second.values) {
+            size_t count = domain ? vectors.intersectionCardinality(*domain) : vectors.cardinality();
+            if (count > 0) {
+                counts.emplace_back(count, &value);
+            }
+        }
+
+        auto byCount = [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first > b.first : *a.second < *b.second;
+        };
+        size_t kept = limit < 0 ? counts.size() : std::min(counts.size(), static_cast<size_t>(limit));
+        std::partial_sort(counts.begin(), counts.begin() + kept, counts.end(), byCount);
+
+        facets.reserve(kept);
+        for (size_t i = 0; i < kept; ++i) {
+            facets.push_back({*counts[i].second, static_cast<int>(counts[i].first)});
+        }
+    }
+}
+
+MetadataBitmapIndex::VersionIndex* MetadataBitmapIndex::acquireVersion(long versionId, std::shared_lock<std::shared_mutex>& lock) {
+    while (true) {
+        lock = std::shared_lock<std::shared_mutex>(indexMutex);
+        auto it = versions.find(versionId);
+        if (versionsGeneration == DatabaseManager::getInstance().getResetGeneration() && it != versions.end()) {
+            return it->second.get();
+        }
+        lock.unlock();
+
+        std::unique_lock<std::shared_mutex> writeLock(indexMutex);
+        checkGeneration();
+        if (!loadVersion(versionId)) {
+            return nullptr;
+        }
+    }
+}
+
+std::vector<int> MetadataBitmapIndex::toVectorIds(long versionId, const std::vector<uint32_t>& uniqueIds) {
+    std::vector<int> vectorIds;
+    vectorIds.reserve(uniqueIds.size());
+
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    auto it = versions.find(versionId);
+    if (it == versions.end()) {
+        return vectorIds;
+    }
+    for (uint32_t uniqueId : uniqueIds) {
+        auto vectorIt = it->second->vectorIdByUniqueId.find(uniqueId);
+        if (vectorIt != it->second->vectorIdByUniqueId.end()) {
+            vectorIds.push_back(static_cast<int>(vectorIt->second));
+        }
+    }
+    return vectorIds;
+}
+
+void MetadataBitmapIndex::onMetadataAdded(const VectorMetadata& metadata) {
+    if (!enabled) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    checkGeneration();
+    auto it = versions.find(metadata.versionId);
+    if (it == versions.end()) {
+        return;
+    }
+    VersionIndex& index = *it->second;
+
+    Entry entry;
+    entry.vectorId = metadata.vectorId;
+    entry.key = metadata.key;
+    std::optional<std::string> value;
+    if (metadata.valueType != MetadataValueType::Null) {
+        value = metadata.value;
+    }
+    std::optional<double> number = metadata.numericValue();
+
+    auto siblings = index.entryIdsByVectorId.find(metadata.vectorId);
+    if (siblings != index.entryIdsByVectorId.end() && !siblings->second.empty()) {
+        entry.uniqueId = index.entries.at(siblings->second.front()).uniqueId;
+    } else {
+        auto& dbManager = DatabaseManager::getInstance();
+        auto& db = dbManager.getDatabase();
+        auto query = dbManager.prepare(db, "SELECT unique_id FROM Vector WHERE id = ?");
+        query->bind(1, static_cast<int64_t>(metadata.vectorId));
+        if (!query->executeStep()) {
+            return;  // no vector row, left out like when loading
+        }
+        entry.uniqueId = static_cast<uint32_t>(query->getColumn(0).getInt64());
+    }
+
+    addEntry(index, metadata.id, std::move(entry), value, number);
+}
+
+void MetadataBitmapIndex::onMetadataUpdated(const VectorMetadata& metadata) {
+    if (!enabled) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(indexMutex);
+        checkGeneration();
+        for (auto& version : versions) {
+            removeEntry(*version.second, metadata.id);
+        }
+    }
+    onMetadataAdded(metadata);
+}
+
+void MetadataBitmapIndex::onMetadataDeleted(long metadataId) {
+    if (!enabled) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    checkGeneration();
+    for (auto& version : versions) {
+        removeEntry(*version.second, metadataId);
+    }
+}
+
+void MetadataBitmapIndex::onVectorMetadataDeleted(long vectorId) {
+    onVectorMetadataDeleted(std::vector<long>{vectorId});
+}
+
+void MetadataBitmapIndex::onVectorMetadataDeleted(const std::vector<long>& vectorIds) {
+    if (!enabled) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    checkGeneration();
+    for (auto& version : versions) {
+        for (long vectorId : vectorIds) {
+            auto it = version.second->entryIdsByVectorId.find(vectorId);
+            if (it == version.second->entryIdsByVectorId.end()) {
+                continue;
+            }
+            std::vector<long> entryIds = it->second;
+            for (long entryId : entryIds) {
+                removeEntry(*version.second, entryId);
+            }
+        }
+    }
+}
+
+void MetadataBitmapIndex::setEnabled(bool value) {
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    enabled = value;
+    versions.clear();
+}
+
+void MetadataBitmapIndex::clean() {
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    versions.clear();
+}
+
+};
+};
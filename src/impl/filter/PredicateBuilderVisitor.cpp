@@ -0,0 +1,476 @@
+#include "filter/PredicateBuilderVisitor.hpp"
+#include "filter/BitmapFilterVisitor.hpp"
+#include "filter/FilterManager.hpp"
+#include "filter/ParsedFilter.hpp"
+#include "filter/SQLBuilderVisitor.hpp"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <set>
+#include <unordered_set>
+
+namespace atinyvectors
+{
+namespace filter
+{
+
+namespace {
+
+template <typename T>
+bool compareValues(size_t op, const T& left, const T& right) {
+    switch (op) {
+    case PlanParser::LT: return left < right;
+    case PlanParser::LE: return left <= right;
+    case PlanParser::GT: return left > right;
+    case PlanParser::GE: return left >= right;
+    case PlanParser::EQ: return left == right;
+    case PlanParser::NE: return left != right;
+    default: return false;
+    }
+}
+
+// Runs `node` on the candidates whose result is still `pending` and stores its
+// result for them; the others keep theirs
+void evaluatePending(const FilterPredicate::Node& node, const MetadataView& view,
+                     const uint32_t* uniqueIds, size_t count, uint8_t* matched, uint8_t pending) {
+    std::vector<uint32_t> subset;
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < count; ++i) {
+        if (matched[i] == pending) {
+            subset.push_back(uniqueIds[i]);
+            positions.push_back(i);
+        }
+    }
+    if (subset.empty()) {
+        return;
+    }
+    if (subset.size() == count) {
+        node(view, uniqueIds, count, matched);
+        return;
+    }
+
+    std::vector<uint8_t> result(subset.size());
+    node(view, subset.data(), subset.size(), result.data());
+    for (size_t j = 0; j < positions.size(); ++j) {
+        matched[positions[j]] = result[j];
+    }
+}
+
+} // anonymous namespace
+
+void FilterPredicate::evaluate(const VersionBitmaps& bitmaps, const MetadataColumns& columns,
+                               const uint32_t* uniqueIds, size_t count, uint8_t* matched) const {
+    MetadataView view{bitmaps, columns};
+    root(view, uniqueIds, count, matched);
+}
+
+std::shared_ptr<const FilterPredicate> PredicateBuilderVisitor::compile(const std::string& filter) {
+    // Compiled once per parsed filter and shared by the searches that use it
+    std::shared_ptr<const ParsedFilter> parsed = FilterManager::getInstance().parse(filter);
+    if (parsed->tree == nullptr) {
+        return nullptr;
+    }
+
+    std::call_once(parsed->predicateOnce, [&]() {
+        PredicateBuilderVisitor visitor;
+        FilterPredicate::Node root = visitor.compileCondition(parsed->tree);
+        if (!visitor.isSupported()) {
+            spdlog::debug("Filter cannot be evaluated in memory: {}", filter);
+            return;
+        }
+        parsed->predicate = std::make_shared<const FilterPredicate>(std::move(root));
+    });
+    return parsed->predicate;
+}
+
+FilterPredicate::Node PredicateBuilderVisitor::compileCondition(PlanParser::ExprContext* ctx) {
+    if (!supported || ctx == nullptr) {
+        supported = false;
+        return FilterPredicate::Node();
+    }
+
+    std::any result = visit(ctx);
+    if (auto* node = std::any_cast<FilterPredicate::Node>(&result)) {
+        return std::move(*node);
+    }
+    supported = false;
+    return FilterPredicate::Node();
+}
+
+std::any PredicateBuilderVisitor::unsupported() {
+    supported = false;
+    return std::any();
+}
+
+std::any PredicateBuilderVisitor::visitChildren(antlr4::tree::ParseTree* node) {
+    // Every rule without an override, so partial results never leak upwards
+    return unsupported();
+}
+
+bool PredicateBuilderVisitor::conditionKey(PlanParser::ExprContext* ctx, std::string& key) {
+    if (auto idCtx = dynamic_cast<PlanParser::IdentifierContext*>(ctx)) {
+        key = idCtx->getText();
+        return true;
+    }
+    return false;
+}
+
+bool PredicateBuilderVisitor::constant(PlanParser::ExprContext* ctx, Constant& value) {
+    if (SQLBuilderVisitor::isNumeric(ctx)) {
+        Number number;
+        if (!fold(ctx, number)) {
+            return false;
+        }
+        if (number.integer) {
+            // SQLite compares large integers with REAL exactly; doubles only hold 53 bits
+            if (number.intValue > (1LL << 53) || number.intValue < -(1LL << 53)) {
+                return false;
+            }
+            value.number = static_cast<double>(number.intValue);
+        } else {
+            value.number = number.realValue;
+        }
+        value.numeric = true;
+        return true;
+    }
+
+    if (dynamic_cast<PlanParser::StringContext*>(ctx) != nullptr) {
+        FilterParameter parameter;
+        antlr4::Token* token = ctx->getStart();
+        if (!SQLBuilderVisitor::toParameter(token->getType(), token->getText(), parameter)) {
+            return false;
+        }
+        value.numeric = false;
+        value.text = parameter.textValue;
+        return true;
+    }
+    return false;
+}
+
+bool PredicateBuilderVisitor::fold(PlanParser::ExprContext* ctx, Number& number) {
+    if (dynamic_cast<PlanParser::IntegerContext*>(ctx) != nullptr ||
+        dynamic_cast<PlanParser::FloatingContext*>(ctx) != nullptr) {
+        FilterParameter parameter;
+        antlr4::Token* token = ctx->getStart();
+        if (!SQLBuilderVisitor::toParameter(token->getType(), token->getText(), parameter)) {
+            return false;
+        }
+        number.integer = parameter.type == FilterParameter::Type::Integer;
+        number.intValue = parameter.intValue;
+        number.realValue = parameter.realValue;
+        return true;
+    }
+
+    if (dynamic_cast<PlanParser::BooleanContext*>(ctx) != nullptr) {
+        std::string value = ctx->getText();
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        if (value != "true" && value != "false") {
+            return false;
+        }
+        number.integer = true;
+        number.intValue = (value == "true") ? 1 : 0;
+        return true;
+    }
+
+    if (auto parensCtx = dynamic_cast<PlanParser::ParensContext*>(ctx)) {
+        return fold(parensCtx->expr(), number);
+    }
+
+    if (auto unaryCtx = dynamic_cast<PlanParser::UnaryContext*>(ctx)) {
+        size_t op = unaryCtx->op->getType();
+        if ((op != PlanParser::ADD && op != PlanParser::SUB) || !fold(unaryCtx->expr(), number)) {
+            return false;
+        }
+        if (op == PlanParser::SUB) {
+            if (number.integer && number.intValue == LLONG_MIN) {
+                return false;
+            }
+            number.intValue = -number.intValue;
+            number.realValue = -number.realValue;
+        }
+        return true;
+    }
+
+    PlanParser::ExprContext* leftCtx = nullptr;
+    PlanParser::ExprContext* rightCtx = nullptr;
+    size_t op = 0;
+    if (auto addSubCtx = dynamic_cast<PlanParser::AddSubContext*>(ctx)) {
+        leftCtx = addSubCtx->expr(0);
+        rightCtx = addSubCtx->expr(1);
+        op = addSubCtx->op->getType();
+    } else if (auto mulDivCtx = dynamic_cast<PlanParser::MulDivModContext*>(ctx)) {
+        leftCtx = mulDivCtx->expr(0);
+        rightCtx = mulDivCtx->expr(1);
+        op = mulDivCtx->op->getType();
+    } else {
+        return false;
+    }
+
+    Number left;
+    Number right;
+    if (!fold(leftCtx, left) || !fold(rightCtx, right)) {
+        return false;
+    }
+
+    // Division by zero gives NULL and integer overflow switches SQLite to REAL;
+    // both are left to SQL
+    if (left.integer && right.integer) {
+        long long a = left.intValue;
+        long long b = right.intValue;
+        long long result = 0;
+        switch (op) {
+        case PlanParser::ADD:
+            if (__builtin_add_overflow(a, b, &result)) return false;
+            break;
+        case PlanParser::SUB:
+            if (__builtin_sub_overflow(a, b, &result)) return false;
+            break;
+        case PlanParser::MUL:
+            if (__builtin_mul_overflow(a, b, &result)) return false;
+            break;
+        case PlanParser::DIV:
+            if (b == 0 || (a == LLONG_MIN && b == -1)) return false;
+            result = a / b;
+            break;
+        case PlanParser::MOD:
+            if (b == 0) return false;
+            result = (b == -1) ? 0 : a % b;
+            break;
+        default:
+            return false;
+        }
+        number.integer = true;
+        number.intValue = result;
+        return true;
+    }
+
+    double a = left.integer ? static_cast<double>(left.intValue) : left.realValue;
+    double b = right.integer ? static_cast<double>(right.intValue) : right.realValue;
+    double result = 0;
+    switch (op) {
+    case PlanParser::ADD: result = a + b; break;
+    case PlanParser::SUB: result = a - b; break;
+    case PlanParser::MUL: result = a * b; break;
+    case PlanParser::DIV:
+        if (b == 0) return false;
+        result = a / b;
+        break;
+    default:
+        return false;  // SQLite takes the remainder of REALs as integers
+    }
+    if (!std::isfinite(result)) {
+        return false;
+    }
+    number.integer = false;
+    number.realValue = result;
+    return true;
+}
+
+PredicateBuilderVisitor::RowTest PredicateBuilderVisitor::compare(size_t op, const Constant& operand) {
+    // NULL columns never pass a comparison
+    if (operand.numeric) {
+        double number = operand.number;
+        return [op, number](const KeyColumn& column, uint32_t slot) {
+            return column.hasNumber(slot) && compareValues(op, column.numbers[slot], number);
+        };
+    }
+    std::string text = operand.text;
+    return [op, text](const KeyColumn& column, uint32_t slot) {
+        // std::string orders bytes like the BINARY collation
+        return column.hasValue(slot) && compareValues(op, column.values[slot], text);
+    };
+}
+
+FilterPredicate::Node PredicateBuilderVisitor::keyCondition(const std::string& key, RowTest test) {
+    // Like the EXISTS of the SQL: one row of the key passing the test is enough
+    return [key, test](const MetadataView& view, const uint32_t* uniqueIds, size_t count, uint8_t* matched) {
+        const KeyColumn* column = view.columns.find(key);
+        for (size_t i = 0; i < count; ++i) {
+            matched[i] = column != nullptr && column->anyRow(uniqueIds[i], test);
+        }
+    };
+}
+
+std::any PredicateBuilderVisitor::rangeCondition(const std::string& key, PlanParser::ExprContext* lower, bool lowerInclusive,
+                                                 PlanParser::ExprContext* upper, bool upperInclusive) {
+    // Each bound tests its own column of the row, so mixed bounds work as in SQL
+    Constant lowerValue;
+    Constant upperValue;
+    if (!constant(lower, lowerValue) || !constant(upper, upperValue)) {
+        return unsupported();
+    }
+
+    RowTest lowerTest = compare(lowerInclusive ? PlanParser::GE : PlanParser::GT, lowerValue);
+    RowTest upperTest = compare(upperInclusive ? PlanParser::LE : PlanParser::LT, upperValue);
+    return std::any(keyCondition(key, [lowerTest, upperTest](const KeyColumn& column, uint32_t slot) {
+        return lowerTest(column, slot) && upperTest(column, slot);
+    }));
+}
+
+std::any PredicateBuilderVisitor::visitParens(PlanParser::ParensContext* ctx) {
+    FilterPredicate::Node node = compileCondition(ctx->expr());
+    return supported ? std::any(std::move(node)) : std::any();
+}
+
+std::any PredicateBuilderVisitor::visitLike(PlanParser::LikeContext* ctx) {
+    std::string key;
+    FilterParameter pattern;
+    antlr4::Token* token = ctx->StringLiteral()->getSymbol();
+    if (!conditionKey(ctx->expr(), key) ||
+        !SQLBuilderVisitor::toParameter(token->getType(), token->getText(), pattern)) {
+        return unsupported();
+    }
+
+    std::string text = pattern.textValue;
+    return std::any(keyCondition(key, [text](const KeyColumn& column, uint32_t slot) {
+        return column.hasValue(slot) && BitmapFilterVisitor::likeMatch(column.values[slot], text);
+    }));
+}
+
+std::any PredicateBuilderVisitor::visitEquality(PlanParser::EqualityContext* ctx) {
+    std::string key;
+    Constant operand;
+    if (!conditionKey(ctx->expr(0), key) || !constant(ctx->expr(1), operand)) {
+        return unsupported();
+    }
+    return std::any(keyCondition(key, compare(ctx->op->getType(), operand)));
+}
+
+std::any PredicateBuilderVisitor::visitLogicalAnd(PlanParser::LogicalAndContext* ctx) {
+    FilterPredicate::Node left = compileCondition(ctx->expr(0));
+    FilterPredicate::Node right = compileCondition(ctx->expr(1));
+    if (!supported) {
+        return std::any();
+    }
+    return std::any(FilterPredicate::Node(
+        [left, right](const MetadataView& view, const uint32_t* uniqueIds, size_t count, uint8_t* matched) {
+            left(view, uniqueIds, count, matched);
+            evaluatePending(right, view, uniqueIds, count, matched, 1);
+        }));
+}
+
+std::any PredicateBuilderVisitor::visitLogicalOr(PlanParser::LogicalOrContext* ctx) {
+    FilterPredicate::Node left = compileCondition(ctx->expr(0));
+    FilterPredicate::Node right = compileCondition(ctx->expr(1));
+    if (!supported) {
+        return std::any();
+    }
+    return std::any(FilterPredicate::Node(
+        [left, right](const MetadataView& view, const uint32_t* uniqueIds, size_t count, uint8_t* matched) {
+            left(view, uniqueIds, count, matched);
+            evaluatePending(right, view, uniqueIds, count, matched, 0);
+        }));
+}
+
+std::any PredicateBuilderVisitor::visitRelational(PlanParser::RelationalContext* ctx) {
+    std::string key;
+    Constant operand;
+    if (!conditionKey(ctx->expr(0), key) || !constant(ctx->expr(1), operand)) {
+        return unsupported();
+    }
+    return std::any(keyCondition(key, compare(ctx->op->getType(), operand)));
+}
+
+std::any PredicateBuilderVisitor::visitRange(PlanParser::RangeContext* ctx) {
+    // lower < key < upper
+    if (ctx->Identifier() == nullptr) {
+        return unsupported();
+    }
+    return rangeCondition(ctx->Identifier()->getText(), ctx->expr(0), ctx->op1->getType() == PlanParser::LE,
+                          ctx->expr(1), ctx->op2->getType() == PlanParser::LE);
+}
+
+std::any PredicateBuilderVisitor::visitReverseRange(PlanParser::ReverseRangeContext* ctx) {
+    // upper > key > lower
+    if (ctx->Identifier() == nullptr) {
+        return unsupported();
+    }
+    return rangeCondition(ctx->Identifier()->getText(), ctx->expr(1), ctx->op2->getType() == PlanParser::GE,
+                          ctx->expr(0), ctx->op1->getType() == PlanParser::GE);
+}
+
+std::any PredicateBuilderVisitor::visitUnary(PlanParser::UnaryContext* ctx) {
+    if (ctx->op->getType() != PlanParser::NOT) {
+        return unsupported();
+    }
+
+    FilterPredicate::Node operand = compileCondition(ctx->expr());
+    if (!supported) {
+        return std::any();
+    }
+    // NOT is taken within the vectors that have metadata, as the SQL selects rows
+    return std::any(FilterPredicate::Node(
+        [operand](const MetadataView& view, const uint32_t* uniqueIds, size_t count, uint8_t* matched) {
+            operand(view, uniqueIds, count, matched);
+            for (size_t i = 0; i < count; ++i) {
+                matched[i] = !matched[i] && view.bitmaps.all.contains(uniqueIds[i]);
+            }
+        }));
+}
+
+std::any PredicateBuilderVisitor::visitTerm(PlanParser::TermContext* ctx) {
+    std::string key;
+    if (!conditionKey(ctx->expr(0), key)) {
+        return unsupported();
+    }
+
+    std::set<double> numbers;
+    std::unordered_set<std::string> texts;
+    for (size_t i = 1; i < ctx->expr().size(); ++i) {
+        Constant operand;
+        if (!constant(ctx->expr(i), operand)) {
+            return unsupported();
+        }
+        if (operand.numeric) {
+            numbers.insert(operand.number);
+        } else {
+            texts.insert(operand.text);
+        }
+    }
+
+    auto inNumbers = [numbers](const KeyColumn& column, uint32_t slot) {
+        return numbers.count(column.numbers[slot]) > 0;
+    };
+    auto inTexts = [texts](const KeyColumn& column, uint32_t slot) {
+        return texts.count(column.values[slot]) > 0;
+    };
+
+    if (ctx->op->getType() != PlanParser::NIN) {
+        return std::any(keyCondition(key, [inNumbers, inTexts](const KeyColumn& column, uint32_t slot) {
+            return (column.hasNumber(slot) && inNumbers(column, slot)) || (column.hasValue(slot) && inTexts(column, slot));
+        }));
+    }
+
+    // NOT IN is NULL for a NULL column; mixed lists COALESCE the numeric side
+    // since strings have no numericValue
+    if (texts.empty()) {
+        return std::any(keyCondition(key, [inNumbers](const KeyColumn& column, uint32_t slot) {
+            return column.hasNumber(slot) && !inNumbers(column, slot);
+        }));
+    }
+    bool mixed = !numbers.empty();
+    return std::any(keyCondition(key, [mixed, inNumbers, inTexts](const KeyColumn& column, uint32_t slot) {
+        if (mixed && column.hasNumber(slot) && inNumbers(column, slot)) {
+            return false;
+        }
+        return column.hasValue(slot) && !inTexts(column, slot);
+    }));
+}
+
+std::any PredicateBuilderVisitor::visitEmptyTerm(PlanParser::EmptyTermContext* ctx) {
+    std::string key;
+    if (!conditionKey(ctx->expr(), key)) {
+        return unsupported();
+    }
+
+    // Same as the SQL: IN () tests for a value, NOT IN () for a NULL value
+    bool notIn = ctx->op->getType() == PlanParser::NIN;
+    return std::any(keyCondition(key, [notIn](const KeyColumn& column, uint32_t slot) {
+        return column.hasValue(slot) != notIn;
+    }));
+}
+
+}; // namespace filter
+}; // namespace atinyvectors
@@ -0,0 +1,496 @@
+#include "filter/RoaringBitmap.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace atinyvectors {
+namespace filter {
+
+namespace {
+
+inline uint16_t highBits(uint32_t value) {
+    return static_cast<uint16_t>(value >> 16);
+}
+
+inline uint16_t lowBits(uint32_t value) {
+    return static_cast<uint16_t>(value & 0xFFFF);
+}
+
+inline int popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word) {
+        word &= word - 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline int countTrailingZeros(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+} // anonymous namespace
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) {
+        return (bits[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::toBitset() {
+    bits.assign(BITSET_WORDS, 0);
+    for (uint16_t low : array) {
+        bits[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::toArray() {
+    array.clear();
+    array.reserve(cardinality);
+    for (size_t word = 0; word < bits.size(); ++word) {
+        uint64_t w = bits[word];
+        while (w) {
+            array.push_back(static_cast<uint16_t>(word * 64 + countTrailingZeros(w)));
+            w &= w - 1;
+        }
+    }
+    bits.clear();
+    bits.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::normalize() {
+    if (isBitset() && cardinality <= ARRAY_MAX_SIZE) {
+        toArray();
+    } else if (!isBitset() && cardinality > ARRAY_MAX_SIZE) {
+        toBitset();
+    }
+}
+
+template <typename Fn>
+bool RoaringBitmap::Container::forEach(uint16_t fromLow, Fn&& fn) const {
+    if (isBitset()) {
+        for (size_t word = fromLow >> 6; word < bits.size(); ++word) {
+            uint64_t w = bits[word];
+            if (word == static_cast<size_t>(fromLow >> 6)) {
+                w &= ~uint64_t(0) << (fromLow & 63);
+            }
+            while (w) {
+                if (!fn(static_cast<uint16_t>(word * 64 + countTrailingZeros(w)))) {
+                    return false;
+                }
+                w &= w - 1;
+            }
+        }
+        return true;
+    }
+
+    for (auto it = std::lower_bound(array.begin(), array.end(), fromLow); it != array.end(); ++it) {
+        if (!fn(*it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+RoaringBitmap RoaringBitmap::of(const std::vector<uint32_t>& values) {
+    RoaringBitmap bitmap;
+    for (uint32_t value : values) {
+        bitmap.add(value);
+    }
+    return bitmap;
+}
+
+RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t high) {
+    auto it = std::lower_bound(containers.begin(), containers.end(), high,
+                               [](const auto& entry, uint16_t key) { return entry.first < key; });
+    return (it != containers.end() && it->first == high) ? &it->second : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::findContainer(uint16_t high) const {
+    return const_cast<RoaringBitmap*>(this)->findContainer(high);
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t high = highBits(value);
+    uint16_t low = lowBits(value);
+
+    auto it = std::lower_bound(containers.begin(), containers.end(), high,
+                               [](const auto& entry, uint16_t key) { return entry.first < key; });
+    if (it == containers.end() || it->first != high) {
+        it = containers.insert(it, {high, Container()});
+    }
+
+    Container& container = it->second;
+    if (container.isBitset()) {
+        uint64_t& word = container.bits[low >> 6];
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(word & mask)) {
+            word |= mask;
+            ++container.cardinality;
+        }
+        return;
+    }
+
+    auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+    if (pos != container.array.end() && *pos == low) {
+        return;
+    }
+    container.array.insert(pos, low);
+    ++container.cardinality;
+    container.normalize();
+}
+
+void RoaringBitmap::remove(uint32_t value) {
+    uint16_t high = highBits(value);
+    uint16_t low = lowBits(value);
+
+    auto it = std::lower_bound(containers.begin(), containers.end(), high,
+                               [](const auto& entry, uint16_t key) { return entry.first < key; });
+    if (it == containers.end() || it->first != high) {
+        return;
+    }
+
+    Container& container = it->second;
+    if (container.isBitset()) {
+        uint64_t& word = container.bits[low >> 6];
+        uint64_t mask = uint64_t(1) << (low & 63);
+        if (!(word & mask)) {
+            return;
+        }
+        word &= ~mask;
+        --container.cardinality;
+        container.normalize();
+    } else {
+        auto pos = std::lower_bound(container.array.begin(), container.array.end(), low);
+        if (pos == container.array.end() || *pos != low) {
+            return;
+        }
+        container.array.erase(pos);
+        --container.cardinality;
+    }
+
+    if (container.cardinality == 0) {
+        containers.erase(it);
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    const Container* container = findContainer(highBits(value));
+    return container != nullptr && container->contains(lowBits(value));
+}
+
+size_t RoaringBitmap::cardinality() const {
+    size_t total = 0;
+    for (const auto& entry : containers) {
+        total += entry.second.cardinality;
+    }
+    return total;
+}
+
+size_t RoaringBitmap::intersectionCardinality(const RoaringBitmap& other) const {
+    size_t total = 0;
+    auto right = other.containers.begin();
+    for (const auto& entry : containers) {
+        while (right != other.containers.end() && right->first < entry.first) {
+            ++right;
+        }
+        if (right == other.containers.end()) {
+            break;
+        }
+        if (right->first == entry.first) {
+            total += intersectCount(entry.second, right->second);
+        }
+    }
+    return total;
+}
+
+RoaringBitmap::Container RoaringBitmap::unite(const Container& a, const Container& b) {
+    Container result;
+    if (!a.isBitset() && !b.isBitset()) {
+        result.array.reserve(a.array.size() + b.array.size());
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                       std::back_inserter(result.array));
+        result.cardinality = static_cast<uint32_t>(result.array.size());
+        result.normalize();
+        return result;
+    }
+
+    const Container& dense = a.isBitset() ? a : b;
+    const Container& other = a.isBitset() ? b : a;
+    result.bits = dense.bits;
+    if (other.isBitset()) {
+        for (size_t i = 0; i < BITSET_WORDS; ++i) {
+            result.bits[i] |= other.bits[i];
+        }
+    } else {
+        for (uint16_t low : other.array) {
+            result.bits[low >> 6] |= uint64_t(1) << (low & 63);
+        }
+    }
+    for (uint64_t word : result.bits) {
+        result.cardinality += popcount(word);
+    }
+    return result;
+}
+
+RoaringBitmap::Container RoaringBitmap::intersect(const Container& a, const Container& b) {
+    Container result;
+    if (!a.isBitset() && !b.isBitset()) {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(result.array));
+    } else if (a.isBitset() && b.isBitset()) {
+        result.bits.resize(BITSET_WORDS);
+        for (size_t i = 0; i < BITSET_WORDS; ++i) {
+            result.bits[i] = a.bits[i] & b.bits[i];
+            result.cardinality += popcount(result.bits[i]);
+        }
+        result.normalize();
+        return result;
+    } else {
+        const Container& sparse = a.isBitset() ? b : a;
+        const Container& dense = a.isBitset() ? a : b;
+        for (uint16_t low : sparse.array) {
+            if (dense.contains(low)) {
+                result.array.push_back(low);
+            }
+        }
+    }
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    return result;
+}
+
+uint32_t RoaringBitmap::intersectCount(const Container& a, const Container& b) {
+    uint32_t count = 0;
+    if (!a.isBitset() && !b.isBitset()) {
+        auto left = a.array.begin();
+        auto right = b.array.begin();
+        while (left != a.array.end() && right != b.array.end()) {
+            if (*left < *right) {
+                ++left;
+            } else if (*right < *left) {
+                ++right;
+            } else {
+                ++count;
+                ++left;
+                ++right;
+            }
+        }
+    } else if (a.isBitset() && b.isBitset()) {
+        for (size_t i = 0; i < BITSET_WORDS; ++i) {
+            count += popcount(a.bits[i] & b.bits[i]);
+        }
+    } else {
+        const Container& sparse = a.isBitset() ? b : a;
+        const Container& dense = a.isBitset() ? a : b;
+        for (uint16_t low : sparse.array) {
+            if (dense.contains(low)) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+RoaringBitmap::Container RoaringBitmap::subtract(const Container& a, const Container& b) {
+    Container result;
+    if (!a.isBitset()) {
+        if (!b.isBitset()) {
+            std::set_difference(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                std::back_inserter(result.array));
+        } else {
+            for (uint16_t low : a.array) {
+                if (!b.contains(low)) {
+                    result.array.push_back(low);
+                }
+            }
+        }
+        result.cardinality = static_cast<uint32_t>(result.array.size());
+        return result;
+    }
+
+    result.bits = a.bits;
+    if (b.isBitset()) {
+        for (size_t i = 0; i < BITSET_WORDS; ++i) {
+            result.bits[i] &= ~b.bits[i];
+        }
+    } else {
+        for (uint16_t low : b.array) {
+            result.bits[low >> 6] &= ~(uint64_t(1) << (low & 63));
+        }
+    }
+    for (uint64_t word : result.bits) {
+        result.cardinality += popcount(word);
+    }
+    result.normalize();
+    return result;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+    std::vector<std::pair<uint16_t, Container>> merged;
+    merged.reserve(containers.size() + other.containers.size());
+
+    auto left = containers.begin();
+    auto right = other.containers.begin();
+    while (left != containers.end() || right != other.containers.end()) {
+        if (right == other.containers.end() || (left != containers.end() && left->first < right->first)) {
+            merged.push_back(std::move(*left++));
+        } else if (left == containers.end() || right->first < left->first) {
+            merged.push_back(*right++);
+        } else {
+            merged.emplace_back(left->first, unite(left->second, right->second));
+            ++left;
+            ++right;
+        }
+    }
+
+    containers = std::move(merged);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+    std::vector<std::pair<uint16_t, Container>> kept;
+
+    auto right = other.containers.begin();
+    for (auto& entry : containers) {
+        while (right != other.containers.end() && right->first < entry.first) {
+            ++right;
+        }
+        if (right == other.containers.end()) {
+            break;
+        }
+        if (right->first == entry.first) {
+            Container container = intersect(entry.second, right->second);
+            if (container.cardinality > 0) {
+                kept.emplace_back(entry.first, std::move(container));
+            }
+        }
+    }
+
+    containers = std::move(kept);
+    return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+    std::vector<std::pair<uint16_t, Container>> kept;
+    kept.reserve(containers.size());
+
+    auto right = other.containers.begin();
+    for (auto& entry : containers) {
+        while (right != other.containers.end() && right->first < entry.first) {
+            ++right;
+        }
+        if (right != other.containers.end() && right->first == entry.first) {
+            Container container = subtract(entry.second, right->second);
+            if (container.cardinality > 0) {
+                kept.emplace_back(entry.first, std::move(container));
+            }
+        } else {
+            kept.push_back(std::move(entry));
+        }
+    }
+
+    containers = std::move(kept);
+    return *this;
+}
+
+bool RoaringBitmap::operator==(const RoaringBitmap& other) const {
+    if (containers.size() != other.containers.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < containers.size(); ++i) {
+        const auto& a = containers[i];
+        const auto& b = other.containers[i];
+        if (a.first != b.first || a.second.cardinality != b.second.cardinality) {
+            return false;
+        }
+        // Layout follows the cardinality, so equal sets share it
+        if (a.second.array != b.second.array || a.second.bits != b.second.bits) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint32_t> RoaringBitmap::toVector() const {
+    std::vector<uint32_t> values;
+    values.reserve(cardinality());
+    for (const auto& entry : containers) {
+        uint32_t base = static_cast<uint32_t>(entry.first) << 16;
+        entry.second.forEach(0, [&](uint16_t low) {
+            values.push_back(base | low);
+            return true;
+        });
+    }
+    return values;
+}
+
+std::vector<uint32_t> RoaringBitmap::valuesFrom(uint32_t minValue, size_t limit) const {
+    std::vector<uint32_t> values;
+    if (limit == 0) {
+        return values;
+    }
+
+    uint16_t minHigh = highBits(minValue);
+    auto it = std::lower_bound(containers.begin(), containers.end(), minHigh,
+                               [](const auto& entry, uint16_t key) { return entry.first < key; });
+    for (; it != containers.end(); ++it) {
+        uint32_t base = static_cast<uint32_t>(it->first) << 16;
+        uint16_t fromLow = (it->first == minHigh) ? lowBits(minValue) : 0;
+        bool more = it->second.forEach(fromLow, [&](uint16_t low) {
+            values.push_back(base | low);
+            return values.size() < limit;
+        });
+        if (!more) {
+            break;
+        }
+    }
+    return values;
+}
+
+std::vector<uint32_t> RoaringBitmap::page(size_t offset, size_t limit) const {
+    std::vector<uint32_t> values;
+    if (limit == 0) {
+        return values;
+    }
+
+    for (const auto& entry : containers) {
+        // Whole containers before the offset are skipped by their cardinality
+        if (offset >= entry.second.cardinality) {
+            offset -= entry.second.cardinality;
+            continue;
+        }
+
+        uint32_t base = static_cast<uint32_t>(entry.first) << 16;
+        bool more = entry.second.forEach(0, [&](uint16_t low) {
+            if (offset > 0) {
+                --offset;
+                return true;
+            }
+            values.push_back(base | low);
+            return values.size() < limit;
+        });
+        if (!more) {
+            break;
+        }
+    }
+    return values;
+}
+
+};
+};
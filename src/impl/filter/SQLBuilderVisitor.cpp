@@ -2,13 +2,31 @@
 #include "spdlog/spdlog.h"
 #include <sstream>
 #include <regex>
+#include <stdexcept>
 
 namespace atinyvectors
 {
 namespace filter
 {
 
-SQLBuilderVisitor::SQLBuilderVisitor() : conditionCount(0) {
+namespace {
+
+// JSON type at `path` in an array or object (valueType 4 or 5) metadata value;
+// NULL for the other rows, whose value is not JSON
+std::string jsonType(const std::string& row, const std::string& path) {
+    return "CASE WHEN " + row + ".valueType IN (4, 5) THEN json_type(" + row + ".value, " + path + ") END";
+}
+
+bool isLiteral(PlanParser::ExprContext* ctx) {
+    return SQLBuilderVisitor::isNumeric(ctx) || dynamic_cast<PlanParser::StringContext*>(ctx) != nullptr;
+}
+
+} // anonymous namespace
+
+SQLBuilderVisitor::SQLBuilderVisitor(bool parameterize, const MetadataIndexes& indexes)
+    : conditionCount(0), parameterize(parameterize),
+      indexedPaths(indexes.paths.begin(), indexes.paths.end()),
+      textKeys(indexes.textKeys.begin(), indexes.textKeys.end()) {
 }
 
 std::string SQLBuilderVisitor::getSQL() const {
@@ -40,28 +58,251 @@ std::string SQLBuilderVisitor::quoteString(const std::string& str) {
     return escaped;
 }
 
+bool SQLBuilderVisitor::toParameter(size_t tokenType, const std::string& text, FilterParameter& parameter) {
+    try {
+        if (tokenType == PlanParser::IntegerConstant) {
+            if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+                // SQLite reads hex literals as 64-bit two's complement
+                parameter.intValue = static_cast<long long>(std::stoull(text.substr(2), nullptr, 16));
+            } else if (text.find_first_not_of("0123456789") == std::string::npos) {
+                // Leading zeros are decimal for SQLite as well
+                parameter.intValue = std::stoll(text);
+            } else {
+                return false;
+            }
+            parameter.type = FilterParameter::Type::Integer;
+            return true;
+        }
+
+        if (tokenType == PlanParser::FloatingConstant) {
+            if (text.find_first_of("xX") != std::string::npos) {
+                return false;
+            }
+            size_t parsed = 0;
+            parameter.realValue = std::stod(text, &parsed);
+            parameter.type = FilterParameter::Type::Real;
+            return parsed == text.size();
+        }
+
+        if (tokenType == PlanParser::StringLiteral) {
+            if (text.size() < 2 || (text.front() != '\'' && text.front() != '"')) {
+                return false;
+            }
+            parameter.textValue = text.substr(1, text.size() - 2);
+            parameter.type = FilterParameter::Type::Text;
+            return true;
+        }
+    } catch (const std::exception&) {
+        // Out of range for int64/double; SQLite gets the literal as written
+    }
+    return false;
+}
+
+std::string SQLBuilderVisitor::literal(antlr4::Token* token, const std::string& inlined) {
+    FilterParameter parameter;
+    if (!parameterize || token == nullptr || !toParameter(token->getType(), token->getText(), parameter)) {
+        return inlined;
+    }
+
+    std::string name = ":p" + std::to_string(token->getTokenIndex());
+    placeholders.emplace_back(name, token->getTokenIndex());
+    return name;
+}
+
+bool SQLBuilderVisitor::isNumeric(PlanParser::ExprContext* ctx) {
+    if (dynamic_cast<PlanParser::IntegerContext*>(ctx) != nullptr ||
+        dynamic_cast<PlanParser::FloatingContext*>(ctx) != nullptr) {
+        return true;
+    }
+    if (dynamic_cast<PlanParser::BooleanContext*>(ctx) != nullptr) {
+        std::string value = ctx->getText();
+        std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+        return value == "true" || value == "false";
+    }
+    if (auto parensCtx = dynamic_cast<PlanParser::ParensContext*>(ctx)) {
+        return isNumeric(parensCtx->expr());
+    }
+    if (auto unaryCtx = dynamic_cast<PlanParser::UnaryContext*>(ctx)) {
+        size_t op = unaryCtx->op->getType();
+        return (op == PlanParser::ADD || op == PlanParser::SUB) && isNumeric(unaryCtx->expr());
+    }
+    if (auto addSubCtx = dynamic_cast<PlanParser::AddSubContext*>(ctx)) {
+        return isNumeric(addSubCtx->expr(0)) && isNumeric(addSubCtx->expr(1));
+    }
+    if (auto mulDivCtx = dynamic_cast<PlanParser::MulDivModContext*>(ctx)) {
+        return isNumeric(mulDivCtx->expr(0)) && isNumeric(mulDivCtx->expr(1));
+    }
+    return false;
+}
+
+bool SQLBuilderVisitor::hasTrigram(const std::string& pattern) {
+    size_t run = 0;
+    for (unsigned char c : pattern) {
+        if ((c & 0xC0) == 0x80) {
+            continue;  // UTF-8 continuation byte; trigrams count characters
+        }
+        run = (c == '%' || c == '_') ? 0 : run + 1;
+        if (run >= 3) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SQLBuilderVisitor::setTarget(antlr4::ParserRuleContext* ctx, bool elements) {
+    if (dynamic_cast<PlanParser::IdentifierContext*>(ctx) != nullptr) {
+        return setTarget(ctx->getText(), false, elements);
+    }
+    if (dynamic_cast<PlanParser::JSONIdentifierContext*>(ctx) != nullptr) {
+        return setTarget(ctx->getText(), true, elements);
+    }
+    target = ConditionTarget();
+    return false;
+}
+
+bool SQLBuilderVisitor::setTarget(const std::string& text, bool json, bool elements) {
+    target = ConditionTarget();
+    if (!json && !elements) {
+        target.key = text;
+        return true;
+    }
+
+    JsonPath path = JsonPath::parse(text);
+    if (elements) {
+        path = path.each();
+    }
+    target.key = path.getKey();
+    if (indexedPaths.count(path.toString()) > 0) {
+        target.kind = ConditionTarget::Kind::IndexedPath;
+        target.path = path.toString();
+    } else {
+        target.kind = elements ? ConditionTarget::Kind::JsonElements : ConditionTarget::Kind::JsonValue;
+        target.path = path.toSQLitePath();
+    }
+    return true;
+}
+
+std::string SQLBuilderVisitor::column(const std::string& name) const {
+    std::string alias = std::to_string(conditionCount);
+    std::string row = "vm" + alias;
+
+    // JSON values get the columns of a VectorMetadataPath row: strings as is,
+    // other values as JSON text, numbers and booleans in numericValue
+    switch (target.kind) {
+    case ConditionTarget::Kind::Key:
+        break;
+    case ConditionTarget::Kind::IndexedPath:
+        return "vp" + alias + "." + name;
+    case ConditionTarget::Kind::JsonValue: {
+        std::string path = quoteString(target.path);
+        std::string type = jsonType(row, path);
+        if (name == "value") {
+            return "CASE WHEN " + type + " = 'text' THEN " + row + ".value ->> " + path +
+                   " WHEN " + type + " <> 'null' THEN " + row + ".value -> " + path + " END";
+        }
+        if (name == "numericValue") {
+            return "CASE " + type + " WHEN 'integer' THEN " + row + ".value ->> " + path +
+                   " WHEN 'real' THEN " + row + ".value ->> " + path + " WHEN 'true' THEN 1 WHEN 'false' THEN 0 END";
+        }
+        break;
+    }
+    case ConditionTarget::Kind::JsonElements: {
+        std::string element = "je" + alias;
+        if (name == "value") {
+            return "CASE WHEN " + element + ".type = 'text' THEN " + element + ".value WHEN " + element +
+                   ".type <> 'null' THEN " + row + ".value -> " + element + ".fullkey END";
+        }
+        if (name == "numericValue") {
+            return "CASE " + element + ".type WHEN 'integer' THEN " + element + ".value WHEN 'real' THEN " +
+                   element + ".value WHEN 'true' THEN 1 WHEN 'false' THEN 0 END";
+        }
+        break;
+    }
+    }
+    return row + "." + name;
+}
+
+std::string SQLBuilderVisitor::valueColumn(PlanParser::ExprContext* ctx) const {
+    return column(isNumeric(ctx) ? "numericValue" : "value");
+}
+
 std::string SQLBuilderVisitor::generateValueCondition(const std::string& op, PlanParser::ExprContext* ctx) {
-    return op + " " + std::any_cast<std::string>(visit(ctx));
+    std::string value = std::any_cast<std::string>(visit(ctx));
+    return valueColumn(ctx) + " " + op + " " + value;
 }
 
-std::string SQLBuilderVisitor::handleKeyValueCondition(const std::string& key, const std::string& condition) {
+std::string SQLBuilderVisitor::handleKeyValueCondition(const std::string& predicate) {
+    std::string alias = std::to_string(conditionCount);
+    std::string row = "vm" + alias;
     std::stringstream ss;
-    ss << "EXISTS (SELECT 1 FROM VectorMetadata vm" << conditionCount 
-       << " WHERE vm" << conditionCount << ".vectorId = VectorMetadata.vectorId "
-       << "AND vm" << conditionCount << ".key = " << quoteString(key) 
-       << " AND vm" << conditionCount << ".value " << condition << ")";
+    switch (target.kind) {
+    case ConditionTarget::Kind::Key:
+        ss << "EXISTS (SELECT 1 FROM VectorMetadata " << row
+           << " WHERE " << row << ".vectorId = VectorMetadata.vectorId "
+           << "AND " << row << ".key = " << quoteString(target.key)
+           << " AND " << predicate << ")";
+        break;
+    case ConditionTarget::Kind::IndexedPath:
+        ss << "EXISTS (SELECT 1 FROM VectorMetadataPath vp" << alias
+           << " WHERE vp" << alias << ".vectorId = VectorMetadata.vectorId "
+           << "AND vp" << alias << ".path = " << quoteString(target.path)
+           << " AND " << predicate << ")";
+        break;
+    case ConditionTarget::Kind::JsonValue:
+        // Only where the path exists, like the rows of an indexed path
+        ss << "EXISTS (SELECT 1 FROM VectorMetadata " << row
+           << " WHERE " << row << ".vectorId = VectorMetadata.vectorId "
+           << "AND " << row << ".key = " << quoteString(target.key)
+           << " AND " << jsonType(row, quoteString(target.path)) << " IS NOT NULL"
+           << " AND " << predicate << ")";
+        break;
+    case ConditionTarget::Kind::JsonElements:
+        ss << "EXISTS (SELECT 1 FROM VectorMetadata " << row << ", json_each(CASE WHEN " << row
+           << ".valueType IN (4, 5) THEN " << row << ".value END, " << quoteString(target.path) << ") je" << alias
+           << " WHERE " << row << ".vectorId = VectorMetadata.vectorId "
+           << "AND " << row << ".key = " << quoteString(target.key)
+           << " AND " << predicate << ")";
+        break;
+    }
     conditionCount++;
     return ss.str();
 }
 
+std::string SQLBuilderVisitor::textIndexCondition(const std::string& pattern) {
+    std::string alias = std::to_string(conditionCount);
+    std::string row = "vm" + alias;
+    std::string text = "vt" + alias;
+
+    // The index folds case beyond ASCII, so LIKE is checked again on the row
+    std::string expr = "VectorMetadata.vectorId IN (SELECT " + row + ".vectorId FROM VectorMetadataText " + text +
+                       " CROSS JOIN VectorMetadata " + row + " ON " + row + ".id = " + text + ".rowid WHERE " +
+                       text + ".value LIKE " + pattern + " AND " + row + ".key = " + quoteString(target.key) +
+                       " AND " + row + ".value LIKE " + pattern + ")";
+    conditionCount++;
+    return expr;
+}
+
+std::string SQLBuilderVisitor::rangeCondition(PlanParser::ExprContext* lower, antlr4::Token* lowerOp,
+                                              PlanParser::ExprContext* upper, antlr4::Token* upperOp) {
+    // Both bounds test the same row, so `lo < key < hi` is a single range scan
+    std::string lowerValue = std::any_cast<std::string>(visit(lower));
+    std::string upperValue = std::any_cast<std::string>(visit(upper));
+    bool lowerInclusive = lowerOp->getType() == PlanParser::LE || lowerOp->getType() == PlanParser::GE;
+    bool upperInclusive = upperOp->getType() == PlanParser::LE || upperOp->getType() == PlanParser::GE;
+
+    std::string predicate = valueColumn(lower) + (lowerInclusive ? " >= " : " > ") + lowerValue +
+                            " AND " + valueColumn(upper) + (upperInclusive ? " <= " : " < ") + upperValue;
+    return handleKeyValueCondition(predicate);
+}
+
 std::any SQLBuilderVisitor::visitInteger(PlanParser::IntegerContext* ctx) {
-    std::string value = ctx->getText();
+    std::string value = literal(ctx->getStart(), ctx->getText());
     spdlog::debug("Visited Integer: {}", value);
     return std::any(value);
 }
 
 std::any SQLBuilderVisitor::visitFloating(PlanParser::FloatingContext* ctx) {
-    std::string value = ctx->getText();
+    std::string value = literal(ctx->getStart(), ctx->getText());
     spdlog::debug("Visited Floating: {}", value);
     return std::any(value);
 }
@@ -92,6 +333,7 @@ std::any SQLBuilderVisitor::visitString(PlanParser::StringContext* ctx) {
         }
     }
     escaped += "'";
+    escaped = literal(ctx->getStart(), escaped);
     spdlog::debug("Visited String: {}", escaped);
     return std::any(escaped);
 }
@@ -107,16 +349,25 @@ std::any SQLBuilderVisitor::visitParens(PlanParser::ParensContext* ctx) {
 }
 
 std::any SQLBuilderVisitor::visitLike(PlanParser::LikeContext* ctx) {
-    if (isIdentifier(ctx->expr())) {
-        std::string key = getIdentifier(ctx->expr());
-        std::string pattern = ctx->StringLiteral()->getText();
-        std::string condition = "LIKE " + pattern;
-        std::string expr = handleKeyValueCondition(key, condition);
+    if (setTarget(ctx->expr())) {
+        antlr4::Token* token = ctx->StringLiteral()->getSymbol();
+        std::string pattern = literal(token, ctx->StringLiteral()->getText());
+
+        FilterParameter parameter;
+        if (target.kind == ConditionTarget::Kind::Key && textKeys.count(target.key) > 0 &&
+            toParameter(token->getType(), token->getText(), parameter) && hasTrigram(parameter.textValue)) {
+            std::string expr = textIndexCondition(pattern);
+            spdlog::debug("Visited Like: {}", expr);
+            return std::any(expr);
+        }
+
+        std::string condition = column("value") + " LIKE " + pattern;
+        std::string expr = handleKeyValueCondition(condition);
         spdlog::debug("Visited Like: {}", expr);
         return std::any(expr);
     } else {
         std::string field = std::any_cast<std::string>(visit(ctx->expr()));
-        std::string pattern = ctx->StringLiteral()->getText();
+        std::string pattern = literal(ctx->StringLiteral()->getSymbol(), ctx->StringLiteral()->getText());
         std::string expr = field + " LIKE " + pattern;
         spdlog::debug("Visited Like: {}", expr);
         return std::any(expr);
@@ -133,8 +384,7 @@ std::any SQLBuilderVisitor::visitAddSub(PlanParser::AddSubContext* ctx) {
 }
 
 std::any SQLBuilderVisitor::visitEquality(PlanParser::EqualityContext* ctx) {
-    if (isIdentifier(ctx->expr(0))) {
-        std::string key = getIdentifier(ctx->expr(0));
+    if (setTarget(ctx->expr(0))) {
         std::string op = ctx->op->getText();
         if (op == "==") {
             op = "=";
@@ -142,7 +392,7 @@ std::any SQLBuilderVisitor::visitEquality(PlanParser::EqualityContext* ctx) {
             op = "<>";
         }
         std::string value_condition = generateValueCondition(op, ctx->expr(1));
-        std::string expr = handleKeyValueCondition(key, value_condition);
+        std::string expr = handleKeyValueCondition(value_condition);
         spdlog::debug("Visited Equality: {}", expr);
         return std::any(expr);
     } else {
@@ -180,14 +430,13 @@ std::any SQLBuilderVisitor::visitLogicalOr(PlanParser::LogicalOrContext* ctx) {
 }
 
 std::any SQLBuilderVisitor::visitRelational(PlanParser::RelationalContext* ctx) {
-    if (isIdentifier(ctx->expr(0))) {
-        std::string key = getIdentifier(ctx->expr(0));
+    if (setTarget(ctx->expr(0))) {
         std::string op = ctx->op->getText();
         if (op == "==") {
             op = "=";
         }
         std::string value_condition = generateValueCondition(op, ctx->expr(1));
-        std::string expr = handleKeyValueCondition(key, value_condition);
+        std::string expr = handleKeyValueCondition(value_condition);
         spdlog::debug("Visited Relational: {}", expr);
         return std::any(expr);
     } else {
@@ -203,6 +452,30 @@ std::any SQLBuilderVisitor::visitRelational(PlanParser::RelationalContext* ctx)
     }
 }
 
+std::any SQLBuilderVisitor::visitRange(PlanParser::RangeContext* ctx) {
+    // lower < key < upper
+    if (ctx->Identifier() != nullptr) {
+        setTarget(ctx->Identifier()->getText(), false, false);
+    } else {
+        setTarget(ctx->JSONIdentifier()->getText(), true, false);
+    }
+    std::string expr = rangeCondition(ctx->expr(0), ctx->op1, ctx->expr(1), ctx->op2);
+    spdlog::debug("Visited Range: {}", expr);
+    return std::any(expr);
+}
+
+std::any SQLBuilderVisitor::visitReverseRange(PlanParser::ReverseRangeContext* ctx) {
+    // upper > key > lower
+    if (ctx->Identifier() != nullptr) {
+        setTarget(ctx->Identifier()->getText(), false, false);
+    } else {
+        setTarget(ctx->JSONIdentifier()->getText(), true, false);
+    }
+    std::string expr = rangeCondition(ctx->expr(1), ctx->op2, ctx->expr(0), ctx->op1);
+    spdlog::debug("Visited ReverseRange: {}", expr);
+    return std::any(expr);
+}
+
 std::any SQLBuilderVisitor::visitUnary(PlanParser::UnaryContext* ctx) {
     std::string op = ctx->op->getText();
 
@@ -246,26 +519,48 @@ std::any SQLBuilderVisitor::visitJSONIdentifier(PlanParser::JSONIdentifierContex
     return std::any(json_id);
 }
 
-std::any SQLBuilderVisitor::visitTerm(PlanParser::TermContext* ctx) {
-    std::string op = ctx->op->getText();
-    std::string key = getIdentifier(ctx->expr(0));
-    std::string in_values;
+std::string SQLBuilderVisitor::inCondition(const std::string& op, bool notIn,
+                                           const std::vector<PlanParser::ExprContext*>& values) {
+    std::string numeric_values;
+    std::string text_values;
 
-    for (size_t i = 1; i < ctx->expr().size(); ++i) {
-        if (i > 1) {
+    for (PlanParser::ExprContext* value : values) {
+        std::string& in_values = isNumeric(value) ? numeric_values : text_values;
+        if (!in_values.empty()) {
             in_values += ", ";
         }
         try {
-            in_values += std::any_cast<std::string>(visit(ctx->expr(i)));
+            in_values += std::any_cast<std::string>(visit(value));
         } catch (const std::bad_any_cast&) {
             spdlog::error("Failed to cast expression in visitTerm");
             in_values += "''";
         }
     }
 
-    // "value" 제외하고 단순히 IN (...) 형식만 추가
-    std::string condition = op + " (" + in_values + ")";
-    std::string expr = handleKeyValueCondition(key, condition);
+    // Numbers are looked up in numericValue and strings in value
+    std::string numeric_condition = column("numericValue") + " " + op + " (" + numeric_values + ")";
+    std::string text_condition = column("value") + " " + op + " (" + text_values + ")";
+    std::string condition;
+    if (text_values.empty()) {
+        condition = numeric_condition;
+    } else if (numeric_values.empty()) {
+        condition = text_condition;
+    } else if (notIn) {
+        // Neither one of the numbers nor one of the strings; strings have no numericValue
+        condition = "(COALESCE(" + numeric_condition + ", 1) AND " + text_condition + ")";
+    } else {
+        condition = "(" + numeric_condition + " OR " + text_condition + ")";
+    }
+    return condition;
+}
+
+std::any SQLBuilderVisitor::visitTerm(PlanParser::TermContext* ctx) {
+    std::string op = ctx->op->getText();
+    setTarget(ctx->expr(0));
+    std::vector<PlanParser::ExprContext*> values = ctx->expr();
+    values.erase(values.begin());
+    std::string condition = inCondition(op, ctx->op->getType() == PlanParser::NIN, values);
+    std::string expr = handleKeyValueCondition(condition);
     spdlog::debug("Visited Term ({}): {}", op, expr);
     return std::any(expr);
 }
@@ -273,16 +568,16 @@ std::any SQLBuilderVisitor::visitTerm(PlanParser::TermContext* ctx) {
 
 std::any SQLBuilderVisitor::visitEmptyTerm(PlanParser::EmptyTermContext* ctx) {
     std::string op = ctx->op->getText();
-    std::string key = getIdentifier(ctx->expr());
+    setTarget(ctx->expr());
 
     if (op == "IN" || op == "in") {
-        std::string condition = "\"value\" IS NOT NULL";
-        std::string expr = handleKeyValueCondition(key, condition);
+        std::string condition = column("value") + " IS NOT NULL";
+        std::string expr = handleKeyValueCondition(condition);
         spdlog::debug("Visited EmptyTerm (IN): {}", expr);
         return std::any(expr);
     } else if (op == "NIN" || op == "not in" || op == "NOT IN") {
-        std::string condition = "\"value\" IS NULL";
-        std::string expr = handleKeyValueCondition(key, condition);
+        std::string condition = column("value") + " IS NULL";
+        std::string expr = handleKeyValueCondition(condition);
         spdlog::debug("Visited EmptyTerm (NOT IN): {}", expr);
         return std::any(expr);
     } else {
@@ -291,5 +586,70 @@ std::any SQLBuilderVisitor::visitEmptyTerm(PlanParser::EmptyTermContext* ctx) {
     }
 }
 
+std::vector<PlanParser::ExprContext*> SQLBuilderVisitor::arrayElements(PlanParser::ExprContext* ctx,
+                                                                       const std::string& function) {
+    auto arrayCtx = dynamic_cast<PlanParser::ArrayContext*>(ctx);
+    if (arrayCtx == nullptr) {
+        throw std::invalid_argument(function + " expects an array of values: " + ctx->getText());
+    }
+    for (PlanParser::ExprContext* value : arrayCtx->expr()) {
+        if (!isLiteral(value)) {
+            throw std::invalid_argument(function + " expects numbers or strings: " + value->getText());
+        }
+    }
+    return arrayCtx->expr();
+}
+
+std::any SQLBuilderVisitor::visitJSONContains(PlanParser::JSONContainsContext* ctx) {
+    // Some element of the array equals the value
+    if (!isLiteral(ctx->expr(1))) {
+        throw std::invalid_argument("json_contains expects a number or a string: " + ctx->expr(1)->getText());
+    }
+    if (!setTarget(ctx->expr(0), true)) {
+        throw std::invalid_argument("json_contains expects a metadata key or JSON path: " + ctx->expr(0)->getText());
+    }
+    std::string expr = handleKeyValueCondition(generateValueCondition("=", ctx->expr(1)));
+    spdlog::debug("Visited JSONContains: {}", expr);
+    return std::any(expr);
+}
+
+std::any SQLBuilderVisitor::visitJSONContainsAll(PlanParser::JSONContainsAllContext* ctx) {
+    // One EXISTS per value, each may match a different element
+    std::string expr;
+    for (PlanParser::ExprContext* value : arrayElements(ctx->expr(1), "json_contains_all")) {
+        if (!setTarget(ctx->expr(0), true)) {
+            throw std::invalid_argument("json_contains_all expects a metadata key or JSON path: " + ctx->expr(0)->getText());
+        }
+        expr += (expr.empty() ? "" : " AND ") + handleKeyValueCondition(generateValueCondition("=", value));
+    }
+    expr = "(" + expr + ")";
+    spdlog::debug("Visited JSONContainsAll: {}", expr);
+    return std::any(expr);
+}
+
+std::any SQLBuilderVisitor::visitJSONContainsAny(PlanParser::JSONContainsAnyContext* ctx) {
+    std::vector<PlanParser::ExprContext*> values = arrayElements(ctx->expr(1), "json_contains_any");
+    if (!setTarget(ctx->expr(0), true)) {
+        throw std::invalid_argument("json_contains_any expects a metadata key or JSON path: " + ctx->expr(0)->getText());
+    }
+    std::string expr = handleKeyValueCondition(inCondition("IN", false, values));
+    spdlog::debug("Visited JSONContainsAny: {}", expr);
+    return std::any(expr);
+}
+
+std::any SQLBuilderVisitor::visitArrayLength(PlanParser::ArrayLengthContext* ctx) {
+    // A scalar subquery, compared like any other expression; NULL without an array
+    JsonPath path = JsonPath::parse(ctx->Identifier() != nullptr ? ctx->Identifier()->getText()
+                                                                 : ctx->JSONIdentifier()->getText());
+    std::string row = "vm" + std::to_string(conditionCount);
+    std::string expr = "(SELECT MAX(CASE WHEN " + row + ".valueType IN (4, 5) THEN json_array_length(" + row +
+                       ".value, " + quoteString(path.toSQLitePath()) + ") END) FROM VectorMetadata " + row +
+                       " WHERE " + row + ".vectorId = VectorMetadata.vectorId AND " + row + ".key = " +
+                       quoteString(path.getKey()) + ")";
+    conditionCount++;
+    spdlog::debug("Visited ArrayLength: {}", expr);
+    return std::any(expr);
+}
+
 }; // namespace filter
 }; // namespace atinyvectors
@@ -1,23 +1,57 @@
 #include "service/SearchService.hpp"
+#include "service/EngineLock.hpp"
 #include "algo/FaissIndexLRUCache.hpp"
 #include "Space.hpp"
 #include "Version.hpp"
 #include "VectorIndex.hpp"
+#include "Config.hpp"
 #include "DatabaseManager.hpp"
 #include "IdCache.hpp"
 #include "SparseDataPool.hpp"
 #include "VectorMetadata.hpp"
+#include "filter/FilterPlanner.hpp"
+#include "filter/MetadataBitmapIndex.hpp"
+#include "filter/PredicateBuilderVisitor.hpp"
 #include "utils/Utils.hpp"
 
 #include "nlohmann/json.hpp"
 #include "spdlog/spdlog.h"
+#include "faiss/impl/IDSelector.h"
+
+#include <algorithm>
+#include <unordered_map>
 
 using namespace atinyvectors::algo;
+using namespace atinyvectors::filter;
 using namespace atinyvectors::utils;
 
 namespace atinyvectors {
 namespace service {
 
+namespace {
+
+// Admits the unique ids of a filter's bitmap during an HNSW traversal
+struct BitmapIDSelector : faiss::IDSelector {
+    const RoaringBitmap& bitmap;
+
+    explicit BitmapIDSelector(const RoaringBitmap& bitmap) : bitmap(bitmap) {}
+
+    bool is_member(faiss::idx_t id) const override {
+        return id >= 0 && id <= UINT32_MAX && bitmap.contains(static_cast<uint32_t>(id));
+    }
+};
+
+std::vector<std::pair<float, int>> toResults(const std::vector<float>& distances, const std::vector<int64_t>& labels, size_t found) {
+    std::vector<std::pair<float, int>> results;
+    results.reserve(found);
+    for (size_t i = 0; i < found; ++i) {
+        results.emplace_back(distances[i], static_cast<int>(labels[i]));
+    }
+    return results;
+}
+
+}
+
 // Function to perform a search using the query JSON string
 std::vector<std::pair<float, int>> SearchServiceManager::search(const std::string& spaceName, int versionUniqueId, const std::string& queryJsonStr, size_t k) {
     // Parse the JSON query string
@@ -42,6 +76,8 @@ std::vector<std::pair<float, int>> SearchServiceManager::search(const std::strin
         throw std::invalid_argument("Invalid query JSON format.");
     }
 
+    auto lock = EngineLock::shared();
+
     // Find the correct vector index by space name and version unique ID
     int vectorIndexId = findVectorIndexBySpaceNameAndVersionUniqueId(spaceName, versionUniqueId);
     if (vectorIndexId == -1) {
@@ -64,6 +100,7 @@ std::vector<std::pair<float, int>> SearchServiceManager::search(const std::strin
 
     // Perform search based on vector type
     std::vector<std::pair<float, int>> initialResults;
+    std::vector<float> filterQuery;  // dense query for the filtered plans
     if (isSparse) {
         // Extract Sparse Vector data
         nlohmann::json sparseData = queryJson["sparse_data"];
@@ -86,8 +123,17 @@ std::vector<std::pair<float, int>> SearchServiceManager::search(const std::strin
             sparseVector.emplace_back(index, value);
         }
 
-        // Perform the search using the Sparse Vector
-        initialResults = hnswIndexManager->search(&sparseVector, k);
+        if (!filterCondition.empty()) {
+            filterQuery.assign(hnswIndexManager->dim, 0.0f);
+            for (const auto& [index, value] : sparseVector) {
+                if (index >= 0 && index < hnswIndexManager->dim) {
+                    filterQuery[index] = value;
+                }
+            }
+        } else {
+            // Perform the search using the Sparse Vector
+            initialResults = hnswIndexManager->search(&sparseVector, k);
+        }
     }
     else {
         // Extract Dense Vector data
@@ -99,19 +145,184 @@ std::vector<std::pair<float, int>> SearchServiceManager::search(const std::strin
             throw std::invalid_argument("Invalid 'vector' format.");
         }
 
-        // Perform the search using the Dense Vector
-        initialResults = hnswIndexManager->search(queryVector, k);
+        if (!filterCondition.empty()) {
+            // Short queries are padded like in FaissIndexManager::search
+            filterQuery = std::move(queryVector);
+            if (filterQuery.size() < static_cast<size_t>(hnswIndexManager->dim)) {
+                filterQuery.resize(hnswIndexManager->dim, 0.0f);
+            }
+        } else {
+            // Perform the search using the Dense Vector
+            initialResults = hnswIndexManager->search(queryVector, k);
+        }
     }
 
     // Apply filter if a filter condition is provided
     if (!filterCondition.empty()) {
-        VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
-        initialResults = metadataManager.filterVectors(initialResults, filterCondition);
+        int versionId = IdCache::getInstance().getVersionId(spaceName, versionUniqueId);
+        initialResults = searchFiltered(*hnswIndexManager, versionId, filterQuery, k, filterCondition);
     }
 
     return initialResults;
 }
 
+std::vector<std::pair<float, int>> SearchServiceManager::searchFiltered(FaissIndexManager& indexManager, int versionId,
+                                                                        const std::vector<float>& queryVector, size_t k,
+                                                                        const std::string& filter) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+
+    // The bitmap index gives the exact number of matches; without it there is no
+    // estimate, and the filter is applied to the unfiltered hits, compiled to a
+    // predicate over the in-memory metadata when possible and through SQL otherwise
+    auto& bitmapIndex = MetadataBitmapIndex::getInstance();
+    RoaringBitmap matching;
+    if (!bitmapIndex.evaluate(versionId, filter, matching)) {
+        std::shared_ptr<const FilterPredicate> predicate;
+        if (bitmapIndex.isEnabled()) {
+            predicate = PredicateBuilderVisitor::compile(filter);
+        }
+        spdlog::debug("Filter plan: {} (no cardinality estimate, {} checks), k: {}, filter: {}",
+                      toString(FilterPlan::PostFilter), predicate ? "in-memory" : "SQL", k, filter);
+        bool complete;
+        return searchOverFetch(indexManager, queryVector, k, k,
+            [&](const std::vector<std::pair<float, int>>& candidates) {
+                return metadataManager.filterCandidates(versionId, candidates, filter, predicate.get());
+            }, complete);
+    }
+
+    size_t matchingCount = matching.cardinality();
+    size_t total = indexManager.count();
+    FilterPlan plan = FilterPlanner::getInstance().choose(matchingCount, total, k);
+    spdlog::debug("Filter plan: {} for {} of {} vectors, k: {}, filter: {}", toString(plan), matchingCount, total, k, filter);
+
+    if (plan == FilterPlan::ExactScan) {
+        std::vector<uint32_t> uniqueIds = matching.toVector();
+        std::vector<int64_t> candidates(uniqueIds.begin(), uniqueIds.end());
+        std::vector<float> distances(k);
+        std::vector<int64_t> labels(k);
+        size_t found = indexManager.searchExact(queryVector.data(), candidates.data(), candidates.size(), k,
+                                                distances.data(), labels.data());
+        return toResults(distances, labels, found);
+    }
+
+    if (plan == FilterPlan::PostFilter) {
+        bool complete;
+        auto results = searchOverFetch(indexManager, queryVector, k, FilterPlanner::postFilterFetch(matchingCount, total, k),
+            [&](const std::vector<std::pair<float, int>>& candidates) {
+                std::vector<std::pair<float, int>> accepted;
+                for (const auto& candidate : candidates) {
+                    if (candidate.second >= 0 && matching.contains(static_cast<uint32_t>(candidate.second))) {
+                        accepted.push_back(candidate);
+                    }
+                }
+                return accepted;
+            }, complete);
+        if (complete) {
+            return results;
+        }
+        spdlog::debug("Filter plan: post-filter found {} of {} hits, switching to {}", results.size(), k,
+                      toString(FilterPlan::FilteredIndex));
+    }
+
+    BitmapIDSelector selector(matching);
+    std::vector<float> distances(k);
+    std::vector<int64_t> labels(k);
+    size_t found = indexManager.search(queryVector.data(), k, selector, distances.data(), labels.data());
+    return toResults(distances, labels, found);
+}
+
+size_t SearchServiceManager::searchDense(const std::string& spaceName, int versionUniqueId, const float* queryVector, size_t dim,
+                                         size_t k, float* outDistances, int64_t* outLabels) {
+    if (queryVector == nullptr || outDistances == nullptr || outLabels == nullptr) {
+        throw std::invalid_argument("Query and output buffers must not be null.");
+    }
+
+    auto lock = EngineLock::shared();
+    int vectorIndexId = findVectorIndexBySpaceNameAndVersionUniqueId(spaceName, versionUniqueId);
+    auto hnswIndexManager = FaissIndexLRUCache::getInstance().get(vectorIndexId);
+    if (!hnswIndexManager) {
+        spdlog::error("HnswIndexManager instance not found for vectorIndexId: {}", vectorIndexId);
+        throw std::runtime_error("HnswIndexManager not found.");
+    }
+
+    if (dim != static_cast<size_t>(hnswIndexManager->dim)) {
+        spdlog::error("Query dimension {} does not match index dimension {}", dim, hnswIndexManager->dim);
+        throw std::invalid_argument("Query dimension does not match the vector index.");
+    }
+
+    return hnswIndexManager->search(queryVector, k, outDistances, outLabels);
+}
+
+size_t SearchServiceManager::searchSparse(const std::string& spaceName, int versionUniqueId, const int* indices, const float* values,
+                                          size_t nnz, size_t k, float* outDistances, int64_t* outLabels) {
+    if ((nnz > 0 && (indices == nullptr || values == nullptr)) || outDistances == nullptr || outLabels == nullptr) {
+        throw std::invalid_argument("Query and output buffers must not be null.");
+    }
+
+    auto lock = EngineLock::shared();
+    int vectorIndexId = findVectorIndexBySpaceNameAndVersionUniqueId(spaceName, versionUniqueId);
+    auto hnswIndexManager = FaissIndexLRUCache::getInstance().get(vectorIndexId);
+    if (!hnswIndexManager) {
+        spdlog::error("HnswIndexManager instance not found for vectorIndexId: {}", vectorIndexId);
+        throw std::runtime_error("HnswIndexManager not found.");
+    }
+
+    return hnswIndexManager->search(indices, values, nnz, k, outDistances, outLabels);
+}
+
+std::vector<std::pair<float, int>> SearchServiceManager::searchOverFetch(FaissIndexManager& indexManager,
+                                                                         const std::vector<float>& queryVector, size_t k, size_t fetch,
+                                                                         const CandidateFilter& filter, bool& complete) {
+    size_t total = indexManager.count();
+    size_t limit = std::min(total, std::max(k, static_cast<size_t>(Config::getInstance().getFilterOverFetchMax())));
+    fetch = std::min(std::max(fetch, k), limit);
+
+    std::unordered_map<int, bool> verdicts;  // by label
+    std::vector<std::pair<float, int>> results;
+    while (true) {
+        // Each round ranks all its candidates, so the survivors come out in order
+        auto hits = indexManager.search(queryVector, fetch);
+
+        std::vector<std::pair<float, int>> unseen;
+        for (const auto& hit : hits) {
+            if (verdicts.emplace(hit.second, false).second) {
+                unseen.push_back(hit);
+            }
+        }
+        if (!unseen.empty()) {
+            for (const auto& accepted : filter(unseen)) {
+                verdicts[accepted.second] = true;
+            }
+        }
+
+        results.clear();
+        for (const auto& hit : hits) {
+            if (verdicts[hit.second]) {
+                results.push_back(hit);
+            }
+        }
+
+        // Fewer hits than asked for means the index has no more to give
+        if (results.size() >= k || hits.size() < fetch || fetch >= total) {
+            complete = true;
+            break;
+        }
+        if (fetch >= limit) {
+            complete = false;
+            break;
+        }
+
+        size_t next = std::min(fetch * 2, limit);
+        spdlog::debug("Over-fetch: {} of {} hits in {} candidates, retrying with {}", results.size(), k, fetch, next);
+        fetch = next;
+    }
+
+    if (results.size() > k) {
+        results.resize(k);
+    }
+    return results;
+}
+
 // Function to find vector index by space name and version unique ID
 int SearchServiceManager::findVectorIndexBySpaceNameAndVersionUniqueId(const std::string& spaceName, int& outVersionUniqueId) {
     IdCache& cache = IdCache::getInstance();
@@ -134,5 +345,32 @@ nlohmann::json SearchServiceManager::extractSearchResultsToJson(const std::vecto
     return result;
 }
 
+nlohmann::json SearchServiceManager::getFacets(const std::string& spaceName, int versionUniqueId,
+                                               const std::vector<std::pair<float, int>>& searchResults,
+                                               const std::vector<std::string>& keys, int limit) {
+    int versionId = IdCache::getInstance().getVersionId(spaceName, versionUniqueId);
+
+    // Labels are unique ids, which the bitmap index is keyed by
+    std::vector<int> uniqueIds;
+    uniqueIds.reserve(searchResults.size());
+    for (const auto& [distance, label] : searchResults) {
+        uniqueIds.push_back(label);
+    }
+    MetadataFacets facets = VectorMetadataManager::getInstance().facetCounts(versionId, uniqueIds, keys, limit);
+
+    nlohmann::json facetsJson = nlohmann::json::object();
+    for (const auto& [key, values] : facets) {
+        nlohmann::json valuesJson = nlohmann::json::array();
+        for (const auto& facet : values) {
+            valuesJson.push_back({{"value", facet.value}, {"count", facet.count}});
+        }
+        facetsJson[key] = valuesJson;
+    }
+
+    nlohmann::json result;
+    result["facets"] = facetsJson;
+    return result;
+}
+
 } // namespace dto
 } // namespace atinyvectors
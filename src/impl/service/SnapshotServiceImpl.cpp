@@ -1,4 +1,5 @@
 #include "service/SnapshotService.hpp"
+#include "service/EngineLock.hpp"
 #include "Snapshot.hpp"
 #include "Version.hpp"
 #include "Space.hpp"
@@ -139,6 +140,7 @@ void SnapshotServiceManager::restoreSnapshot(const std::string& fileName) {
         std::string metaDirectory = Config::getInstance().getDataPath();
 
         // Restore the snapshot from the specified file
+        auto lock = EngineLock::exclusive();
         SnapshotManager::getInstance().restoreSnapshot(fullFilePath, metaDirectory);
         spdlog::info("Snapshot restored successfully from file: {}", fileName);
 
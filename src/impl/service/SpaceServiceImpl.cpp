@@ -9,6 +9,7 @@
 #include "Config.hpp"
 #include "DatabaseManager.hpp"
 #include "IdCache.hpp"
+#include "filter/JsonPath.hpp"
 
 #include <string>
 #include <SQLiteCpp/SQLiteCpp.h>
@@ -182,6 +183,47 @@ int createSparseVectorIndex(int versionId, const std::string& name, const std::s
     return VectorIndexManager::getInstance().addVectorIndex(sparseVectorIndex);
 }
 
+// "metadata_indexes": JSON paths into array and object metadata, e.g. attrs["brand"]
+// or tags[], that filters look up in an index instead of reading the JSON
+std::vector<std::string> parseMetadataIndexes(const json& parsedJson) {
+    std::vector<std::string> paths;
+    if (!parsedJson.contains("metadata_indexes")) {
+        return paths;
+    }
+
+    const auto& indexesJson = parsedJson["metadata_indexes"];
+    if (!indexesJson.is_array()) {
+        throw std::invalid_argument("'metadata_indexes' must be an array of JSON paths.");
+    }
+    for (const auto& pathJson : indexesJson) {
+        if (!pathJson.is_string()) {
+            throw std::invalid_argument("'metadata_indexes' must be an array of JSON paths.");
+        }
+        paths.push_back(filter::JsonPath::parse(pathJson.get<std::string>()).toString());
+    }
+    return paths;
+}
+
+// "text_indexes": metadata keys whose values LIKE filters look up by trigram
+std::vector<std::string> parseTextIndexes(const json& parsedJson) {
+    std::vector<std::string> keys;
+    if (!parsedJson.contains("text_indexes")) {
+        return keys;
+    }
+
+    const auto& indexesJson = parsedJson["text_indexes"];
+    if (!indexesJson.is_array()) {
+        throw std::invalid_argument("'text_indexes' must be an array of metadata keys.");
+    }
+    for (const auto& keyJson : indexesJson) {
+        if (!keyJson.is_string() || keyJson.get<std::string>().empty()) {
+            throw std::invalid_argument("'text_indexes' must be an array of metadata keys.");
+        }
+        keys.push_back(keyJson.get<std::string>());
+    }
+    return keys;
+}
+
 nlohmann::json fetchSpaceDetails(const Space& space) {
     nlohmann::json result;
 
@@ -189,6 +231,8 @@ nlohmann::json fetchSpaceDetails(const Space& space) {
     result["name"] = space.name;
     result["created_time_utc"] = space.created_time_utc;
     result["updated_time_utc"] = space.updated_time_utc;
+    result["metadata_indexes"] = VectorMetadataManager::getInstance().getIndexedPaths(space.id);
+    result["text_indexes"] = VectorMetadataManager::getInstance().getTextIndexedKeys(space.id);
 
     auto versions = VersionManager::getInstance().getVersionsBySpaceId(space.id, 0, std::numeric_limits<int>::max());
     if (versions.empty()) {
@@ -395,6 +439,9 @@ void SpaceServiceManager::createSpace(const std::string& jsonStr) {
         spaceDescription = parsedJson["description"];
     }
 
+    std::vector<std::string> metadataIndexes = parseMetadataIndexes(parsedJson);
+    std::vector<std::string> textIndexes = parseTextIndexes(parsedJson);
+
     // validation
     try {
         int versionId = IdCache::getInstance().getDefaultVersionId(spaceName);
@@ -414,6 +461,13 @@ void SpaceServiceManager::createSpace(const std::string& jsonStr) {
     processDenseConfiguration(parsedJson, versionId);
     processSparseConfiguration(parsedJson, versionId);
     processIndexesConfiguration(parsedJson, versionId);
+
+    if (!metadataIndexes.empty()) {
+        VectorMetadataManager::getInstance().setIndexedPaths(spaceId, metadataIndexes);
+    }
+    if (!textIndexes.empty()) {
+        VectorMetadataManager::getInstance().setTextIndexedKeys(spaceId, textIndexes);
+    }
 }
 
 void SpaceServiceManager::deleteSpace(const std::string& spaceName, const std::string& jsonStr) {
@@ -500,6 +554,24 @@ void SpaceServiceManager::updateSpace(const std::string& spaceName, const std::s
         json parsedJson = json::parse(jsonStr);
         int versionId = IdCache::getInstance().getDefaultVersionId(spaceName);
 
+        // Metadata indexes are rebuilt from the stored metadata, so they can change
+        // while the space holds vectors
+        if (parsedJson.contains("metadata_indexes") || parsedJson.contains("text_indexes")) {
+            if (parsedJson.contains("metadata_indexes")) {
+                VectorMetadataManager::getInstance().setIndexedPaths(space.id, parseMetadataIndexes(parsedJson));
+                parsedJson.erase("metadata_indexes");
+            }
+            if (parsedJson.contains("text_indexes")) {
+                VectorMetadataManager::getInstance().setTextIndexedKeys(space.id, parseTextIndexes(parsedJson));
+                parsedJson.erase("text_indexes");
+            }
+            if (parsedJson.empty()) {
+                space.updated_time_utc = getCurrentTimeUTC();
+                SpaceManager::getInstance().updateSpace(space);
+                return;
+            }
+        }
+
         int vectorCount = VectorManager::getInstance().countByVersionId(versionId);
         if (vectorCount > 0) {
             spdlog::error("Cannot update space '{}'. There are {} vectors assigned to its vector indices.", spaceName, vectorCount);
@@ -1,5 +1,6 @@
 // VectorServiceImpl.cpp
 #include "service/VectorService.hpp"
+#include "service/EngineLock.hpp"
 #include "BM25.hpp"
 #include "Space.hpp"
 #include "Version.hpp"
@@ -10,6 +11,10 @@
 #include "SparseDataPool.hpp"
 #include "IdCache.hpp"
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
 #include <stdexcept>
 #include <iostream>
 #include "nlohmann/json.hpp"
@@ -24,12 +29,446 @@ namespace atinyvectors
 namespace service
 {
 
-void VectorServiceManager::upsert(const std::string& spaceName, int versionUniqueId, const std::string& jsonStr) {
-    json parsedJson = json::parse(jsonStr);
+namespace {
+
+// Vectors are written in chunks of this many records while the payload is parsed
+const size_t UPSERT_CHUNK_SIZE = 256;
+
+// Metadata row for a JSON value: strings are stored as is, other values as their
+// JSON text along with their type
+VectorMetadata toVectorMetadata(int versionId, int vectorId, const std::string& key, const json& value) {
+    MetadataValueType valueType;
+    switch (value.type()) {
+    case json::value_t::string:
+        return VectorMetadata(0, versionId, vectorId, key, value.get<std::string>());
+    case json::value_t::null:
+        return VectorMetadata(0, versionId, vectorId, key, "", MetadataValueType::Null);
+    case json::value_t::number_integer:
+    case json::value_t::number_unsigned:
+        valueType = MetadataValueType::Integer;
+        break;
+    case json::value_t::number_float:
+        valueType = MetadataValueType::Float;
+        break;
+    case json::value_t::boolean:
+        valueType = MetadataValueType::Boolean;
+        break;
+    case json::value_t::array:
+        valueType = MetadataValueType::Array;
+        break;
+    case json::value_t::object:
+        valueType = MetadataValueType::Object;
+        break;
+    default:
+        throw std::runtime_error("Unsupported metadata value for '" + key + "'.");
+    }
+    return VectorMetadata(0, versionId, vectorId, key, value.dump(), valueType);
+}
+
+// The JSON value a metadata row was written from
+json toMetadataJson(const VectorMetadata& metadata) {
+    switch (metadata.valueType) {
+    case MetadataValueType::String:
+        return metadata.value;
+    case MetadataValueType::Null:
+        return nullptr;
+    default: {
+        json value = json::parse(metadata.value, nullptr, false);
+        return value.is_discarded() ? json(metadata.value) : value;
+    }
+    }
+}
+
+// One element of "vectors", decoded without an intermediate json value
+struct VectorRecord {
+    int id = 0;
+
+    bool hasData = false;
+    bool dataIsArray = false;
+    std::vector<float> data;
+
+    bool hasIndices = false;
+    bool hasValues = false;
+    bool sparseIsArray = true;
+    std::vector<int> indices;
+    std::vector<float> values;
+
+    bool hasMetadata = false;
+    std::map<std::string, json> metadata;   // sorted, last duplicate wins (as with a json object)
+
+    bool hasDoc = false;
+    std::string doc;
+    bool hasDocTokens = false;
+    std::vector<std::string> docTokens;
+};
+
+// SAX handler for upsert payloads. Elements of the top-level "vectors" array are
+// decoded straight into VectorRecord buffers and handed to the callback every
+// UPSERT_CHUNK_SIZE records; other members are skipped.
+class VectorStreamHandler {
+public:
+    using ChunkCallback = std::function<void(std::vector<VectorRecord>&)>;
+
+    explicit VectorStreamHandler(ChunkCallback onChunk) : onChunk(std::move(onChunk)) {
+        records.reserve(UPSERT_CHUNK_SIZE);
+    }
+
+    // True when the payload has a top-level "data" array or object
+    bool hasStandaloneData() const { return standaloneData; }
+
+    bool null() {
+        return inMetadata() ? addMetadataValue(nullptr) : onScalar(nullptr, nullptr);
+    }
+    bool boolean(bool value) {
+        return inMetadata() ? addMetadataValue(value) : onScalar(nullptr, nullptr);
+    }
+    bool number_integer(json::number_integer_t value) {
+        double number = static_cast<double>(value);
+        return inMetadata() ? addMetadataValue(value) : onScalar(&number, nullptr);
+    }
+    bool number_unsigned(json::number_unsigned_t value) {
+        double number = static_cast<double>(value);
+        return inMetadata() ? addMetadataValue(value) : onScalar(&number, nullptr);
+    }
+    bool number_float(json::number_float_t value, const json::string_t&) {
+        return inMetadata() ? addMetadataValue(value) : onScalar(&value, nullptr);
+    }
+    bool string(json::string_t& value) {
+        return inMetadata() ? addMetadataValue(std::move(value)) : onScalar(nullptr, &value);
+    }
+    bool binary(json::binary_t&) { return onScalar(nullptr, nullptr); }
+
+    bool key(json::string_t& name) {
+        pendingKey = name;
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        Context next = Context::Skip;
+        switch (current()) {
+        case Context::None:
+            next = Context::Root;
+            break;
+        case Context::Root:
+            standaloneData = standaloneData || pendingKey == "data";
+            break;
+        case Context::Vectors:
+            record = VectorRecord();
+            next = Context::Element;
+            break;
+        case Context::Element:
+            if (pendingKey == "sparse_data") {
+                next = Context::SparseData;
+            } else if (pendingKey == "metadata") {
+                record.hasMetadata = true;
+                next = Context::Metadata;
+            } else if (pendingKey == "data") {
+                record.hasData = true;
+                record.dataIsArray = false;
+            }
+            break;
+        case Context::SparseData:
+            markSparseScalar();
+            break;
+        case Context::Metadata:
+        case Context::MetadataValue:
+            startMetadataContainer(json::object());
+            next = Context::MetadataValue;
+            break;
+        case Context::Skip:
+            break;
+        default:
+            throwUnexpected();
+        }
+        stack.push_back(next);
+        return true;
+    }
+
+    bool end_object() {
+        Context closed = stack.back();
+        stack.pop_back();
+        if (closed == Context::MetadataValue) {
+            containers.pop_back();
+        } else if (closed == Context::Element) {
+            records.push_back(std::move(record));
+            if (records.size() >= UPSERT_CHUNK_SIZE) {
+                flushChunk();
+            }
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        Context next = Context::Skip;
+        switch (current()) {
+        case Context::None:
+            break;
+        case Context::Root:
+            if (pendingKey == "vectors") {
+                next = Context::Vectors;
+            } else {
+                standaloneData = standaloneData || pendingKey == "data";
+            }
+            break;
+        case Context::Element:
+            if (pendingKey == "data") {
+                record.hasData = true;
+                record.dataIsArray = true;
+                record.data.clear();
+                next = Context::Data;
+            } else if (pendingKey == "doc_tokens") {
+                record.hasDocTokens = true;
+                record.docTokens.clear();
+                next = Context::DocTokens;
+            } else if (pendingKey == "metadata") {
+                throw std::runtime_error("metadata must be an object.");
+            }
+            break;
+        case Context::SparseData:
+            if (pendingKey == "indices") {
+                record.hasIndices = true;
+                record.indices.clear();
+                next = Context::Indices;
+            } else if (pendingKey == "values") {
+                record.hasValues = true;
+                record.values.clear();
+                next = Context::Values;
+            }
+            break;
+        case Context::Metadata:
+        case Context::MetadataValue:
+            startMetadataContainer(json::array());
+            next = Context::MetadataValue;
+            break;
+        case Context::Skip:
+            break;
+        default:
+            throwUnexpected();
+        }
+        stack.push_back(next);
+        return true;
+    }
+
+    bool end_array() {
+        Context closed = stack.back();
+        stack.pop_back();
+        if (closed == Context::MetadataValue) {
+            containers.pop_back();
+        } else if (closed == Context::Vectors) {
+            flushChunk();
+        }
+        return true;
+    }
+
+    template<class Exception>
+    bool parse_error(std::size_t, const std::string&, const Exception& ex) {
+        // Rethrown as is so callers still see json::parse_error
+        throw ex;
+    }
+
+private:
+    // MetadataValue: inside an array or object given as a metadata value
+    enum class Context { None, Root, Vectors, Element, Data, SparseData, Indices, Values, Metadata, MetadataValue, DocTokens, Skip };
+
+    Context current() const {
+        return stack.empty() ? Context::None : stack.back();
+    }
+
+    bool inMetadata() const {
+        return current() == Context::Metadata || current() == Context::MetadataValue;
+    }
+
+    // Metadata values keep their JSON type, so they are collected as json values
+    json& storeMetadataValue(json value) {
+        if (current() == Context::Metadata) {
+            return record.metadata[pendingKey] = std::move(value);
+        }
+        json& container = *containers.back();
+        if (container.is_array()) {
+            container.push_back(std::move(value));
+            return container.back();
+        }
+        return container[pendingKey] = std::move(value);
+    }
+
+    bool addMetadataValue(json value) {
+        storeMetadataValue(std::move(value));
+        return true;
+    }
+
+    void startMetadataContainer(json container) {
+        // Nested values are only appended to the innermost container, so the
+        // pointers to its parents stay valid until they are closed
+        containers.push_back(&storeMetadataValue(std::move(container)));
+    }
+
+    bool onScalar(const double* number, json::string_t* text) {
+        switch (current()) {
+        case Context::Element:
+            if (pendingKey == "id") {
+                record.id = toInt(number, "Vector id must be an integer.");
+            } else if (pendingKey == "data") {
+                record.hasData = true;
+                record.dataIsArray = false;
+            } else if (pendingKey == "doc") {
+                if (text == nullptr) {
+                    throw std::runtime_error("doc must be a string.");
+                }
+                record.hasDoc = true;
+                record.doc = std::move(*text);
+            } else if (pendingKey == "metadata" || pendingKey == "doc_tokens") {
+                throwUnexpected();
+            }
+            break;
+        case Context::Data:
+        case Context::Values:
+            if (number == nullptr) {
+                throw std::runtime_error("Vector values must be numbers.");
+            }
+            (current() == Context::Data ? record.data : record.values).push_back(static_cast<float>(*number));
+            break;
+        case Context::Indices:
+            record.indices.push_back(toInt(number, "Sparse indices must be integers."));
+            break;
+        case Context::SparseData:
+            markSparseScalar();
+            break;
+        case Context::DocTokens:
+            if (text == nullptr) {
+                throw std::runtime_error("doc_tokens must be strings.");
+            }
+            record.docTokens.push_back(std::move(*text));
+            break;
+        case Context::Vectors:
+            throwUnexpected();
+        default:
+            break;
+        }
+        return true;
+    }
+
+    // "indices" or "values" given as something other than an array
+    void markSparseScalar() {
+        if (pendingKey == "indices" || pendingKey == "values") {
+            (pendingKey == "indices" ? record.hasIndices : record.hasValues) = true;
+            record.sparseIsArray = false;
+        }
+    }
+
+    // Numbers arrive as doubles; fractions and values outside int are rejected
+    // instead of being truncated
+    static int toInt(const double* number, const char* error) {
+        if (number == nullptr || std::trunc(*number) != *number ||
+            *number < std::numeric_limits<int>::min() || *number > std::numeric_limits<int>::max()) {
+            throw std::runtime_error(error);
+        }
+        return static_cast<int>(*number);
+    }
+
+    [[noreturn]] void throwUnexpected() const {
+        switch (current()) {
+        case Context::Vectors:
+            throw std::runtime_error("Each entry of vectors must be an object.");
+        case Context::DocTokens:
+            throw std::runtime_error("doc_tokens must be strings.");
+        case Context::Element:
+            throw std::runtime_error("Unsupported value for '" + pendingKey + "' in vector.");
+        default:
+            throw std::runtime_error("Vector values must be numbers.");
+        }
+    }
+
+    void flushChunk() {
+        if (!records.empty()) {
+            onChunk(records);
+            records.clear();
+        }
+    }
+
+    ChunkCallback onChunk;
+    std::vector<Context> stack;
+    std::vector<json*> containers;  // open metadata arrays and objects, innermost last
+    std::string pendingKey;
+    VectorRecord record;
+    std::vector<VectorRecord> records;
+    bool standaloneData = false;
+};
+
+// Same semantics as the former per-element DOM loop: a vector is sparse when
+// sparse_data has both indices and values, otherwise dense from "data".
+// Throws what addVectorRecords would throw for the records, before anything is written
+void validateVectorRecords(const std::vector<VectorRecord>& records) {
+    for (const auto& record : records) {
+        if (record.hasIndices && record.hasValues) {
+            if (!record.sparseIsArray) {
+                throw std::runtime_error("indices and values must be arrays.");
+            }
+            if (record.indices.size() != record.values.size()) {
+                throw std::runtime_error("Indices and values arrays must have the same length.");
+            }
+        } else if (record.hasData && !record.dataIsArray) {
+            throw std::runtime_error("Data format is not supported for Dense vector.");
+        }
+    }
+}
+
+void addVectorRecords(std::vector<VectorRecord>& records, int versionId, int vectorIndexId) {
+    validateVectorRecords(records);
+
+    IdCache& idCache = IdCache::getInstance();
+    VectorManager& vectorManager = VectorManager::getInstance();
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+
+    int autoIdCount = static_cast<int>(std::count_if(records.begin(), records.end(), [](const VectorRecord& record) {
+        return record.id == 0;
+    }));
+    if (autoIdCount > 0) {
+        idCache.reserveVectorUniqueIds(versionId, autoIdCount);
+    }
+
+    for (auto& record : records) {
+        bool isSparse = record.hasIndices && record.hasValues;
+        Vector vector(0, versionId, record.id, isSparse ? VectorValueType::Sparse : VectorValueType::Dense, {}, false);
+
+        if (isSparse) {
+            SparseData* sparseData = idCache.getSparseDataPool(vectorIndexId).allocate();
+            sparseData->reserve(record.indices.size());
+            for (size_t i = 0; i < record.indices.size(); ++i) {
+                sparseData->emplace_back(record.indices[i], record.values[i]);
+            }
+            vector.values.emplace_back(0, vector.id, vectorIndexId, VectorValueType::Sparse, sparseData);
+        } else if (record.hasData) {
+            vector.values.emplace_back(0, vector.id, vectorIndexId, VectorValueType::Dense);
+            vector.values.back().denseData = std::move(record.data);
+        }
 
+        int addedVectorId = vectorManager.addVector(vector);
+
+        // Add metadata if present
+        if (record.hasMetadata) {
+            metadataManager.deleteVectorMetadataByVectorId(addedVectorId);
+            for (const auto& [key, value] : record.metadata) {
+                VectorMetadata metadata = toVectorMetadata(versionId, addedVectorId, key, value);
+                metadataManager.addVectorMetadata(metadata);
+            }
+        }
+
+        // Add document and tokens to BM25 if present
+        if (record.hasDoc && record.hasDocTokens) {
+            spdlog::debug("Adding document to BM25Manager. VectorId={}, Doc={}, Tokens={}",
+                          addedVectorId, record.doc, record.docTokens.size());
+            BM25Manager::getInstance().addDocument(addedVectorId, record.doc, record.docTokens);
+        }
+    }
+}
+
+}
+
+void VectorServiceManager::upsert(const std::string& spaceName, int versionUniqueId, const std::string& jsonStr) {
     spdlog::debug("Parsing JSON input. SpaceName={}, versionUniqueId={}", spaceName, versionUniqueId);
     spdlog::debug("Json={}", jsonStr);
 
+    auto lock = EngineLock::exclusive();
     IdCache& idCache = IdCache::getInstance();
     int versionId = idCache.getVersionId(spaceName, versionUniqueId);
     int vectorIndexId = idCache.getVectorIndexId(spaceName, versionUniqueId);
@@ -37,185 +476,208 @@ void VectorServiceManager::upsert(const std::string& spaceName, int versionUniqu
     VectorManager& vectorManager = VectorManager::getInstance();
     vectorManager.flush();
 
-    // Process vectors in JSON
-    if (parsedJson.contains("vectors") && parsedJson["vectors"].is_array()) {
-        const auto& vectorsJson = parsedJson["vectors"];
-        for (const auto& vectorJson : vectorsJson) {
-            int unique_id = vectorJson.value("id", 0); 
-            int vectorId = 0; 
-
-            // Determine the type of vector (Dense or Sparse)
-            VectorValueType valueType = VectorValueType::Dense; // Default to Dense
-            if (vectorJson.contains("sparse_data")) {
-                const auto& sparseDataJson = vectorJson["sparse_data"];
-                if (sparseDataJson.contains("indices") && sparseDataJson.contains("values")) {
-                    valueType = VectorValueType::Sparse;
-                }
-            }
+    // Chunks are written while parsing and each commits on its own, so a dry pass
+    // first rejects malformed or invalid payloads before any vector is written
+    VectorStreamHandler validator([](std::vector<VectorRecord>& records) {
+        validateVectorRecords(records);
+    });
+    json::sax_parse(jsonStr, &validator);
+
+    // Process vectors in JSON without building a DOM for the payload
+    VectorStreamHandler handler([&](std::vector<VectorRecord>& records) {
+        addVectorRecords(records, versionId, vectorIndexId);
+    });
+    json::sax_parse(jsonStr, &handler);
+
+    // Process standalone data. Only these legacy forms go through a DOM, with
+    // "vectors" dropped while parsing.
+    if (handler.hasStandaloneData()) {
+        json parsedJson = json::parse(jsonStr, [](int depth, json::parse_event_t event, json& parsed) {
+            return !(depth == 1 && event == json::parse_event_t::key && parsed == "vectors");
+        });
+        processDefaultDenseData(parsedJson, versionId, vectorIndexId);
+    }
+
+    vectorManager.flush();
+}
 
-            Vector vector(vectorId, versionId, unique_id, valueType, {}, false);
+void VectorServiceManager::upsertBatch(const std::string& spaceName, int versionUniqueId, const VectorBatch& batch) {
+    if (batch.count == 0) {
+        return;
+    }
 
-            if (vectorJson.contains("data") || vectorJson.contains("sparse_data")) {
-                if (valueType == VectorValueType::Dense && vectorJson.contains("data")) {
-                    auto dataJson = vectorJson["data"];
-                    if (dataJson.is_array()) {
-                        VectorValue denseValue(0, vector.id, vectorIndexId, VectorValueType::Dense, dataJson.get<std::vector<float>>());
-                        vector.values.push_back(denseValue);
-                    } else {
-                        throw std::runtime_error("Data format is not supported for Dense vector.");
-                    }
-                } else if (valueType == VectorValueType::Sparse && vectorJson.contains("sparse_data")) {
-                    auto sparseDataJson = vectorJson["sparse_data"];
-                    if (sparseDataJson.contains("indices") && sparseDataJson.contains("values")) {
-                        if (sparseDataJson["indices"].is_array() && sparseDataJson["values"].is_array()) {
-                            // Combine indices and values into SparseData
-                            std::vector<std::pair<int, float>> sparseDataPairs;
-                            const auto& indices = sparseDataJson["indices"];
-                            const auto& values = sparseDataJson["values"];
-                            
-                            if (indices.size() != values.size()) {
-                                throw std::runtime_error("Indices and values arrays must have the same length.");
-                            }
-
-                            SparseData* sparseData = idCache.getSparseDataPool(vectorIndexId).allocate();
-
-                            for (size_t i = 0; i < indices.size(); ++i) {
-                                sparseData->emplace_back(indices[i].get<int>(), values[i].get<float>());
-                            }
-                            VectorValue sparseValue(0, vector.id, vectorIndexId, VectorValueType::Sparse, sparseData);
-                            vector.values.push_back(sparseValue);
-                        } else {
-                            throw std::runtime_error("indices and values must be arrays.");
-                        }
-                    } else {
-                        throw std::runtime_error("Sparse vector must contain indices and values.");
-                    }
-                }
+    bool isDense = batch.denseData != nullptr;
+    bool isSparse = batch.sparseOffsets != nullptr;
+    if (isDense == isSparse) {
+        throw std::invalid_argument("Vector batch must contain either dense data or sparse data.");
+    }
+    if (isDense && batch.dim <= 0) {
+        throw std::invalid_argument("Dense vector batch requires a positive dim.");
+    }
+    if (isSparse) {
+        if (batch.sparseOffsets[0] != 0 || ((batch.sparseIndices == nullptr || batch.sparseValues == nullptr) && batch.sparseOffsets[batch.count] != 0)) {
+            throw std::invalid_argument("Sparse vector batch requires offsets starting at 0, indices and values.");
+        }
+        for (size_t i = 0; i < batch.count; ++i) {
+            if (batch.sparseOffsets[i + 1] < batch.sparseOffsets[i]) {
+                throw std::invalid_argument("Sparse vector batch offsets must be non-decreasing.");
             }
+        }
+    }
+    if (batch.metadataKeyCount > 0 && (batch.metadataKeys == nullptr || batch.metadataValues == nullptr)) {
+        throw std::invalid_argument("Vector batch metadata requires keys and values.");
+    }
 
-            int addedVectorId = vectorManager.addVector(vector);
+    spdlog::debug("Upserting vector batch. SpaceName={}, versionUniqueId={}, count={}", spaceName, versionUniqueId, batch.count);
 
-            // Add metadata if present
-            if (vectorJson.contains("metadata")) {
-                VectorMetadataManager::getInstance().deleteVectorMetadataByVectorId(addedVectorId);
-                for (const auto& [key, value] : vectorJson["metadata"].items()) {
-                    VectorMetadata metadata(0, versionId, addedVectorId, key, value.get<std::string>());
-                    VectorMetadataManager::getInstance().addVectorMetadata(metadata);
-                }
+    auto lock = EngineLock::exclusive();
+    IdCache& idCache = IdCache::getInstance();
+    int versionId = idCache.getVersionId(spaceName, versionUniqueId);
+    int vectorIndexId = idCache.getVectorIndexId(spaceName, versionUniqueId);
+
+    VectorManager& vectorManager = VectorManager::getInstance();
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+    vectorManager.flush();
+
+    size_t autoIdCount = batch.ids == nullptr ? batch.count : static_cast<size_t>(std::count(batch.ids, batch.ids + batch.count, 0));
+    if (autoIdCount > 0) {
+        idCache.reserveVectorUniqueIds(versionId, static_cast<int>(autoIdCount));
+    }
+
+    for (size_t i = 0; i < batch.count; ++i) {
+        int unique_id = batch.ids != nullptr ? batch.ids[i] : 0;
+        VectorValueType valueType = isDense ? VectorValueType::Dense : VectorValueType::Sparse;
+        Vector vector(0, versionId, unique_id, valueType, {}, false);
+
+        if (isDense) {
+            const float* row = batch.denseData + i * static_cast<size_t>(batch.dim);
+            vector.values.emplace_back(0, vector.id, vectorIndexId, VectorValueType::Dense, std::vector<float>(row, row + batch.dim));
+        } else {
+            SparseData* sparseData = idCache.getSparseDataPool(vectorIndexId).allocate();
+            for (int64_t j = batch.sparseOffsets[i]; j < batch.sparseOffsets[i + 1]; ++j) {
+                sparseData->emplace_back(batch.sparseIndices[j], batch.sparseValues[j]);
             }
+            vector.values.emplace_back(0, vector.id, vectorIndexId, VectorValueType::Sparse, sparseData);
+        }
 
-            // Add document and tokens to BM25 if present
-            if (vectorJson.contains("doc") && vectorJson.contains("doc_tokens")) {
-                std::string doc = vectorJson["doc"].get<std::string>();
-                std::vector<std::string> docTokens = vectorJson["doc_tokens"].get<std::vector<std::string>>();
+        int addedVectorId = vectorManager.addVector(vector);
 
-                spdlog::debug("Adding document to BM25Manager. VectorId={}, Doc={}, Tokens={}", 
-                              addedVectorId, doc, docTokens.size());
-                BM25Manager::getInstance().addDocument(addedVectorId, doc, docTokens);
+        if (batch.metadataKeyCount > 0) {
+            metadataManager.deleteVectorMetadataByVectorId(addedVectorId);
+            for (size_t k = 0; k < batch.metadataKeyCount; ++k) {
+                const char* value = batch.metadataValues[k * batch.count + i];
+                if (value == nullptr) {
+                    continue;
+                }
+                VectorMetadata metadata(0, versionId, addedVectorId, batch.metadataKeys[k], value);
+                metadataManager.addVectorMetadata(metadata);
             }
         }
     }
 
-    // Process standalone data
-    if (parsedJson.contains("data")) {
-        if (parsedJson["data"].is_array()) {
-            if (!parsedJson["data"].empty() && parsedJson["data"][0].is_object()) {
-                // Assuming each element can specify its type
-                for (const auto& vectorData : parsedJson["data"]) {
-                    VectorValueType valueType = VectorValueType::Dense; // Default
-                    if (vectorData.contains("indices") && vectorData.contains("values")) {
-                        valueType = VectorValueType::Sparse;
-                    }
+    vectorManager.flush();
+}
+
+void VectorServiceManager::processDefaultDenseData(const json& parsedJson, int versionId, int defaultIndexId) {
+    if (parsedJson["data"].is_array()) {
+        if (!parsedJson["data"].empty() && parsedJson["data"][0].is_object()) {
+            // One sequence reservation covers the whole batch
+            IdCache::getInstance().reserveVectorUniqueIds(versionId, static_cast<int>(parsedJson["data"].size()));
 
-                    Vector vector(0, versionId, 0, valueType, {}, false);
-                    
-                    if (valueType == VectorValueType::Dense) {
-                        if (vectorData.contains("data")) {
-                            VectorValue denseValue(0, vector.id, vectorIndexId, VectorValueType::Dense, vectorData["data"].get<std::vector<float>>());
-                            vector.values.push_back(denseValue);
-                        } else {
-                            throw std::runtime_error("Dense vector must contain 'data' field.");
+            // Assuming each element can specify its type
+            for (const auto& vectorData : parsedJson["data"]) {
+                VectorValueType valueType = VectorValueType::Dense; // Default
+                if (vectorData.contains("indices") && vectorData.contains("values")) {
+                    valueType = VectorValueType::Sparse;
+                }
+
+                Vector vector(0, versionId, 0, valueType, {}, false);
+                
+                if (valueType == VectorValueType::Dense) {
+                    if (vectorData.contains("data")) {
+                        VectorValue denseValue(0, vector.id, defaultIndexId, VectorValueType::Dense, vectorData["data"].get<std::vector<float>>());
+                        vector.values.push_back(denseValue);
+                    } else {
+                        throw std::runtime_error("Dense vector must contain 'data' field.");
+                    }
+                } else if (valueType == VectorValueType::Sparse) {
+                    if (vectorData.contains("indices") && vectorData.contains("values")) {
+                        // Combine indices and values into SparseData
+                        std::vector<std::pair<int, float>> sparseDataPairs;
+                        const auto& indices = vectorData["indices"];
+                        const auto& values = vectorData["values"];
+                        
+                        if (indices.size() != values.size()) {
+                            throw std::runtime_error("Indices and values arrays must have the same length.");
                         }
-                    } else if (valueType == VectorValueType::Sparse) {
-                        if (vectorData.contains("indices") && vectorData.contains("values")) {
-                            // Combine indices and values into SparseData
-                            std::vector<std::pair<int, float>> sparseDataPairs;
-                            const auto& indices = vectorData["indices"];
-                            const auto& values = vectorData["values"];
-                            
-                            if (indices.size() != values.size()) {
-                                throw std::runtime_error("Indices and values arrays must have the same length.");
-                            }
-
-                            SparseData* sparseData = idCache.getSparseDataPool(vectorIndexId).allocate();
-
-                            for (size_t i = 0; i < indices.size(); ++i) {
-                                sparseData->emplace_back(indices[i].get<int>(), values[i].get<float>());
-                            }
-                            VectorValue sparseValue(0, vector.id, vectorIndexId, VectorValueType::Sparse, sparseData);
-                            vector.values.push_back(sparseValue);
-                        } else {
-                            throw std::runtime_error("Sparse vector must contain 'indices' and 'values'.");
+
+                        SparseData* sparseData = IdCache::getInstance().getSparseDataPool(defaultIndexId).allocate();
+
+                        for (size_t i = 0; i < indices.size(); ++i) {
+                            sparseData->emplace_back(indices[i].get<int>(), values[i].get<float>());
                         }
+                        VectorValue sparseValue(0, vector.id, defaultIndexId, VectorValueType::Sparse, sparseData);
+                        vector.values.push_back(sparseValue);
+                    } else {
+                        throw std::runtime_error("Sparse vector must contain 'indices' and 'values'.");
                     }
-
-                    VectorManager::getInstance().addVector(vector);
-                }
-            } else if (!parsedJson["data"].empty() && parsedJson["data"][0].is_array()) {
-                for (const auto& vectorData : parsedJson["data"]) {
-                    Vector vector(0, versionId, 0, VectorValueType::Dense, {}, false);
-                    vector.values.push_back(VectorValue(0, vector.id, vectorIndexId, VectorValueType::Dense, vectorData.get<std::vector<float>>()));
-                    VectorManager::getInstance().addVector(vector);
                 }
-            } else {
-                // Assuming it's a single dense vector
-                Vector vector(0, versionId, 0, VectorValueType::Dense, {}, false);
-                vector.values.push_back(VectorValue(0, vector.id, vectorIndexId, VectorValueType::Dense, parsedJson["data"].get<std::vector<float>>()));
+
                 VectorManager::getInstance().addVector(vector);
             }
-        } else if (parsedJson["data"].is_object()) {
-            // Single vector object with type
-            VectorValueType valueType = VectorValueType::Dense; // Default
-            if (parsedJson["data"].contains("indices") && parsedJson["data"].contains("values")) {
-                valueType = VectorValueType::Sparse;
+        } else if (!parsedJson["data"].empty() && parsedJson["data"][0].is_array()) {
+            IdCache::getInstance().reserveVectorUniqueIds(versionId, static_cast<int>(parsedJson["data"].size()));
+            for (const auto& vectorData : parsedJson["data"]) {
+                Vector vector(0, versionId, 0, VectorValueType::Dense, {}, false);
+                vector.values.push_back(VectorValue(0, vector.id, defaultIndexId, VectorValueType::Dense, vectorData.get<std::vector<float>>()));
+                VectorManager::getInstance().addVector(vector);
             }
+        } else {
+            // Assuming it's a single dense vector
+            Vector vector(0, versionId, 0, VectorValueType::Dense, {}, false);
+            vector.values.push_back(VectorValue(0, vector.id, defaultIndexId, VectorValueType::Dense, parsedJson["data"].get<std::vector<float>>()));
+            VectorManager::getInstance().addVector(vector);
+        }
+    } else if (parsedJson["data"].is_object()) {
+        // Single vector object with type
+        VectorValueType valueType = VectorValueType::Dense; // Default
+        if (parsedJson["data"].contains("indices") && parsedJson["data"].contains("values")) {
+            valueType = VectorValueType::Sparse;
+        }
 
-            Vector vector(0, versionId, 0, valueType, {}, false);
+        Vector vector(0, versionId, 0, valueType, {}, false);
 
-            if (valueType == VectorValueType::Dense) {
-                if (parsedJson["data"].contains("data")) {
-                    vector.values.emplace_back(VectorValue(0, vector.id, vectorIndexId, VectorValueType::Dense, parsedJson["data"]["data"].get<std::vector<float>>()));
-                } else {
-                    throw std::runtime_error("Dense vector must contain 'data' field.");
+        if (valueType == VectorValueType::Dense) {
+            if (parsedJson["data"].contains("data")) {
+                vector.values.emplace_back(VectorValue(0, vector.id, defaultIndexId, VectorValueType::Dense, parsedJson["data"]["data"].get<std::vector<float>>()));
+            } else {
+                throw std::runtime_error("Dense vector must contain 'data' field.");
+            }
+        } else if (valueType == VectorValueType::Sparse) {
+            if (parsedJson["data"].contains("indices") && parsedJson["data"].contains("values")) {
+                // Combine indices and values into SparseData
+                std::vector<std::pair<int, float>> sparseDataPairs;
+                const auto& indices = parsedJson["data"]["indices"];
+                const auto& values = parsedJson["data"]["values"];
+                
+                if (indices.size() != values.size()) {
+                    throw std::runtime_error("Indices and values arrays must have the same length.");
                 }
-            } else if (valueType == VectorValueType::Sparse) {
-                if (parsedJson["data"].contains("indices") && parsedJson["data"].contains("values")) {
-                    // Combine indices and values into SparseData
-                    std::vector<std::pair<int, float>> sparseDataPairs;
-                    const auto& indices = parsedJson["data"]["indices"];
-                    const auto& values = parsedJson["data"]["values"];
-                    
-                    if (indices.size() != values.size()) {
-                        throw std::runtime_error("Indices and values arrays must have the same length.");
-                    }
 
-                    SparseData* sparseData = idCache.getSparseDataPool(vectorIndexId).allocate();
+                SparseData* sparseData = IdCache::getInstance().getSparseDataPool(defaultIndexId).allocate();
 
-                    for (size_t i = 0; i < indices.size(); ++i) {
-                        sparseData->emplace_back(indices[i].get<int>(), values[i].get<float>());
-                    }
-                    VectorValue sparseValue(0, vector.id, vectorIndexId, VectorValueType::Sparse, sparseData);
-                    vector.values.emplace_back(sparseValue);
-                } else {
-                    throw std::runtime_error("Sparse vector must contain 'indices' and 'values'.");
+                for (size_t i = 0; i < indices.size(); ++i) {
+                    sparseData->emplace_back(indices[i].get<int>(), values[i].get<float>());
                 }
+                VectorValue sparseValue(0, vector.id, defaultIndexId, VectorValueType::Sparse, sparseData);
+                vector.values.emplace_back(sparseValue);
+            } else {
+                throw std::runtime_error("Sparse vector must contain 'indices' and 'values'.");
             }
-
-            VectorManager::getInstance().addVector(vector);
         }
-    }
 
-    vectorManager.flush();
+        VectorManager::getInstance().addVector(vector);
+    }
 }
 
 void VectorServiceManager::processSimpleVectors(const json& vectorsJson, int versionId, int defaultIndexId) {
@@ -312,7 +774,7 @@ void VectorServiceManager::processVectors(const json& parsedJson, int versionId,
             VectorMetadataManager::getInstance().deleteVectorMetadataByVectorId(addedVectorId);
             
             for (const auto& [key, value] : vectorJson["metadata"].items()) {
-                VectorMetadata metadata(0, versionId, addedVectorId, key, value.get<std::string>());
+                VectorMetadata metadata = toVectorMetadata(versionId, addedVectorId, key, value);
                 VectorMetadataManager::getInstance().addVectorMetadata(metadata);
             }
         }
@@ -328,23 +790,17 @@ void VectorServiceManager::processVectors(const json& parsedJson, int versionId,
     }
 }
 
-json VectorServiceManager::getVectorsByVersionId(const std::string& spaceName, int versionUniqueId, int start, int limit, const std::string& filter) {
-    json result;
-
-    IdCache& idCache = IdCache::getInstance();
-    int versionId = idCache.getVersionId(spaceName, versionUniqueId);
+json VectorServiceManager::buildVectorsJson(const std::vector<Vector>& vectors) {
     json vectorsJson = json::array();
 
-    spdlog::debug("VectorServiceManager::getVectorsByVersionId called with parameters: spaceName={}, versionUniqueId={}, start={}, limit={}, filter={}", 
-                  spaceName, versionUniqueId, start, limit, filter);
-
-    std::vector<Vector> vectors;
-    if (filter.empty()) {
-        vectors = VectorManager::getInstance().getVectorsByVersionId(versionId, start, limit);
-    } else {
-        auto filteredVectorIds = VectorMetadataManager::getInstance().queryVectors(versionId, filter, start, limit).vectorUniqueIds;
-        vectors = VectorManager::getInstance().getVectorsByVectorIds(filteredVectorIds);
+    // Metadata and BM25 docs for the whole page in one pass each
+    std::vector<long> vectorIds;
+    vectorIds.reserve(vectors.size());
+    for (const auto& vector : vectors) {
+        vectorIds.push_back(vector.id);
     }
+    auto metadataByVectorId = VectorMetadataManager::getInstance().getVectorMetadataByVectorIds(vectorIds);
+    auto docsByVectorId = BM25Manager::getInstance().getDocsByVectorIds(vectorIds);
 
     for (const auto& vector : vectors) {
         json vectorJson;
@@ -371,27 +827,45 @@ json VectorServiceManager::getVectorsByVersionId(const std::string& spaceName, i
 
         vectorJson["data"] = dataJson;
 
-        auto metadataList = VectorMetadataManager::getInstance().getVectorMetadataByVectorId(vector.id);
         json metadataJson;
-
-        for (const auto& metadata : metadataList) {
-            metadataJson[metadata.key] = metadata.value;
+        auto metadataIt = metadataByVectorId.find(vector.id);
+        if (metadataIt != metadataByVectorId.end()) {
+            for (const auto& metadata : metadataIt->second) {
+                metadataJson[metadata.key] = toMetadataJson(metadata);
+            }
         }
 
         vectorJson["metadata"] = metadataJson;
 
-        try {
-            std::string doc = BM25Manager::getInstance().getDocByVectorId(vector.id);
-            if (!doc.empty()) {
-                vectorJson["doc"] = doc;
-            }
-        } catch (const std::exception& e) {
+        auto docIt = docsByVectorId.find(vector.id);
+        if (docIt != docsByVectorId.end() && !docIt->second.empty()) {
+            vectorJson["doc"] = docIt->second;
         }
 
         vectorsJson.push_back(vectorJson);
     }
 
-    result["vectors"] = vectorsJson;
+    return vectorsJson;
+}
+
+json VectorServiceManager::getVectorsByVersionId(const std::string& spaceName, int versionUniqueId, int start, int limit, const std::string& filter) {
+    json result;
+
+    IdCache& idCache = IdCache::getInstance();
+    int versionId = idCache.getVersionId(spaceName, versionUniqueId);
+
+    spdlog::debug("VectorServiceManager::getVectorsByVersionId called with parameters: spaceName={}, versionUniqueId={}, start={}, limit={}, filter={}", 
+                  spaceName, versionUniqueId, start, limit, filter);
+
+    std::vector<Vector> vectors;
+    if (filter.empty()) {
+        vectors = VectorManager::getInstance().getVectorsByVersionId(versionId, start, limit);
+    } else {
+        auto filteredVectorIds = VectorMetadataManager::getInstance().queryVectors(versionId, filter, start, limit).vectorUniqueIds;
+        vectors = VectorManager::getInstance().getVectorsByVectorIds(filteredVectorIds);
+    }
+
+    result["vectors"] = buildVectorsJson(vectors);
 
     int totalCount = VectorManager::getInstance().countByVersionId(versionId);
     result["total_count"] = totalCount;
@@ -399,5 +873,108 @@ json VectorServiceManager::getVectorsByVersionId(const std::string& spaceName, i
     return result;
 }
 
+json VectorServiceManager::getVectorsByCursor(const std::string& spaceName, int versionUniqueId, int afterUniqueId, int limit, const std::string& filter) {
+    json result;
+
+    IdCache& idCache = IdCache::getInstance();
+    int versionId = idCache.getVersionId(spaceName, versionUniqueId);
+
+    spdlog::debug("VectorServiceManager::getVectorsByCursor called with parameters: spaceName={}, versionUniqueId={}, afterUniqueId={}, limit={}, filter={}",
+                  spaceName, versionUniqueId, afterUniqueId, limit, filter);
+
+    std::vector<Vector> vectors;
+    if (filter.empty()) {
+        vectors = VectorManager::getInstance().getVectorsByVersionIdAfter(versionId, afterUniqueId, limit);
+    } else {
+        auto filteredVectorIds = VectorMetadataManager::getInstance().queryVectorIdsAfter(versionId, filter, afterUniqueId, limit);
+        vectors = VectorManager::getInstance().getVectorsByVectorIds(filteredVectorIds);
+        std::sort(vectors.begin(), vectors.end(), [](const Vector& a, const Vector& b) {
+            return a.unique_id < b.unique_id;
+        });
+    }
+
+    result["vectors"] = buildVectorsJson(vectors);
+    result["total_count"] = VectorManager::getInstance().countByVersionId(versionId);
+
+    // A short page means the listing is exhausted
+    if (limit > 0 && static_cast<int>(vectors.size()) == limit) {
+        result["next_cursor"] = vectors.back().unique_id;
+    } else {
+        result["next_cursor"] = nullptr;
+    }
+
+    return result;
+}
+
+json VectorServiceManager::getFacets(const std::string& spaceName, int versionUniqueId, const std::vector<std::string>& keys,
+                                     const std::string& filter, int limit) {
+    IdCache& idCache = IdCache::getInstance();
+    int versionId = idCache.getVersionId(spaceName, versionUniqueId);
+
+    spdlog::debug("VectorServiceManager::getFacets called with parameters: spaceName={}, versionUniqueId={}, keys={}, filter={}, limit={}",
+                  spaceName, versionUniqueId, keys.size(), filter, limit);
+
+    MetadataFacets facets = VectorMetadataManager::getInstance().facetCounts(versionId, filter, keys, limit);
+
+    json facetsJson = json::object();
+    for (const auto& [key, values] : facets) {
+        json valuesJson = json::array();
+        for (const auto& facet : values) {
+            valuesJson.push_back({{"value", facet.value}, {"count", facet.count}});
+        }
+        facetsJson[key] = valuesJson;
+    }
+
+    json result;
+    result["facets"] = facetsJson;
+    return result;
+}
+
+json VectorServiceManager::deleteByFilter(const std::string& spaceName, int versionUniqueId, const std::string& filter) {
+    if (filter.empty()) {
+        throw std::invalid_argument("A filter is required to delete vectors by filter.");
+    }
+
+    auto lock = EngineLock::exclusive();
+    int versionId = IdCache::getInstance().getVersionId(spaceName, versionUniqueId);
+    spdlog::debug("VectorServiceManager::deleteByFilter called with parameters: spaceName={}, versionUniqueId={}, filter={}",
+                  spaceName, versionUniqueId, filter);
+
+    // Matched and deleted in a single transaction
+    size_t deleted = VectorManager::getInstance().deleteVectorsByFilter(versionId, filter);
+
+    json result;
+    result["deleted_count"] = deleted;
+    return result;
+}
+
+json VectorServiceManager::updateMetadataByFilter(const std::string& spaceName, int versionUniqueId, const std::string& filter,
+                                                  const std::string& metadataJsonStr) {
+    if (filter.empty()) {
+        throw std::invalid_argument("A filter is required to update metadata by filter.");
+    }
+
+    json metadataJson = json::parse(metadataJsonStr);
+    if (!metadataJson.is_object() || metadataJson.empty()) {
+        throw std::invalid_argument("metadata must be a non-empty object.");
+    }
+
+    auto lock = EngineLock::exclusive();
+    int versionId = IdCache::getInstance().getVersionId(spaceName, versionUniqueId);
+    spdlog::debug("VectorServiceManager::updateMetadataByFilter called with parameters: spaceName={}, versionUniqueId={}, filter={}",
+                  spaceName, versionUniqueId, filter);
+
+    std::vector<VectorMetadata> values;
+    for (const auto& [key, value] : metadataJson.items()) {
+        values.push_back(toVectorMetadata(versionId, 0, key, value));
+    }
+
+    size_t updated = VectorMetadataManager::getInstance().replaceVectorMetadataByFilter(versionId, filter, values);
+
+    json result;
+    result["updated_count"] = updated;
+    return result;
+}
+
 } // namespace dto
 } // namespace atinyvectors
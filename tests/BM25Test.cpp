@@ -79,3 +79,17 @@ TEST_F(BM25Test, SearchEmptyVectorIdsTest) {
     ASSERT_NEAR(results[0].second, expectedScore1, 0.01);
     ASSERT_NEAR(results[1].second, expectedScore2, 0.01);
 }
+
+TEST_F(BM25Test, GetDocsByVectorIdsTest) {
+    BM25Manager& bm25Manager = BM25Manager::getInstance();
+
+    bm25Manager.addDocument(1, "Document 1", {"token1"});
+    bm25Manager.addDocument(2, "Document 2", {"token2"});
+    bm25Manager.addDocument(3, "Document 3", {"token3"});
+
+    auto docs = bm25Manager.getDocsByVectorIds({1, 3, 42});
+    ASSERT_EQ(docs.size(), 2);
+    EXPECT_EQ(docs[1], "Document 1");
+    EXPECT_EQ(docs[3], "Document 3");
+    EXPECT_EQ(docs.count(42), 0);
+}
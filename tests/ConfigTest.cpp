@@ -17,6 +17,15 @@ protected:
         unsetenv("ATV_DEFAULT_M");
         unsetenv("ATV_DEFAULT_EF_CONSTRUCTION");
         unsetenv("ATV_HNSW_MAX_DATASIZE");
+        unsetenv("ATV_SQLITE_JOURNAL_MODE");
+        unsetenv("ATV_SQLITE_SYNCHRONOUS");
+        unsetenv("ATV_SQLITE_CACHE_SIZE");
+        unsetenv("ATV_SQLITE_MMAP_SIZE");
+        unsetenv("ATV_SQLITE_TEMP_STORE");
+        unsetenv("ATV_SQLITE_PAGE_SIZE");
+        unsetenv("ATV_SQLITE_READ_POOL_SIZE");
+        unsetenv("ATV_SQLITE_WAL_AUTOCHECKPOINT");
+        unsetenv("ATV_SQLITE_BUSY_TIMEOUT_MS");
     }
 
     void TearDown() override {
@@ -28,6 +37,15 @@ protected:
         unsetenv("ATV_DEFAULT_M");
         unsetenv("ATV_DEFAULT_EF_CONSTRUCTION");
         unsetenv("ATV_HNSW_MAX_DATASIZE");
+        unsetenv("ATV_SQLITE_JOURNAL_MODE");
+        unsetenv("ATV_SQLITE_SYNCHRONOUS");
+        unsetenv("ATV_SQLITE_CACHE_SIZE");
+        unsetenv("ATV_SQLITE_MMAP_SIZE");
+        unsetenv("ATV_SQLITE_TEMP_STORE");
+        unsetenv("ATV_SQLITE_PAGE_SIZE");
+        unsetenv("ATV_SQLITE_READ_POOL_SIZE");
+        unsetenv("ATV_SQLITE_WAL_AUTOCHECKPOINT");
+        unsetenv("ATV_SQLITE_BUSY_TIMEOUT_MS");
     }
 };
 
@@ -76,3 +94,65 @@ TEST_F(ConfigTest, TestInvalidEnvironmentVariables) {
     EXPECT_EQ(config.getEfConstruction(), 100);  // Should use the default value
     EXPECT_EQ(config.getHnswMaxDataSize(), 1000000);  // Should use the default value
 }
+
+TEST_F(ConfigTest, TestSqliteProfileDefaults) {
+    Config& config = Config::getInstance();
+
+    EXPECT_EQ(config.getSqliteJournalMode(), "WAL");
+    EXPECT_EQ(config.getSqliteSynchronous(), "NORMAL");
+    EXPECT_EQ(config.getSqliteCacheSize(), -65536);
+    EXPECT_EQ(config.getSqliteMmapSize(), 268435456LL);
+    EXPECT_EQ(config.getSqliteTempStore(), "MEMORY");
+    EXPECT_EQ(config.getSqlitePageSize(), 4096);
+    EXPECT_EQ(config.getSqliteReadPoolSize(), 8);
+    EXPECT_EQ(config.getSqliteWalAutocheckpoint(), 1000);
+    EXPECT_EQ(config.getSqliteBusyTimeoutMs(), 5000);
+}
+
+TEST_F(ConfigTest, TestSqliteProfileOverrides) {
+    setenv("ATV_SQLITE_JOURNAL_MODE", "delete", 1);  // case-insensitive
+    setenv("ATV_SQLITE_SYNCHRONOUS", "FULL", 1);
+    setenv("ATV_SQLITE_CACHE_SIZE", "-2000", 1);
+    setenv("ATV_SQLITE_MMAP_SIZE", "0", 1);
+    setenv("ATV_SQLITE_TEMP_STORE", "FILE", 1);
+    setenv("ATV_SQLITE_PAGE_SIZE", "8192", 1);
+    setenv("ATV_SQLITE_READ_POOL_SIZE", "0", 1);  // disables the read pool
+    setenv("ATV_SQLITE_WAL_AUTOCHECKPOINT", "0", 1);  // disables automatic checkpoints
+    setenv("ATV_SQLITE_BUSY_TIMEOUT_MS", "250", 1);
+
+    Config& config = Config::getInstance();
+
+    EXPECT_EQ(config.getSqliteJournalMode(), "DELETE");
+    EXPECT_EQ(config.getSqliteSynchronous(), "FULL");
+    EXPECT_EQ(config.getSqliteCacheSize(), -2000);
+    EXPECT_EQ(config.getSqliteMmapSize(), 0LL);
+    EXPECT_EQ(config.getSqliteTempStore(), "FILE");
+    EXPECT_EQ(config.getSqlitePageSize(), 8192);
+    EXPECT_EQ(config.getSqliteReadPoolSize(), 0);
+    EXPECT_EQ(config.getSqliteWalAutocheckpoint(), 0);
+    EXPECT_EQ(config.getSqliteBusyTimeoutMs(), 250);
+}
+
+TEST_F(ConfigTest, TestSqliteProfileInvalidValues) {
+    setenv("ATV_SQLITE_JOURNAL_MODE", "WAL; DROP TABLE Vector", 1);  // pragma values are never passed through
+    setenv("ATV_SQLITE_SYNCHRONOUS", "sometimes", 1);
+    setenv("ATV_SQLITE_CACHE_SIZE", "invalid_value", 1);
+    setenv("ATV_SQLITE_MMAP_SIZE", "-1", 1);
+    setenv("ATV_SQLITE_TEMP_STORE", "disk", 1);
+    setenv("ATV_SQLITE_PAGE_SIZE", "5000", 1);  // not a power of two
+    setenv("ATV_SQLITE_READ_POOL_SIZE", "-1", 1);
+    setenv("ATV_SQLITE_WAL_AUTOCHECKPOINT", "-5", 1);
+    setenv("ATV_SQLITE_BUSY_TIMEOUT_MS", "soon", 1);
+
+    Config& config = Config::getInstance();
+
+    EXPECT_EQ(config.getSqliteJournalMode(), "WAL");
+    EXPECT_EQ(config.getSqliteSynchronous(), "NORMAL");
+    EXPECT_EQ(config.getSqliteCacheSize(), -65536);
+    EXPECT_EQ(config.getSqliteMmapSize(), 268435456LL);
+    EXPECT_EQ(config.getSqliteTempStore(), "MEMORY");
+    EXPECT_EQ(config.getSqlitePageSize(), 4096);
+    EXPECT_EQ(config.getSqliteReadPoolSize(), 8);
+    EXPECT_EQ(config.getSqliteWalAutocheckpoint(), 1000);
+    EXPECT_EQ(config.getSqliteBusyTimeoutMs(), 5000);
+}
@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
 #include "DatabaseManager.hpp"
 #include "Config.hpp"
+#include "Space.hpp"
+#include "utils/Utils.hpp"
+#include <atomic>
+#include <cstdlib>
 #include <filesystem>
+#include <future>
+#include <mutex>
+#include <thread>
 
 using namespace atinyvectors;
 
@@ -35,3 +42,218 @@ TEST_F(DatabaseManagerTest, TestMigration) {
     SQLite::Statement checkBillionVectorsTable(db, "SELECT name FROM sqlite_master WHERE type='table' AND name='billionvectors';");
     ASSERT_TRUE(checkBillionVectorsTable.executeStep());
 }
+
+TEST_F(DatabaseManagerTest, TestPragmasApplied) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance(":memory:", migrationPath);
+    auto& db = dbManager.getDatabase();
+
+    // NORMAL = 1, MEMORY = 2
+    ASSERT_EQ(db.execAndGet("PRAGMA synchronous;").getInt(), 1);
+    ASSERT_EQ(db.execAndGet("PRAGMA temp_store;").getInt(), 2);
+    ASSERT_EQ(db.execAndGet("PRAGMA cache_size;").getInt(), Config::getInstance().getSqliteCacheSize());
+
+    // In-memory databases cannot use WAL, so checkpoint is a no-op there
+    ASSERT_EQ(dbManager.getJournalMode(), "memory");
+    ASSERT_NO_THROW(dbManager.checkpoint(true));
+}
+
+TEST_F(DatabaseManagerTest, TestReadDatabaseFallsBackToWriterForMemoryDb) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance(":memory:", migrationPath);
+
+    // A second connection to ":memory:" would be a different, empty database
+    ASSERT_FALSE(dbManager.isReadPoolEnabled());
+    ASSERT_EQ(&dbManager.getReadDatabase(), &dbManager.getDatabase());
+    ASSERT_EQ(dbManager.getReadConnectionCount(), 0u);
+}
+
+TEST_F(DatabaseManagerTest, FailingPreCommitHookRollsBack) {
+    // Hooks stay registered for the process, so this one is switched by a flag
+    static std::atomic<bool> failCommits{false};
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        DatabaseManager::addPreCommitHook([]() { return !failCommits.load(); });
+    });
+
+    auto& db = DatabaseManager::getInstance(":memory:", migrationPath).getDatabase();
+    db.exec("CREATE TABLE PreCommitRow (id INTEGER PRIMARY KEY)");
+
+    failCommits = true;
+    EXPECT_THROW(db.exec("INSERT INTO PreCommitRow (id) VALUES (1)"), SQLite::Exception);
+    {
+        SQLite::Transaction transaction(db);
+        db.exec("INSERT INTO PreCommitRow (id) VALUES (2)");
+        EXPECT_THROW(transaction.commit(), SQLite::Exception);
+    }
+    failCommits = false;
+
+    EXPECT_EQ(db.execAndGet("SELECT COUNT(*) FROM PreCommitRow").getInt(), 0);
+    db.exec("INSERT INTO PreCommitRow (id) VALUES (3)");
+    EXPECT_EQ(db.execAndGet("SELECT COUNT(*) FROM PreCommitRow").getInt(), 1);
+}
+
+// Read pool over a WAL file database. The pool only exists for file databases, so
+// the shared in-memory instance is closed for these tests and reopened afterwards.
+class DatabaseReadPoolTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        setenv("ATV_SQLITE_READ_POOL_SIZE", "2", 1);
+        Config::reset();
+        DatabaseManager::closeInstance();
+
+        std::filesystem::create_directories(Config::getInstance().getDataPath());
+        dbPath = Config::getInstance().getDataPath() + "/" + dbFileName;
+        removeDatabaseFiles();
+
+        DatabaseManager& dbManager = DatabaseManager::getInstance(dbFileName, "db");
+        ASSERT_TRUE(dbManager.isReadPoolEnabled());
+        dbManager.getDatabase().exec("CREATE TABLE ReadPoolRow (id INTEGER PRIMARY KEY)");
+    }
+
+    void TearDown() override {
+        DatabaseManager::closeInstance();
+        removeDatabaseFiles();
+        unsetenv("ATV_SQLITE_READ_POOL_SIZE");
+        Config::reset();
+    }
+
+    void removeDatabaseFiles() {
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::filesystem::remove(dbPath + suffix);
+        }
+    }
+
+    void insertRow() {
+        DatabaseManager::getInstance().getDatabase().exec("INSERT INTO ReadPoolRow DEFAULT VALUES");
+    }
+
+    static int countRows(SQLite::Database& db) {
+        return db.execAndGet("SELECT COUNT(*) FROM ReadPoolRow").getInt();
+    }
+
+    const std::string dbFileName = "read_pool_test.db";
+    std::string dbPath;
+};
+
+TEST_F(DatabaseReadPoolTest, ReadsSeeCommittedWrites) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    SQLite::Database& readDb = dbManager.getReadDatabase();
+    ASSERT_NE(&readDb, &dbManager.getDatabase());
+    EXPECT_EQ(countRows(readDb), 0);
+
+    insertRow();
+    EXPECT_EQ(countRows(readDb), 1);
+    insertRow();
+    EXPECT_EQ(countRows(dbManager.getReadDatabase()), 2);
+    EXPECT_EQ(dbManager.getReadConnectionCount(), 1u);
+}
+
+TEST_F(DatabaseReadPoolTest, ThreadsGetTheirOwnConnections) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    insertRow();
+    SQLite::Database* mainDb = &dbManager.getReadDatabase();
+
+    SQLite::Database* threadDb = nullptr;
+    int threadCount = -1;
+    std::thread reader([&]() {
+        threadDb = &dbManager.getReadDatabase();
+        threadCount = countRows(*threadDb);
+    });
+    reader.join();
+
+    EXPECT_NE(threadDb, mainDb);
+    EXPECT_NE(threadDb, &dbManager.getDatabase());
+    EXPECT_EQ(threadCount, 1);
+}
+
+TEST_F(DatabaseReadPoolTest, ReadsInsideTransactionUseWriter) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    SQLite::Database& db = dbManager.getDatabase();
+    SQLite::Database& readDb = dbManager.getReadDatabase();
+
+    {
+        SQLite::Transaction transaction(db);
+        insertRow();
+        ASSERT_EQ(&dbManager.getReadDatabase(), &db);
+        EXPECT_EQ(countRows(dbManager.getReadDatabase()), 1);
+        EXPECT_EQ(countRows(readDb), 0);
+        transaction.commit();
+    }
+
+    EXPECT_EQ(&dbManager.getReadDatabase(), &readDb);
+    EXPECT_EQ(countRows(readDb), 1);
+}
+
+TEST_F(DatabaseReadPoolTest, OtherThreadsDoNotSeeOpenTransaction) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    SQLite::Database& db = dbManager.getDatabase();
+
+    SQLite::Transaction transaction(db);
+    insertRow();
+    ASSERT_TRUE(dbManager.readsUncommittedRows(dbManager.getReadDatabase()));
+
+    bool usedWriter = true;
+    int rows = -1;
+    std::thread reader([&]() {
+        SQLite::Database& readDb = dbManager.getReadDatabase();
+        usedWriter = &readDb == &db;
+        rows = countRows(readDb);
+    });
+    reader.join();
+
+    EXPECT_FALSE(usedWriter);
+    EXPECT_EQ(rows, 0);
+}
+
+TEST_F(DatabaseReadPoolTest, FullPoolFallsBackToWriter) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    ASSERT_NE(&dbManager.getReadDatabase(), &dbManager.getDatabase());
+
+    // Keep a second thread, and its connection, alive while a third one reads
+    std::promise<void> opened;
+    std::promise<void> done;
+    std::thread holder([&]() {
+        dbManager.getReadDatabase();
+        opened.set_value();
+        done.get_future().wait();
+    });
+    opened.get_future().wait();
+    EXPECT_EQ(dbManager.getReadConnectionCount(), 2u);
+
+    SQLite::Database* overflowDb = nullptr;
+    std::thread overflow([&]() {
+        overflowDb = &dbManager.getReadDatabase();
+    });
+    overflow.join();
+    EXPECT_EQ(overflowDb, &dbManager.getDatabase());
+
+    done.set_value();
+    holder.join();
+}
+
+TEST_F(DatabaseReadPoolTest, ConnectionIsReleasedAtThreadExit) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+
+    size_t openInThread = 0;
+    std::thread reader([&]() {
+        dbManager.getReadDatabase();
+        openInThread = dbManager.getReadConnectionCount();
+    });
+    reader.join();
+
+    EXPECT_EQ(openInThread, 1u);
+    EXPECT_EQ(dbManager.getReadConnectionCount(), 0u);
+}
+
+TEST_F(DatabaseReadPoolTest, ReadsSeeReset) {
+    DatabaseManager& dbManager = DatabaseManager::getInstance();
+    Space space(0, "ReadPoolSpace", "", utils::getCurrentTimeUTC(), utils::getCurrentTimeUTC());
+    SpaceManager::getInstance().addSpace(space);
+
+    SQLite::Database& readDb = dbManager.getReadDatabase();
+    EXPECT_EQ(readDb.execAndGet("SELECT COUNT(*) FROM Space").getInt(), 1);
+
+    uint64_t generation = dbManager.getResetGeneration();
+    dbManager.reset();
+    EXPECT_GT(dbManager.getResetGeneration(), generation);
+    EXPECT_EQ(dbManager.getReadDatabase().execAndGet("SELECT COUNT(*) FROM Space").getInt(), 0);
+}
@@ -105,3 +105,34 @@ TEST_F(IdCacheTest, TestNonExistentEntry) {
     // Test accessing a non-existent entry
     EXPECT_THROW(cache.getVersionId("nonExistentSpace", 999), std::runtime_error);
 }
+
+TEST_F(IdCacheTest, TestVectorUniqueIdSequence) {
+    IdCache& cache = IdCache::getInstance();
+    auto& db = DatabaseManager::getInstance().getDatabase();
+
+    // Seeded past existing rows
+    db.exec("INSERT INTO Vector (versionId, unique_id, type, deleted) VALUES (" + std::to_string(versionId) + ", 41, 0, 0)");
+
+    ASSERT_EQ(cache.allocateVectorUniqueIds(versionId), 42);
+    ASSERT_EQ(cache.allocateVectorUniqueIds(versionId, 10), 43);
+    ASSERT_EQ(cache.allocateVectorUniqueIds(versionId), 53);
+
+    // Explicit ids move the sequence forward
+    cache.observeVectorUniqueId(versionId, 100);
+    ASSERT_EQ(cache.allocateVectorUniqueIds(versionId), 101);
+
+    // The reserved bound is persisted, so a reseed never hands out used ids
+    SQLite::Statement query(db, "SELECT nextUniqueId FROM VectorSequence WHERE versionId = ?");
+    query.bind(1, versionId);
+    ASSERT_TRUE(query.executeStep());
+    int persistedNext = query.getColumn(0).getInt();
+    ASSERT_GT(persistedNext, 101);
+
+    cache.resetVectorUniqueIdSequences();
+    ASSERT_EQ(cache.allocateVectorUniqueIds(versionId), persistedNext);
+
+    // A database reset invalidates the in-memory sequences
+    DatabaseManager::getInstance().reset();
+    createDummyData();
+    ASSERT_EQ(cache.allocateVectorUniqueIds(versionId), 1);
+}
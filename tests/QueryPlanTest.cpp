@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "DatabaseManager.hpp"
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace atinyvectors;
+
+namespace {
+
+const std::string VECTOR_WITH_VALUES_COLUMNS =
+    "V.id, V.versionId, V.unique_id, V.type, V.deleted, VV.id, VV.vectorId, VV.vectorIndexId, VV.type, VV.data";
+
+// Statements issued per vector, per page or per search. Keep in sync with the managers.
+const std::vector<std::string> HOT_STATEMENTS = {
+    // VectorManager
+    "SELECT id FROM Vector WHERE versionId = ? AND unique_id = ?",
+    "SELECT IFNULL(MAX(unique_id), 0) + 1 FROM Vector WHERE versionId = ?",
+    "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM Vector V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id WHERE V.id = ? ORDER BY VV.id",
+    "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM Vector V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id WHERE V.versionId = ? AND V.unique_id = ? ORDER BY V.id, VV.id",
+    "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM "
+        "(SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE versionId = ? ORDER BY unique_id LIMIT ? OFFSET ?) V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id ORDER BY V.unique_id, V.id, VV.id",
+    "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM "
+        "(SELECT id, versionId, unique_id, type, deleted FROM Vector WHERE versionId = ? AND unique_id > ? ORDER BY unique_id LIMIT ?) V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id ORDER BY V.unique_id, V.id, VV.id",
+    "SELECT " + VECTOR_WITH_VALUES_COLUMNS + " FROM Vector V "
+        "LEFT JOIN VectorValue VV ON VV.vectorId = V.id WHERE V.id IN (?, ?) ORDER BY V.id, VV.id",
+    "DELETE FROM VectorValue WHERE vectorId = ?",
+    "SELECT liveCount FROM VectorCount WHERE versionId = ?",
+
+    // FaissIndexManager::restoreVectorsToIndex
+    "SELECT V.unique_id, VV.type, VV.data, V.id FROM VectorValue VV "
+        "JOIN Vector V ON VV.vectorId = V.id WHERE VV.vectorIndexId = ? AND V.deleted = 0",
+    "SELECT V.unique_id, E.recordIndex FROM VectorSegmentEntry E "
+        "JOIN Vector V ON E.vectorId = V.id WHERE E.vectorIndexId = ? AND V.deleted = 0",
+
+    // VectorSegmentStoreManager
+    "SELECT IFNULL(MAX(recordIndex), -1) + 1 FROM VectorSegmentEntry WHERE vectorIndexId = ?",
+
+    // BM25Manager
+    "SELECT doc FROM BM25 WHERE vectorId = ?",
+    "SELECT vectorId, doc FROM BM25 WHERE vectorId IN (?, ?) ORDER BY vectorId, id",
+    "SELECT vectorId, tokens, docLength FROM BM25 WHERE vectorId IN (?, ?)",
+
+    // VectorMetadataManager
+    "SELECT id, vectorId, key, value, versionId FROM VectorMetadata WHERE vectorId = ?",
+    "SELECT id, vectorId, key, value, versionId FROM VectorMetadata WHERE vectorId IN (?, ?) ORDER BY vectorId, id",
+    "DELETE FROM VectorMetadata WHERE vectorId = ?",
+
+    // IdCache
+    "SELECT V.id FROM Version V JOIN Space S ON V.spaceId = S.id WHERE S.name = ? AND V.unique_id = ?",
+    "SELECT id FROM Space WHERE name = ? LIMIT 1",
+    "SELECT nextUniqueId FROM VectorSequence WHERE versionId = ?",
+
+    // BM25ServiceManager
+    "SELECT id FROM Vector WHERE unique_id = ? AND versionId = ? AND deleted = 0",
+};
+
+// Returns the plan lines that read a whole table or index. Scans of co-routines
+// (the paging subqueries) only walk rows that were already found by a search.
+std::vector<std::string> findFullScans(SQLite::Database& db, const std::string& sql) {
+    SQLite::Statement plan(db, "EXPLAIN QUERY PLAN " + sql);
+    for (int i = 1; i <= plan.getBindParameterCount(); ++i) {
+        plan.bind(i, 0);
+    }
+
+    std::set<std::string> coroutines;
+    std::vector<std::string> scans;
+    while (plan.executeStep()) {
+        std::string detail = plan.getColumn(3).getString();
+        for (const std::string prefix : {"CO-ROUTINE ", "MATERIALIZE "}) {
+            if (detail.rfind(prefix, 0) == 0) {
+                coroutines.insert(detail.substr(prefix.size()));
+            }
+        }
+
+        if (detail.rfind("SCAN ", 0) == 0) {
+            std::string name = detail.substr(5, detail.find(' ', 5) - 5);
+            if (coroutines.count(name) == 0) {
+                scans.push_back(detail);
+            }
+        }
+    }
+    return scans;
+}
+
+}
+
+class QueryPlanTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        DatabaseManager::getInstance().reset();
+    }
+};
+
+TEST_F(QueryPlanTest, HotStatementsUseIndexes) {
+    auto& db = DatabaseManager::getInstance().getDatabase();
+
+    for (const auto& sql : HOT_STATEMENTS) {
+        auto scans = findFullScans(db, sql);
+        EXPECT_TRUE(scans.empty()) << sql << "\n  full scan: " << (scans.empty() ? "" : scans.front());
+    }
+}
+
+TEST_F(QueryPlanTest, DetectsFullScan) {
+    auto& db = DatabaseManager::getInstance().getDatabase();
+
+    // Sanity check for the detector itself: `type` is not indexed
+    ASSERT_FALSE(findFullScans(db, "SELECT id FROM Vector WHERE type = ?").empty());
+}
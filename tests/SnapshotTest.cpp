@@ -192,4 +192,29 @@ TEST_F(SnapshotManagerTest, CreateAndRestoreSnapshot) {
     std::getline(restoredTestFile, restoredContent);
     EXPECT_EQ(restoredContent, "This is a test file for the snapshot.");
     restoredTestFile.close();
-}
\ No newline at end of file
+}
+
+TEST_F(SnapshotManagerTest, RestoreDropsCachedMetadataIndexes) {
+    SnapshotManager& snapshotManager = SnapshotManager::getInstance();
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+    VectorManager& vectorManager = VectorManager::getInstance();
+
+    Vector vector(0, versionId, 1, VectorValueType::Dense, {}, false);
+    vectorManager.addVector(vector);
+    VectorMetadata row(0, versionId, vector.id, "attrs", R"({"brand":"acme"})", MetadataValueType::Object);
+    metadataManager.addVectorMetadata(row);
+
+    std::vector<std::pair<std::string, int>> versionInfoList = {{"CreateAndRestoreSnapshot", versionUniqueId}};
+    int snapshotId = snapshotManager.createSnapshot(versionInfoList, "RestoreDropsCachedMetadataIndexes.zip", metaDirectory);
+    Snapshot snapshot = snapshotManager.getSnapshotById(snapshotId);
+
+    // Index the path after the snapshot and let a query cache it for the version
+    const std::string filter = "attrs[\"brand\"] == 'acme'";
+    metadataManager.setIndexedPaths(spaceId, {"attrs['brand']"});
+    EXPECT_EQ(metadataManager.queryVectorIdsAfter(versionId, filter, -1, 10), std::vector<int>{vector.id});
+
+    // The restored space indexes no paths, so the filter must read VectorMetadata again
+    snapshotManager.restoreSnapshot(snapshot.fileName, metaDirectory);
+    EXPECT_TRUE(metadataManager.getIndexedPaths(spaceId).empty());
+    EXPECT_EQ(metadataManager.queryVectorIdsAfter(versionId, filter, -1, 10), std::vector<int>{vector.id});
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "StatementCache.hpp"
+#include "DatabaseManager.hpp"
+
+using namespace atinyvectors;
+
+class StatementCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        db = std::make_unique<SQLite::Database>(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+        db->exec("CREATE TABLE item (id INTEGER PRIMARY KEY, name TEXT)");
+        db->exec("INSERT INTO item (name) VALUES ('a'), ('b'), ('c')");
+        cache = std::make_unique<StatementCache>(*db, 2);
+    }
+
+    void TearDown() override {
+        cache.reset();
+        db.reset();
+    }
+
+    std::unique_ptr<SQLite::Database> db;
+    std::unique_ptr<StatementCache> cache;
+};
+
+TEST_F(StatementCacheTest, ReusesPreparedStatement) {
+    const std::string sql = "SELECT name FROM item WHERE id = ?";
+    {
+        auto query = cache->acquire(sql);
+        query->bind(1, 1);
+        ASSERT_TRUE(query->executeStep());
+        EXPECT_EQ(query->getColumn(0).getString(), "a");
+    }
+    EXPECT_EQ(cache->size(), 1u);
+
+    {
+        // Returned statement is reset and its bindings cleared, so id = NULL matches nothing
+        auto query = cache->acquire(sql);
+        EXPECT_FALSE(query->executeStep());
+    }
+    {
+        auto query = cache->acquire(sql);
+        query->bind(1, 2);
+        ASSERT_TRUE(query->executeStep());
+        EXPECT_EQ(query->getColumn(0).getString(), "b");
+    }
+
+    EXPECT_EQ(cache->getMisses(), 1u);
+    EXPECT_EQ(cache->getHits(), 2u);
+}
+
+TEST_F(StatementCacheTest, NestedUseOfSameSqlGetsSeparateStatements) {
+    const std::string sql = "SELECT id FROM item ORDER BY id";
+
+    auto outer = cache->acquire(sql);
+    ASSERT_TRUE(outer->executeStep());
+    EXPECT_EQ(outer->getColumn(0).getInt(), 1);
+
+    {
+        auto inner = cache->acquire(sql);
+        ASSERT_TRUE(inner->executeStep());
+        EXPECT_EQ(inner->getColumn(0).getInt(), 1);
+    }
+
+    // The outer cursor is untouched by the nested statement
+    ASSERT_TRUE(outer->executeStep());
+    EXPECT_EQ(outer->getColumn(0).getInt(), 2);
+}
+
+TEST_F(StatementCacheTest, EvictsLeastRecentlyUsed) {
+    { auto q = cache->acquire("SELECT 1"); }
+    { auto q = cache->acquire("SELECT 2"); }
+    { auto q = cache->acquire("SELECT 1"); }
+    { auto q = cache->acquire("SELECT 3"); }  // capacity is 2, "SELECT 2" goes
+
+    EXPECT_EQ(cache->size(), 2u);
+
+    size_t missesBefore = cache->getMisses();
+    { auto q = cache->acquire("SELECT 1"); }
+    EXPECT_EQ(cache->getMisses(), missesBefore);
+    { auto q = cache->acquire("SELECT 2"); }
+    EXPECT_EQ(cache->getMisses(), missesBefore + 1);
+}
+
+TEST_F(StatementCacheTest, ClearDropsIdleStatements) {
+    { auto q = cache->acquire("SELECT 1"); }
+    ASSERT_EQ(cache->size(), 1u);
+
+    cache->clear();
+    EXPECT_EQ(cache->size(), 0u);
+
+    // Writes are not blocked by statements left in the cache
+    { auto q = cache->acquire("SELECT name FROM item"); ASSERT_TRUE(q->executeStep()); }
+    EXPECT_NO_THROW(db->exec("DROP TABLE item"));
+}
+
+TEST_F(StatementCacheTest, DatabaseManagerPrepareUsesWriterCache) {
+    auto& dbManager = DatabaseManager::getInstance();
+    dbManager.reset();
+
+    auto& writerCache = dbManager.getStatementCache();
+    size_t hitsBefore = writerCache.getHits();
+    for (int i = 0; i < 3; ++i) {
+        auto query = dbManager.prepare(dbManager.getDatabase(), "SELECT COUNT(*) FROM Space");
+        ASSERT_TRUE(query->executeStep());
+    }
+    EXPECT_GE(writerCache.getHits(), hitsBefore + 2);
+}
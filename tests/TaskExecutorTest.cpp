@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "TaskExecutor.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+using namespace atinyvectors;
+
+TEST(TaskExecutorTest, RunsSubmittedTasks) {
+    TaskExecutor executor(4, 64);
+    EXPECT_EQ(executor.getThreadCount(), 4u);
+
+    std::atomic<int> sum{0};
+    for (int i = 1; i <= 50; ++i) {
+        ASSERT_TRUE(executor.trySubmit([&sum, i]() { sum += i; }));
+    }
+    executor.waitIdle();
+
+    EXPECT_EQ(sum.load(), 1275);
+    EXPECT_EQ(executor.pending(), 0u);
+}
+
+TEST(TaskExecutorTest, RejectsWhenQueueIsFull) {
+    TaskExecutor executor(1, 2);
+
+    // Park the only worker so submissions pile up in the queue
+    std::mutex gateMutex;
+    std::condition_variable gate;
+    bool started = false;
+    bool released = false;
+    ASSERT_TRUE(executor.trySubmit([&]() {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        started = true;
+        gate.notify_all();
+        gate.wait(lock, [&]() { return released; });
+    }));
+    {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        gate.wait(lock, [&]() { return started; });
+    }
+
+    std::atomic<int> ran{0};
+    EXPECT_TRUE(executor.trySubmit([&]() { ++ran; }));
+    EXPECT_TRUE(executor.trySubmit([&]() { ++ran; }));
+    EXPECT_FALSE(executor.trySubmit([&]() { ++ran; }));
+    EXPECT_EQ(executor.pending(), 2u);
+
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        released = true;
+    }
+    gate.notify_all();
+    executor.waitIdle();
+
+    EXPECT_EQ(ran.load(), 2);
+    EXPECT_TRUE(executor.trySubmit([&]() { ++ran; }));
+    executor.waitIdle();
+    EXPECT_EQ(ran.load(), 3);
+}
+
+TEST(TaskExecutorTest, FailingTaskDoesNotStopWorker) {
+    TaskExecutor executor(1, 8);
+
+    std::atomic<bool> ran{false};
+    ASSERT_TRUE(executor.trySubmit([]() { throw std::runtime_error("task failure"); }));
+    ASSERT_TRUE(executor.trySubmit([&]() { ran = true; }));
+    executor.waitIdle();
+
+    EXPECT_TRUE(ran.load());
+}
+
+TEST(TaskExecutorTest, ShutdownDrainsQueue) {
+    std::atomic<int> ran{0};
+    std::atomic<int> cancelled{0};
+    TaskExecutor executor(2, 16);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(executor.trySubmit([&]() { ++ran; }, [&]() { ++cancelled; }));
+    }
+    executor.shutdown();
+
+    EXPECT_EQ(ran.load(), 10);
+    EXPECT_EQ(cancelled.load(), 0);
+    EXPECT_FALSE(executor.trySubmit([&]() { ++ran; }));
+}
+
+TEST(TaskExecutorTest, DestructorCancelsQueuedTasks) {
+    std::mutex gateMutex;
+    std::condition_variable gate;
+    bool started = false;
+    bool released = false;
+    std::atomic<int> ran{0};
+    std::atomic<int> cancelled{0};
+    {
+        TaskExecutor executor(1, 8);
+
+        // The running task finishes; the queued ones are cancelled, and the first
+        // cancellation lets the running task go so the destructor can join it
+        ASSERT_TRUE(executor.trySubmit([&]() {
+            std::unique_lock<std::mutex> lock(gateMutex);
+            started = true;
+            gate.notify_all();
+            gate.wait(lock, [&]() { return released; });
+            ++ran;
+        }));
+        {
+            std::unique_lock<std::mutex> lock(gateMutex);
+            gate.wait(lock, [&]() { return started; });
+        }
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(executor.trySubmit([&]() { ++ran; }, [&]() {
+                ++cancelled;
+                std::lock_guard<std::mutex> lock(gateMutex);
+                released = true;
+                gate.notify_all();
+            }));
+        }
+    }
+
+    EXPECT_EQ(ran.load(), 1);
+    EXPECT_EQ(cancelled.load(), 3);
+}
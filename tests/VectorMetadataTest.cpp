@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <map>
 #include "algo/FaissIndexLRUCache.hpp"
 #include "Vector.hpp"
 #include "VectorIndex.hpp"
@@ -152,6 +153,43 @@ TEST_F(VectorMetadataManagerTest, DeleteVectorMetadata) {
 }
 
 // Test for handling a non-existent VectorMetadata
+TEST_F(VectorMetadataManagerTest, StoresValueTypes) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+
+    VectorMetadata price(0, versionId, 1001, "price", "1250.5", MetadataValueType::Float);
+    VectorMetadata active(0, versionId, 1001, "active", "true", MetadataValueType::Boolean);
+    VectorMetadata missing(0, versionId, 1001, "missing", "", MetadataValueType::Null);
+    metadataManager.addVectorMetadata(price);
+    metadataManager.addVectorMetadata(active);
+    metadataManager.addVectorMetadata(missing);
+
+    std::map<std::string, VectorMetadata> metadataByKey;
+    for (const auto& metadata : metadataManager.getVectorMetadataByVectorId(1001)) {
+        metadataByKey[metadata.key] = metadata;
+    }
+    ASSERT_EQ(metadataByKey.size(), 3);
+    EXPECT_EQ(metadataByKey["price"].valueType, MetadataValueType::Float);
+    EXPECT_EQ(metadataByKey["price"].numericValue(), 1250.5);
+    EXPECT_EQ(metadataByKey["active"].valueType, MetadataValueType::Boolean);
+    EXPECT_EQ(metadataByKey["active"].numericValue(), 1.0);
+    EXPECT_EQ(metadataByKey["missing"].valueType, MetadataValueType::Null);
+    EXPECT_FALSE(metadataByKey["missing"].numericValue().has_value());
+
+    // Strings keep their type; only those that read as a number get a numeric value
+    EXPECT_EQ(VectorMetadata(0, versionId, 1001, "k", "-1.5e2").numericValue(), -150.0);
+    EXPECT_FALSE(VectorMetadata(0, versionId, 1001, "k", "007").numericValue().has_value());
+    EXPECT_FALSE(VectorMetadata(0, versionId, 1001, "k", " 1").numericValue().has_value());
+    EXPECT_FALSE(VectorMetadata(0, versionId, 1001, "k", "1e").numericValue().has_value());
+    EXPECT_FALSE(VectorMetadata(0, versionId, 1001, "k", "seoul").numericValue().has_value());
+
+    // The numeric column is what range conditions read
+    auto& db = DatabaseManager::getInstance().getReadDatabase();
+    SQLite::Statement query(db, "SELECT key FROM VectorMetadata WHERE vectorId = 1001 AND numericValue > 100");
+    ASSERT_TRUE(query.executeStep());
+    EXPECT_EQ(query.getColumn(0).getString(), "price");
+    EXPECT_FALSE(query.executeStep());
+}
+
 TEST_F(VectorMetadataManagerTest, HandleNonExistentVectorMetadata) {
     VectorMetadataManager& manager = VectorMetadataManager::getInstance();
 
@@ -246,3 +284,231 @@ TEST_F(VectorMetadataManagerTest, QueryVectors) {
     EXPECT_EQ(result.vectorUniqueIds[0], 1);
     EXPECT_EQ(result.vectorUniqueIds[1], 3);
 }
+
+// Test for loading metadata of several vectors at once
+TEST_F(VectorMetadataManagerTest, GetVectorMetadataByVectorIds) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+
+    VectorMetadata metadata1(0, versionId, 1001, "Key1", "Value1");
+    VectorMetadata metadata2(0, versionId, 1001, "Key2", "Value2");
+    VectorMetadata metadata3(0, versionId, 1002, "Key1", "Value3");
+    VectorMetadata metadata4(0, versionId, 1003, "Key1", "Value4");
+    metadataManager.addVectorMetadata(metadata1);
+    metadataManager.addVectorMetadata(metadata2);
+    metadataManager.addVectorMetadata(metadata3);
+    metadataManager.addVectorMetadata(metadata4);
+
+    auto metadataByVectorId = metadataManager.getVectorMetadataByVectorIds({1001, 1002, 9999});
+    ASSERT_EQ(metadataByVectorId.size(), 2);
+    ASSERT_EQ(metadataByVectorId[1001].size(), 2);
+    EXPECT_EQ(metadataByVectorId[1001][0].key, "Key1");
+    EXPECT_EQ(metadataByVectorId[1001][1].key, "Key2");
+    ASSERT_EQ(metadataByVectorId[1002].size(), 1);
+    EXPECT_EQ(metadataByVectorId[1002][0].value, "Value3");
+    EXPECT_EQ(metadataByVectorId.count(1003), 0);
+
+    EXPECT_TRUE(metadataManager.getVectorMetadataByVectorIds({}).empty());
+}
+
+// Filters on JSON paths select the same vectors whether the path is indexed or read from the JSON
+TEST_F(VectorMetadataManagerTest, FiltersJsonPaths) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+    VectorManager& vectorManager = VectorManager::getInstance();
+
+    auto addVector = [&](int uniqueId, const std::string& attrs, const std::string& tags) {
+        Vector vector(0, versionId, uniqueId, VectorValueType::Dense, {}, false);
+        vectorManager.addVector(vector);
+        VectorMetadata attrsRow(0, versionId, vector.id, "attrs", attrs, MetadataValueType::Object);
+        VectorMetadata tagsRow(0, versionId, vector.id, "tags", tags, MetadataValueType::Array);
+        metadataManager.addVectorMetadata(attrsRow);
+        metadataManager.addVectorMetadata(tagsRow);
+        return tagsRow;
+    };
+    VectorMetadata firstTags = addVector(1, R"({"brand":"acme","size":{"width":30}})", R"(["red","blue"])");
+    addVector(2, R"({"brand":"zen","size":{"width":45.5}})", R"(["green",7,true])");
+    addVector(3, R"({"size":null})", R"([])");
+
+    const std::vector<std::pair<std::string, std::vector<int>>> cases = {
+        {"attrs[\"brand\"] == 'acme'", {1}},
+        {"attrs['size']['width'] > 40", {2}},
+        {"20 < attrs[\"size\"][\"width\"] < 40", {1}},
+        {"attrs[\"brand\"] IN ('zen', 'other')", {2}},
+        {"attrs[\"brand\"] != 'acme'", {2}},
+        {"array_contains(tags, 'red')", {1}},
+        {"json_contains(tags, 7)", {2}},
+        {"json_contains(tags, true)", {2}},
+        {"array_contains_any(tags, ['green', 'red'])", {1, 2}},
+        {"array_contains_all(tags, ['red', 'blue'])", {1}},
+        {"array_contains_all(tags, ['red', 'green'])", {}},
+        {"array_length(tags) == 0", {3}},
+    };
+    auto query = [&](const std::string& filter) {
+        std::vector<int> uniqueIds;
+        for (int id : metadataManager.queryVectorIdsAfter(versionId, filter, -1, 10)) {
+            uniqueIds.push_back(vectorManager.getVectorById(id).unique_id);
+        }
+        return uniqueIds;
+    };
+
+    for (const auto& [filter, expected] : cases) {
+        EXPECT_EQ(query(filter), expected) << filter;
+    }
+
+    metadataManager.setIndexedPaths(spaceId, {"attrs['brand']", "attrs[\"size\"][\"width\"]", "tags[]", "tags[]"});
+    EXPECT_EQ(metadataManager.getIndexedPaths(spaceId),
+              (std::vector<std::string>{"attrs[\"brand\"]", "attrs[\"size\"][\"width\"]", "tags[]"}));
+    for (const auto& [filter, expected] : cases) {
+        EXPECT_EQ(query(filter), expected) << filter;
+    }
+
+    // Path rows follow metadata changes
+    firstTags.value = R"(["green"])";
+    metadataManager.updateVectorMetadata(firstTags);
+    EXPECT_EQ(query("array_contains(tags, 'red')"), std::vector<int>{});
+    EXPECT_EQ(query("array_contains(tags, 'green')"), (std::vector<int>{1, 2}));
+    addVector(4, R"({"brand":"acme"})", R"(["red"])");
+    EXPECT_EQ(query("attrs[\"brand\"] == 'acme'"), (std::vector<int>{1, 4}));
+    metadataManager.deleteVectorMetadata(firstTags.id);
+    EXPECT_EQ(query("array_contains(tags, 'green')"), std::vector<int>{2});
+
+    EXPECT_THROW(metadataManager.setIndexedPaths(spaceId, {"attrs[brand]"}), std::invalid_argument);
+}
+
+TEST_F(VectorMetadataManagerTest, FilterVectorsStaysInVersion) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+    VectorManager& vectorManager = VectorManager::getInstance();
+
+    Version version2;
+    version2.spaceId = spaceId;
+    version2.name = "Version 2.0";
+    version2.is_default = false;
+    int versionId2 = VersionManager::getInstance().addVersion(version2);
+
+    // Both versions have a vector with unique_id 7
+    auto addVector = [&](int version, const std::string& attrs) {
+        Vector vector(0, version, 7, VectorValueType::Dense, {}, false);
+        vectorManager.addVector(vector);
+        VectorMetadata row(0, version, vector.id, "attrs", attrs, MetadataValueType::Object);
+        metadataManager.addVectorMetadata(row);
+    };
+    addVector(versionId, R"({"brand":"zen"})");
+    addVector(versionId2, R"({"brand":"acme"})");
+
+    // JSON paths are answered by SQL
+    std::vector<std::pair<float, int>> candidates = {{0.1f, 7}};
+    EXPECT_TRUE(metadataManager.filterVectors(versionId, candidates, "attrs[\"brand\"] == 'acme'").empty());
+    EXPECT_EQ(metadataManager.filterVectors(versionId, candidates, "attrs[\"brand\"] == 'zen'").size(), 1u);
+    EXPECT_EQ(metadataManager.filterVectors(versionId2, candidates, "attrs[\"brand\"] == 'acme'").size(), 1u);
+    EXPECT_TRUE(metadataManager.filterVectors(versionId2, candidates, "attrs[\"brand\"] == 'zen'").empty());
+}
+
+TEST_F(VectorMetadataManagerTest, FiltersTextIndexedKeys) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+    VectorManager& vectorManager = VectorManager::getInstance();
+
+    auto addVector = [&](int uniqueId, const std::string& title) {
+        Vector vector(0, versionId, uniqueId, VectorValueType::Dense, {}, false);
+        vectorManager.addVector(vector);
+        VectorMetadata titleRow(0, versionId, vector.id, "title", title);
+        metadataManager.addVectorMetadata(titleRow);
+        return titleRow;
+    };
+    VectorMetadata firstTitle = addVector(1, "Wireless Headphones");
+    addVector(2, "wired headphones");
+    addVector(3, "Caf\xc3\xa9 Cr\xc3\xa8me");
+
+    const std::vector<std::pair<std::string, std::vector<int>>> cases = {
+        {"title LIKE '%headphones%'", {1, 2}},
+        {"title LIKE '%WIRE%'", {1, 2}},
+        {"title LIKE 'wireless%'", {1}},
+        {"title LIKE '%less_head%'", {1}},
+        {"title LIKE '%caf\xc3\xa9%'", {3}},
+        {"title LIKE '%CAF\xc3\x89%'", {}},  // LIKE folds ASCII case only
+        {"title LIKE '%ph%'", {1, 2}},
+        {"title LIKE '%missing%'", {}},
+    };
+    auto query = [&](const std::string& filter) {
+        std::vector<int> uniqueIds;
+        for (int id : metadataManager.queryVectorIdsAfter(versionId, filter, -1, 10)) {
+            uniqueIds.push_back(vectorManager.getVectorById(id).unique_id);
+        }
+        return uniqueIds;
+    };
+
+    for (const auto& [filter, expected] : cases) {
+        EXPECT_EQ(query(filter), expected) << filter;
+    }
+
+    // The FTS5 table is only created once a space names text keys
+    auto& db = DatabaseManager::getInstance().getDatabase();
+    const char* textTableCount = "SELECT COUNT(*) FROM sqlite_master WHERE name = 'VectorMetadataText'";
+    metadataManager.setTextIndexedKeys(spaceId, {});
+    EXPECT_EQ(db.execAndGet(textTableCount).getInt(), 0);
+
+    metadataManager.setTextIndexedKeys(spaceId, {"title", "title"});
+    EXPECT_EQ(db.execAndGet(textTableCount).getInt(), 1);
+    EXPECT_EQ(metadataManager.getTextIndexedKeys(spaceId), std::vector<std::string>{"title"});
+    for (const auto& [filter, expected] : cases) {
+        EXPECT_EQ(query(filter), expected) << filter;
+    }
+
+    // The text index follows metadata changes
+    firstTitle.value = "Bluetooth Speaker";
+    metadataManager.updateVectorMetadata(firstTitle);
+    EXPECT_EQ(query("title LIKE '%headphones%'"), std::vector<int>{2});
+    EXPECT_EQ(query("title LIKE '%speaker%'"), std::vector<int>{1});
+    addVector(4, "Speaker Stand");
+    EXPECT_EQ(query("title LIKE '%speaker%'"), (std::vector<int>{1, 4}));
+    metadataManager.deleteVectorMetadata(firstTitle.id);
+    EXPECT_EQ(query("title LIKE '%speaker%'"), std::vector<int>{4});
+
+    EXPECT_THROW(metadataManager.setTextIndexedKeys(spaceId, {""}), std::invalid_argument);
+}
+
+TEST_F(VectorMetadataManagerTest, FacetCounts) {
+    VectorMetadataManager& metadataManager = VectorMetadataManager::getInstance();
+    VectorManager& vectorManager = VectorManager::getInstance();
+
+    auto addVector = [&](int uniqueId, const std::string& category, double price, const std::string& tags) {
+        Vector vector(0, versionId, uniqueId, VectorValueType::Dense, {}, false);
+        vectorManager.addVector(vector);
+        VectorMetadata categoryRow(0, versionId, vector.id, "category", category);
+        VectorMetadata priceRow(0, versionId, vector.id, "price", std::to_string(static_cast<int>(price)), MetadataValueType::Integer);
+        VectorMetadata tagsRow(0, versionId, vector.id, "tags", tags, MetadataValueType::Array);
+        metadataManager.addVectorMetadata(categoryRow);
+        metadataManager.addVectorMetadata(priceRow);
+        metadataManager.addVectorMetadata(tagsRow);
+    };
+    addVector(1, "book", 5, R"(["red"])");
+    addVector(2, "pen", 12, R"(["blue"])");
+    addVector(3, "book", 20, R"(["red","blue"])");
+    addVector(4, "lamp", 30, R"(["red"])");
+
+    auto counts = [](const std::vector<MetadataFacet>& facets) {
+        std::vector<std::pair<std::string, int>> result;
+        for (const auto& facet : facets) {
+            result.emplace_back(facet.value, facet.count);
+        }
+        return result;
+    };
+    using Counts = std::vector<std::pair<std::string, int>>;
+
+    MetadataFacets facets = metadataManager.facetCounts(versionId, "", {"category", "missing"}, -1);
+    ASSERT_EQ(facets.size(), 2u);
+    EXPECT_EQ(counts(facets["category"]), (Counts{{"book", 2}, {"lamp", 1}, {"pen", 1}}));
+    EXPECT_TRUE(facets["missing"].empty());
+
+    facets = metadataManager.facetCounts(versionId, "price > 10", {"category"}, -1);
+    EXPECT_EQ(counts(facets["category"]), (Counts{{"book", 1}, {"lamp", 1}, {"pen", 1}}));
+
+    facets = metadataManager.facetCounts(versionId, "", {"category"}, 1);
+    EXPECT_EQ(counts(facets["category"]), (Counts{{"book", 2}}));
+
+    // Filters the bitmap index can't answer are counted in SQL, with the same order
+    facets = metadataManager.facetCounts(versionId, "array_contains(tags, 'red')", {"category", "price"}, -1);
+    EXPECT_EQ(counts(facets["category"]), (Counts{{"book", 2}, {"lamp", 1}}));
+    EXPECT_EQ(counts(facets["price"]), (Counts{{"20", 1}, {"30", 1}, {"5", 1}}));
+
+    facets = metadataManager.facetCounts(versionId, std::vector<int>{2, 3, 99}, {"category"}, -1);
+    EXPECT_EQ(counts(facets["category"]), (Counts{{"book", 1}, {"pen", 1}}));
+}
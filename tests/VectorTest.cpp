@@ -276,3 +276,247 @@ TEST_F(VectorManagerTest, GetVectorsByVectorIds) {
         EXPECT_EQ(retrievedVectors[i].versionId, versionId);
     }
 }
+
+// Test that paged loads bring back every value of every vector in the page
+TEST_F(VectorManagerTest, GetVectorsByVersionIdLoadsValues) {
+    VectorManager& manager = VectorManager::getInstance();
+
+    for (int i = 0; i < 3; ++i) {
+        float base = static_cast<float>(i);
+        VectorValue value(0, 0, indexId, VectorValueType::Dense, std::vector<float>{base, base + 0.1f, base + 0.2f, base + 0.3f});
+        Vector vector(0, versionId, 0, VectorValueType::Dense, {value}, false);
+        manager.addVector(vector);
+    }
+
+    // A vector without values still comes back once
+    Vector emptyVector(0, versionId, 0, VectorValueType::Dense, {}, false);
+    manager.addVector(emptyVector);
+
+    auto vectors = manager.getVectorsByVersionId(versionId, 0, 10);
+    ASSERT_EQ(vectors.size(), 4);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(vectors[i].values.size(), 1);
+        ASSERT_EQ(vectors[i].values[0].denseData.size(), 4);
+        EXPECT_FLOAT_EQ(vectors[i].values[0].denseData[0], static_cast<float>(i));
+        EXPECT_EQ(vectors[i].values[0].vectorId, vectors[i].id);
+    }
+    EXPECT_TRUE(vectors[3].values.empty());
+
+    // Offsets count vectors, not value rows
+    auto secondPage = manager.getVectorsByVersionId(versionId, 2, 10);
+    ASSERT_EQ(secondPage.size(), 2);
+    EXPECT_EQ(secondPage[0].id, vectors[2].id);
+}
+
+// Test for keyset pagination by unique_id
+TEST_F(VectorManagerTest, GetVectorsByVersionIdAfterCursor) {
+    VectorManager& manager = VectorManager::getInstance();
+
+    for (int i = 0; i < 7; ++i) {
+        Vector vector(0, versionId, 0, VectorValueType::Dense, {}, false);
+        manager.addVector(vector);
+    }
+
+    std::vector<int> seenUniqueIds;
+    int cursor = 0;
+    while (true) {
+        auto page = manager.getVectorsByVersionIdAfter(versionId, cursor, 3);
+        for (const auto& vector : page) {
+            EXPECT_GT(vector.unique_id, cursor);
+            seenUniqueIds.push_back(vector.unique_id);
+        }
+        if (page.size() < 3) {
+            break;
+        }
+        cursor = page.back().unique_id;
+    }
+
+    ASSERT_EQ(seenUniqueIds.size(), 7);
+    for (int i = 0; i < 7; ++i) {
+        EXPECT_EQ(seenUniqueIds[i], i + 1);
+    }
+}
+
+// Test that the maintained live count follows inserts, soft deletes and deletes
+TEST_F(VectorManagerTest, CountByVersionIdTracksChanges) {
+    VectorManager& manager = VectorManager::getInstance();
+    EXPECT_EQ(manager.countByVersionId(versionId), 0);
+
+    std::vector<Vector> vectors;
+    for (int i = 0; i < 3; ++i) {
+        Vector vector(0, versionId, 0, VectorValueType::Dense, {}, false);
+        manager.addVector(vector);
+        vectors.push_back(vector);
+    }
+    EXPECT_EQ(manager.countByVersionId(versionId), 3);
+
+    manager.deleteVector(vectors[0].id);
+    EXPECT_EQ(manager.countByVersionId(versionId), 2);
+
+    vectors[1].deleted = true;
+    manager.updateVector(vectors[1]);
+    EXPECT_EQ(manager.countByVersionId(versionId), 1);
+
+    // Deleting an already soft-deleted vector does not count twice
+    manager.deleteVector(vectors[1].id);
+    EXPECT_EQ(manager.countByVersionId(versionId), 1);
+}
+
+TEST_F(VectorManagerTest, DeserializeFromRawBlob) {
+    VectorValue dense(0, 0, 1, VectorValueType::Dense, std::vector<float>{1.5f, -2.0f, 3.25f});
+    std::vector<uint8_t> denseBlob = dense.serialize();
+
+    VectorValue decoded;
+    decoded.type = VectorValueType::Dense;
+    decoded.deserialize(denseBlob.data(), denseBlob.size());
+    EXPECT_EQ(decoded.denseData, dense.denseData);
+
+    SparseData sparse = {{3, 0.5f}, {10, -1.0f}};
+    VectorValue sparseValue(0, 0, 1, VectorValueType::Sparse, &sparse);
+    std::vector<uint8_t> sparseBlob = sparseValue.serialize();
+
+    SparseData target;
+    VectorValue decodedSparse(0, 0, 1, VectorValueType::Sparse, &target);
+    decodedSparse.deserialize(sparseBlob.data(), sparseBlob.size());
+    EXPECT_EQ(target, sparse);
+
+    // A pair count larger than the blob is rejected instead of read past the end
+    std::vector<uint8_t> truncated(sparseBlob.begin(), sparseBlob.end() - 1);
+    EXPECT_THROW(decodedSparse.deserialize(truncated.data(), truncated.size()), std::runtime_error);
+}
+
+TEST_F(VectorManagerTest, VectorValueViewReadsBlobInPlace) {
+    VectorValue dense(0, 0, 1, VectorValueType::Dense, std::vector<float>{1.0f, 2.0f, 4.0f});
+    std::vector<uint8_t> denseBlob = dense.serialize();
+
+    VectorValueView denseView(VectorValueType::Dense, denseBlob.data(), denseBlob.size());
+    ASSERT_EQ(denseView.denseSize(), 3u);
+    ASSERT_EQ(static_cast<const void*>(denseView.denseData()), static_cast<const void*>(denseBlob.data()));
+    EXPECT_FLOAT_EQ(denseView.denseData()[2], 4.0f);
+
+    std::vector<float> copied(3);
+    denseView.copyDenseTo(copied.data());
+    EXPECT_EQ(copied, dense.denseData);
+
+    SparseData sparse = {{7, 0.25f}, {1, 2.0f}};
+    VectorValue sparseValue(0, 0, 1, VectorValueType::Sparse, &sparse);
+    std::vector<uint8_t> sparseBlob = sparseValue.serialize();
+
+    VectorValueView sparseView(VectorValueType::Sparse, sparseBlob.data(), sparseBlob.size());
+    ASSERT_EQ(sparseView.sparseSize(), 2);
+    std::vector<float> scattered(8, 0.0f);
+    sparseView.scatterSparseTo(scattered.data(), 8);
+    EXPECT_EQ(scattered, std::vector<float>({0.0f, 2.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.25f}));
+}
+
+TEST_F(VectorManagerTest, SerializeReducedPrecision) {
+    std::vector<float> data = {0.0f, 1.0f, -2.5f, 0.333333f, 65504.0f, 1e-6f, -0.0f, 3.14159f, 42.0f};
+    VectorValue dense(0, 0, 1, VectorValueType::Dense, data);
+
+    std::vector<uint8_t> fp32Blob = dense.serialize();
+    ASSERT_EQ(fp32Blob.size(), data.size() * sizeof(float));
+
+    for (auto precision : {StoragePrecision::Float16, StoragePrecision::BFloat16}) {
+        std::vector<uint8_t> blob = dense.serialize(precision);
+        EXPECT_EQ(blob.size(), sizeof(uint32_t) + data.size() * sizeof(uint16_t));
+
+        VectorValue decoded;
+        decoded.type = VectorValueType::Dense;
+        decoded.deserialize(blob);
+        ASSERT_EQ(decoded.denseData.size(), data.size());
+
+        // fp16 keeps 11 significant bits, bf16 keeps 8
+        float relativeError = precision == StoragePrecision::Float16 ? 1.0f / 1024 : 1.0f / 128;
+        for (size_t i = 0; i < data.size(); ++i) {
+            EXPECT_NEAR(decoded.denseData[i], data[i], std::abs(data[i]) * relativeError + 1e-7f) << i;
+        }
+
+        VectorValueView view(VectorValueType::Dense, blob.data(), blob.size());
+        EXPECT_EQ(view.getPrecision(), precision);
+        EXPECT_EQ(view.denseSize(), data.size());
+        EXPECT_EQ(view.denseData(), nullptr);
+
+        std::vector<float> widened(data.size());
+        view.copyDenseTo(widened.data());
+        EXPECT_EQ(widened, decoded.denseData);
+    }
+}
+
+TEST_F(VectorManagerTest, StoragePrecisionAppliesPerIndex) {
+    QuantizationConfig quantizationConfig;
+    quantizationConfig.Storage = StoragePrecision::Float16;
+    ASSERT_EQ(QuantizationConfig::fromJson(quantizationConfig.toJson()).Storage, StoragePrecision::Float16);
+
+    VectorIndex halfIndex(0, versionId, VectorValueType::Dense, "Half Index", MetricType::L2, 4,
+                          HnswConfig().toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, false);
+    int halfIndexId = VectorIndexManager::getInstance().addVectorIndex(halfIndex);
+
+    std::vector<float> data = {0.5f, -1.25f, 2.0f, 8.0f};
+    Vector vector(0, versionId, 0, VectorValueType::Dense,
+                  {VectorValue(0, 0, indexId, VectorValueType::Dense, data),
+                   VectorValue(0, 0, halfIndexId, VectorValueType::Dense, data)}, false);
+    int vectorId = VectorManager::getInstance().addVector(vector, false);
+
+    auto& db = DatabaseManager::getInstance().getDatabase();
+    SQLite::Statement sizes(db, "SELECT vectorIndexId, LENGTH(data) FROM VectorValue WHERE vectorId = ? ORDER BY vectorIndexId");
+    sizes.bind(1, vectorId);
+    ASSERT_TRUE(sizes.executeStep());
+    EXPECT_EQ(sizes.getColumn(1).getInt(), 16);
+    ASSERT_TRUE(sizes.executeStep());
+    EXPECT_EQ(sizes.getColumn(1).getInt(), 12);
+
+    // Values exactly representable in fp16 come back unchanged
+    auto stored = VectorManager::getInstance().getVectorById(vectorId);
+    ASSERT_EQ(stored.values.size(), 2);
+    EXPECT_EQ(stored.values[0].denseData, data);
+    EXPECT_EQ(stored.values[1].denseData, data);
+}
+
+TEST_F(VectorManagerTest, SparseDeltaVarintEncoding) {
+    // SPLADE-like: vocabulary-sized indexes, given out of order
+    SparseData sparse = {{30521, 0.75f}, {7, 1.5f}, {2048, 0.125f}, {8, -0.5f}};
+    VectorValue sparseValue(0, 0, 1, VectorValueType::Sparse, &sparse);
+
+    SparseData expected = {{7, 1.5f}, {8, -0.5f}, {2048, 0.125f}, {30521, 0.75f}};
+    size_t legacySize = sizeof(int) + sparse.size() * (sizeof(int) + sizeof(float));
+
+    for (auto precision : {StoragePrecision::Float32, StoragePrecision::Float16, StoragePrecision::BFloat16}) {
+        std::vector<uint8_t> blob = sparseValue.serialize(precision);
+        EXPECT_LT(blob.size(), legacySize);
+
+        SparseData decoded;
+        VectorValue decodedValue(0, 0, 1, VectorValueType::Sparse, &decoded);
+        decodedValue.deserialize(blob);
+
+        // Every value above is exactly representable in fp16 and bf16
+        EXPECT_EQ(decoded, expected);
+
+        VectorValueView view(VectorValueType::Sparse, blob.data(), blob.size());
+        SparseData copied;
+        view.copySparseTo(copied);
+        EXPECT_EQ(copied, expected);
+    }
+
+    // Blobs written before the tagged format still decode
+    std::vector<uint8_t> legacy;
+    auto append = [&legacy](const void* p, size_t n) {
+        legacy.insert(legacy.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+    };
+    int count = 2, firstIndex = 9, secondIndex = 4;
+    float firstValue = 0.5f, secondValue = 2.0f;
+    append(&count, sizeof(count));
+    append(&firstIndex, sizeof(firstIndex));
+    append(&firstValue, sizeof(firstValue));
+    append(&secondIndex, sizeof(secondIndex));
+    append(&secondValue, sizeof(secondValue));
+
+    SparseData decodedLegacy;
+    VectorValue legacyValue(0, 0, 1, VectorValueType::Sparse, &decodedLegacy);
+    legacyValue.deserialize(legacy);
+    EXPECT_EQ(decodedLegacy, SparseData({{9, 0.5f}, {4, 2.0f}}));
+
+    // A format version from the future is rejected
+    std::vector<uint8_t> future = sparseValue.serialize();
+    future[0] = 0x7F;
+    EXPECT_THROW(legacyValue.deserialize(future), std::runtime_error);
+}
@@ -9,6 +9,7 @@
 #include "Space.hpp"
 #include "Config.hpp"
 #include "gtest/gtest.h"
+#include "faiss/impl/IDSelector.h"
 #include "nlohmann/json.hpp"
 
 #include <fstream>
@@ -261,4 +262,128 @@ TEST_F(FaissIndexManagerTest, TestAddAndSearch4DimVectors) {
 
     EXPECT_TRUE(foundA) << "Vector A was not found in the search results.";
     EXPECT_TRUE(foundB) << "Vector B was not found in the search results.";
-}
\ No newline at end of file
+}
+
+// Selector that admits the even unique ids
+struct EvenIdSelector : faiss::IDSelector {
+    bool is_member(faiss::idx_t id) const override {
+        return id % 2 == 0;
+    }
+};
+
+TEST_F(FaissIndexManagerTest, TestSearchWithSelector) {
+    indexManager->restoreVectorsToIndex();
+
+    std::vector<float> queryVector(dim, 3.2f);
+    std::vector<float> distances(3);
+    std::vector<int64_t> labels(3);
+    EvenIdSelector selector;
+    size_t found = indexManager->search(queryVector.data(), 3, selector, distances.data(), labels.data());
+
+    ASSERT_EQ(found, 3u);
+    EXPECT_EQ(labels[0], 4);
+    EXPECT_EQ(labels[1], 2);
+    EXPECT_EQ(labels[2], 6);
+    EXPECT_NEAR(distances[0], 0.8f * 0.8f * dim, 1e-3);
+}
+
+TEST_F(FaissIndexManagerTest, TestSearchExact) {
+    indexManager->restoreVectorsToIndex();
+    EXPECT_EQ(indexManager->count(), 10u);
+
+    // Label 42 is not in the index and is skipped
+    std::vector<float> queryVector(dim, 3.2f);
+    std::vector<int64_t> candidates = {9, 1, 42, 5};
+    std::vector<float> distances(2);
+    std::vector<int64_t> labels(2);
+    size_t found = indexManager->searchExact(queryVector.data(), candidates.data(), candidates.size(), 2,
+                                             distances.data(), labels.data());
+
+    ASSERT_EQ(found, 2u);
+    EXPECT_EQ(labels[0], 5);
+    EXPECT_EQ(labels[1], 1);
+    EXPECT_NEAR(distances[0], 1.8f * 1.8f * dim, 1e-3);
+    EXPECT_NEAR(distances[1], 2.2f * 2.2f * dim, 1e-3);
+
+    // Vectors added later are found too
+    std::vector<float> newVector(dim, 3.0f);
+    indexManager->addVectorData(newVector, 20);
+    candidates = {20, 9};
+    found = indexManager->searchExact(queryVector.data(), candidates.data(), candidates.size(), 2,
+                                      distances.data(), labels.data());
+    ASSERT_EQ(found, 2u);
+    EXPECT_EQ(labels[0], 20);
+    EXPECT_EQ(labels[1], 9);
+}
+
+TEST_F(FaissIndexManagerTest, TestMarkDeleted) {
+    indexManager->restoreVectorsToIndex();
+    indexManager->markDeleted({3});
+    EXPECT_EQ(indexManager->deletedCount(), 1u);
+
+    std::vector<float> queryVector(dim, 3.2f);
+    std::vector<float> distances(2);
+    std::vector<int64_t> labels(2);
+    size_t found = indexManager->search(queryVector.data(), 2, distances.data(), labels.data());
+    ASSERT_EQ(found, 2u);
+    EXPECT_EQ(labels[0], 4);
+    EXPECT_EQ(labels[1], 2);
+
+    // Tombstones apply on top of a selector and to exact scans
+    indexManager->markDeleted({4});
+    EvenIdSelector selector;
+    found = indexManager->search(queryVector.data(), 2, selector, distances.data(), labels.data());
+    ASSERT_EQ(found, 2u);
+    EXPECT_EQ(labels[0], 2);
+    EXPECT_EQ(labels[1], 6);
+
+    std::vector<int64_t> candidates = {3, 4, 5};
+    found = indexManager->searchExact(queryVector.data(), candidates.data(), candidates.size(), 2,
+                                      distances.data(), labels.data());
+    ASSERT_EQ(found, 1u);
+    EXPECT_EQ(labels[0], 5);
+
+    // Adding a label again makes only its new vector visible
+    indexManager->addVectorData(std::vector<float>(dim, 100.0f), 3);
+    EXPECT_EQ(indexManager->deletedCount(), 2u);
+    found = indexManager->search(queryVector.data(), 1, distances.data(), labels.data());
+    ASSERT_EQ(found, 1u);
+    EXPECT_EQ(labels[0], 2);
+
+    candidates = {3};
+    found = indexManager->searchExact(queryVector.data(), candidates.data(), candidates.size(), 1,
+                                      distances.data(), labels.data());
+    ASSERT_EQ(found, 1u);
+    EXPECT_EQ(labels[0], 3);
+    EXPECT_NEAR(distances[0], 96.8f * 96.8f * dim, 1.0f);
+
+    // The same holds for a label that was never deleted
+    indexManager->addVectorData(std::vector<float>(dim, -100.0f), 2);
+    EXPECT_EQ(indexManager->deletedCount(), 3u);
+    found = indexManager->search(queryVector.data(), 1, distances.data(), labels.data());
+    ASSERT_EQ(found, 1u);
+    EXPECT_EQ(labels[0], 5);
+
+    indexManager->addVectorData(std::vector<float>(dim, 3.2f), 3);
+    found = indexManager->search(queryVector.data(), 1, distances.data(), labels.data());
+    ASSERT_EQ(found, 1u);
+    EXPECT_EQ(labels[0], 3);
+}
+
+TEST_F(FaissIndexManagerTest, TestLoadedIndexTombstonesDeletedVectors) {
+    indexManager->restoreVectorsToIndex();  // also writes the index file
+
+    auto& db = DatabaseManager::getInstance().getDatabase();
+    db.exec("DELETE FROM VectorValue WHERE vectorId IN (SELECT id FROM Vector WHERE unique_id = 5)");
+    db.exec("DELETE FROM Vector WHERE unique_id = 5");
+
+    FaissIndexManager loaded(indexFileName, vectorIndexId, dim, maxElements, MetricType::L2,
+                             VectorValueType::Dense, HnswConfig(16, 200), QuantizationConfig());
+    std::vector<float> queryVector(dim, 5.0f);
+    std::vector<float> distances(1);
+    std::vector<int64_t> labels(1);
+    size_t found = loaded.search(queryVector.data(), 1, distances.data(), labels.data());
+    ASSERT_EQ(found, 1u);
+    EXPECT_NE(labels[0], 5);
+    EXPECT_EQ(loaded.deletedCount(), 1u);
+}
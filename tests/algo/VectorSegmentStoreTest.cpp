@@ -0,0 +1,121 @@
+#include "algo/VectorSegmentStore.hpp"
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <vector>
+
+using namespace atinyvectors::algo;
+namespace fs = std::filesystem;
+
+class VectorSegmentStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = (fs::temp_directory_path() / "atv_vector_segment_store_test").string();
+        fs::remove_all(directory);
+
+        dim = 4;
+    }
+
+    void TearDown() override {
+        fs::remove_all(directory);
+    }
+
+    std::vector<float> makeVector(float base) {
+        std::vector<float> data(dim);
+        for (int i = 0; i < dim; ++i) {
+            data[i] = base + static_cast<float>(i);
+        }
+        return data;
+    }
+
+    std::string directory;
+    int dim;
+};
+
+TEST_F(VectorSegmentStoreTest, AppendAndGet) {
+    VectorSegmentStore store(directory, dim, 8);
+
+    auto first = makeVector(1.0f);
+    auto second = makeVector(10.0f);
+    EXPECT_EQ(store.append(first.data()), 0);
+    EXPECT_EQ(store.append(second.data()), 1);
+    EXPECT_EQ(store.getRecordCount(), 2);
+
+    FloatSpan record = store.get(1);
+    ASSERT_EQ(record.size, static_cast<size_t>(dim));
+    EXPECT_EQ(std::vector<float>(record.begin(), record.end()), second);
+
+    // Records past the append position are not visible
+    EXPECT_TRUE(store.get(2).empty());
+    EXPECT_TRUE(store.get(-1).empty());
+}
+
+TEST_F(VectorSegmentStoreTest, RollsOverToNewSegment) {
+    VectorSegmentStore store(directory, dim, 2);
+
+    for (int i = 0; i < 5; ++i) {
+        auto data = makeVector(static_cast<float>(i * 100));
+        ASSERT_EQ(store.append(data.data()), i);
+    }
+
+    EXPECT_TRUE(fs::exists(directory + "/segment_0.vseg"));
+    EXPECT_TRUE(fs::exists(directory + "/segment_2.vseg"));
+
+    // Spans handed out before the rollover stay valid
+    FloatSpan first = store.get(0);
+    FloatSpan last = store.get(4);
+    EXPECT_FLOAT_EQ(first[0], 0.0f);
+    EXPECT_FLOAT_EQ(last[0], 400.0f);
+    EXPECT_FLOAT_EQ(last[3], 403.0f);
+}
+
+TEST_F(VectorSegmentStoreTest, ReopenKeepsRecordsAndLayout) {
+    {
+        VectorSegmentStore store(directory, dim, 2);
+        for (int i = 0; i < 3; ++i) {
+            auto data = makeVector(static_cast<float>(i));
+            store.append(data.data());
+        }
+        EXPECT_TRUE(store.sync());
+    }
+
+    // The segment size of the existing files wins over the requested one
+    VectorSegmentStore store(directory, dim, 64);
+    store.setRecordCount(3);
+
+    FloatSpan record = store.get(2);
+    ASSERT_FALSE(record.empty());
+    EXPECT_EQ(std::vector<float>(record.begin(), record.end()), makeVector(2.0f));
+
+    auto next = makeVector(7.0f);
+    EXPECT_EQ(store.append(next.data()), 3);
+    EXPECT_TRUE(fs::exists(directory + "/segment_1.vseg"));
+}
+
+TEST_F(VectorSegmentStoreTest, SyncCoversNewRecordsOnly) {
+    VectorSegmentStore store(directory, dim, 2);
+    EXPECT_TRUE(store.sync());
+
+    // Spans three segments, the last one partly
+    for (int i = 0; i < 5; ++i) {
+        auto data = makeVector(static_cast<float>(i));
+        store.append(data.data());
+    }
+    EXPECT_TRUE(store.sync());
+
+    auto next = makeVector(9.0f);
+    store.append(next.data());
+    EXPECT_TRUE(store.sync());
+    EXPECT_TRUE(store.sync());
+    EXPECT_EQ(std::vector<float>(store.get(5).begin(), store.get(5).end()), next);
+}
+
+TEST_F(VectorSegmentStoreTest, DimensionMismatchThrows) {
+    {
+        VectorSegmentStore store(directory, dim, 2);
+        auto data = makeVector(1.0f);
+        store.append(data.data());
+    }
+
+    EXPECT_THROW(VectorSegmentStore(directory, dim + 1, 2), std::runtime_error);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include "filter/FilterManager.hpp"
+#include "filter/ParsedFilter.hpp"
+
+#include <set>
 
 using namespace atinyvectors;
 using namespace atinyvectors::filter;
@@ -18,8 +21,8 @@ TEST(FilterManagerTest, ConvertFilterToSQL) {
     FilterManager& manager = FilterManager::getInstance();
     
     std::string filter = "age > 30 AND is_active == true";
-    std::string expectedSQL = "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) "
-                              "AND EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_active' AND vm1.value = 1))";
+    std::string expectedSQL = "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) "
+                              "AND EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_active' AND vm1.numericValue = 1))";
 
     std::string actualSQL = manager.toSQL(filter);
 
@@ -47,3 +50,79 @@ TEST(FilterManagerTest, ConvertFilterToSQLWithIn) {
 
     EXPECT_EQ(actualSQL, expectedSQL);
 }
+
+TEST(FilterManagerTest, CompileBindsLiteralsAsParameters) {
+    FilterManager& manager = FilterManager::getInstance();
+    manager.clearCache();
+
+    CompiledFilter compiled = manager.compile("age > 30 AND name LIKE 'John%'");
+    std::string expectedSQL = "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > :p2) "
+                              "AND EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'name' AND vm1.value LIKE :p6))";
+    EXPECT_EQ(compiled.sql, expectedSQL);
+
+    ASSERT_EQ(compiled.parameters.size(), 2);
+    EXPECT_EQ(compiled.parameters[0].name, ":p2");
+    EXPECT_EQ(compiled.parameters[0].type, FilterParameter::Type::Integer);
+    EXPECT_EQ(compiled.parameters[0].intValue, 30);
+    EXPECT_EQ(compiled.parameters[1].name, ":p6");
+    EXPECT_EQ(compiled.parameters[1].type, FilterParameter::Type::Text);
+    EXPECT_EQ(compiled.parameters[1].textValue, "John%");
+
+    // Same shape with other literals and spacing reuses the cached template
+    size_t misses = manager.getCacheMisses();
+    CompiledFilter other = manager.compile("age >   45 AND name LIKE \"Jane%\"");
+    EXPECT_EQ(manager.getCacheMisses(), misses);
+    EXPECT_EQ(other.sql, compiled.sql);
+    ASSERT_EQ(other.parameters.size(), 2);
+    EXPECT_EQ(other.parameters[0].intValue, 45);
+    EXPECT_EQ(other.parameters[1].textValue, "Jane%");
+
+    // A floating literal is a different shape
+    manager.compile("age > 30.5 AND name LIKE 'John%'");
+    EXPECT_EQ(manager.getCacheMisses(), misses + 1);
+    EXPECT_EQ(manager.getCacheSize(), 2);
+}
+
+TEST(FilterManagerTest, CompiledFilterMatchesInlinedSQL) {
+    SQLite::Database db(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    db.exec("CREATE TABLE VectorMetadata (vectorId INTEGER, key TEXT, value TEXT, numericValue REAL)");
+    db.exec("INSERT INTO VectorMetadata VALUES (1, 'status', 'active', NULL), (1, 'age', '40', 40), "
+            "(2, 'status', 'inactive', NULL), (2, 'age', '25', 25), (3, 'status', 'it''s', NULL)");
+
+    FilterManager& manager = FilterManager::getInstance();
+    for (const std::string filter : {"status == 'active' AND age > 30", "status IN ('inactive', \"it's\")", "status != 'active'"}) {
+        std::set<long long> inlined;
+        SQLite::Statement inlinedQuery(db, "SELECT DISTINCT vectorId FROM VectorMetadata WHERE " + manager.toSQL(filter));
+        while (inlinedQuery.executeStep()) {
+            inlined.insert(inlinedQuery.getColumn(0).getInt64());
+        }
+
+        CompiledFilter compiled = manager.compile(filter);
+        std::set<long long> bound;
+        SQLite::Statement boundQuery(db, "SELECT DISTINCT vectorId FROM VectorMetadata WHERE " + compiled.sql);
+        compiled.bind(boundQuery);
+        while (boundQuery.executeStep()) {
+            bound.insert(boundQuery.getColumn(0).getInt64());
+        }
+
+        EXPECT_FALSE(inlined.empty()) << filter;
+        EXPECT_EQ(bound, inlined) << filter;
+    }
+}
+
+TEST(FilterManagerTest, ParseIsSharedPerFilter) {
+    FilterManager& manager = FilterManager::getInstance();
+    manager.clearCache();
+
+    auto parsed = manager.parse("age > 30 AND name == 'Bob'");
+    ASSERT_NE(parsed->tree, nullptr);
+    EXPECT_EQ(manager.parse("age > 30 AND name == 'Bob'"), parsed);
+
+    // Plans carry the literals, so another literal is another parse
+    EXPECT_NE(manager.parse("age > 31 AND name == 'Bob'"), parsed);
+
+    EXPECT_EQ(manager.parse("age > ")->tree, nullptr);
+
+    manager.clearCache();
+    EXPECT_NE(manager.parse("age > 30 AND name == 'Bob'"), parsed);
+}
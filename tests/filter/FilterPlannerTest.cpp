@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include "filter/FilterPlanner.hpp"
+
+using namespace atinyvectors::filter;
+
+TEST(FilterPlannerTest, ChoosesPlanBySelectivity) {
+    FilterPlanner planner(100, 0.25);
+
+    // Small sets are scanned exactly, whatever their share
+    EXPECT_EQ(planner.choose(0, 1000000, 10), FilterPlan::ExactScan);
+    EXPECT_EQ(planner.choose(100, 1000000, 10), FilterPlan::ExactScan);
+    EXPECT_EQ(planner.choose(100, 100, 10), FilterPlan::ExactScan);
+    EXPECT_EQ(planner.choose(500, 1000000, 500), FilterPlan::ExactScan);
+
+    EXPECT_EQ(planner.choose(101, 1000000, 10), FilterPlan::FilteredIndex);
+    EXPECT_EQ(planner.choose(249999, 1000000, 10), FilterPlan::FilteredIndex);
+    EXPECT_EQ(planner.choose(250000, 1000000, 10), FilterPlan::PostFilter);
+    EXPECT_EQ(planner.choose(900000, 1000000, 10), FilterPlan::PostFilter);
+}
+
+TEST(FilterPlannerTest, PostFilterFetchesByInverseSelectivity) {
+    EXPECT_EQ(FilterPlanner::postFilterFetch(500, 1000, 10), 20u);
+    EXPECT_EQ(FilterPlanner::postFilterFetch(300, 1000, 10), 34u);
+    EXPECT_EQ(FilterPlanner::postFilterFetch(1000, 1000, 10), 10u);
+    EXPECT_EQ(FilterPlanner::postFilterFetch(5, 1000, 10), 1000u);
+    EXPECT_EQ(FilterPlanner::postFilterFetch(0, 5, 10), 5u);
+}
+
+TEST(FilterPlannerTest, PlanNames) {
+    EXPECT_STREQ(toString(FilterPlan::PostFilter), "post-filter");
+    EXPECT_STREQ(toString(FilterPlan::FilteredIndex), "filtered-index");
+    EXPECT_STREQ(toString(FilterPlan::ExactScan), "exact-scan");
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "filter/JsonPath.hpp"
+
+#include <stdexcept>
+
+using namespace atinyvectors::filter;
+
+TEST(JsonPathTest, ParsesFilterPaths) {
+    JsonPath path = JsonPath::parse("attrs['size'][\"width\"][2]");
+    EXPECT_EQ(path.getKey(), "attrs");
+    ASSERT_EQ(path.getSegments().size(), 3u);
+    EXPECT_EQ(path.getSegments()[0].member, "size");
+    EXPECT_EQ(path.getSegments()[1].member, "width");
+    EXPECT_TRUE(path.getSegments()[2].isIndex);
+    EXPECT_EQ(path.getSegments()[2].index, 2u);
+    EXPECT_FALSE(path.selectsElements());
+
+    // Both quote styles share one canonical form
+    EXPECT_EQ(path.toString(), "attrs[\"size\"][\"width\"][2]");
+    EXPECT_EQ(path.toSQLitePath(), "$.\"size\".\"width\"[2]");
+
+    EXPECT_EQ(JsonPath::parse("tags").toString(), "tags");
+    EXPECT_EQ(JsonPath::parse("tags").toSQLitePath(), "$");
+    EXPECT_EQ(JsonPath::parse("tags[]").toString(), "tags[]");
+    EXPECT_EQ(JsonPath::parse("attrs['colors']").each().toString(), "attrs[\"colors\"][]");
+}
+
+TEST(JsonPathTest, RejectsMalformedPaths) {
+    EXPECT_THROW(JsonPath::parse(""), std::invalid_argument);
+    EXPECT_THROW(JsonPath::parse("[\"a\"]"), std::invalid_argument);
+    EXPECT_THROW(JsonPath::parse("attrs[brand]"), std::invalid_argument);
+    EXPECT_THROW(JsonPath::parse("attrs[\"brand\""), std::invalid_argument);
+    EXPECT_THROW(JsonPath::parse("attrs[\"a\\\"b\"]"), std::invalid_argument);
+    EXPECT_THROW(JsonPath::parse("tags[][0]"), std::invalid_argument);
+    EXPECT_THROW(JsonPath::parse("attrs[\"brand\"]x"), std::invalid_argument);
+}
+
+TEST(JsonPathTest, ExtractsValues) {
+    nlohmann::json value = nlohmann::json::parse(R"({"brand": "acme", "sizes": [30, 45], "dims": {"w": 1, "h": 2}})");
+
+    auto brand = JsonPath::parse("attrs[\"brand\"]").extract(value);
+    ASSERT_EQ(brand.size(), 1u);
+    EXPECT_EQ(*brand[0], "acme");
+
+    auto size = JsonPath::parse("attrs[\"sizes\"][1]").extract(value);
+    ASSERT_EQ(size.size(), 1u);
+    EXPECT_EQ(*size[0], 45);
+
+    EXPECT_TRUE(JsonPath::parse("attrs[\"missing\"]").extract(value).empty());
+    EXPECT_TRUE(JsonPath::parse("attrs[\"sizes\"][2]").extract(value).empty());
+    EXPECT_TRUE(JsonPath::parse("attrs[\"brand\"][\"x\"]").extract(value).empty());
+
+    // [] selects elements, member values, or a scalar itself
+    EXPECT_EQ(JsonPath::parse("attrs[\"sizes\"][]").extract(value).size(), 2u);
+    EXPECT_EQ(JsonPath::parse("attrs[\"dims\"][]").extract(value).size(), 2u);
+    EXPECT_EQ(JsonPath::parse("attrs[\"brand\"][]").extract(value).size(), 1u);
+}
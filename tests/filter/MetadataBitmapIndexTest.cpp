@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+#include "filter/MetadataBitmapIndex.hpp"
+#include "filter/FilterManager.hpp"
+#include "Vector.hpp"
+#include "VectorMetadata.hpp"
+#include "Version.hpp"
+#include "Space.hpp"
+#include "DatabaseManager.hpp"
+#include "IdCache.hpp"
+#include "utils/Utils.hpp"
+
+using namespace atinyvectors;
+using namespace atinyvectors::filter;
+using namespace atinyvectors::utils;
+
+class MetadataBitmapIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        IdCache::getInstance().clean();
+        DatabaseManager::getInstance().reset();
+        MetadataBitmapIndex::getInstance().clean();
+
+        Space space(0, "BitmapSpace", "Space for bitmap index tests", getCurrentTimeUTC(), getCurrentTimeUTC());
+        int spaceId = SpaceManager::getInstance().addSpace(space);
+
+        Version version;
+        version.spaceId = spaceId;
+        version.name = "v1";
+        version.is_default = true;
+        versionId = VersionManager::getInstance().addVersion(version);
+
+        addVector(1, {{"name", "Alice"}, {"age", "30"}, {"city", "Seoul"}});
+        addVector(2, {{"name", "Bob"}, {"age", "45"}, {"city", "Busan"}});
+        addVector(3, {{"name", "alfred"}, {"age", "-5"}});
+        addVector(4, {{"name", "Carol"}, {"age", "30"}, {"city", "seoul"}, {"active", "1"}});
+    }
+
+    long addVector(int uniqueId, const std::vector<std::pair<std::string, std::string>>& metadata) {
+        Vector vector(0, versionId, uniqueId, VectorValueType::Dense, {}, false);
+        VectorManager::getInstance().addVector(vector);
+        for (const auto& [key, value] : metadata) {
+            VectorMetadata row(0, versionId, vector.id, key, value);
+            VectorMetadataManager::getInstance().addVectorMetadata(row);
+        }
+        return vector.id;
+    }
+
+    std::vector<uint32_t> evaluate(const std::string& filter) {
+        RoaringBitmap result;
+        EXPECT_TRUE(MetadataBitmapIndex::getInstance().evaluate(versionId, filter, result)) << filter;
+        return result.toVector();
+    }
+
+    // Unique ids the generated SQL selects for the filter
+    std::vector<uint32_t> evaluateSQL(const std::string& filter) {
+        auto& db = DatabaseManager::getInstance().getReadDatabase();
+        SQLite::Statement query(db,
+            "SELECT DISTINCT V.unique_id FROM VectorMetadata JOIN Vector V ON V.id = VectorMetadata.vectorId "
+            "WHERE VectorMetadata.versionId = ? AND " + FilterManager::getInstance().toSQL(filter) + " ORDER BY V.unique_id");
+        query.bind(1, versionId);
+
+        std::vector<uint32_t> uniqueIds;
+        while (query.executeStep()) {
+            uniqueIds.push_back(static_cast<uint32_t>(query.getColumn(0).getInt64()));
+        }
+        return uniqueIds;
+    }
+
+    int versionId;
+};
+
+TEST_F(MetadataBitmapIndexTest, EvaluatesConditions) {
+    EXPECT_EQ(evaluate("name == 'Alice'"), (std::vector<uint32_t>{1}));
+    EXPECT_EQ(evaluate("age == 30"), (std::vector<uint32_t>{1, 4}));
+    EXPECT_EQ(evaluate("age == -5"), (std::vector<uint32_t>{3}));
+    EXPECT_EQ(evaluate("active == true"), (std::vector<uint32_t>{4}));
+    EXPECT_EQ(evaluate("city != 'Seoul'"), (std::vector<uint32_t>{2, 4}));
+    EXPECT_EQ(evaluate("name IN ('Bob', 'Carol')"), (std::vector<uint32_t>{2, 4}));
+    EXPECT_EQ(evaluate("name NOT IN ('Bob', 'Carol')"), (std::vector<uint32_t>{1, 3}));
+    EXPECT_EQ(evaluate("name LIKE 'al%'"), (std::vector<uint32_t>{1, 3}));
+    EXPECT_EQ(evaluate("city == 'Seoul' || age == 45"), (std::vector<uint32_t>{1, 2}));
+    EXPECT_EQ(evaluate("age == 30 && city == 'seoul'"), (std::vector<uint32_t>{4}));
+    EXPECT_EQ(evaluate("NOT (age == 30)"), (std::vector<uint32_t>{2, 3}));
+    EXPECT_EQ(evaluate("city IN ()"), (std::vector<uint32_t>{1, 2, 4}));
+    EXPECT_EQ(evaluate("missing == 'x'"), (std::vector<uint32_t>{}));
+
+    // Numbers compare against numericValue
+    EXPECT_EQ(evaluate("age > 1.5"), (std::vector<uint32_t>{1, 2, 4}));
+    EXPECT_EQ(evaluate("age == 30.0"), (std::vector<uint32_t>{1, 4}));
+    EXPECT_EQ(evaluate("-10 < age <= 30"), (std::vector<uint32_t>{1, 3, 4}));
+    EXPECT_EQ(evaluate("45 >= age > 30"), (std::vector<uint32_t>{2}));
+    EXPECT_EQ(evaluate("30 < age < 30"), (std::vector<uint32_t>{}));
+    EXPECT_EQ(evaluate("age NOT IN (30, 45)"), (std::vector<uint32_t>{3}));
+    EXPECT_EQ(evaluate("age IN (45, 'Bob')"), (std::vector<uint32_t>{2}));
+}
+
+TEST_F(MetadataBitmapIndexTest, MatchesGeneratedSQL) {
+    const std::vector<std::string> filters = {
+        "name == 'Alice'",
+        "age > 30",
+        "age >= 30",
+        "age < 45",
+        "age <= '30'",
+        "city != 'Seoul'",
+        "name LIKE '%o%'",
+        "name LIKE '_ob'",
+        "age IN (30, 45)",
+        "age NOT IN (30)",
+        "age > 1.5",
+        "age != 30",
+        "0 <= age < 45",
+        "100 > age > -5",
+        "'Z' > name >= 'B'",
+        "name IN ('Bob', 45)",
+        "active == true",
+        "(age == 30 OR name == 'Bob') AND NOT (city == 'Busan')",
+        "NOT (city == 'Seoul' OR city == 'seoul')",
+    };
+    for (const auto& filter : filters) {
+        EXPECT_EQ(evaluate(filter), evaluateSQL(filter)) << filter;
+    }
+}
+
+TEST_F(MetadataBitmapIndexTest, QueryVectorsIsTheSameWithoutTheIndex) {
+    // Several rows of a vector can match the same filter, and pages run in unique_id order either way
+    const std::vector<std::string> filters = {
+        "age >= 30 OR city == 'Seoul'",
+        "name != 'Bob'",
+        "city IN ('Seoul', 'seoul') OR active == true",
+        "age IN (30, 45)",
+    };
+    const std::vector<std::pair<int, int>> pages = {{0, -1}, {0, 2}, {1, 2}, {3, 10}};
+
+    auto& index = MetadataBitmapIndex::getInstance();
+    auto& metadataManager = VectorMetadataManager::getInstance();
+    bool wasEnabled = index.isEnabled();
+    for (const auto& filter : filters) {
+        for (const auto& [start, limit] : pages) {
+            index.setEnabled(true);
+            auto indexed = metadataManager.queryVectors(versionId, filter, start, limit);
+            index.setEnabled(false);
+            auto scanned = metadataManager.queryVectors(versionId, filter, start, limit);
+
+            EXPECT_EQ(indexed.totalCount, scanned.totalCount) << filter;
+            EXPECT_EQ(indexed.vectorUniqueIds, scanned.vectorUniqueIds) << filter << " " << start << " " << limit;
+        }
+    }
+    index.setEnabled(wasEnabled);
+}
+
+TEST_F(MetadataBitmapIndexTest, UnsupportedFiltersFallBack) {
+    RoaringBitmap result;
+    auto& index = MetadataBitmapIndex::getInstance();
+    EXPECT_FALSE(index.evaluate(versionId, "age == 30 + 1", result));
+    EXPECT_FALSE(index.evaluate(versionId, "age * 2 > 10", result));
+    EXPECT_FALSE(index.evaluate(versionId, "age NOT IN (30, 'Bob')", result));
+    EXPECT_FALSE(index.evaluate(versionId, "'a' < name < 5", result));
+    EXPECT_FALSE(index.evaluate(versionId, "age == 30 & city == 'Seoul'", result));
+    EXPECT_FALSE(index.evaluate(versionId, "age == ", result));
+
+    // Queries still answer them through SQL
+    auto queried = VectorMetadataManager::getInstance().queryVectorIdsAfter(versionId, "age > 1 + 0.5", 0, 10);
+    EXPECT_EQ(queried.size(), 3u);
+}
+
+TEST_F(MetadataBitmapIndexTest, DoesNotLoadRowsOfOpenTransaction) {
+    auto& index = MetadataBitmapIndex::getInstance();
+    auto& db = DatabaseManager::getInstance().getDatabase();
+
+    {
+        SQLite::Transaction transaction(db);
+        db.exec("UPDATE VectorMetadata SET value = 'Zed' WHERE key = 'name' AND value = 'Alice'");
+
+        // Answered by SQL instead, which sees the uncommitted row
+        RoaringBitmap result;
+        EXPECT_FALSE(index.evaluate(versionId, "name == 'Zed'", result));
+        EXPECT_EQ(evaluateSQL("name == 'Zed'"), (std::vector<uint32_t>{1}));
+    }
+
+    // Rolled back, so the index is loaded without the row
+    EXPECT_EQ(evaluate("name == 'Zed'"), (std::vector<uint32_t>{}));
+    EXPECT_EQ(evaluate("name == 'Alice'"), (std::vector<uint32_t>{1}));
+}
+
+TEST_F(MetadataBitmapIndexTest, FollowsMetadataChanges) {
+    auto& metadataManager = VectorMetadataManager::getInstance();
+    EXPECT_EQ(evaluate("city == 'Seoul'"), (std::vector<uint32_t>{1}));
+
+    long vectorId = addVector(5, {{"city", "Seoul"}});
+    EXPECT_EQ(evaluate("city == 'Seoul'"), (std::vector<uint32_t>{1, 5}));
+
+    // Upserts replace the rows of the vector
+    metadataManager.deleteVectorMetadataByVectorId(vectorId);
+    VectorMetadata row(0, versionId, vectorId, "city", "Busan");
+    metadataManager.addVectorMetadata(row);
+    EXPECT_EQ(evaluate("city == 'Seoul'"), (std::vector<uint32_t>{1}));
+    EXPECT_EQ(evaluate("city == 'Busan'"), (std::vector<uint32_t>{2, 5}));
+
+    row.value = "Incheon";
+    metadataManager.updateVectorMetadata(row);
+    EXPECT_EQ(evaluate("city == 'Busan'"), (std::vector<uint32_t>{2}));
+    EXPECT_EQ(evaluate("city == 'Incheon'"), (std::vector<uint32_t>{5}));
+
+    metadataManager.deleteVectorMetadata(row.id);
+    EXPECT_EQ(evaluate("city == 'Incheon'"), (std::vector<uint32_t>{}));
+    EXPECT_EQ(evaluate("NOT (city == 'Busan')"), (std::vector<uint32_t>{1, 3, 4}));
+
+    // Pages come back as Vector ids in unique_id order
+    VectorMetadataResult page = metadataManager.queryVectors(versionId, "age == 30 || age == 45", 1, 5);
+    EXPECT_EQ(page.totalCount, 3);
+    EXPECT_EQ(page.vectorUniqueIds.size(), 2u);
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include "filter/PredicateBuilderVisitor.hpp"
+#include "filter/MetadataBitmapIndex.hpp"
+#include "filter/FilterManager.hpp"
+#include "Vector.hpp"
+#include "VectorMetadata.hpp"
+#include "Version.hpp"
+#include "Space.hpp"
+#include "DatabaseManager.hpp"
+#include "IdCache.hpp"
+#include "utils/Utils.hpp"
+
+using namespace atinyvectors;
+using namespace atinyvectors::filter;
+using namespace atinyvectors::utils;
+
+class PredicateBuilderVisitorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        IdCache::getInstance().clean();
+        DatabaseManager::getInstance().reset();
+        MetadataBitmapIndex::getInstance().clean();
+
+        Space space(0, "PredicateSpace", "Space for compiled filter tests", getCurrentTimeUTC(), getCurrentTimeUTC());
+        int spaceId = SpaceManager::getInstance().addSpace(space);
+
+        Version version;
+        version.spaceId = spaceId;
+        version.name = "v1";
+        version.is_default = true;
+        versionId = VersionManager::getInstance().addVersion(version);
+
+        aliceId = addVector(1, {{"name", "Alice"}, {"age", "30"}, {"city", "Seoul"}});
+        addVector(2, {{"name", "Bob"}, {"age", "45"}, {"city", "Busan"}});
+        addVector(3, {{"name", "alfred"}, {"age", "-5"}, {"tag", "red"}, {"tag", "7"}});
+        addVector(4, {{"name", "Carol"}, {"age", "31"}, {"city", "seoul"}, {"active", "1"}});
+        addVector(5, {});
+    }
+
+    long addVector(int uniqueId, const std::vector<std::pair<std::string, std::string>>& metadata) {
+        Vector vector(0, versionId, uniqueId, VectorValueType::Dense, {}, false);
+        VectorManager::getInstance().addVector(vector);
+        for (const auto& [key, value] : metadata) {
+            VectorMetadata row(0, versionId, vector.id, key, value);
+            VectorMetadataManager::getInstance().addVectorMetadata(row);
+        }
+        return vector.id;
+    }
+
+    std::vector<uint32_t> evaluate(const std::string& filter) {
+        auto predicate = PredicateBuilderVisitor::compile(filter);
+        EXPECT_NE(predicate, nullptr) << filter;
+        if (!predicate) {
+            return {};
+        }
+
+        const std::vector<uint32_t> candidates = {5, 4, 3, 2, 1};
+        std::vector<uint8_t> matched(candidates.size());
+        EXPECT_TRUE(MetadataBitmapIndex::getInstance().evaluate(versionId, *predicate, candidates.data(),
+                                                                candidates.size(), matched.data()));
+
+        std::vector<uint32_t> uniqueIds;
+        for (size_t i = candidates.size(); i-- > 0;) {
+            if (matched[i]) {
+                uniqueIds.push_back(candidates[i]);
+            }
+        }
+        return uniqueIds;
+    }
+
+    // Unique ids the generated SQL selects for the filter
+    std::vector<uint32_t> evaluateSQL(const std::string& filter) {
+        auto& db = DatabaseManager::getInstance().getReadDatabase();
+        SQLite::Statement query(db,
+            "SELECT DISTINCT V.unique_id FROM VectorMetadata JOIN Vector V ON V.id = VectorMetadata.vectorId "
+            "WHERE VectorMetadata.versionId = ? AND " + FilterManager::getInstance().toSQL(filter) + " ORDER BY V.unique_id");
+        query.bind(1, versionId);
+
+        std::vector<uint32_t> uniqueIds;
+        while (query.executeStep()) {
+            uniqueIds.push_back(static_cast<uint32_t>(query.getColumn(0).getInt64()));
+        }
+        return uniqueIds;
+    }
+
+    int versionId;
+    long aliceId;
+};
+
+TEST_F(PredicateBuilderVisitorTest, EvaluatesConditions) {
+    EXPECT_EQ(evaluate("name == 'Alice'"), (std::vector<uint32_t>{1}));
+    EXPECT_EQ(evaluate("age > 1 + 0.5"), (std::vector<uint32_t>{1, 2, 4}));
+    EXPECT_EQ(evaluate("age == (30 + 1)"), (std::vector<uint32_t>{4}));
+    EXPECT_EQ(evaluate("age >= 60 / 2 && city LIKE 'seoul'"), (std::vector<uint32_t>{1, 4}));
+    EXPECT_EQ(evaluate("tag == 7"), (std::vector<uint32_t>{3}));
+    EXPECT_EQ(evaluate("NOT (age > 0)"), (std::vector<uint32_t>{3}));
+    EXPECT_EQ(evaluate("missing == 'x'"), (std::vector<uint32_t>{}));
+}
+
+TEST_F(PredicateBuilderVisitorTest, MatchesGeneratedSQL) {
+    const std::vector<std::string> filters = {
+        "age > 1 + 0.5",
+        "age == (30 + 1)",
+        "age < -(2 * 3) + 100",
+        "age == 91 % 60",
+        "age > 7 / 2",
+        "age > 7.0 / 2",
+        "age NOT IN (30, 'Bob')",
+        "tag NOT IN (7, 'blue')",
+        "tag IN (7, 'red')",
+        "'a' < name < 50",
+        "0 < age <= 30 + 1",
+        "100 > age >= 'A'",
+        "name LIKE 'al%' || age == 45",
+        "city != 'Seoul' && NOT (name == 'Bob')",
+        "NOT (tag IN ())",
+        "tag NOT IN ()",
+        "active == true",
+    };
+    for (const auto& filter : filters) {
+        EXPECT_EQ(evaluate(filter), evaluateSQL(filter)) << filter;
+    }
+}
+
+TEST_F(PredicateBuilderVisitorTest, UnsupportedFiltersAreNotCompiled) {
+    EXPECT_EQ(PredicateBuilderVisitor::compile("age * 2 > 10"), nullptr);
+    EXPECT_EQ(PredicateBuilderVisitor::compile("age == 30 + 1"), nullptr);
+    EXPECT_EQ(PredicateBuilderVisitor::compile("age > 1 / 0"), nullptr);
+    EXPECT_EQ(PredicateBuilderVisitor::compile("age > 9223372036854775807 + 1"), nullptr);
+    EXPECT_EQ(PredicateBuilderVisitor::compile("info[\"city\"] == 'Seoul'"), nullptr);
+    EXPECT_EQ(PredicateBuilderVisitor::compile("age == "), nullptr);
+}
+
+TEST_F(PredicateBuilderVisitorTest, CompiledPredicatesAreReused) {
+    auto predicate = PredicateBuilderVisitor::compile("age > 30 + 0.5");
+    ASSERT_NE(predicate, nullptr);
+    EXPECT_EQ(PredicateBuilderVisitor::compile("age > 30 + 0.5"), predicate);
+    EXPECT_NE(PredicateBuilderVisitor::compile("age > 31 + 0.5"), predicate);
+}
+
+TEST_F(PredicateBuilderVisitorTest, FiltersCandidates) {
+    auto& metadataManager = VectorMetadataManager::getInstance();
+    std::vector<std::pair<float, int>> candidates = {{0.1f, 4}, {0.2f, 2}, {0.3f, 1}, {0.4f, -1}};
+
+    // The bitmap index cannot answer arithmetic, the compiled predicate can
+    auto filtered = metadataManager.filterVectors(versionId, candidates, "age > 30 + 0.5");
+    ASSERT_EQ(filtered.size(), 2u);
+    EXPECT_EQ(filtered[0].second, 4);
+    EXPECT_EQ(filtered[1].second, 2);
+
+    // Metadata changes reach the columns
+    VectorMetadata row(0, versionId, aliceId, "age", "50");
+    metadataManager.addVectorMetadata(row);
+    filtered = metadataManager.filterVectors(versionId, candidates, "age > 30 + 0.5");
+    ASSERT_EQ(filtered.size(), 3u);
+    EXPECT_EQ(filtered[2].second, 1);
+}
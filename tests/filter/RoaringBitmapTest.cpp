@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "filter/RoaringBitmap.hpp"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+using namespace atinyvectors::filter;
+
+namespace {
+
+std::vector<uint32_t> toSorted(const std::set<uint32_t>& values) {
+    return std::vector<uint32_t>(values.begin(), values.end());
+}
+
+} // anonymous namespace
+
+TEST(RoaringBitmapTest, AddRemoveContains) {
+    RoaringBitmap bitmap;
+    EXPECT_TRUE(bitmap.empty());
+
+    bitmap.add(5);
+    bitmap.add(70000);
+    bitmap.add(5);
+    bitmap.add(1);
+
+    EXPECT_EQ(bitmap.cardinality(), 3u);
+    EXPECT_TRUE(bitmap.contains(1));
+    EXPECT_TRUE(bitmap.contains(5));
+    EXPECT_TRUE(bitmap.contains(70000));
+    EXPECT_FALSE(bitmap.contains(6));
+    EXPECT_EQ(bitmap.toVector(), (std::vector<uint32_t>{1, 5, 70000}));
+
+    bitmap.remove(70000);
+    bitmap.remove(12345);
+    EXPECT_EQ(bitmap.toVector(), (std::vector<uint32_t>{1, 5}));
+
+    bitmap.remove(1);
+    bitmap.remove(5);
+    EXPECT_TRUE(bitmap.empty());
+}
+
+TEST(RoaringBitmapTest, DenseContainerRoundTrip) {
+    RoaringBitmap bitmap;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        bitmap.add(i * 2);
+    }
+    EXPECT_EQ(bitmap.cardinality(), 10000u);
+    EXPECT_TRUE(bitmap.contains(19998));
+    EXPECT_FALSE(bitmap.contains(19999));
+
+    // Shrinking below the array threshold switches the layout back
+    for (uint32_t i = 0; i < 9000; ++i) {
+        bitmap.remove(i * 2);
+    }
+    EXPECT_EQ(bitmap.cardinality(), 1000u);
+    EXPECT_EQ(bitmap.toVector().front(), 18000u);
+    EXPECT_EQ(bitmap, RoaringBitmap::of(bitmap.toVector()));
+}
+
+TEST(RoaringBitmapTest, SetOperationsMatchStdSet) {
+    std::mt19937 rng(42);
+    // Mix of sparse and dense containers across several high keys
+    std::uniform_int_distribution<uint32_t> dist(0, 3 * 65536);
+
+    std::set<uint32_t> left;
+    std::set<uint32_t> right;
+    for (int i = 0; i < 20000; ++i) {
+        left.insert(dist(rng));
+    }
+    for (int i = 0; i < 3000; ++i) {
+        right.insert(dist(rng));
+    }
+    for (uint32_t i = 65536; i < 65536 + 8000; ++i) {
+        right.insert(i);
+    }
+
+    RoaringBitmap a = RoaringBitmap::of(toSorted(left));
+    RoaringBitmap b = RoaringBitmap::of(toSorted(right));
+    EXPECT_EQ(a.cardinality(), left.size());
+    EXPECT_EQ(b.cardinality(), right.size());
+
+    std::vector<uint32_t> expected;
+    std::set_union(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(expected));
+    EXPECT_EQ((a | b).toVector(), expected);
+
+    expected.clear();
+    std::set_intersection(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(expected));
+    EXPECT_EQ((a & b).toVector(), expected);
+    EXPECT_EQ(a.intersectionCardinality(b), expected.size());
+    EXPECT_EQ(b.intersectionCardinality(a), expected.size());
+
+    expected.clear();
+    std::set_difference(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(expected));
+    EXPECT_EQ((a - b).toVector(), expected);
+
+    expected.clear();
+    std::set_difference(right.begin(), right.end(), left.begin(), left.end(), std::back_inserter(expected));
+    EXPECT_EQ((b - a).toVector(), expected);
+}
+
+TEST(RoaringBitmapTest, ValuesFromAndPage) {
+    RoaringBitmap bitmap = RoaringBitmap::of({3, 10, 65535, 65536, 65540, 200000});
+
+    EXPECT_EQ(bitmap.valuesFrom(0, 2), (std::vector<uint32_t>{3, 10}));
+    EXPECT_EQ(bitmap.valuesFrom(11, 3), (std::vector<uint32_t>{65535, 65536, 65540}));
+    EXPECT_EQ(bitmap.valuesFrom(65537, 10), (std::vector<uint32_t>{65540, 200000}));
+    EXPECT_TRUE(bitmap.valuesFrom(200001, 10).empty());
+    EXPECT_TRUE(bitmap.valuesFrom(0, 0).empty());
+
+    EXPECT_EQ(bitmap.page(0, 2), (std::vector<uint32_t>{3, 10}));
+    EXPECT_EQ(bitmap.page(3, 2), (std::vector<uint32_t>{65536, 65540}));
+    EXPECT_EQ(bitmap.page(5, 10), (std::vector<uint32_t>{200000}));
+    EXPECT_TRUE(bitmap.page(6, 10).empty());
+}
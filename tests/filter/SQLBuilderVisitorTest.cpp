@@ -19,7 +19,7 @@ protected:
     }
 };
 
-std::string convertFilterToSQL(const std::string& filter) {
+std::string convertFilterToSQL(const std::string& filter, const MetadataIndexes& indexes = {}) {
     antlr4::ANTLRInputStream input(filter);
     PlanLexer lexer(&input);
     antlr4::CommonTokenStream tokens(&lexer);
@@ -27,7 +27,7 @@ std::string convertFilterToSQL(const std::string& filter) {
 
     PlanParser::ExprContext* tree = parser.expr();
 
-    SQLBuilderVisitor visitor;
+    SQLBuilderVisitor visitor(false, indexes);
     std::any result = visitor.visit(tree);
 
     if (result.has_value()) {
@@ -43,7 +43,7 @@ std::string convertFilterToSQL(const std::string& filter) {
 
 TEST(SQLBuilderVisitorTest, IntegerComparison) {
     std::string filter = "age > 30";
-    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30)";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30)";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -51,8 +51,8 @@ TEST(SQLBuilderVisitorTest, IntegerComparison) {
 TEST(SQLBuilderVisitorTest, MultipleConditionsAnd) {
     std::string filter = "age > 30 AND salary <= 50000";
     std::string expected_sql = 
-        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) AND "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.value <= 50000))";
+        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.numericValue <= 50000))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -60,8 +60,8 @@ TEST(SQLBuilderVisitorTest, MultipleConditionsAnd) {
 TEST(SQLBuilderVisitorTest, MultipleConditionsOr) {
     std::string filter = "age > 30 OR salary <= 50000";
     std::string expected_sql = 
-        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) OR "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.value <= 50000))";
+        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) OR "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.numericValue <= 50000))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -70,8 +70,8 @@ TEST(SQLBuilderVisitorTest, CombinedAndOr) {
     std::string filter = "age > 30 AND salary <= 50000 OR department == 'HR'";
     std::string expected_sql = 
         "(("
-        "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) AND "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.value <= 50000)"
+        "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.numericValue <= 50000)"
         ") OR "
         "EXISTS (SELECT 1 FROM VectorMetadata vm2 WHERE vm2.vectorId = VectorMetadata.vectorId AND vm2.key = 'department' AND vm2.value = 'HR'))";
     std::string actual_sql = convertFilterToSQL(filter);
@@ -89,8 +89,8 @@ TEST(SQLBuilderVisitorTest, Parentheses) {
     std::string filter = "(age > 30 AND salary <= 50000) OR department == 'HR'";
     std::string expected_sql = 
         "(("
-        "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) AND "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.value <= 50000)"
+        "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'salary' AND vm1.numericValue <= 50000)"
         ") OR "
         "EXISTS (SELECT 1 FROM VectorMetadata vm2 WHERE vm2.vectorId = VectorMetadata.vectorId AND vm2.key = 'department' AND vm2.value = 'HR'))";
     std::string actual_sql = convertFilterToSQL(filter);
@@ -100,8 +100,8 @@ TEST(SQLBuilderVisitorTest, Parentheses) {
 TEST(SQLBuilderVisitorTest, BooleanValues) {
     std::string filter = "is_active == true AND is_manager == false";
     std::string expected_sql = 
-        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'is_active' AND vm0.value = 1) AND "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_manager' AND vm1.value = 0))";
+        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'is_active' AND vm0.numericValue = 1) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_manager' AND vm1.numericValue = 0))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -111,22 +111,22 @@ TEST(SQLBuilderVisitorTest, ComplexExpression) {
     std::string expected_sql = 
         "(("
         "("
-        "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 25) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 25) AND "
         "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'department' AND vm1.value = 'Engineering')"
         ") OR "
         "("
-        "EXISTS (SELECT 1 FROM VectorMetadata vm2 WHERE vm2.vectorId = VectorMetadata.vectorId AND vm2.key = 'age' AND vm2.value > 30) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm2 WHERE vm2.vectorId = VectorMetadata.vectorId AND vm2.key = 'age' AND vm2.numericValue > 30) AND "
         "EXISTS (SELECT 1 FROM VectorMetadata vm3 WHERE vm3.vectorId = VectorMetadata.vectorId AND vm3.key = 'department' AND vm3.value = 'HR')"
         ")"
         ") AND "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm4 WHERE vm4.vectorId = VectorMetadata.vectorId AND vm4.key = 'is_active' AND vm4.value = 1))";
+        "EXISTS (SELECT 1 FROM VectorMetadata vm4 WHERE vm4.vectorId = VectorMetadata.vectorId AND vm4.key = 'is_active' AND vm4.numericValue = 1))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
 
 TEST(SQLBuilderVisitorTest, NotCondition) {
     std::string filter = "NOT is_active == true";
-    std::string expected_sql = "(NOT EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'is_active' AND vm0.value = 1))";
+    std::string expected_sql = "(NOT EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'is_active' AND vm0.numericValue = 1))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -134,8 +134,8 @@ TEST(SQLBuilderVisitorTest, NotCondition) {
 TEST(SQLBuilderVisitorTest, NotCombinedWithAnd) {
     std::string filter = "age > 30 AND NOT is_active == true";
     std::string expected_sql = 
-        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) AND "
-        "(NOT EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_active' AND vm1.value = 1)))";
+        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) AND "
+        "(NOT EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_active' AND vm1.numericValue = 1)))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -143,15 +143,15 @@ TEST(SQLBuilderVisitorTest, NotCombinedWithAnd) {
 TEST(SQLBuilderVisitorTest, NotCombinedWithOr) {
     std::string filter = "age > 30 OR NOT is_active == true";
     std::string expected_sql = 
-        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.value > 30) OR "
-        "(NOT EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_active' AND vm1.value = 1)))";
+        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'age' AND vm0.numericValue > 30) OR "
+        "(NOT EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'is_active' AND vm1.numericValue = 1)))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
 
 TEST(SQLBuilderVisitorTest, InCondition) {
     std::string filter = "key2 IN (1, 2, 3)";
-    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'key2' AND vm0.value IN (1, 2, 3))";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'key2' AND vm0.numericValue IN (1, 2, 3))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
@@ -160,14 +160,123 @@ TEST(SQLBuilderVisitorTest, CombinedLikeAndIn) {
     std::string filter = "metakey LIKE '%data%' AND key2 IN (1, 2, 3)";
     std::string expected_sql = 
         "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'metakey' AND vm0.value LIKE '%data%') AND "
-        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'key2' AND vm1.value IN (1, 2, 3)))";
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'key2' AND vm1.numericValue IN (1, 2, 3)))";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
 
 TEST(SQLBuilderVisitorTest, GreaterThanCondition) {
     std::string filter = "key3 > 1000";
-    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'key3' AND vm0.value > 1000)";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'key3' AND vm0.numericValue > 1000)";
     std::string actual_sql = convertFilterToSQL(filter);
     EXPECT_EQ(actual_sql, expected_sql);
 }
+
+TEST(SQLBuilderVisitorTest, StringComparisonUsesTextValue) {
+    std::string filter = "created_at >= '2024-01-01'";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'created_at' AND vm0.value >= '2024-01-01')";
+    std::string actual_sql = convertFilterToSQL(filter);
+    EXPECT_EQ(actual_sql, expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, RangeCondition) {
+    std::string filter = "10 < price <= 99.5";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'price' AND vm0.numericValue > 10 AND vm0.numericValue <= 99.5)";
+    std::string actual_sql = convertFilterToSQL(filter);
+    EXPECT_EQ(actual_sql, expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, ReverseRangeCondition) {
+    std::string filter = "1700000000 > timestamp >= -5 AND name == 'a'";
+    std::string expected_sql =
+        "(EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'timestamp' AND vm0.numericValue >= -5 AND vm0.numericValue < 1700000000) AND "
+        "EXISTS (SELECT 1 FROM VectorMetadata vm1 WHERE vm1.vectorId = VectorMetadata.vectorId AND vm1.key = 'name' AND vm1.value = 'a'))";
+    std::string actual_sql = convertFilterToSQL(filter);
+    EXPECT_EQ(actual_sql, expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, MixedInCondition) {
+    std::string filter = "code IN (1, 'x', 2)";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'code' AND (vm0.numericValue IN (1, 2) OR vm0.value IN ('x')))";
+    EXPECT_EQ(convertFilterToSQL(filter), expected_sql);
+
+    filter = "code NOT IN (1, 'x')";
+    expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'code' AND (COALESCE(vm0.numericValue NOT IN (1), 1) AND vm0.value NOT IN ('x')))";
+    EXPECT_EQ(convertFilterToSQL(filter), expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, EmptyInCondition) {
+    std::string filter = "tag IN ()";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'tag' AND vm0.value IS NOT NULL)";
+    std::string actual_sql = convertFilterToSQL(filter);
+    EXPECT_EQ(actual_sql, expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, JSONPathReadsJSONValue) {
+    std::string filter = "attrs[\"brand\"] == 'acme'";
+    std::string type = "CASE WHEN vm0.valueType IN (4, 5) THEN json_type(vm0.value, '$.\"brand\"') END";
+    std::string expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'attrs' AND " +
+        type + " IS NOT NULL AND CASE WHEN " + type + " = 'text' THEN vm0.value ->> '$.\"brand\"' WHEN " + type +
+        " <> 'null' THEN vm0.value -> '$.\"brand\"' END = 'acme')";
+    EXPECT_EQ(convertFilterToSQL(filter), expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, IndexedJSONPathReadsPathRows) {
+    MetadataIndexes indexes;
+    indexes.paths = {"attrs[\"brand\"]", "attrs[\"size\"]", "tags[]"};
+
+    std::string filter = "attrs['brand'] == 'acme' AND attrs[\"size\"] > 40";
+    std::string expected_sql =
+        "(EXISTS (SELECT 1 FROM VectorMetadataPath vp0 WHERE vp0.vectorId = VectorMetadata.vectorId AND vp0.path = 'attrs[\"brand\"]' AND vp0.value = 'acme') AND "
+        "EXISTS (SELECT 1 FROM VectorMetadataPath vp1 WHERE vp1.vectorId = VectorMetadata.vectorId AND vp1.path = 'attrs[\"size\"]' AND vp1.numericValue > 40))";
+    EXPECT_EQ(convertFilterToSQL(filter, indexes), expected_sql);
+
+    filter = "array_contains_any(tags, [7, 'red'])";
+    expected_sql = "EXISTS (SELECT 1 FROM VectorMetadataPath vp0 WHERE vp0.vectorId = VectorMetadata.vectorId AND vp0.path = 'tags[]' AND "
+                   "(vp0.numericValue IN (7) OR vp0.value IN ('red')))";
+    EXPECT_EQ(convertFilterToSQL(filter, indexes), expected_sql);
+}
+
+TEST(SQLBuilderVisitorTest, TextIndexedLikeReadsTrigramIndex) {
+    MetadataIndexes indexes;
+    indexes.textKeys = {"title"};
+
+    std::string filter = "title LIKE '%wireless%'";
+    std::string expected_sql =
+        "VectorMetadata.vectorId IN (SELECT vm0.vectorId FROM VectorMetadataText vt0 CROSS JOIN VectorMetadata vm0 "
+        "ON vm0.id = vt0.rowid WHERE vt0.value LIKE '%wireless%' AND vm0.key = 'title' AND vm0.value LIKE '%wireless%')";
+    EXPECT_EQ(convertFilterToSQL(filter, indexes), expected_sql);
+
+    // Patterns without three literal characters in a row can't use the index
+    filter = "title LIKE '%ab%'";
+    expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'title' AND vm0.value LIKE '%ab%')";
+    EXPECT_EQ(convertFilterToSQL(filter, indexes), expected_sql);
+
+    filter = "name LIKE '%wireless%'";
+    expected_sql = "EXISTS (SELECT 1 FROM VectorMetadata vm0 WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'name' AND vm0.value LIKE '%wireless%')";
+    EXPECT_EQ(convertFilterToSQL(filter, indexes), expected_sql);
+
+    EXPECT_TRUE(SQLBuilderVisitor::hasTrigram("%abc%"));
+    EXPECT_TRUE(SQLBuilderVisitor::hasTrigram("%\xc3\xa9t\xc3\xa9%"));  // three characters, five bytes
+    EXPECT_FALSE(SQLBuilderVisitor::hasTrigram("%\xc3\xa9t%"));
+    EXPECT_FALSE(SQLBuilderVisitor::hasTrigram("a_c%"));
+    EXPECT_FALSE(SQLBuilderVisitor::hasTrigram("%ab%cd%"));
+}
+
+TEST(SQLBuilderVisitorTest, ArrayFunctionsReadElements) {
+    std::string filter = "json_contains(tags, 'red')";
+    std::string expected_sql =
+        "EXISTS (SELECT 1 FROM VectorMetadata vm0, json_each(CASE WHEN vm0.valueType IN (4, 5) THEN vm0.value END, '$') je0 "
+        "WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'tags' AND "
+        "CASE WHEN je0.type = 'text' THEN je0.value WHEN je0.type <> 'null' THEN vm0.value -> je0.fullkey END = 'red')";
+    EXPECT_EQ(convertFilterToSQL(filter), expected_sql);
+
+    filter = "array_length(tags) == 2";
+    expected_sql =
+        "(SELECT MAX(CASE WHEN vm0.valueType IN (4, 5) THEN json_array_length(vm0.value, '$') END) FROM VectorMetadata vm0 "
+        "WHERE vm0.vectorId = VectorMetadata.vectorId AND vm0.key = 'tags') = 2";
+    EXPECT_EQ(convertFilterToSQL(filter), expected_sql);
+
+    EXPECT_THROW(convertFilterToSQL("json_contains_all(tags, 'red')"), std::invalid_argument);
+    EXPECT_THROW(convertFilterToSQL("json_contains(tags, other)"), std::invalid_argument);
+}
@@ -538,6 +538,15 @@ TEST_F(SearchServiceTest, VectorSearchWithJSONQueryAndFilter) {
     auto metadataList3 = VectorMetadataManager::getInstance().getVectorMetadataByVectorId(vector3.id);
     EXPECT_EQ(metadataList3[0].key, "category");
     EXPECT_EQ(metadataList3[0].value, "A");
+
+    // Facets are counted over the hits only
+    nlohmann::json facets = searchManager.getFacets("VectorSearchWithJSONQuery", 1, searchResults, {"category"});
+    EXPECT_EQ(facets["facets"]["category"], nlohmann::json::parse(R"([{"value": "A", "count": 2}])"));
+
+    auto allResults = searchManager.search("VectorSearchWithJSONQuery", 1, R"({"vector": [0.25, 0.45, 0.75, 0.85]})", 3);
+    facets = searchManager.getFacets("VectorSearchWithJSONQuery", 1, allResults, {"category"});
+    EXPECT_EQ(facets["facets"]["category"],
+              nlohmann::json::parse(R"([{"value": "A", "count": 2}, {"value": "B", "count": 1}])"));
 }
 
 TEST_F(SearchServiceTest, VectorSearchWithQuantization) {
@@ -600,3 +609,143 @@ TEST_F(SearchServiceTest, VectorSearchWithQuantization) {
     // Validate that two results are returned
     ASSERT_EQ(searchResults.size(), 2);
 }
+
+TEST_F(SearchServiceTest, VectorSearchIntoCallerBuffers) {
+    Space defaultSpace(0, "VectorSearchIntoCallerBuffers", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 1, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    VersionManager::getInstance().addVersion(defaultVersion);
+    int versionId = IdCache::getInstance().getVersionId("VectorSearchIntoCallerBuffers", 1);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    std::string vectorDataJson = R"({
+        "vectors": [
+            {"id": 1, "data": [0.25, 0.45, 0.75, 0.85]},
+            {"id": 2, "data": [0.20, 0.62, 0.77, 0.75]},
+            {"id": 3, "data": [0.90, 0.10, 0.10, 0.10]}
+        ]
+    })";
+    VectorServiceManager vectorServiceManager;
+    vectorServiceManager.upsert("VectorSearchIntoCallerBuffers", 1, vectorDataJson);
+
+    SearchServiceManager searchManager;
+    auto jsonResults = searchManager.search("VectorSearchIntoCallerBuffers", 1, R"({"vector": [0.25, 0.45, 0.75, 0.85]})", 2);
+
+    const float query[] = {0.25f, 0.45f, 0.75f, 0.85f};
+    float distances[2];
+    int64_t labels[2];
+    size_t found = searchManager.searchDense("VectorSearchIntoCallerBuffers", 1, query, 4, 2, distances, labels);
+
+    ASSERT_EQ(found, jsonResults.size());
+    for (size_t i = 0; i < found; ++i) {
+        EXPECT_FLOAT_EQ(distances[i], jsonResults[i].first);
+        EXPECT_EQ(labels[i], jsonResults[i].second);
+    }
+    EXPECT_EQ(labels[0], 1);
+
+    // Asking for more hits than vectors leaves the tail unused
+    float moreDistances[8];
+    int64_t moreLabels[8];
+    EXPECT_EQ(searchManager.searchDense("VectorSearchIntoCallerBuffers", 1, query, 4, 8, moreDistances, moreLabels), 3u);
+
+    // Sparse query against the same dense index
+    const int indices[] = {0, 1, 2, 3};
+    float sparseDistances[1];
+    int64_t sparseLabels[1];
+    ASSERT_EQ(searchManager.searchSparse("VectorSearchIntoCallerBuffers", 1, indices, query, 4, 1, sparseDistances, sparseLabels), 1u);
+    EXPECT_EQ(sparseLabels[0], 1);
+
+    EXPECT_THROW(searchManager.searchDense("VectorSearchIntoCallerBuffers", 1, query, 3, 2, distances, labels), std::invalid_argument);
+}
+
+TEST_F(SearchServiceTest, VectorSearchWithSelectiveFilter) {
+    Space defaultSpace(0, "VectorSearchWithSelectiveFilter", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 1, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+    IdCache::getInstance().getVersionId("VectorSearchWithSelectiveFilter", 1);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    // Vectors 1..40 lie along a line; only the farthest four are "rare"
+    json vectors = json::array();
+    for (int i = 1; i <= 40; ++i) {
+        float x = static_cast<float>(i);
+        vectors.push_back({
+            {"id", i},
+            {"data", {x, x, x, x}},
+            {"metadata", {{"kind", i > 36 ? "rare" : "common"}}}
+        });
+    }
+    VectorServiceManager vectorServiceManager;
+    vectorServiceManager.upsert("VectorSearchWithSelectiveFilter", 1, json{{"vectors", vectors}}.dump());
+
+    // Filtering the unfiltered top 3 would leave nothing; the rare vectors are
+    // searched directly instead
+    SearchServiceManager searchManager;
+    auto results = searchManager.search("VectorSearchWithSelectiveFilter", 1,
+        R"({"vector": [1, 1, 1, 1], "filter": "kind == 'rare'"})", 3);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].second, 37);
+    EXPECT_EQ(results[1].second, 38);
+    EXPECT_EQ(results[2].second, 39);
+    EXPECT_NEAR(results[0].first, 4 * 36.0 * 36.0, 1e-2);
+
+    // Sparse queries take the same plans
+    results = searchManager.search("VectorSearchWithSelectiveFilter", 1,
+        R"({"sparse_data": {"indices": [0, 1, 2, 3], "values": [40, 40, 40, 40]}, "filter": "kind == 'common'"})", 2);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].second, 36);
+    EXPECT_EQ(results[1].second, 35);
+}
+
+TEST_F(SearchServiceTest, VectorSearchOverFetchesForSQLFilters) {
+    Space defaultSpace(0, "VectorSearchOverFetch", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 1, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+    IdCache::getInstance().getVersionId("VectorSearchOverFetch", 1);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    json vectors = json::array();
+    for (int i = 1; i <= 40; ++i) {
+        float x = static_cast<float>(i);
+        vectors.push_back({{"id", i}, {"data", {x, x, x, x}}, {"metadata", {{"info", {{"rank", i}}}}}});
+    }
+    VectorServiceManager vectorServiceManager;
+    vectorServiceManager.upsert("VectorSearchOverFetch", 1, json{{"vectors", vectors}}.dump());
+
+    // JSON paths are only answered by SQL, neither by the bitmap index nor by a
+    // compiled predicate, so the hits nearest to the query are filtered in
+    // growing rounds until three of them pass
+    SearchServiceManager searchManager;
+    auto results = searchManager.search("VectorSearchOverFetch", 1,
+        R"({"vector": [1, 1, 1, 1], "filter": "info['rank'] > 36"})", 3);
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].second, 37);
+    EXPECT_EQ(results[1].second, 38);
+    EXPECT_EQ(results[2].second, 39);
+
+    // Filters matching fewer than k vectors return all of them
+    results = searchManager.search("VectorSearchOverFetch", 1,
+        R"({"vector": [1, 1, 1, 1], "filter": "info['rank'] > 39"})", 3);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].second, 40);
+}
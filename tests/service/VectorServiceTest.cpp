@@ -1,6 +1,8 @@
 // VectorServiceTest.cpp
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include "service/SearchService.hpp"
 #include "service/SpaceService.hpp"
 #include "service/VectorService.hpp"
 #include "algo/FaissIndexLRUCache.hpp"
@@ -313,4 +315,363 @@ TEST_F(VectorServiceManagerTest, GetVectorsByVersionIdWithFilter) {
     ASSERT_EQ(fetchedVectors["vectors"].size(), 1);
     EXPECT_EQ(fetchedVectors["vectors"][0]["id"], 2);
     EXPECT_EQ(fetchedVectors["vectors"][0]["metadata"]["status"], "inactive");
-}
\ No newline at end of file
+}
+
+TEST_F(VectorServiceManagerTest, UpsertTypedMetadataAndFilterRanges) {
+    Space defaultSpace(0, "default_space", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 0, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 2,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    VectorServiceManager manager;
+
+    std::string updateJson = R"({
+        "vectors": [
+            {"id": 1, "data": [0.1, 0.2], "metadata": {"price": 9, "on_sale": true, "tags": ["a", "b"], "name": "pen"}},
+            {"id": 2, "data": [0.3, 0.4], "metadata": {"price": 100, "on_sale": false, "rating": 4.5, "extra": null}},
+            {"id": 3, "data": [0.5, 0.6], "metadata": {"price": 1250.5, "dims": {"w": 2}}}
+        ]
+    })";
+    manager.upsert("default_space", 0, updateJson);
+
+    // Values come back with the type they were written with
+    json fetched = manager.getVectorsByVersionId("default_space", 0, 0, 10);
+    ASSERT_EQ(fetched["vectors"].size(), 3);
+    for (const auto& vectorJson : fetched["vectors"]) {
+        const auto& metadata = vectorJson["metadata"];
+        if (vectorJson["id"] == 1) {
+            EXPECT_EQ(metadata["price"], 9);
+            EXPECT_EQ(metadata["on_sale"], true);
+            EXPECT_EQ(metadata["tags"], json::array({"a", "b"}));
+            EXPECT_EQ(metadata["name"], "pen");
+        } else if (vectorJson["id"] == 2) {
+            EXPECT_EQ(metadata["rating"], 4.5);
+            EXPECT_TRUE(metadata["extra"].is_null());
+        } else {
+            EXPECT_EQ(metadata["price"], 1250.5);
+            EXPECT_EQ(metadata["dims"]["w"], 2);
+        }
+    }
+
+    // Numbers compare numerically ("9" > "100" as TEXT)
+    auto ids = [&](const std::string& filter) {
+        std::vector<int> uniqueIds;
+        for (const auto& vectorJson : manager.getVectorsByVersionId("default_space", 0, 0, 10, filter)["vectors"]) {
+            uniqueIds.push_back(vectorJson["id"].get<int>());
+        }
+        std::sort(uniqueIds.begin(), uniqueIds.end());
+        return uniqueIds;
+    };
+    EXPECT_EQ(ids("price > 50"), (std::vector<int>{2, 3}));
+    EXPECT_EQ(ids("price < 100"), (std::vector<int>{1}));
+    EXPECT_EQ(ids("10 <= price < 2000"), (std::vector<int>{2, 3}));
+    EXPECT_EQ(ids("1000 > price >= 9"), (std::vector<int>{1, 2}));
+    EXPECT_EQ(ids("on_sale == true"), (std::vector<int>{1}));
+    EXPECT_EQ(ids("rating >= 4.5"), (std::vector<int>{2}));
+    EXPECT_EQ(ids("price IN (9, 100)"), (std::vector<int>{1, 2}));
+}
+
+TEST_F(VectorServiceManagerTest, GetVectorsByCursor) {
+    Space defaultSpace(0, "default_space", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 0, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    VectorServiceManager manager;
+
+    std::string updateJson = R"({
+        "vectors": [
+            {"id": 1, "data": [0.1, 0.2, 0.3, 0.4], "metadata": {"status": "active"}},
+            {"id": 2, "data": [0.2, 0.3, 0.4, 0.5], "metadata": {"status": "inactive"}},
+            {"id": 3, "data": [0.3, 0.4, 0.5, 0.6], "metadata": {"status": "active"}},
+            {"id": 4, "data": [0.4, 0.5, 0.6, 0.7], "metadata": {"status": "active"}}
+        ]
+    })";
+    manager.upsert("default_space", 0, updateJson);
+
+    json firstPage = manager.getVectorsByCursor("default_space", 0, 0, 2);
+    ASSERT_EQ(firstPage["vectors"].size(), 2);
+    EXPECT_EQ(firstPage["vectors"][0]["id"], 1);
+    EXPECT_EQ(firstPage["vectors"][1]["id"], 2);
+    EXPECT_EQ(firstPage["total_count"], 4);
+    ASSERT_EQ(firstPage["next_cursor"], 2);
+
+    json secondPage = manager.getVectorsByCursor("default_space", 0, firstPage["next_cursor"].get<int>(), 2);
+    ASSERT_EQ(secondPage["vectors"].size(), 2);
+    EXPECT_EQ(secondPage["vectors"][0]["id"], 3);
+    EXPECT_EQ(secondPage["vectors"][1]["id"], 4);
+
+    json lastPage = manager.getVectorsByCursor("default_space", 0, secondPage["next_cursor"].get<int>(), 2);
+    EXPECT_TRUE(lastPage["vectors"].empty());
+    EXPECT_TRUE(lastPage["next_cursor"].is_null());
+
+    // Filtered cursor skips non-matching vectors
+    json filteredPage = manager.getVectorsByCursor("default_space", 0, 1, 10, "status == 'active'");
+    ASSERT_EQ(filteredPage["vectors"].size(), 2);
+    EXPECT_EQ(filteredPage["vectors"][0]["id"], 3);
+    EXPECT_EQ(filteredPage["vectors"][1]["id"], 4);
+    EXPECT_TRUE(filteredPage["next_cursor"].is_null());
+}
+
+TEST_F(VectorServiceManagerTest, GetFacets) {
+    Space defaultSpace(0, "default_space", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 0, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    VectorServiceManager manager;
+
+    std::string updateJson = R"({
+        "vectors": [
+            {"id": 1, "data": [0.1, 0.2, 0.3, 0.4], "metadata": {"status": "active", "color": "red"}},
+            {"id": 2, "data": [0.2, 0.3, 0.4, 0.5], "metadata": {"status": "inactive", "color": "red"}},
+            {"id": 3, "data": [0.3, 0.4, 0.5, 0.6], "metadata": {"status": "active", "color": "blue"}},
+            {"id": 4, "data": [0.4, 0.5, 0.6, 0.7], "metadata": {"status": "active", "color": "red"}}
+        ]
+    })";
+    manager.upsert("default_space", 0, updateJson);
+
+    json result = manager.getFacets("default_space", 0, {"status", "color"});
+    EXPECT_EQ(result["facets"]["status"], json::parse(R"([{"value": "active", "count": 3}, {"value": "inactive", "count": 1}])"));
+    EXPECT_EQ(result["facets"]["color"], json::parse(R"([{"value": "red", "count": 3}, {"value": "blue", "count": 1}])"));
+
+    result = manager.getFacets("default_space", 0, {"color"}, "status == 'active'", 1);
+    EXPECT_EQ(result["facets"]["color"], json::parse(R"([{"value": "red", "count": 2}])"));
+}
+
+TEST_F(VectorServiceManagerTest, DeleteAndUpdateByFilter) {
+    Space defaultSpace(0, "default_space", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 0, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    VectorServiceManager manager;
+
+    std::string updateJson = R"({
+        "vectors": [
+            {"id": 1, "data": [0.1, 0.2, 0.3, 0.4], "metadata": {"status": "active", "color": "red"}},
+            {"id": 2, "data": [0.2, 0.3, 0.4, 0.5], "metadata": {"status": "inactive", "color": "red"}},
+            {"id": 3, "data": [0.3, 0.4, 0.5, 0.6], "metadata": {"status": "active", "color": "blue"}},
+            {"id": 4, "data": [0.4, 0.5, 0.6, 0.7], "metadata": {"status": "active", "color": "red"}}
+        ]
+    })";
+    manager.upsert("default_space", 0, updateJson);
+
+    SearchServiceManager searchManager;
+    std::string queryJson = R"({"vector": [0.2, 0.3, 0.4, 0.5]})";
+    ASSERT_EQ(searchManager.search("default_space", 0, queryJson, 4).size(), 4u);
+    long deletedVectorId = VectorManager::getInstance().getVectorByUniqueId(versionId, 2).id;
+
+    json result = manager.deleteByFilter("default_space", 0, "status == 'inactive'");
+    EXPECT_EQ(result["deleted_count"], 1);
+    EXPECT_EQ(manager.getVectorsByVersionId("default_space", 0, 0, 10)["total_count"], 3);
+    EXPECT_TRUE(VectorMetadataManager::getInstance().getVectorMetadataByVectorId(deletedVectorId).empty());
+
+    // The loaded index no longer returns the deleted vector
+    auto hits = searchManager.search("default_space", 0, queryJson, 4);
+    ASSERT_EQ(hits.size(), 3u);
+    for (const auto& hit : hits) {
+        EXPECT_NE(hit.second, 2);
+    }
+
+    result = manager.updateMetadataByFilter("default_space", 0, "color == 'red'", R"({"color": "green", "reviewed": true})");
+    EXPECT_EQ(result["updated_count"], 2);
+    result = manager.getFacets("default_space", 0, {"color"});
+    EXPECT_EQ(result["facets"]["color"], json::parse(R"([{"value": "green", "count": 2}, {"value": "blue", "count": 1}])"));
+    json reviewed = manager.getVectorsByCursor("default_space", 0, 0, 10, "reviewed == true");
+    ASSERT_EQ(reviewed["vectors"].size(), 2);
+    EXPECT_EQ(reviewed["vectors"][0]["id"], 1);
+    EXPECT_EQ(reviewed["vectors"][1]["id"], 4);
+    EXPECT_EQ(reviewed["vectors"][0]["metadata"]["color"], "green");
+
+    // Filters only SQL answers (mixed NOT IN lists) are matched on the writer,
+    // inside the write transaction
+    EXPECT_EQ(manager.updateMetadataByFilter("default_space", 0, "color NOT IN ('green', 5)", R"({"reviewed": false})")["updated_count"], 1);
+    EXPECT_EQ(manager.deleteByFilter("default_space", 0, "color NOT IN ('green', 5)")["deleted_count"], 1);
+    EXPECT_EQ(manager.getVectorsByVersionId("default_space", 0, 0, 10)["total_count"], 2);
+
+    EXPECT_EQ(manager.deleteByFilter("default_space", 0, "status == 'missing'")["deleted_count"], 0);
+    EXPECT_THROW(manager.deleteByFilter("default_space", 0, ""), std::invalid_argument);
+    EXPECT_THROW(manager.updateMetadataByFilter("default_space", 0, "status == 'active'", "[]"), std::invalid_argument);
+}
+
+TEST_F(VectorServiceManagerTest, UpsertBatchFromBuffers) {
+    Space defaultSpace(0, "default_space", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 0, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    VectorServiceManager manager;
+
+    // Two explicit ids and one allocated id; "status" is missing for the third vector
+    std::vector<int> ids = {10, 20, 0};
+    std::vector<float> dense = {
+        0.1f, 0.2f, 0.3f, 0.4f,
+        0.5f, 0.6f, 0.7f, 0.8f,
+        0.9f, 1.0f, 1.1f, 1.2f,
+    };
+    std::vector<const char*> keys = {"category", "status"};
+    std::vector<const char*> values = {
+        "A", "B", "C",
+        "active", "inactive", nullptr,
+    };
+
+    VectorBatch batch;
+    batch.count = ids.size();
+    batch.ids = ids.data();
+    batch.denseData = dense.data();
+    batch.dim = 4;
+    batch.metadataKeyCount = keys.size();
+    batch.metadataKeys = keys.data();
+    batch.metadataValues = values.data();
+    manager.upsertBatch("default_space", 0, batch);
+
+    json fetched = manager.getVectorsByVersionId("default_space", 0, 0, 10);
+    ASSERT_EQ(fetched["vectors"].size(), 3);
+
+    EXPECT_EQ(fetched["vectors"][0]["id"], 10);
+    EXPECT_EQ(fetched["vectors"][0]["data"]["data"], std::vector<float>({0.1f, 0.2f, 0.3f, 0.4f}));
+    EXPECT_EQ(fetched["vectors"][0]["metadata"]["category"], "A");
+    EXPECT_EQ(fetched["vectors"][0]["metadata"]["status"], "active");
+
+    EXPECT_EQ(fetched["vectors"][1]["id"], 20);
+    EXPECT_EQ(fetched["vectors"][1]["metadata"]["status"], "inactive");
+
+    EXPECT_GT(fetched["vectors"][2]["id"].get<int>(), 20);
+    EXPECT_EQ(fetched["vectors"][2]["data"]["data"], std::vector<float>({0.9f, 1.0f, 1.1f, 1.2f}));
+    EXPECT_EQ(fetched["vectors"][2]["metadata"]["category"], "C");
+    EXPECT_FALSE(fetched["vectors"][2]["metadata"].contains("status"));
+
+    // Sparse rows in CSR form replace the existing vector with id 10
+    std::vector<int> sparseIds = {10};
+    std::vector<int64_t> offsets = {0, 2};
+    std::vector<int> indices = {0, 2};
+    std::vector<float> sparseValues = {0.5f, 0.7f};
+
+    VectorBatch sparseBatch;
+    sparseBatch.count = 1;
+    sparseBatch.ids = sparseIds.data();
+    sparseBatch.sparseOffsets = offsets.data();
+    sparseBatch.sparseIndices = indices.data();
+    sparseBatch.sparseValues = sparseValues.data();
+    manager.upsertBatch("default_space", 0, sparseBatch);
+
+    fetched = manager.getVectorsByVersionId("default_space", 0, 0, 10);
+    ASSERT_EQ(fetched["vectors"].size(), 3);
+    EXPECT_EQ(fetched["vectors"][0]["data"]["sparse_data"]["indices"], std::vector<int>({0, 2}));
+    EXPECT_EQ(fetched["vectors"][0]["data"]["sparse_data"]["values"], std::vector<float>({0.5f, 0.7f}));
+
+    // Dense and sparse in the same batch is rejected
+    sparseBatch.denseData = dense.data();
+    sparseBatch.dim = 4;
+    EXPECT_THROW(manager.upsertBatch("default_space", 0, sparseBatch), std::invalid_argument);
+}
+
+TEST_F(VectorServiceManagerTest, UpsertStreamsLargeVectorsPayload) {
+    Space defaultSpace(0, "default_space", "Default Space Description", 0, 0);
+    int spaceId = SpaceManager::getInstance().addSpace(defaultSpace);
+
+    Version defaultVersion(0, spaceId, 0, "Default Version", "Automatically created default version", "v1", 0, 0, true);
+    int versionId = VersionManager::getInstance().addVersion(defaultVersion);
+
+    HnswConfig hnswConfig(16, 200);
+    QuantizationConfig quantizationConfig;
+    VectorIndex defaultIndex(0, versionId, VectorValueType::Dense, "Default Index", MetricType::L2, 4,
+                             hnswConfig.toJson().dump(), quantizationConfig.toJson().dump(), 0, 0, true);
+    VectorIndexManager::getInstance().addVectorIndex(defaultIndex);
+
+    VectorServiceManager manager;
+
+    // More vectors than one write chunk, with members in any order and unknown members skipped
+    const int explicitCount = 300;
+    std::string payload = R"({"name": "bulk", "vectors": [)";
+    for (int i = 0; i < explicitCount; ++i) {
+        payload += R"({"metadata": {"group": ")" + std::to_string(i % 2) + R"("}, "data": [)" +
+                   std::to_string(i) + R"(, 0.5, 1, 2], "extra": {"nested": [1, {"a": 2}]}, "id": )" + std::to_string(i + 1) + "},";
+    }
+    payload += R"({"sparse_data": {"indices": [1, 3], "values": [0.9, 1.0]}, "doc": "sparse doc", "doc_tokens": ["sparse", "doc"]},)";
+    payload += R"({"data": [9, 9, 9, 9]}]})";
+
+    manager.upsert("default_space", 0, payload);
+
+    EXPECT_EQ(VectorManager::getInstance().countByVersionId(versionId), explicitCount + 2);
+
+    auto vector = VectorManager::getInstance().getVectorByUniqueId(versionId, 257);
+    ASSERT_EQ(vector.values.size(), 1);
+    EXPECT_EQ(vector.values[0].denseData, std::vector<float>({256.0f, 0.5f, 1.0f, 2.0f}));
+    auto metadataList = VectorMetadataManager::getInstance().getVectorMetadataByVectorId(vector.id);
+    ASSERT_EQ(metadataList.size(), 1);
+    EXPECT_EQ(metadataList[0].key, "group");
+    EXPECT_EQ(metadataList[0].value, "0");
+
+    json page = manager.getVectorsByCursor("default_space", 0, explicitCount, 10);
+    ASSERT_EQ(page["vectors"].size(), 2);
+    EXPECT_EQ(page["vectors"][0]["data"]["sparse_data"]["indices"], std::vector<int>({1, 3}));
+    EXPECT_EQ(page["vectors"][0]["doc"], "sparse doc");
+    EXPECT_EQ(page["vectors"][1]["data"]["data"], std::vector<float>({9.0f, 9.0f, 9.0f, 9.0f}));
+
+    // "vectors" and the standalone "data" form in one payload
+    manager.upsert("default_space", 0, R"({"vectors": [{"id": 1, "data": [1, 1, 1, 1]}], "data": [[2, 2, 2, 2]]})");
+    EXPECT_EQ(VectorManager::getInstance().countByVersionId(versionId), explicitCount + 3);
+    EXPECT_EQ(VectorManager::getInstance().getVectorByUniqueId(versionId, 1).values[0].denseData, std::vector<float>({1.0f, 1.0f, 1.0f, 1.0f}));
+
+    EXPECT_THROW(manager.upsert("default_space", 0, R"({"vectors": [{"id": 5, "data": [1, 2)"), json::parse_error);
+    EXPECT_THROW(manager.upsert("default_space", 0, R"({"vectors": [{"id": 5, "metadata": {"group": 1}}]})"), std::runtime_error);
+
+    // Ids and sparse indices must be integers that fit an int
+    for (const char* id : {"1.5", "1e10", "-3000000000", "\"5\""}) {
+        std::string payload = std::string(R"({"vectors": [{"id": )") + id + R"(, "data": [1, 2, 3, 4]}]})";
+        EXPECT_THROW(manager.upsert("default_space", 0, payload), std::runtime_error) << id;
+    }
+    for (const char* index : {"2.5", "4294967296"}) {
+        std::string payload = std::string(R"({"vectors": [{"id": 5, "sparse_data": {"indices": [)") + index +
+                              R"(], "values": [0.5]}}]})";
+        EXPECT_THROW(manager.upsert("default_space", 0, payload), std::runtime_error) << index;
+    }
+    EXPECT_EQ(VectorManager::getInstance().countByVersionId(versionId), explicitCount + 3);
+
+    // A bad payload writes nothing, even when its error comes after the first chunks
+    std::string valid = R"({"vectors": [)";
+    for (int i = 0; i < explicitCount; ++i) {
+        valid += R"({"id": )" + std::to_string(1000 + i) + R"(, "data": [1, 2, 3, 4]},)";
+    }
+    EXPECT_THROW(manager.upsert("default_space", 0, valid + R"({"id": 5, "data": [1, 2)"), json::parse_error);
+    EXPECT_THROW(manager.upsert("default_space", 0, valid + R"({"id": 5.5, "data": [1, 2, 3, 4]}]})"), std::runtime_error);
+    EXPECT_THROW(manager.upsert("default_space", 0, valid + R"({"sparse_data": {"indices": [1], "values": []}}]})"), std::runtime_error);
+    EXPECT_EQ(VectorManager::getInstance().countByVersionId(versionId), explicitCount + 3);
+}